@@ -0,0 +1,263 @@
+// Generated by make_font_headers from Bm437_IBM_VGA_8x16.FON, do not edit
+// 8x16 cells, 256 glyphs in CP437 order, one row per uint16_t (bit 15 = leftmost)
+
+static const uint16_t VTermFontBits_Bm437_IBM_VGA_8x16[256 * 16] = {
+  0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000, // 0x00
+  0x0000,0x0000,0x7e00,0x8100,0xa500,0x8100,0x8100,0xbd00,0x9900,0x8100,0x8100,0x7e00,0x0000,0x0000,0x0000,0x0000, // 0x01
+  0x0000,0x0000,0x7e00,0xff00,0xdb00,0xff00,0xff00,0xc300,0xe700,0xff00,0xff00,0x7e00,0x0000,0x0000,0x0000,0x0000, // 0x02
+  0x0000,0x0000,0x0000,0x0000,0x6c00,0xfe00,0xfe00,0xfe00,0xfe00,0x7c00,0x3800,0x1000,0x0000,0x0000,0x0000,0x0000, // 0x03
+  0x0000,0x0000,0x0000,0x0000,0x1000,0x3800,0x7c00,0xfe00,0x7c00,0x3800,0x1000,0x0000,0x0000,0x0000,0x0000,0x0000, // 0x04
+  0x0000,0x0000,0x0000,0x1800,0x3c00,0x3c00,0xe700,0xe700,0xe700,0x1800,0x1800,0x3c00,0x0000,0x0000,0x0000,0x0000, // 0x05
+  0x0000,0x0000,0x0000,0x1800,0x3c00,0x7e00,0xff00,0xff00,0x7e00,0x1800,0x1800,0x3c00,0x0000,0x0000,0x0000,0x0000, // 0x06
+  0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x1800,0x3c00,0x3c00,0x1800,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000, // 0x07
+  0xff00,0xff00,0xff00,0xff00,0xff00,0xff00,0xe700,0xc300,0xc300,0xe700,0xff00,0xff00,0xff00,0xff00,0xff00,0xff00, // 0x08
+  0x0000,0x0000,0x0000,0x0000,0x0000,0x3c00,0x6600,0x4200,0x4200,0x6600,0x3c00,0x0000,0x0000,0x0000,0x0000,0x0000, // 0x09
+  0xff00,0xff00,0xff00,0xff00,0xff00,0xc300,0x9900,0xbd00,0xbd00,0x9900,0xc300,0xff00,0xff00,0xff00,0xff00,0xff00, // 0x0a
+  0x0000,0x0000,0x1e00,0x0e00,0x1a00,0x3200,0x7800,0xcc00,0xcc00,0xcc00,0xcc00,0x7800,0x0000,0x0000,0x0000,0x0000, // 0x0b
+  0x0000,0x0000,0x3c00,0x6600,0x6600,0x6600,0x6600,0x3c00,0x1800,0x7e00,0x1800,0x1800,0x0000,0x0000,0x0000,0x0000, // 0x0c
+  0x0000,0x0000,0x3f00,0x3300,0x3f00,0x3000,0x3000,0x3000,0x3000,0x7000,0xf000,0xe000,0x0000,0x0000,0x0000,0x0000, // 0x0d
+  0x0000,0x0000,0x7f00,0x6300,0x7f00,0x6300,0x6300,0x6300,0x6300,0x6700,0xe700,0xe600,0xc000,0x0000,0x0000,0x0000, // 0x0e
+  0x0000,0x0000,0x0000,0x1800,0x1800,0xdb00,0x3c00,0xe700,0x3c00,0xdb00,0x1800,0x1800,0x0000,0x0000,0x0000,0x0000, // 0x0f
+  0x0000,0x8000,0xc000,0xe000,0xf000,0xf800,0xfe00,0xf800,0xf000,0xe000,0xc000,0x8000,0x0000,0x0000,0x0000,0x0000, // 0x10
+  0x0000,0x0200,0x0600,0x0e00,0x1e00,0x3e00,0xfe00,0x3e00,0x1e00,0x0e00,0x0600,0x0200,0x0000,0x0000,0x0000,0x0000, // 0x11
+  0x0000,0x0000,0x1800,0x3c00,0x7e00,0x1800,0x1800,0x1800,0x7e00,0x3c00,0x1800,0x0000,0x0000,0x0000,0x0000,0x0000, // 0x12
+  0x0000,0x0000,0x6600,0x6600,0x6600,0x6600,0x6600,0x6600,0x6600,0x0000,0x6600,0x6600,0x0000,0x0000,0x0000,0x0000, // 0x13
+  0x0000,0x0000,0x7f00,0xdb00,0xdb00,0xdb00,0x7b00,0x1b00,0x1b00,0x1b00,0x1b00,0x1b00,0x0000,0x0000,0x0000,0x0000, // 0x14
+  0x0000,0x7c00,0xc600,0x6000,0x3800,0x6c00,0xc600,0xc600,0x6c00,0x3800,0x0c00,0xc600,0x7c00,0x0000,0x0000,0x0000, // 0x15
+  0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0xfe00,0xfe00,0xfe00,0xfe00,0x0000,0x0000,0x0000,0x0000, // 0x16
+  0x0000,0x0000,0x1800,0x3c00,0x7e00,0x1800,0x1800,0x1800,0x7e00,0x3c00,0x1800,0x7e00,0x0000,0x0000,0x0000,0x0000, // 0x17
+  0x0000,0x0000,0x1800,0x3c00,0x7e00,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x0000,0x0000,0x0000,0x0000, // 0x18
+  0x0000,0x0000,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x7e00,0x3c00,0x1800,0x0000,0x0000,0x0000,0x0000, // 0x19
+  0x0000,0x0000,0x0000,0x0000,0x0000,0x1800,0x0c00,0xfe00,0x0c00,0x1800,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000, // 0x1a
+  0x0000,0x0000,0x0000,0x0000,0x0000,0x3000,0x6000,0xfe00,0x6000,0x3000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000, // 0x1b
+  0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0xc000,0xc000,0xc000,0xfe00,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000, // 0x1c
+  0x0000,0x0000,0x0000,0x0000,0x0000,0x2800,0x6c00,0xfe00,0x6c00,0x2800,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000, // 0x1d
+  0x0000,0x0000,0x0000,0x0000,0x1000,0x3800,0x3800,0x7c00,0x7c00,0xfe00,0xfe00,0x0000,0x0000,0x0000,0x0000,0x0000, // 0x1e
+  0x0000,0x0000,0x0000,0x0000,0xfe00,0xfe00,0x7c00,0x7c00,0x3800,0x3800,0x1000,0x0000,0x0000,0x0000,0x0000,0x0000, // 0x1f
+  0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000, // 0x20
+  0x0000,0x0000,0x1800,0x3c00,0x3c00,0x3c00,0x1800,0x1800,0x1800,0x0000,0x1800,0x1800,0x0000,0x0000,0x0000,0x0000, // 0x21
+  0x0000,0x6600,0x6600,0x6600,0x2400,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000, // 0x22
+  0x0000,0x0000,0x0000,0x6c00,0x6c00,0xfe00,0x6c00,0x6c00,0x6c00,0xfe00,0x6c00,0x6c00,0x0000,0x0000,0x0000,0x0000, // 0x23
+  0x1800,0x1800,0x7c00,0xc600,0xc200,0xc000,0x7c00,0x0600,0x0600,0x8600,0xc600,0x7c00,0x1800,0x1800,0x0000,0x0000, // 0x24
+  0x0000,0x0000,0x0000,0x0000,0xc200,0xc600,0x0c00,0x1800,0x3000,0x6000,0xc600,0x8600,0x0000,0x0000,0x0000,0x0000, // 0x25
+  0x0000,0x0000,0x3800,0x6c00,0x6c00,0x3800,0x7600,0xdc00,0xcc00,0xcc00,0xcc00,0x7600,0x0000,0x0000,0x0000,0x0000, // 0x26
+  0x0000,0x3000,0x3000,0x3000,0x6000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000, // 0x27
+  0x0000,0x0000,0x0c00,0x1800,0x3000,0x3000,0x3000,0x3000,0x3000,0x3000,0x1800,0x0c00,0x0000,0x0000,0x0000,0x0000, // 0x28
+  0x0000,0x0000,0x3000,0x1800,0x0c00,0x0c00,0x0c00,0x0c00,0x0c00,0x0c00,0x1800,0x3000,0x0000,0x0000,0x0000,0x0000, // 0x29
+  0x0000,0x0000,0x0000,0x0000,0x0000,0x6600,0x3c00,0xff00,0x3c00,0x6600,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000, // 0x2a
+  0x0000,0x0000,0x0000,0x0000,0x0000,0x1800,0x1800,0x7e00,0x1800,0x1800,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000, // 0x2b
+  0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x1800,0x1800,0x1800,0x3000,0x0000,0x0000,0x0000, // 0x2c
+  0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0xfe00,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000, // 0x2d
+  0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x1800,0x1800,0x0000,0x0000,0x0000,0x0000, // 0x2e
+  0x0000,0x0000,0x0000,0x0000,0x0200,0x0600,0x0c00,0x1800,0x3000,0x6000,0xc000,0x8000,0x0000,0x0000,0x0000,0x0000, // 0x2f
+  0x0000,0x0000,0x3800,0x6c00,0xc600,0xc600,0xd600,0xd600,0xc600,0xc600,0x6c00,0x3800,0x0000,0x0000,0x0000,0x0000, // 0x30
+  0x0000,0x0000,0x1800,0x3800,0x7800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x7e00,0x0000,0x0000,0x0000,0x0000, // 0x31
+  0x0000,0x0000,0x7c00,0xc600,0x0600,0x0c00,0x1800,0x3000,0x6000,0xc000,0xc600,0xfe00,0x0000,0x0000,0x0000,0x0000, // 0x32
+  0x0000,0x0000,0x7c00,0xc600,0x0600,0x0600,0x3c00,0x0600,0x0600,0x0600,0xc600,0x7c00,0x0000,0x0000,0x0000,0x0000, // 0x33
+  0x0000,0x0000,0x0c00,0x1c00,0x3c00,0x6c00,0xcc00,0xfe00,0x0c00,0x0c00,0x0c00,0x1e00,0x0000,0x0000,0x0000,0x0000, // 0x34
+  0x0000,0x0000,0xfe00,0xc000,0xc000,0xc000,0xfc00,0x0600,0x0600,0x0600,0xc600,0x7c00,0x0000,0x0000,0x0000,0x0000, // 0x35
+  0x0000,0x0000,0x3800,0x6000,0xc000,0xc000,0xfc00,0xc600,0xc600,0xc600,0xc600,0x7c00,0x0000,0x0000,0x0000,0x0000, // 0x36
+  0x0000,0x0000,0xfe00,0xc600,0x0600,0x0600,0x0c00,0x1800,0x3000,0x3000,0x3000,0x3000,0x0000,0x0000,0x0000,0x0000, // 0x37
+  0x0000,0x0000,0x7c00,0xc600,0xc600,0xc600,0x7c00,0xc600,0xc600,0xc600,0xc600,0x7c00,0x0000,0x0000,0x0000,0x0000, // 0x38
+  0x0000,0x0000,0x7c00,0xc600,0xc600,0xc600,0x7e00,0x0600,0x0600,0x0600,0x0c00,0x7800,0x0000,0x0000,0x0000,0x0000, // 0x39
+  0x0000,0x0000,0x0000,0x0000,0x1800,0x1800,0x0000,0x0000,0x0000,0x1800,0x1800,0x0000,0x0000,0x0000,0x0000,0x0000, // 0x3a
+  0x0000,0x0000,0x0000,0x0000,0x1800,0x1800,0x0000,0x0000,0x0000,0x1800,0x1800,0x3000,0x0000,0x0000,0x0000,0x0000, // 0x3b
+  0x0000,0x0000,0x0000,0x0600,0x0c00,0x1800,0x3000,0x6000,0x3000,0x1800,0x0c00,0x0600,0x0000,0x0000,0x0000,0x0000, // 0x3c
+  0x0000,0x0000,0x0000,0x0000,0x0000,0x7e00,0x0000,0x0000,0x7e00,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000, // 0x3d
+  0x0000,0x0000,0x0000,0x6000,0x3000,0x1800,0x0c00,0x0600,0x0c00,0x1800,0x3000,0x6000,0x0000,0x0000,0x0000,0x0000, // 0x3e
+  0x0000,0x0000,0x7c00,0xc600,0xc600,0x0c00,0x1800,0x1800,0x1800,0x0000,0x1800,0x1800,0x0000,0x0000,0x0000,0x0000, // 0x3f
+  0x0000,0x0000,0x0000,0x7c00,0xc600,0xc600,0xde00,0xde00,0xde00,0xdc00,0xc000,0x7c00,0x0000,0x0000,0x0000,0x0000, // 0x40
+  0x0000,0x0000,0x1000,0x3800,0x6c00,0xc600,0xc600,0xfe00,0xc600,0xc600,0xc600,0xc600,0x0000,0x0000,0x0000,0x0000, // 0x41
+  0x0000,0x0000,0xfc00,0x6600,0x6600,0x6600,0x7c00,0x6600,0x6600,0x6600,0x6600,0xfc00,0x0000,0x0000,0x0000,0x0000, // 0x42
+  0x0000,0x0000,0x3c00,0x6600,0xc200,0xc000,0xc000,0xc000,0xc000,0xc200,0x6600,0x3c00,0x0000,0x0000,0x0000,0x0000, // 0x43
+  0x0000,0x0000,0xf800,0x6c00,0x6600,0x6600,0x6600,0x6600,0x6600,0x6600,0x6c00,0xf800,0x0000,0x0000,0x0000,0x0000, // 0x44
+  0x0000,0x0000,0xfe00,0x6600,0x6200,0x6800,0x7800,0x6800,0x6000,0x6200,0x6600,0xfe00,0x0000,0x0000,0x0000,0x0000, // 0x45
+  0x0000,0x0000,0xfe00,0x6600,0x6200,0x6800,0x7800,0x6800,0x6000,0x6000,0x6000,0xf000,0x0000,0x0000,0x0000,0x0000, // 0x46
+  0x0000,0x0000,0x3c00,0x6600,0xc200,0xc000,0xc000,0xde00,0xc600,0xc600,0x6600,0x3a00,0x0000,0x0000,0x0000,0x0000, // 0x47
+  0x0000,0x0000,0xc600,0xc600,0xc600,0xc600,0xfe00,0xc600,0xc600,0xc600,0xc600,0xc600,0x0000,0x0000,0x0000,0x0000, // 0x48
+  0x0000,0x0000,0x3c00,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x3c00,0x0000,0x0000,0x0000,0x0000, // 0x49
+  0x0000,0x0000,0x1e00,0x0c00,0x0c00,0x0c00,0x0c00,0x0c00,0xcc00,0xcc00,0xcc00,0x7800,0x0000,0x0000,0x0000,0x0000, // 0x4a
+  0x0000,0x0000,0xe600,0x6600,0x6600,0x6c00,0x7800,0x7800,0x6c00,0x6600,0x6600,0xe600,0x0000,0x0000,0x0000,0x0000, // 0x4b
+  0x0000,0x0000,0xf000,0x6000,0x6000,0x6000,0x6000,0x6000,0x6000,0x6200,0x6600,0xfe00,0x0000,0x0000,0x0000,0x0000, // 0x4c
+  0x0000,0x0000,0xc600,0xee00,0xfe00,0xfe00,0xd600,0xc600,0xc600,0xc600,0xc600,0xc600,0x0000,0x0000,0x0000,0x0000, // 0x4d
+  0x0000,0x0000,0xc600,0xe600,0xf600,0xfe00,0xde00,0xce00,0xc600,0xc600,0xc600,0xc600,0x0000,0x0000,0x0000,0x0000, // 0x4e
+  0x0000,0x0000,0x7c00,0xc600,0xc600,0xc600,0xc600,0xc600,0xc600,0xc600,0xc600,0x7c00,0x0000,0x0000,0x0000,0x0000, // 0x4f
+  0x0000,0x0000,0xfc00,0x6600,0x6600,0x6600,0x7c00,0x6000,0x6000,0x6000,0x6000,0xf000,0x0000,0x0000,0x0000,0x0000, // 0x50
+  0x0000,0x0000,0x7c00,0xc600,0xc600,0xc600,0xc600,0xc600,0xc600,0xd600,0xde00,0x7c00,0x0c00,0x0e00,0x0000,0x0000, // 0x51
+  0x0000,0x0000,0xfc00,0x6600,0x6600,0x6600,0x7c00,0x6c00,0x6600,0x6600,0x6600,0xe600,0x0000,0x0000,0x0000,0x0000, // 0x52
+  0x0000,0x0000,0x7c00,0xc600,0xc600,0x6000,0x3800,0x0c00,0x0600,0xc600,0xc600,0x7c00,0x0000,0x0000,0x0000,0x0000, // 0x53
+  0x0000,0x0000,0x7e00,0x7e00,0x5a00,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x3c00,0x0000,0x0000,0x0000,0x0000, // 0x54
+  0x0000,0x0000,0xc600,0xc600,0xc600,0xc600,0xc600,0xc600,0xc600,0xc600,0xc600,0x7c00,0x0000,0x0000,0x0000,0x0000, // 0x55
+  0x0000,0x0000,0xc600,0xc600,0xc600,0xc600,0xc600,0xc600,0xc600,0x6c00,0x3800,0x1000,0x0000,0x0000,0x0000,0x0000, // 0x56
+  0x0000,0x0000,0xc600,0xc600,0xc600,0xc600,0xd600,0xd600,0xd600,0xfe00,0xee00,0x6c00,0x0000,0x0000,0x0000,0x0000, // 0x57
+  0x0000,0x0000,0xc600,0xc600,0x6c00,0x7c00,0x3800,0x3800,0x7c00,0x6c00,0xc600,0xc600,0x0000,0x0000,0x0000,0x0000, // 0x58
+  0x0000,0x0000,0x6600,0x6600,0x6600,0x6600,0x3c00,0x1800,0x1800,0x1800,0x1800,0x3c00,0x0000,0x0000,0x0000,0x0000, // 0x59
+  0x0000,0x0000,0xfe00,0xc600,0x8600,0x0c00,0x1800,0x3000,0x6000,0xc200,0xc600,0xfe00,0x0000,0x0000,0x0000,0x0000, // 0x5a
+  0x0000,0x0000,0x3c00,0x3000,0x3000,0x3000,0x3000,0x3000,0x3000,0x3000,0x3000,0x3c00,0x0000,0x0000,0x0000,0x0000, // 0x5b
+  0x0000,0x0000,0x0000,0x8000,0xc000,0xe000,0x7000,0x3800,0x1c00,0x0e00,0x0600,0x0200,0x0000,0x0000,0x0000,0x0000, // 0x5c
+  0x0000,0x0000,0x3c00,0x0c00,0x0c00,0x0c00,0x0c00,0x0c00,0x0c00,0x0c00,0x0c00,0x3c00,0x0000,0x0000,0x0000,0x0000, // 0x5d
+  0x1000,0x3800,0x6c00,0xc600,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000, // 0x5e
+  0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0xff00,0x0000,0x0000, // 0x5f
+  0x3000,0x3000,0x1800,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000, // 0x60
+  0x0000,0x0000,0x0000,0x0000,0x0000,0x7800,0x0c00,0x7c00,0xcc00,0xcc00,0xcc00,0x7600,0x0000,0x0000,0x0000,0x0000, // 0x61
+  0x0000,0x0000,0xe000,0x6000,0x6000,0x7800,0x6c00,0x6600,0x6600,0x6600,0x6600,0x7c00,0x0000,0x0000,0x0000,0x0000, // 0x62
+  0x0000,0x0000,0x0000,0x0000,0x0000,0x7c00,0xc600,0xc000,0xc000,0xc000,0xc600,0x7c00,0x0000,0x0000,0x0000,0x0000, // 0x63
+  0x0000,0x0000,0x1c00,0x0c00,0x0c00,0x3c00,0x6c00,0xcc00,0xcc00,0xcc00,0xcc00,0x7600,0x0000,0x0000,0x0000,0x0000, // 0x64
+  0x0000,0x0000,0x0000,0x0000,0x0000,0x7c00,0xc600,0xfe00,0xc000,0xc000,0xc600,0x7c00,0x0000,0x0000,0x0000,0x0000, // 0x65
+  0x0000,0x0000,0x3800,0x6c00,0x6400,0x6000,0xf000,0x6000,0x6000,0x6000,0x6000,0xf000,0x0000,0x0000,0x0000,0x0000, // 0x66
+  0x0000,0x0000,0x0000,0x0000,0x0000,0x7600,0xcc00,0xcc00,0xcc00,0xcc00,0xcc00,0x7c00,0x0c00,0xcc00,0x7800,0x0000, // 0x67
+  0x0000,0x0000,0xe000,0x6000,0x6000,0x6c00,0x7600,0x6600,0x6600,0x6600,0x6600,0xe600,0x0000,0x0000,0x0000,0x0000, // 0x68
+  0x0000,0x0000,0x1800,0x1800,0x0000,0x3800,0x1800,0x1800,0x1800,0x1800,0x1800,0x3c00,0x0000,0x0000,0x0000,0x0000, // 0x69
+  0x0000,0x0000,0x0600,0x0600,0x0000,0x0e00,0x0600,0x0600,0x0600,0x0600,0x0600,0x0600,0x6600,0x6600,0x3c00,0x0000, // 0x6a
+  0x0000,0x0000,0xe000,0x6000,0x6000,0x6600,0x6c00,0x7800,0x7800,0x6c00,0x6600,0xe600,0x0000,0x0000,0x0000,0x0000, // 0x6b
+  0x0000,0x0000,0x3800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x3c00,0x0000,0x0000,0x0000,0x0000, // 0x6c
+  0x0000,0x0000,0x0000,0x0000,0x0000,0xec00,0xfe00,0xd600,0xd600,0xd600,0xd600,0xc600,0x0000,0x0000,0x0000,0x0000, // 0x6d
+  0x0000,0x0000,0x0000,0x0000,0x0000,0xdc00,0x6600,0x6600,0x6600,0x6600,0x6600,0x6600,0x0000,0x0000,0x0000,0x0000, // 0x6e
+  0x0000,0x0000,0x0000,0x0000,0x0000,0x7c00,0xc600,0xc600,0xc600,0xc600,0xc600,0x7c00,0x0000,0x0000,0x0000,0x0000, // 0x6f
+  0x0000,0x0000,0x0000,0x0000,0x0000,0xdc00,0x6600,0x6600,0x6600,0x6600,0x6600,0x7c00,0x6000,0x6000,0xf000,0x0000, // 0x70
+  0x0000,0x0000,0x0000,0x0000,0x0000,0x7600,0xcc00,0xcc00,0xcc00,0xcc00,0xcc00,0x7c00,0x0c00,0x0c00,0x1e00,0x0000, // 0x71
+  0x0000,0x0000,0x0000,0x0000,0x0000,0xdc00,0x7600,0x6600,0x6000,0x6000,0x6000,0xf000,0x0000,0x0000,0x0000,0x0000, // 0x72
+  0x0000,0x0000,0x0000,0x0000,0x0000,0x7c00,0xc600,0x6000,0x3800,0x0c00,0xc600,0x7c00,0x0000,0x0000,0x0000,0x0000, // 0x73
+  0x0000,0x0000,0x1000,0x3000,0x3000,0xfc00,0x3000,0x3000,0x3000,0x3000,0x3600,0x1c00,0x0000,0x0000,0x0000,0x0000, // 0x74
+  0x0000,0x0000,0x0000,0x0000,0x0000,0xcc00,0xcc00,0xcc00,0xcc00,0xcc00,0xcc00,0x7600,0x0000,0x0000,0x0000,0x0000, // 0x75
+  0x0000,0x0000,0x0000,0x0000,0x0000,0x6600,0x6600,0x6600,0x6600,0x6600,0x3c00,0x1800,0x0000,0x0000,0x0000,0x0000, // 0x76
+  0x0000,0x0000,0x0000,0x0000,0x0000,0xc600,0xc600,0xd600,0xd600,0xd600,0xfe00,0x6c00,0x0000,0x0000,0x0000,0x0000, // 0x77
+  0x0000,0x0000,0x0000,0x0000,0x0000,0xc600,0x6c00,0x3800,0x3800,0x3800,0x6c00,0xc600,0x0000,0x0000,0x0000,0x0000, // 0x78
+  0x0000,0x0000,0x0000,0x0000,0x0000,0xc600,0xc600,0xc600,0xc600,0xc600,0xc600,0x7e00,0x0600,0x0c00,0xf800,0x0000, // 0x79
+  0x0000,0x0000,0x0000,0x0000,0x0000,0xfe00,0xcc00,0x1800,0x3000,0x6000,0xc600,0xfe00,0x0000,0x0000,0x0000,0x0000, // 0x7a
+  0x0000,0x0000,0x0e00,0x1800,0x1800,0x1800,0x7000,0x1800,0x1800,0x1800,0x1800,0x0e00,0x0000,0x0000,0x0000,0x0000, // 0x7b
+  0x0000,0x0000,0x1800,0x1800,0x1800,0x1800,0x0000,0x1800,0x1800,0x1800,0x1800,0x1800,0x0000,0x0000,0x0000,0x0000, // 0x7c
+  0x0000,0x0000,0x7000,0x1800,0x1800,0x1800,0x0e00,0x1800,0x1800,0x1800,0x1800,0x7000,0x0000,0x0000,0x0000,0x0000, // 0x7d
+  0x0000,0x0000,0x7600,0xdc00,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000, // 0x7e
+  0x0000,0x0000,0x0000,0x0000,0x1000,0x3800,0x6c00,0xc600,0xc600,0xc600,0xfe00,0x0000,0x0000,0x0000,0x0000,0x0000, // 0x7f
+  0x0000,0x0000,0x3c00,0x6600,0xc200,0xc000,0xc000,0xc000,0xc200,0x6600,0x3c00,0x0c00,0x0600,0x7c00,0x0000,0x0000, // 0x80
+  0x0000,0x0000,0xcc00,0x0000,0x0000,0xcc00,0xcc00,0xcc00,0xcc00,0xcc00,0xcc00,0x7600,0x0000,0x0000,0x0000,0x0000, // 0x81
+  0x0000,0x0c00,0x1800,0x3000,0x0000,0x7c00,0xc600,0xfe00,0xc000,0xc000,0xc600,0x7c00,0x0000,0x0000,0x0000,0x0000, // 0x82
+  0x0000,0x1000,0x3800,0x6c00,0x0000,0x7800,0x0c00,0x7c00,0xcc00,0xcc00,0xcc00,0x7600,0x0000,0x0000,0x0000,0x0000, // 0x83
+  0x0000,0x0000,0xcc00,0x0000,0x0000,0x7800,0x0c00,0x7c00,0xcc00,0xcc00,0xcc00,0x7600,0x0000,0x0000,0x0000,0x0000, // 0x84
+  0x0000,0x6000,0x3000,0x1800,0x0000,0x7800,0x0c00,0x7c00,0xcc00,0xcc00,0xcc00,0x7600,0x0000,0x0000,0x0000,0x0000, // 0x85
+  0x0000,0x3800,0x6c00,0x3800,0x0000,0x7800,0x0c00,0x7c00,0xcc00,0xcc00,0xcc00,0x7600,0x0000,0x0000,0x0000,0x0000, // 0x86
+  0x0000,0x0000,0x0000,0x0000,0x3c00,0x6600,0x6000,0x6000,0x6600,0x3c00,0x0c00,0x0600,0x3c00,0x0000,0x0000,0x0000, // 0x87
+  0x0000,0x1000,0x3800,0x6c00,0x0000,0x7c00,0xc600,0xfe00,0xc000,0xc000,0xc600,0x7c00,0x0000,0x0000,0x0000,0x0000, // 0x88
+  0x0000,0x0000,0xc600,0x0000,0x0000,0x7c00,0xc600,0xfe00,0xc000,0xc000,0xc600,0x7c00,0x0000,0x0000,0x0000,0x0000, // 0x89
+  0x0000,0x6000,0x3000,0x1800,0x0000,0x7c00,0xc600,0xfe00,0xc000,0xc000,0xc600,0x7c00,0x0000,0x0000,0x0000,0x0000, // 0x8a
+  0x0000,0x0000,0x6600,0x0000,0x0000,0x3800,0x1800,0x1800,0x1800,0x1800,0x1800,0x3c00,0x0000,0x0000,0x0000,0x0000, // 0x8b
+  0x0000,0x1800,0x3c00,0x6600,0x0000,0x3800,0x1800,0x1800,0x1800,0x1800,0x1800,0x3c00,0x0000,0x0000,0x0000,0x0000, // 0x8c
+  0x0000,0x6000,0x3000,0x1800,0x0000,0x3800,0x1800,0x1800,0x1800,0x1800,0x1800,0x3c00,0x0000,0x0000,0x0000,0x0000, // 0x8d
+  0x0000,0xc600,0x0000,0x1000,0x3800,0x6c00,0xc600,0xc600,0xfe00,0xc600,0xc600,0xc600,0x0000,0x0000,0x0000,0x0000, // 0x8e
+  0x3800,0x6c00,0x3800,0x0000,0x3800,0x6c00,0xc600,0xc600,0xfe00,0xc600,0xc600,0xc600,0x0000,0x0000,0x0000,0x0000, // 0x8f
+  0x1800,0x3000,0x6000,0x0000,0xfe00,0x6600,0x6000,0x7c00,0x6000,0x6000,0x6600,0xfe00,0x0000,0x0000,0x0000,0x0000, // 0x90
+  0x0000,0x0000,0x0000,0x0000,0x0000,0xcc00,0x7600,0x3600,0x7e00,0xd800,0xd800,0x6e00,0x0000,0x0000,0x0000,0x0000, // 0x91
+  0x0000,0x0000,0x3e00,0x6c00,0xcc00,0xcc00,0xfe00,0xcc00,0xcc00,0xcc00,0xcc00,0xce00,0x0000,0x0000,0x0000,0x0000, // 0x92
+  0x0000,0x1000,0x3800,0x6c00,0x0000,0x7c00,0xc600,0xc600,0xc600,0xc600,0xc600,0x7c00,0x0000,0x0000,0x0000,0x0000, // 0x93
+  0x0000,0x0000,0xc600,0x0000,0x0000,0x7c00,0xc600,0xc600,0xc600,0xc600,0xc600,0x7c00,0x0000,0x0000,0x0000,0x0000, // 0x94
+  0x0000,0x6000,0x3000,0x1800,0x0000,0x7c00,0xc600,0xc600,0xc600,0xc600,0xc600,0x7c00,0x0000,0x0000,0x0000,0x0000, // 0x95
+  0x0000,0x3000,0x7800,0xcc00,0x0000,0xcc00,0xcc00,0xcc00,0xcc00,0xcc00,0xcc00,0x7600,0x0000,0x0000,0x0000,0x0000, // 0x96
+  0x0000,0x6000,0x3000,0x1800,0x0000,0xcc00,0xcc00,0xcc00,0xcc00,0xcc00,0xcc00,0x7600,0x0000,0x0000,0x0000,0x0000, // 0x97
+  0x0000,0x0000,0xc600,0x0000,0x0000,0xc600,0xc600,0xc600,0xc600,0xc600,0xc600,0x7e00,0x0600,0x0c00,0x7800,0x0000, // 0x98
+  0x0000,0xc600,0x0000,0x7c00,0xc600,0xc600,0xc600,0xc600,0xc600,0xc600,0xc600,0x7c00,0x0000,0x0000,0x0000,0x0000, // 0x99
+  0x0000,0xc600,0x0000,0xc600,0xc600,0xc600,0xc600,0xc600,0xc600,0xc600,0xc600,0x7c00,0x0000,0x0000,0x0000,0x0000, // 0x9a
+  0x0000,0x1800,0x1800,0x3c00,0x6600,0x6000,0x6000,0x6000,0x6600,0x3c00,0x1800,0x1800,0x0000,0x0000,0x0000,0x0000, // 0x9b
+  0x0000,0x3800,0x6c00,0x6400,0x6000,0xf000,0x6000,0x6000,0x6000,0x6000,0xe600,0xfc00,0x0000,0x0000,0x0000,0x0000, // 0x9c
+  0x0000,0x0000,0x6600,0x6600,0x3c00,0x1800,0x7e00,0x1800,0x7e00,0x1800,0x1800,0x1800,0x0000,0x0000,0x0000,0x0000, // 0x9d
+  0x0000,0xf800,0xcc00,0xcc00,0xf800,0xc400,0xcc00,0xde00,0xcc00,0xcc00,0xcc00,0xc600,0x0000,0x0000,0x0000,0x0000, // 0x9e
+  0x0000,0x0e00,0x1b00,0x1800,0x1800,0x1800,0x7e00,0x1800,0x1800,0x1800,0x1800,0x1800,0xd800,0x7000,0x0000,0x0000, // 0x9f
+  0x0000,0x1800,0x3000,0x6000,0x0000,0x7800,0x0c00,0x7c00,0xcc00,0xcc00,0xcc00,0x7600,0x0000,0x0000,0x0000,0x0000, // 0xa0
+  0x0000,0x0c00,0x1800,0x3000,0x0000,0x3800,0x1800,0x1800,0x1800,0x1800,0x1800,0x3c00,0x0000,0x0000,0x0000,0x0000, // 0xa1
+  0x0000,0x1800,0x3000,0x6000,0x0000,0x7c00,0xc600,0xc600,0xc600,0xc600,0xc600,0x7c00,0x0000,0x0000,0x0000,0x0000, // 0xa2
+  0x0000,0x1800,0x3000,0x6000,0x0000,0xcc00,0xcc00,0xcc00,0xcc00,0xcc00,0xcc00,0x7600,0x0000,0x0000,0x0000,0x0000, // 0xa3
+  0x0000,0x0000,0x7600,0xdc00,0x0000,0xdc00,0x6600,0x6600,0x6600,0x6600,0x6600,0x6600,0x0000,0x0000,0x0000,0x0000, // 0xa4
+  0x7600,0xdc00,0x0000,0xc600,0xe600,0xf600,0xfe00,0xde00,0xce00,0xc600,0xc600,0xc600,0x0000,0x0000,0x0000,0x0000, // 0xa5
+  0x0000,0x3c00,0x6c00,0x6c00,0x3e00,0x0000,0x7e00,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000, // 0xa6
+  0x0000,0x3800,0x6c00,0x6c00,0x3800,0x0000,0x7c00,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000, // 0xa7
+  0x0000,0x0000,0x3000,0x3000,0x0000,0x3000,0x3000,0x6000,0xc000,0xc600,0xc600,0x7c00,0x0000,0x0000,0x0000,0x0000, // 0xa8
+  0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0xfe00,0xc000,0xc000,0xc000,0xc000,0x0000,0x0000,0x0000,0x0000,0x0000, // 0xa9
+  0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0xfe00,0x0600,0x0600,0x0600,0x0600,0x0000,0x0000,0x0000,0x0000,0x0000, // 0xaa
+  0x0000,0xc000,0xc000,0xc200,0xc600,0xcc00,0x1800,0x3000,0x6000,0xdc00,0x8600,0x0c00,0x1800,0x3e00,0x0000,0x0000, // 0xab
+  0x0000,0xc000,0xc000,0xc200,0xc600,0xcc00,0x1800,0x3000,0x6600,0xce00,0x9e00,0x3e00,0x0600,0x0600,0x0000,0x0000, // 0xac
+  0x0000,0x0000,0x1800,0x1800,0x0000,0x1800,0x1800,0x1800,0x3c00,0x3c00,0x3c00,0x1800,0x0000,0x0000,0x0000,0x0000, // 0xad
+  0x0000,0x0000,0x0000,0x0000,0x0000,0x3600,0x6c00,0xd800,0x6c00,0x3600,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000, // 0xae
+  0x0000,0x0000,0x0000,0x0000,0x0000,0xd800,0x6c00,0x3600,0x6c00,0xd800,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000, // 0xaf
+  0x1100,0x4400,0x1100,0x4400,0x1100,0x4400,0x1100,0x4400,0x1100,0x4400,0x1100,0x4400,0x1100,0x4400,0x1100,0x4400, // 0xb0
+  0x5500,0xaa00,0x5500,0xaa00,0x5500,0xaa00,0x5500,0xaa00,0x5500,0xaa00,0x5500,0xaa00,0x5500,0xaa00,0x5500,0xaa00, // 0xb1
+  0xdd00,0x7700,0xdd00,0x7700,0xdd00,0x7700,0xdd00,0x7700,0xdd00,0x7700,0xdd00,0x7700,0xdd00,0x7700,0xdd00,0x7700, // 0xb2
+  0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800, // 0xb3
+  0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0xf800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800, // 0xb4
+  0x1800,0x1800,0x1800,0x1800,0x1800,0xf800,0x1800,0xf800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800, // 0xb5
+  0x3600,0x3600,0x3600,0x3600,0x3600,0x3600,0x3600,0xf600,0x3600,0x3600,0x3600,0x3600,0x3600,0x3600,0x3600,0x3600, // 0xb6
+  0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0xfe00,0x3600,0x3600,0x3600,0x3600,0x3600,0x3600,0x3600,0x3600, // 0xb7
+  0x0000,0x0000,0x0000,0x0000,0x0000,0xf800,0x1800,0xf800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800, // 0xb8
+  0x3600,0x3600,0x3600,0x3600,0x3600,0xf600,0x0600,0xf600,0x3600,0x3600,0x3600,0x3600,0x3600,0x3600,0x3600,0x3600, // 0xb9
+  0x3600,0x3600,0x3600,0x3600,0x3600,0x3600,0x3600,0x3600,0x3600,0x3600,0x3600,0x3600,0x3600,0x3600,0x3600,0x3600, // 0xba
+  0x0000,0x0000,0x0000,0x0000,0x0000,0xfe00,0x0600,0xf600,0x3600,0x3600,0x3600,0x3600,0x3600,0x3600,0x3600,0x3600, // 0xbb
+  0x3600,0x3600,0x3600,0x3600,0x3600,0xf600,0x0600,0xfe00,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000, // 0xbc
+  0x3600,0x3600,0x3600,0x3600,0x3600,0x3600,0x3600,0xfe00,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000, // 0xbd
+  0x1800,0x1800,0x1800,0x1800,0x1800,0xf800,0x1800,0xf800,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000, // 0xbe
+  0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0xf800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800, // 0xbf
+  0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1f00,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000, // 0xc0
+  0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0xff00,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000, // 0xc1
+  0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0xff00,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800, // 0xc2
+  0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1f00,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800, // 0xc3
+  0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0xff00,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000, // 0xc4
+  0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0xff00,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800, // 0xc5
+  0x1800,0x1800,0x1800,0x1800,0x1800,0x1f00,0x1800,0x1f00,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800, // 0xc6
+  0x3600,0x3600,0x3600,0x3600,0x3600,0x3600,0x3600,0x3700,0x3600,0x3600,0x3600,0x3600,0x3600,0x3600,0x3600,0x3600, // 0xc7
+  0x3600,0x3600,0x3600,0x3600,0x3600,0x3700,0x3000,0x3f00,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000, // 0xc8
+  0x0000,0x0000,0x0000,0x0000,0x0000,0x3f00,0x3000,0x3700,0x3600,0x3600,0x3600,0x3600,0x3600,0x3600,0x3600,0x3600, // 0xc9
+  0x3600,0x3600,0x3600,0x3600,0x3600,0xf700,0x0000,0xff00,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000, // 0xca
+  0x0000,0x0000,0x0000,0x0000,0x0000,0xff00,0x0000,0xf700,0x3600,0x3600,0x3600,0x3600,0x3600,0x3600,0x3600,0x3600, // 0xcb
+  0x3600,0x3600,0x3600,0x3600,0x3600,0x3700,0x3000,0x3700,0x3600,0x3600,0x3600,0x3600,0x3600,0x3600,0x3600,0x3600, // 0xcc
+  0x0000,0x0000,0x0000,0x0000,0x0000,0xff00,0x0000,0xff00,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000, // 0xcd
+  0x3600,0x3600,0x3600,0x3600,0x3600,0xf700,0x0000,0xf700,0x3600,0x3600,0x3600,0x3600,0x3600,0x3600,0x3600,0x3600, // 0xce
+  0x1800,0x1800,0x1800,0x1800,0x1800,0xff00,0x0000,0xff00,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000, // 0xcf
+  0x3600,0x3600,0x3600,0x3600,0x3600,0x3600,0x3600,0xff00,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000, // 0xd0
+  0x0000,0x0000,0x0000,0x0000,0x0000,0xff00,0x0000,0xff00,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800, // 0xd1
+  0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0xff00,0x3600,0x3600,0x3600,0x3600,0x3600,0x3600,0x3600,0x3600, // 0xd2
+  0x3600,0x3600,0x3600,0x3600,0x3600,0x3600,0x3600,0x3f00,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000, // 0xd3
+  0x1800,0x1800,0x1800,0x1800,0x1800,0x1f00,0x1800,0x1f00,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000, // 0xd4
+  0x0000,0x0000,0x0000,0x0000,0x0000,0x1f00,0x1800,0x1f00,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800, // 0xd5
+  0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x3f00,0x3600,0x3600,0x3600,0x3600,0x3600,0x3600,0x3600,0x3600, // 0xd6
+  0x3600,0x3600,0x3600,0x3600,0x3600,0x3600,0x3600,0xff00,0x3600,0x3600,0x3600,0x3600,0x3600,0x3600,0x3600,0x3600, // 0xd7
+  0x1800,0x1800,0x1800,0x1800,0x1800,0xff00,0x1800,0xff00,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800, // 0xd8
+  0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0xf800,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000, // 0xd9
+  0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x1f00,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800, // 0xda
+  0xff00,0xff00,0xff00,0xff00,0xff00,0xff00,0xff00,0xff00,0xff00,0xff00,0xff00,0xff00,0xff00,0xff00,0xff00,0xff00, // 0xdb
+  0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0xff00,0xff00,0xff00,0xff00,0xff00,0xff00,0xff00,0xff00,0xff00, // 0xdc
+  0xf000,0xf000,0xf000,0xf000,0xf000,0xf000,0xf000,0xf000,0xf000,0xf000,0xf000,0xf000,0xf000,0xf000,0xf000,0xf000, // 0xdd
+  0x0f00,0x0f00,0x0f00,0x0f00,0x0f00,0x0f00,0x0f00,0x0f00,0x0f00,0x0f00,0x0f00,0x0f00,0x0f00,0x0f00,0x0f00,0x0f00, // 0xde
+  0xff00,0xff00,0xff00,0xff00,0xff00,0xff00,0xff00,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000, // 0xdf
+  0x0000,0x0000,0x0000,0x0000,0x0000,0x7600,0xdc00,0xd800,0xd800,0xd800,0xdc00,0x7600,0x0000,0x0000,0x0000,0x0000, // 0xe0
+  0x0000,0x0000,0x7800,0xcc00,0xcc00,0xcc00,0xd800,0xcc00,0xc600,0xc600,0xc600,0xcc00,0x0000,0x0000,0x0000,0x0000, // 0xe1
+  0x0000,0x0000,0xfe00,0xc600,0xc600,0xc000,0xc000,0xc000,0xc000,0xc000,0xc000,0xc000,0x0000,0x0000,0x0000,0x0000, // 0xe2
+  0x0000,0x0000,0x0000,0x0000,0xfe00,0x6c00,0x6c00,0x6c00,0x6c00,0x6c00,0x6c00,0x6c00,0x0000,0x0000,0x0000,0x0000, // 0xe3
+  0x0000,0x0000,0x0000,0xfe00,0xc600,0x6000,0x3000,0x1800,0x3000,0x6000,0xc600,0xfe00,0x0000,0x0000,0x0000,0x0000, // 0xe4
+  0x0000,0x0000,0x0000,0x0000,0x0000,0x7e00,0xd800,0xd800,0xd800,0xd800,0xd800,0x7000,0x0000,0x0000,0x0000,0x0000, // 0xe5
+  0x0000,0x0000,0x0000,0x0000,0x6600,0x6600,0x6600,0x6600,0x6600,0x7c00,0x6000,0x6000,0xc000,0x0000,0x0000,0x0000, // 0xe6
+  0x0000,0x0000,0x0000,0x0000,0x7600,0xdc00,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x0000,0x0000,0x0000,0x0000, // 0xe7
+  0x0000,0x0000,0x0000,0x7e00,0x1800,0x3c00,0x6600,0x6600,0x6600,0x3c00,0x1800,0x7e00,0x0000,0x0000,0x0000,0x0000, // 0xe8
+  0x0000,0x0000,0x0000,0x3800,0x6c00,0xc600,0xc600,0xfe00,0xc600,0xc600,0x6c00,0x3800,0x0000,0x0000,0x0000,0x0000, // 0xe9
+  0x0000,0x0000,0x3800,0x6c00,0xc600,0xc600,0xc600,0x6c00,0x6c00,0x6c00,0x6c00,0xee00,0x0000,0x0000,0x0000,0x0000, // 0xea
+  0x0000,0x0000,0x1e00,0x3000,0x1800,0x0c00,0x3e00,0x6600,0x6600,0x6600,0x6600,0x3c00,0x0000,0x0000,0x0000,0x0000, // 0xeb
+  0x0000,0x0000,0x0000,0x0000,0x0000,0x7e00,0xdb00,0xdb00,0xdb00,0x7e00,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000, // 0xec
+  0x0000,0x0000,0x0000,0x0300,0x0600,0x7e00,0xdb00,0xdb00,0xf300,0x7e00,0x6000,0xc000,0x0000,0x0000,0x0000,0x0000, // 0xed
+  0x0000,0x0000,0x1c00,0x3000,0x6000,0x6000,0x7c00,0x6000,0x6000,0x6000,0x3000,0x1c00,0x0000,0x0000,0x0000,0x0000, // 0xee
+  0x0000,0x0000,0x0000,0x7c00,0xc600,0xc600,0xc600,0xc600,0xc600,0xc600,0xc600,0xc600,0x0000,0x0000,0x0000,0x0000, // 0xef
+  0x0000,0x0000,0x0000,0x0000,0xfe00,0x0000,0x0000,0xfe00,0x0000,0x0000,0xfe00,0x0000,0x0000,0x0000,0x0000,0x0000, // 0xf0
+  0x0000,0x0000,0x0000,0x0000,0x1800,0x1800,0x7e00,0x1800,0x1800,0x0000,0x0000,0xff00,0x0000,0x0000,0x0000,0x0000, // 0xf1
+  0x0000,0x0000,0x0000,0x3000,0x1800,0x0c00,0x0600,0x0c00,0x1800,0x3000,0x0000,0x7e00,0x0000,0x0000,0x0000,0x0000, // 0xf2
+  0x0000,0x0000,0x0000,0x0c00,0x1800,0x3000,0x6000,0x3000,0x1800,0x0c00,0x0000,0x7e00,0x0000,0x0000,0x0000,0x0000, // 0xf3
+  0x0000,0x0000,0x0e00,0x1b00,0x1b00,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800, // 0xf4
+  0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0x1800,0xd800,0xd800,0xd800,0x7000,0x0000,0x0000,0x0000,0x0000, // 0xf5
+  0x0000,0x0000,0x0000,0x0000,0x1800,0x1800,0x0000,0x7e00,0x0000,0x1800,0x1800,0x0000,0x0000,0x0000,0x0000,0x0000, // 0xf6
+  0x0000,0x0000,0x0000,0x0000,0x0000,0x7600,0xdc00,0x0000,0x7600,0xdc00,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000, // 0xf7
+  0x0000,0x3800,0x6c00,0x6c00,0x3800,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000, // 0xf8
+  0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x1800,0x1800,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000, // 0xf9
+  0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x1800,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000, // 0xfa
+  0x0000,0x0f00,0x0c00,0x0c00,0x0c00,0x0c00,0x0c00,0xec00,0x6c00,0x6c00,0x3c00,0x1c00,0x0000,0x0000,0x0000,0x0000, // 0xfb
+  0x0000,0xd800,0x6c00,0x6c00,0x6c00,0x6c00,0x6c00,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000, // 0xfc
+  0x0000,0x7000,0xd800,0x3000,0x6000,0xc800,0xf800,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000, // 0xfd
+  0x0000,0x0000,0x0000,0x0000,0x7c00,0x7c00,0x7c00,0x7c00,0x7c00,0x7c00,0x7c00,0x0000,0x0000,0x0000,0x0000,0x0000, // 0xfe
+  0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000, // 0xff
+};
+
+static const VTermPackedFont VTermFont_Bm437_IBM_VGA_8x16 = { "Bm437_IBM_VGA_8x16", 8, 16, VTermFontBits_Bm437_IBM_VGA_8x16 };
@@ -1,340 +0,0 @@
-////////////////////////////////////////////////////////////////////////////////////////
-//                                                                                    //
-// FontAsCode exporter v1.0 - Font data exported as an array of bytes                 //
-//                                                                                    //
-// more info and bugs-report:  github.com/raysan5/raylib                              //
-// feedback and support:       ray[at]raylib.com                                      //
-//                                                                                    //
-// Copyright (c) 2018-2023 Ramon Santamaria (@raysan5)                                //
-//                                                                                    //
-// ---------------------------------------------------------------------------------- //
-//                                                                                    //
-// TODO: Fill the information and license of the exported font here:                  //
-//                                                                                    //
-// Font name:    ....                                                                 //
-// Font creator: ....                                                                 //
-// Font LICENSE: ....                                                                 //
-//                                                                                    //
-////////////////////////////////////////////////////////////////////////////////////////
-
-#define COMPRESSED_DATA_SIZE_FONT_PX437 1798
-
-// Font image pixels data compressed (DEFLATE)
-// NOTE: Original pixel data simplified to GRAYSCALE
-static unsigned char fontData_Px437[COMPRESSED_DATA_SIZE_FONT_PX437] = { 0xed,
-    0xdd, 0x5b, 0xae, 0x9c, 0x48, 0x10, 0x45, 0xd1, 0x9a, 0xff, 0xa4, 0xbb, 0x3f, 0x5a, 0x2d, 0x59, 0xd6, 0x95, 0x4d, 0x44,
-    0x9e, 0x48, 0xb2, 0x60, 0x79, 0x7d, 0xba, 0x5c, 0x0f, 0x60, 0x63, 0xde, 0xf9, 0xcf, 0x07, 0x00, 0x00, 0x00, 0xe0, 0x0f,
-    0xfe, 0xff, 0x73, 0xe5, 0xef, 0xae, 0xbe, 0xf6, 0x4f, 0xaf, 0xbb, 0xfa, 0xd9, 0x7f, 0xfa, 0xfb, 0x2b, 0xff, 0xe6, 0x6f,
-    0x9f, 0xbf, 0xf2, 0xd9, 0xd5, 0xf7, 0x4e, 0x7c, 0x9f, 0x2b, 0xdf, 0xe9, 0xa7, 0x3f, 0x9d, 0xcf, 0x49, 0x4f, 0xeb, 0xea,
-    0xef, 0xbb, 0xf2, 0xbe, 0x95, 0xd7, 0x56, 0x97, 0xf7, 0xee, 0xf7, 0xa8, 0x7c, 0xd7, 0xea, 0xf7, 0xd0, 0xbf, 0xfe, 0xf5,
-    0xaf, 0xff, 0x89, 0xf6, 0xaf, 0x2e, 0x2b, 0x27, 0xf4, 0x9f, 0xfa, 0x0e, 0x95, 0xf5, 0x5e, 0x62, 0x59, 0x4e, 0xf6, 0x31,
-    0xb5, 0xbe, 0xef, 0x4e, 0xa3, 0x64, 0x23, 0xdd, 0x75, 0x70, 0x75, 0x9e, 0x24, 0xa6, 0xef, 0xca, 0xbc, 0x4d, 0xff, 0x36,
-    0xfd, 0xeb, 0x5f, 0xff, 0xfa, 0xbf, 0xa3, 0xff, 0x5d, 0xdb, 0x37, 0x95, 0x65, 0x68, 0x72, 0xfb, 0xbe, 0x3b, 0x2d, 0x2a,
-    0xaf, 0x9f, 0xea, 0x7f, 0x62, 0xbf, 0xb0, 0x32, 0x3d, 0xee, 0x58, 0x57, 0x5d, 0xfd, 0x1e, 0xc9, 0xcf, 0x5b, 0x5d, 0x7e,
-    0xf4, 0xaf, 0x7f, 0xfd, 0xeb, 0xff, 0xce, 0xfe, 0x7f, 0x3f, 0xfe, 0x93, 0x68, 0x6f, 0x75, 0xdb, 0xad, 0xf2, 0x9b, 0x26,
-    0xb6, 0xfd, 0x93, 0xcb, 0x5b, 0x7a, 0x9f, 0x63, 0x47, 0xfb, 0xdd, 0x79, 0x38, 0xb5, 0x6d, 0x9d, 0xdc, 0x57, 0xd1, 0xbf,
-    0xfe, 0xf5, 0xaf, 0xff, 0xb7, 0xf4, 0x9f, 0x7c, 0xef, 0xd5, 0x69, 0x9c, 0x58, 0x76, 0x7e, 0xef, 0x6d, 0x72, 0x9b, 0x33,
-    0x75, 0xde, 0xf4, 0x8e, 0xbe, 0x93, 0xc7, 0x21, 0x13, 0xc7, 0x5b, 0x13, 0xf3, 0x3b, 0x79, 0x0e, 0xbb, 0xbb, 0x0f, 0x3b,
-    0xb5, 0xaf, 0x72, 0xd7, 0xf9, 0x7f, 0xfd, 0xeb, 0x5f, 0xff, 0xfa, 0xdf, 0xd1, 0x7f, 0xb2, 0xc7, 0x95, 0xe9, 0x96, 0x3c,
-    0x5f, 0xf7, 0xa4, 0x6b, 0x41, 0x77, 0xf5, 0x9f, 0x9e, 0x6f, 0x9d, 0x6b, 0x7a, 0x76, 0x9c, 0x83, 0x4c, 0xee, 0x5b, 0xe9,
-    0x5f, 0xff, 0xfa, 0xd7, 0xff, 0x5d, 0xfd, 0x4f, 0x9d, 0xff, 0x5b, 0xb9, 0x6e, 0x42, 0xff, 0x7b, 0xaf, 0x0b, 0x4a, 0x5e,
-    0x33, 0xb5, 0x6b, 0xdd, 0xb5, 0xbb, 0xff, 0xee, 0x34, 0xd0, 0xbf, 0xfe, 0xf5, 0xaf, 0xff, 0x6f, 0x59, 0x7e, 0x92, 0xd3,
-    0xb8, 0x3b, 0x3f, 0xf4, 0x5f, 0xff, 0xdd, 0x2b, 0xd3, 0x68, 0x75, 0xd9, 0x9f, 0x3a, 0x9f, 0xa6, 0x7f, 0xfd, 0xeb, 0x5f,
-    0xff, 0xfa, 0x3f, 0xe3, 0xf8, 0xdf, 0xae, 0xfb, 0x5a, 0x26, 0xb7, 0x25, 0x9f, 0x78, 0xec, 0x6f, 0x7a, 0x7e, 0x9f, 0x70,
-    0xff, 0xcf, 0xc4, 0x75, 0xcd, 0xfa, 0xd7, 0xbf, 0xfe, 0xf5, 0xff, 0xf6, 0xfe, 0x57, 0xb6, 0x33, 0xd3, 0xeb, 0xa0, 0x95,
-    0xeb, 0x7f, 0x52, 0xf7, 0x07, 0xbd, 0x69, 0x1d, 0xd0, 0x79, 0xf6, 0xc5, 0x1d, 0xf7, 0x90, 0xa5, 0xdf, 0xb7, 0xfa, 0x1d,
-    0xba, 0xdf, 0xf3, 0x1b, 0xae, 0xff, 0xd1, 0xbf, 0xfe, 0xf5, 0xff, 0x7d, 0xfd, 0x9f, 0x70, 0x9e, 0x49, 0x53, 0xf0, 0xde,
-    0xe7, 0x8d, 0xea, 0x1f, 0xde, 0xb9, 0xdd, 0xa8, 0x7d, 0xd0, 0xbf, 0xa9, 0x02, 0xf6, 0x05, 0x00, 0xfd, 0x03, 0xfa, 0x07,
-    0xf4, 0x0f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x4f, 0xba, 0xa7, 0xa6, 0x33, 0xb6,
-    0x56, 0xf5, 0xbe, 0x9c, 0xea, 0xb3, 0x1c, 0x57, 0xee, 0xff, 0x99, 0x7c, 0x2e, 0xe3, 0xe7, 0xc2, 0xf8, 0x17, 0x9d, 0x31,
-    0x24, 0x77, 0x3c, 0x6f, 0x32, 0x39, 0xee, 0xe5, 0xd4, 0x98, 0x6c, 0x89, 0x69, 0xf5, 0xd3, 0xdf, 0x25, 0x3f, 0xb7, 0xf2,
-    0x7b, 0xaa, 0x1d, 0x4d, 0x8e, 0x25, 0xae, 0x7f, 0xfd, 0xeb, 0x5f, 0xff, 0x89, 0xdf, 0x52, 0xe9, 0x72, 0x62, 0xdc, 0x90,
-    0x3b, 0xe6, 0xd1, 0xa7, 0x30, 0x5e, 0x78, 0x65, 0x8c, 0x91, 0xee, 0x6b, 0xab, 0x63, 0x48, 0x4c, 0x7c, 0x87, 0x89, 0x06,
-    0x12, 0xcb, 0xc2, 0xca, 0xef, 0xb9, 0x3a, 0xef, 0xd3, 0xeb, 0xa0, 0xee, 0x74, 0xea, 0xf4, 0xa5, 0x7f, 0xfd, 0xeb, 0x5f,
-    0xff, 0xd3, 0xcf, 0xd8, 0x48, 0xbf, 0xe7, 0x9d, 0x63, 0x43, 0x4d, 0xb4, 0x57, 0x19, 0xcf, 0x34, 0xb1, 0x5c, 0xaf, 0xbe,
-    0x76, 0x75, 0xfc, 0xd5, 0xa7, 0xf4, 0x5f, 0xdd, 0xa7, 0xd2, 0xbf, 0xfe, 0xf5, 0xaf, 0xff, 0x37, 0xf5, 0xdf, 0x39, 0x96,
-    0x93, 0xde, 0x9f, 0xa8, 0xf6, 0xbc, 0x7b, 0x1e, 0xad, 0x8e, 0x7f, 0x5a, 0xf9, 0x7d, 0x57, 0xdf, 0x37, 0x35, 0x9e, 0xe9,
-    0x29, 0xfd, 0xa7, 0xc6, 0x68, 0x9d, 0x3a, 0xa6, 0xaa, 0x7f, 0xfd, 0xeb, 0x5f, 0xff, 0x3b, 0xfb, 0x4f, 0x9f, 0x4b, 0x9c,
-    0xde, 0xee, 0x9f, 0x38, 0xee, 0xb8, 0xa3, 0xff, 0x95, 0x73, 0xab, 0xa9, 0xfe, 0x53, 0xe7, 0x1f, 0x13, 0xe7, 0x61, 0x77,
-    0xf7, 0x3f, 0x31, 0xd6, 0xe6, 0xaf, 0xeb, 0xc8, 0x2b, 0xcb, 0xcb, 0x5d, 0xcb, 0x96, 0xfe, 0xf5, 0xaf, 0x7f, 0xfd, 0xaf,
-    0x36, 0x35, 0x7d, 0x6d, 0xd0, 0xd4, 0xba, 0x65, 0xa2, 0xff, 0xee, 0xb2, 0xfc, 0xc4, 0xed, 0xff, 0xe9, 0xed, 0xda, 0x93,
-    0xfb, 0xaf, 0xce, 0xd7, 0xbb, 0xa6, 0x93, 0xfe, 0xf5, 0xaf, 0x7f, 0xfd, 0xdf, 0xd1, 0xff, 0x5d, 0xc7, 0x14, 0x57, 0xfb,
-    0x9f, 0x38, 0x96, 0x75, 0x77, 0xff, 0x93, 0xeb, 0xd4, 0x1d, 0xcb, 0x75, 0xf5, 0x98, 0xd7, 0xe4, 0xf1, 0xbf, 0xf4, 0x6f,
-    0xd7, 0xbf, 0xfe, 0xf5, 0xaf, 0xff, 0x6f, 0xd9, 0xae, 0x4e, 0x6f, 0x87, 0x9f, 0x7a, 0x2d, 0xd1, 0x9d, 0xfd, 0x9f, 0x70,
-    0xfd, 0xcf, 0x53, 0xfa, 0x4f, 0x4d, 0x27, 0xfd, 0xeb, 0x5f, 0xff, 0xfa, 0x7f, 0x62, 0xff, 0x27, 0x9c, 0xaf, 0x4b, 0xff,
-    0xfb, 0xee, 0xf5, 0x47, 0x3b, 0xfb, 0x3f, 0xf5, 0xfe, 0x9f, 0xc4, 0x3e, 0xc8, 0xb7, 0xf6, 0xbf, 0xbb, 0x69, 0xfd, 0xeb,
-    0x5f, 0xff, 0xfa, 0xdf, 0xdd, 0xff, 0xc4, 0x35, 0x04, 0x27, 0x3e, 0xdf, 0x68, 0xea, 0xbd, 0x56, 0x9f, 0x69, 0x72, 0xea,
-    0xf3, 0x3f, 0xaa, 0xcb, 0x4e, 0x72, 0x7b, 0x39, 0x71, 0x3d, 0xd3, 0xca, 0xf3, 0x3f, 0x52, 0xe7, 0xe9, 0x76, 0x3d, 0xff,
-    0x43, 0xff, 0xfa, 0xd7, 0xbf, 0xfe, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x33, 0x75, 0x9f, 0x39, 0xd8, 0x79, 0xf6, 0xe4, 0xca, 0xfb, 0x9e, 0xf0, 0xdc, 0xe5,
-    0xc4, 0xd8, 0x8f, 0x57, 0x7f, 0x7f, 0xe7, 0xf9, 0x98, 0x9d, 0x71, 0x5b, 0xae, 0x3e, 0x97, 0xb4, 0xba, 0x0c, 0x55, 0xe7,
-    0x65, 0xe7, 0xbb, 0xad, 0x3c, 0xaf, 0xb4, 0x3a, 0xd6, 0x49, 0x62, 0x59, 0xef, 0xbe, 0xe7, 0xd5, 0xe5, 0x47, 0xff, 0xfa,
-    0xd7, 0xbf, 0xfe, 0xab, 0xcb, 0xc0, 0xd5, 0x79, 0x33, 0x39, 0x46, 0xc2, 0xdb, 0xfb, 0xef, 0x7e, 0x7e, 0xe5, 0xef, 0x3b,
-    0xff, 0x66, 0xe2, 0x39, 0xd3, 0x53, 0xe3, 0xb7, 0x26, 0x97, 0xf5, 0x6e, 0x13, 0x9f, 0xc0, 0xd8, 0x2d, 0xab, 0xe3, 0x9c,
-    0xe8, 0x5f, 0xff, 0xfa, 0xd7, 0xff, 0xb7, 0xf4, 0xff, 0xd3, 0x74, 0x39, 0xb1, 0xe9, 0x4f, 0x61, 0xec, 0xad, 0xca, 0xb4,
-    0xba, 0x3a, 0x3f, 0x27, 0x5a, 0x4d, 0x8d, 0x33, 0x96, 0x5c, 0x07, 0x74, 0xf6, 0x33, 0x93, 0xeb, 0x9c, 0xd5, 0xef, 0x5a,
-    0x5d, 0x2e, 0xf4, 0xaf, 0x7f, 0xfd, 0xeb, 0xff, 0x29, 0xfd, 0x7f, 0x06, 0xc6, 0x11, 0x3f, 0xad, 0xff, 0xce, 0x7c, 0x9e,
-    0xd8, 0xd6, 0x4c, 0x1d, 0x13, 0x4b, 0x6e, 0x2f, 0x27, 0xd7, 0x0b, 0xe9, 0x63, 0x85, 0x2b, 0xc7, 0xc6, 0x77, 0x2c, 0xe7,
-    0xab, 0xfd, 0x9f, 0x30, 0x9e, 0xbd, 0xfe, 0xf5, 0xaf, 0xff, 0xe7, 0xf6, 0x9f, 0x3c, 0xcf, 0x71, 0x52, 0xff, 0xd5, 0x31,
-    0xb5, 0x13, 0xe3, 0x79, 0x4e, 0x1e, 0xeb, 0x9a, 0xde, 0x2e, 0x3e, 0xa9, 0xff, 0xc9, 0xff, 0x8f, 0xd2, 0x63, 0xa6, 0x27,
-    0xc7, 0x2d, 0xaf, 0x9c, 0x2b, 0xd4, 0xbf, 0xfe, 0xf5, 0xaf, 0xff, 0xe9, 0x63, 0x5f, 0x89, 0x6d, 0x9e, 0x27, 0xf4, 0x9f,
-    0x3e, 0x3e, 0xb5, 0x32, 0x36, 0xf7, 0x1b, 0xfa, 0xdf, 0x7d, 0xee, 0x36, 0xb1, 0x0f, 0xbd, 0x73, 0x1a, 0xe8, 0x5f, 0xff,
-    0xfa, 0xd7, 0xff, 0x8e, 0xe3, 0x7f, 0xe9, 0x6d, 0xdb, 0x53, 0xfa, 0xef, 0xee, 0x03, 0xed, 0x5a, 0x47, 0x74, 0xaf, 0x33,
-    0x3d, 0xf5, 0x9e, 0x94, 0x89, 0x63, 0xd2, 0xe9, 0x63, 0xb7, 0x93, 0xe7, 0x2b, 0x27, 0xf6, 0x17, 0xf4, 0xaf, 0x7f, 0xfd,
-    0xeb, 0xbf, 0xbb, 0xec, 0x4f, 0x9c, 0x3b, 0x4a, 0xf6, 0xdf, 0x39, 0x7e, 0xd3, 0x59, 0x36, 0xa6, 0xf6, 0x6b, 0xaa, 0xd7,
-    0x05, 0xed, 0x38, 0xa6, 0x78, 0xfa, 0xfd, 0xab, 0xc9, 0xdf, 0x33, 0xf1, 0x9e, 0x3b, 0xe7, 0xa1, 0xfe, 0xf5, 0xaf, 0x7f,
-    0xfd, 0x77, 0xce, 0x71, 0x3c, 0xa5, 0xff, 0xd5, 0xfb, 0x2c, 0x4f, 0xfc, 0x5d, 0x2b, 0xd7, 0x79, 0xea, 0xff, 0x7b, 0xfa,
-    0xbf, 0xe3, 0xf8, 0x9f, 0xfe, 0xf5, 0xaf, 0xff, 0x77, 0xf5, 0xdf, 0x7d, 0x4e, 0xc7, 0xd4, 0x3d, 0x1c, 0xe9, 0xe7, 0x2c,
-    0x5c, 0x7d, 0x26, 0xc6, 0xca, 0xb5, 0x1e, 0x95, 0x69, 0xb0, 0xba, 0xff, 0x51, 0xfd, 0xed, 0xc9, 0x6b, 0x93, 0xbe, 0xfd,
-    0xf9, 0x55, 0x93, 0xc7, 0x20, 0xa7, 0x9e, 0xb9, 0xd2, 0x7d, 0x06, 0x8a, 0xfe, 0xf5, 0xaf, 0x7f, 0xfd, 0xef, 0x38, 0x36,
-    0x01, 0x3c, 0xeb, 0x59, 0xa0, 0xa6, 0x04, 0xbc, 0xfb, 0x59, 0xc0, 0xa6, 0x06, 0xe8, 0x1f, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x98, 0x93, 0x18, 0xc3, 0xab, 0x33, 0x1e, 0xe6, 0xd5,
-    0xe7, 0x8c, 0x56, 0xc7, 0xe2, 0x48, 0x3c, 0x3f, 0x74, 0xe5, 0x7d, 0x3f, 0x85, 0xb1, 0xc6, 0xee, 0x78, 0xde, 0xe9, 0xca,
-    0xd8, 0x96, 0x13, 0x63, 0x6b, 0xa6, 0x5f, 0x9b, 0x1c, 0xa3, 0x7e, 0x62, 0x79, 0x3f, 0x7d, 0xbc, 0x55, 0xfd, 0xeb, 0x5f,
-    0xff, 0xfa, 0xaf, 0xbe, 0x36, 0xfd, 0x3e, 0xe9, 0xb1, 0x1a, 0xa7, 0xc6, 0x3a, 0x5d, 0x19, 0x2b, 0xf2, 0xb3, 0x79, 0x0c,
-    0x95, 0x13, 0xfa, 0xff, 0x0c, 0x3d, 0x6f, 0xbd, 0xf3, 0x0c, 0xec, 0x89, 0xb1, 0x5b, 0x56, 0xd6, 0xf7, 0xfa, 0xd7, 0xbf,
-    0xfe, 0xf5, 0xff, 0xd6, 0xe3, 0x08, 0x9f, 0x83, 0xc6, 0x24, 0x9d, 0xee, 0x3f, 0xbd, 0x4e, 0x3d, 0xa5, 0xff, 0xab, 0xdb,
-    0xb9, 0xdd, 0xb1, 0xb2, 0x77, 0x8e, 0xa7, 0xfe, 0xf4, 0xb1, 0x53, 0xf5, 0xaf, 0x7f, 0xfd, 0xbf, 0xb7, 0xff, 0x89, 0xe3,
-    0x76, 0xab, 0xcb, 0xf5, 0xdb, 0xfa, 0x4f, 0xcc, 0xa3, 0x89, 0xfd, 0xa5, 0x6f, 0xed, 0x3f, 0xf5, 0xff, 0x90, 0xfe, 0xf5,
-    0xaf, 0x7f, 0xfd, 0x3f, 0x7d, 0xfb, 0x7f, 0x6a, 0xbb, 0xbd, 0x3b, 0xdd, 0xf4, 0x9f, 0xdb, 0xb6, 0x7f, 0x5b, 0xff, 0xa9,
-    0xff, 0xcb, 0xa6, 0xfe, 0x0f, 0xd5, 0xbf, 0xfe, 0xf5, 0xaf, 0xff, 0x27, 0xf7, 0xbf, 0xba, 0x9c, 0xea, 0xff, 0x9c, 0xf3,
-    0x7f, 0x9f, 0x81, 0x31, 0xcc, 0x77, 0x9d, 0xff, 0xdb, 0x7d, 0x7e, 0xcf, 0xf6, 0xbf, 0xfe, 0xf5, 0xaf, 0x7f, 0xfd, 0xe7,
-    0xfa, 0x4f, 0x76, 0x5a, 0xbd, 0x9e, 0x76, 0xe2, 0xb5, 0x9d, 0x6b, 0x79, 0x53, 0xd3, 0x75, 0xe5, 0x9a, 0xd4, 0xea, 0x67,
-    0x4f, 0xcc, 0xdf, 0xbf, 0x4d, 0x87, 0xce, 0xf5, 0xbf, 0xfa, 0xd7, 0xbf, 0xfe, 0xf5, 0xaf, 0xff, 0x73, 0x8e, 0xff, 0x7d,
-    0xe3, 0x74, 0x39, 0xe5, 0xb7, 0xbd, 0xe1, 0x7a, 0xb4, 0xe4, 0x6f, 0xd4, 0xbf, 0xfe, 0xf5, 0xaf, 0x7f, 0xfd, 0xe7, 0xef,
-    0xff, 0x49, 0x5e, 0xd7, 0xaa, 0xff, 0xfa, 0x67, 0x3f, 0x71, 0x5d, 0x90, 0xfe, 0x4d, 0xfa, 0xd7, 0xbf, 0xfe, 0xf5, 0xef,
-    0xfa, 0xdf, 0xb5, 0xfb, 0x25, 0x7e, 0x7a, 0x8f, 0xab, 0xc7, 0x69, 0x9e, 0x30, 0x5d, 0x4e, 0xfa, 0x6d, 0x4f, 0xba, 0xcf,
-    0xb4, 0xf3, 0xfc, 0x93, 0xe4, 0xf4, 0x4a, 0x3c, 0xff, 0x43, 0xff, 0xfa, 0xd7, 0xbf, 0xfe, 0x9f, 0xb0, 0xbd, 0xe5, 0x7e,
-    0x67, 0x78, 0xef, 0x3d, 0xfd, 0xfa, 0x07, 0xfd, 0x9b, 0x32, 0xa0, 0x7f, 0xe0, 0x1d, 0xeb, 0x00, 0xed, 0x83, 0xfe, 0x4d,
-    0x11, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0xe0, 0x5e, 0xff, 0xfd, 0x31, 0x1d, 0x40, 0xff, 0xc0, 0xeb, 0xfa, 0xff, 0x17 };
-
-// Font characters rectangles data
-static const Rectangle fontRecs_Px437[95] = {
-    { 4, 4, 16 , 32 },
-    { 28, 4, 8 , 20 },
-    { 44, 4, 12 , 8 },
-    { 64, 4, 14 , 18 },
-    { 86, 4, 14 , 28 },
-    { 108, 4, 14 , 16 },
-    { 130, 4, 14 , 20 },
-    { 152, 4, 6 , 8 },
-    { 166, 4, 8 , 20 },
-    { 182, 4, 8 , 20 },
-    { 198, 4, 16 , 10 },
-    { 222, 4, 12 , 10 },
-    { 242, 4, 6 , 8 },
-    { 256, 4, 14 , 2 },
-    { 278, 4, 4 , 4 },
-    { 290, 4, 14 , 16 },
-    { 312, 4, 14 , 20 },
-    { 334, 4, 12 , 20 },
-    { 354, 4, 14 , 20 },
-    { 376, 4, 14 , 20 },
-    { 398, 4, 14 , 20 },
-    { 420, 4, 14 , 20 },
-    { 442, 4, 14 , 20 },
-    { 464, 4, 14 , 20 },
-    { 486, 4, 14 , 20 },
-    { 4, 44, 14 , 20 },
-    { 26, 44, 4 , 14 },
-    { 38, 44, 6 , 16 },
-    { 52, 44, 12 , 18 },
-    { 72, 44, 12 , 8 },
-    { 92, 44, 12 , 18 },
-    { 112, 44, 14 , 20 },
-    { 134, 44, 14 , 18 },
-    { 156, 44, 14 , 20 },
-    { 178, 44, 14 , 20 },
-    { 200, 44, 14 , 20 },
-    { 222, 44, 14 , 20 },
-    { 244, 44, 14 , 20 },
-    { 266, 44, 14 , 20 },
-    { 288, 44, 14 , 20 },
-    { 310, 44, 14 , 20 },
-    { 332, 44, 8 , 20 },
-    { 348, 44, 14 , 20 },
-    { 370, 44, 14 , 20 },
-    { 392, 44, 14 , 20 },
-    { 414, 44, 14 , 20 },
-    { 436, 44, 14 , 20 },
-    { 458, 44, 14 , 20 },
-    { 480, 44, 14 , 20 },
-    { 4, 84, 14 , 24 },
-    { 26, 84, 14 , 20 },
-    { 48, 84, 14 , 20 },
-    { 70, 84, 12 , 20 },
-    { 90, 84, 14 , 20 },
-    { 112, 84, 14 , 20 },
-    { 134, 84, 14 , 20 },
-    { 156, 84, 14 , 20 },
-    { 178, 84, 12 , 20 },
-    { 198, 84, 14 , 20 },
-    { 220, 84, 8 , 20 },
-    { 236, 84, 14 , 18 },
-    { 258, 84, 8 , 20 },
-    { 274, 84, 14 , 8 },
-    { 296, 84, 16 , 2 },
-    { 320, 84, 6 , 6 },
-    { 334, 84, 14 , 14 },
-    { 356, 84, 14 , 20 },
-    { 378, 84, 14 , 14 },
-    { 400, 84, 14 , 20 },
-    { 422, 84, 14 , 14 },
-    { 444, 84, 12 , 20 },
-    { 464, 84, 14 , 20 },
-    { 486, 84, 14 , 20 },
-    { 4, 124, 8 , 20 },
-    { 20, 124, 12 , 26 },
-    { 40, 124, 14 , 20 },
-    { 62, 124, 8 , 20 },
-    { 78, 124, 14 , 14 },
-    { 100, 124, 14 , 14 },
-    { 122, 124, 14 , 14 },
-    { 144, 124, 14 , 20 },
-    { 166, 124, 14 , 20 },
-    { 188, 124, 14 , 14 },
-    { 210, 124, 14 , 14 },
-    { 232, 124, 14 , 20 },
-    { 254, 124, 14 , 14 },
-    { 276, 124, 12 , 14 },
-    { 296, 124, 14 , 14 },
-    { 318, 124, 14 , 14 },
-    { 340, 124, 14 , 20 },
-    { 362, 124, 14 , 14 },
-    { 384, 124, 12 , 20 },
-    { 404, 124, 4 , 20 },
-    { 416, 124, 12 , 20 },
-    { 436, 124, 14 , 4 },
-};
-
-// Font glyphs info data
-// NOTE: No glyphs.image data provided
-static const GlyphInfo fontGlyphs_Px437[95] = {
-    { 32, 0, 24, 16, { 0 }},
-    { 33, 4, 4, 16, { 0 }},
-    { 34, 2, 2, 16, { 0 }},
-    { 35, 0, 6, 16, { 0 }},
-    { 36, 0, 0, 16, { 0 }},
-    { 37, 0, 8, 16, { 0 }},
-    { 38, 0, 4, 16, { 0 }},
-    { 39, 2, 2, 16, { 0 }},
-    { 40, 4, 4, 16, { 0 }},
-    { 41, 4, 4, 16, { 0 }},
-    { 42, 0, 10, 16, { 0 }},
-    { 43, 2, 10, 16, { 0 }},
-    { 44, 4, 18, 16, { 0 }},
-    { 45, 0, 14, 16, { 0 }},
-    { 46, 6, 20, 16, { 0 }},
-    { 47, 0, 8, 16, { 0 }},
-    { 48, 0, 4, 16, { 0 }},
-    { 49, 2, 4, 16, { 0 }},
-    { 50, 0, 4, 16, { 0 }},
-    { 51, 0, 4, 16, { 0 }},
-    { 52, 0, 4, 16, { 0 }},
-    { 53, 0, 4, 16, { 0 }},
-    { 54, 0, 4, 16, { 0 }},
-    { 55, 0, 4, 16, { 0 }},
-    { 56, 0, 4, 16, { 0 }},
-    { 57, 0, 4, 16, { 0 }},
-    { 58, 6, 8, 16, { 0 }},
-    { 59, 4, 8, 16, { 0 }},
-    { 60, 2, 6, 16, { 0 }},
-    { 61, 2, 10, 16, { 0 }},
-    { 62, 2, 6, 16, { 0 }},
-    { 63, 0, 4, 16, { 0 }},
-    { 64, 0, 6, 16, { 0 }},
-    { 65, 0, 4, 16, { 0 }},
-    { 66, 0, 4, 16, { 0 }},
-    { 67, 0, 4, 16, { 0 }},
-    { 68, 0, 4, 16, { 0 }},
-    { 69, 0, 4, 16, { 0 }},
-    { 70, 0, 4, 16, { 0 }},
-    { 71, 0, 4, 16, { 0 }},
-    { 72, 0, 4, 16, { 0 }},
-    { 73, 4, 4, 16, { 0 }},
-    { 74, 0, 4, 16, { 0 }},
-    { 75, 0, 4, 16, { 0 }},
-    { 76, 0, 4, 16, { 0 }},
-    { 77, 0, 4, 16, { 0 }},
-    { 78, 0, 4, 16, { 0 }},
-    { 79, 0, 4, 16, { 0 }},
-    { 80, 0, 4, 16, { 0 }},
-    { 81, 0, 4, 16, { 0 }},
-    { 82, 0, 4, 16, { 0 }},
-    { 83, 0, 4, 16, { 0 }},
-    { 84, 2, 4, 16, { 0 }},
-    { 85, 0, 4, 16, { 0 }},
-    { 86, 0, 4, 16, { 0 }},
-    { 87, 0, 4, 16, { 0 }},
-    { 88, 0, 4, 16, { 0 }},
-    { 89, 2, 4, 16, { 0 }},
-    { 90, 0, 4, 16, { 0 }},
-    { 91, 4, 4, 16, { 0 }},
-    { 92, 0, 6, 16, { 0 }},
-    { 93, 4, 4, 16, { 0 }},
-    { 94, 0, 0, 16, { 0 }},
-    { 95, 0, 26, 16, { 0 }},
-    { 96, 4, 0, 16, { 0 }},
-    { 97, 0, 10, 16, { 0 }},
-    { 98, 0, 4, 16, { 0 }},
-    { 99, 0, 10, 16, { 0 }},
-    { 100, 0, 4, 16, { 0 }},
-    { 101, 0, 10, 16, { 0 }},
-    { 102, 0, 4, 16, { 0 }},
-    { 103, 0, 10, 16, { 0 }},
-    { 104, 0, 4, 16, { 0 }},
-    { 105, 4, 4, 16, { 0 }},
-    { 106, 2, 4, 16, { 0 }},
-    { 107, 0, 4, 16, { 0 }},
-    { 108, 4, 4, 16, { 0 }},
-    { 109, 0, 10, 16, { 0 }},
-    { 110, 0, 10, 16, { 0 }},
-    { 111, 0, 10, 16, { 0 }},
-    { 112, 0, 10, 16, { 0 }},
-    { 113, 0, 10, 16, { 0 }},
-    { 114, 0, 10, 16, { 0 }},
-    { 115, 0, 10, 16, { 0 }},
-    { 116, 0, 4, 16, { 0 }},
-    { 117, 0, 10, 16, { 0 }},
-    { 118, 2, 10, 16, { 0 }},
-    { 119, 0, 10, 16, { 0 }},
-    { 120, 0, 10, 16, { 0 }},
-    { 121, 0, 10, 16, { 0 }},
-    { 122, 0, 10, 16, { 0 }},
-    { 123, 2, 4, 16, { 0 }},
-    { 124, 6, 4, 16, { 0 }},
-    { 125, 2, 4, 16, { 0 }},
-    { 126, 0, 4, 16, { 0 }},
-};
-
-// Font loading function: Px437
-static Font LoadFont_Px437(void)
-{
-    Font font = { 0 };
-
-    font.baseSize = 32;
-    font.glyphCount = 95;
-    font.glyphPadding = 4;
-
-    // Custom font loading
-    // NOTE: Compressed font image data (DEFLATE), it requires DecompressData() function
-    int fontDataSize_Px437 = 0;
-    unsigned char *data = DecompressData(fontData_Px437, COMPRESSED_DATA_SIZE_FONT_PX437, &fontDataSize_Px437);
-    Image imFont = { data, 512, 256, 1, 2 };
-
-    // Load texture from image
-    font.texture = LoadTextureFromImage(imFont);
-    UnloadImage(imFont);  // Uncompressed data can be unloaded from memory
-
-    // Assign glyph recs and info data directly
-    // WARNING: This font data must not be unloaded
-    font.recs = fontRecs_Px437;
-    font.glyphs = fontGlyphs_Px437;
-
-    return font;
-}
@@ -0,0 +1,37 @@
+#ifndef VTERM_FONT_FORMAT_H
+#define VTERM_FONT_FORMAT_H
+#include <stdint.h>
+
+/* Packed bitmap fonts, as written by make_font_headers. Cells are at most
+ * 16 pixels wide: one uint16_t per glyph row, bit 15 is the leftmost pixel,
+ * 256 glyphs in CP437 order, glyph c row y at bits[c * height + y]. */
+
+#define VTERM_FONT_MAX_WIDTH 16
+#define VTERM_FONT_MAX_HEIGHT 32
+
+typedef struct {
+  const char *name;
+  uint8_t width, height;
+  const uint16_t *bits;
+} VTermPackedFont;
+
+/* Font pack: every font in one file, to be mmap'd. The header is followed by
+ * count entries, each pointing at its rows (offset from the file start). All
+ * fields little endian. */
+#define VTERM_FONT_PACK_MAGIC "VTFPACK1"
+#define VTERM_FONT_NAME_MAX 48
+
+typedef struct {
+  char magic[8];
+  uint32_t count;
+  uint32_t reserved;
+} VTermFontPackHeader;
+
+typedef struct {
+  char name[VTERM_FONT_NAME_MAX];
+  uint8_t width, height;
+  uint16_t reserved;
+  uint32_t offset;
+} VTermFontPackEntry;
+
+#endif
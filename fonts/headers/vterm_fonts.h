@@ -0,0 +1,11 @@
+// Generated by make_font_headers, do not edit
+
+#include "Bm437_IBM_VGA_8x16.h"
+#include "Bm437_IBM_EGA_8x14.h"
+#include "Bm437_IBM_CGA.h"
+
+static const VTermPackedFont *VTermPackedFonts[] = {
+  &VTermFont_Bm437_IBM_VGA_8x16,
+  &VTermFont_Bm437_IBM_EGA_8x14,
+  &VTermFont_Bm437_IBM_CGA,
+};
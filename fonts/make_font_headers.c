@@ -1,51 +1,266 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
-#include "raylib.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <strings.h>
+#include "headers/vterm_font_format.h"
 
+/* Bakes Windows bitmap fonts (.FON, int10h's win_bmp_fon/) into packed
+ * headers: a fixed cell, 1 bit per pixel table indexed by CP437 byte, one
+ * uint16_t per glyph row with bit 15 as the leftmost pixel. The .FON files
+ * hold the original ROM bitmaps, so no rasterising is involved.
+ *
+ * Also writes vterm_fonts.h, which includes every header given on this run
+ * and lists them in VTermPackedFonts[]. Pass all the fonts in one go:
+ *   ./make_font_headers ../fonts/int10h/win_bmp_fon/Bm437_IBM_VGA_8x16.FON ...
+ *
+ * With -p, everything goes into one mmap-able pack instead (see
+ * vterm_font_format.h), this is how the whole int10h set ships: pass every
+ * .FON in ../fonts/int10h/win_bmp_fon/ after -p vterm_fonts.pack */
+
+#define MAX_WIDTH VTERM_FONT_MAX_WIDTH
+#define MAX_HEIGHT VTERM_FONT_MAX_HEIGHT
+
+static const char *prefix = "../fonts/headers/";
+
+typedef struct {
+  char name[256];
+  int width, height;
+  uint16_t bits[256][MAX_HEIGHT];
+} PackedFont;
+
+static uint16_t u16(const uint8_t *p) { return p[0] | p[1] << 8; }
+static uint32_t u32(const uint8_t *p) { return u16(p) | (uint32_t)u16(p + 2) << 16; }
+
+static uint8_t *ReadFile(const char *filename, size_t *size)
+{
+  FILE *f = fopen(filename, "rb");
+  if (f == NULL)
+    return NULL;
+  fseek(f, 0, SEEK_END);
+  *size = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  uint8_t *data = (uint8_t *)malloc(*size);
+  if (fread(data, 1, *size, f) != *size)
+  {
+    free(data);
+    data = NULL;
+  }
+  fclose(f);
+  return data;
+}
+
+static const uint8_t *FindFontResource(const uint8_t *data, size_t size)
+/* MZ -> NE header -> resource table -> first RT_FONT entry */
+{
+  if (size < 0x40 || data[0] != 'M' || data[1] != 'Z')
+    return NULL;
+  uint32_t ne = u32(data + 0x3c);
+  if (ne + 0x40 > size || data[ne] != 'N' || data[ne + 1] != 'E')
+    return NULL;
+
+  const uint8_t *rsrc = data + ne + u16(data + ne + 0x24);
+  uint16_t shift = u16(rsrc);
+  const uint8_t *type = rsrc + 2;
+  while (type + 8 <= data + size && u16(type) != 0)
+  {
+    uint16_t count = u16(type + 2);
+    if (u16(type) == 0x8008 && count > 0)
+    {
+      size_t offset = (size_t)u16(type + 8) << shift;
+      return offset < size ? data + offset : NULL;
+    }
+    type += 8 + count * 12;
+  }
+  return NULL;
+}
+
+static bool LoadFON(const char *filename, PackedFont *font)
+{
+  size_t size;
+  uint8_t *data = ReadFile(filename, &size);
+  if (data == NULL)
+  {
+    printf("Skipped %s: can't read it\n", filename);
+    return false;
+  }
+
+  const uint8_t *fnt = FindFontResource(data, size);
+  if (fnt == NULL || (u16(fnt) != 0x200 && u16(fnt) != 0x300))
+  {
+    printf("Skipped %s: no FNT v2/v3 resource\n", filename);
+    free(data);
+    return false;
+  }
+
+  /* Fixed pitch fonts only, dfPixWidth is the cell width */
+  int v3 = u16(fnt) == 0x300;
+  font->width = u16(fnt + 86);
+  font->height = u16(fnt + 88);
+  int first = fnt[95], last = fnt[96];
+  if (font->width == 0 || font->width > MAX_WIDTH || font->height > MAX_HEIGHT)
+  {
+    printf("Skipped %s: %dx%d cells don't fit %dx%d\n", filename, font->width, font->height, MAX_WIDTH, MAX_HEIGHT);
+    free(data);
+    return false;
+  }
+
+  memset(font->bits, 0, sizeof(font->bits));
+  const uint8_t *table = fnt + (v3 ? 148 : 118);
+  for (int c = first; c <= last; c++)
+  {
+    const uint8_t *entry = table + (c - first) * (v3 ? 6 : 4);
+    size_t offset = v3 ? u32(entry + 2) : u16(entry + 2);
+    const uint8_t *glyph = fnt + offset;
+    if (glyph + font->height * ((font->width + 7) / 8) > data + size)
+      continue;
+    /* Column major: all rows of the first 8 pixels, then the next 8 */
+    for (int y = 0; y < font->height; y++)
+    {
+      uint16_t row = glyph[y] << 8;
+      if (font->width > 8)
+        row |= glyph[font->height + y];
+      font->bits[c][y] = row & (uint16_t)(0xffff << (16 - font->width));
+    }
+  }
+  free(data);
+
+  /* Name from the file, made into a C identifier */
+  const char *base = strrchr(filename, '/');
+  base = base ? base + 1 : filename;
+  snprintf(font->name, sizeof(font->name), "%s", base);
+  char *dot = strrchr(font->name, '.');
+  if (dot)
+    *dot = '\0';
+  for (char *p = font->name; *p; p++)
+    if (!(*p >= 'a' && *p <= 'z') && !(*p >= 'A' && *p <= 'Z') && !(*p >= '0' && *p <= '9'))
+      *p = '_';
+  return true;
+}
+
+static bool ExportPackedFont(const PackedFont *font, const char *filename)
+{
+  char path[512];
+  snprintf(path, sizeof(path), "%s%s.h", prefix, font->name);
+  FILE *f = fopen(path, "w");
+  if (f == NULL)
+  {
+    printf("Skipped %s: can't write %s\n", filename, path);
+    return false;
+  }
+
+  fprintf(f, "// Generated by make_font_headers from %s, do not edit\n", strrchr(filename, '/') ? strrchr(filename, '/') + 1 : filename);
+  fprintf(f, "// %dx%d cells, 256 glyphs in CP437 order, one row per uint16_t (bit 15 = leftmost)\n\n", font->width, font->height);
+  fprintf(f, "static const uint16_t VTermFontBits_%s[256 * %d] = {\n", font->name, font->height);
+  for (int c = 0; c < 256; c++)
+  {
+    fprintf(f, "  ");
+    for (int y = 0; y < font->height; y++)
+      fprintf(f, "0x%04x,", font->bits[c][y]);
+    fprintf(f, " // 0x%02x\n", c);
+  }
+  fprintf(f, "};\n\n");
+  fprintf(f, "static const VTermPackedFont VTermFont_%s = { \"%s\", %d, %d, VTermFontBits_%s };\n",
+          font->name, font->name, font->width, font->height, font->name);
+  fclose(f);
+  printf("Exported %s to %s\n", filename, path);
+  return true;
+}
+
+static bool ExportIndex(char **names, int count)
+{
+  char path[512];
+  snprintf(path, sizeof(path), "%svterm_fonts.h", prefix);
+  FILE *f = fopen(path, "w");
+  if (f == NULL)
+  {
+    printf("Can't write %s\n", path);
+    return false;
+  }
+  fprintf(f, "// Generated by make_font_headers, do not edit\n\n");
+  for (int i = 0; i < count; i++)
+    fprintf(f, "#include \"%s.h\"\n", names[i]);
+  fprintf(f, "\nstatic const VTermPackedFont *VTermPackedFonts[] = {\n");
+  for (int i = 0; i < count; i++)
+    fprintf(f, "  &VTermFont_%s,\n", names[i]);
+  fprintf(f, "};\n");
+  fclose(f);
+  printf("Indexed %d fonts in %s\n", count, path);
+  return true;
+}
+
+static bool ExportPack(const PackedFont *fonts, int count, const char *path)
+/* Header, entries, then each font's rows back to back */
+{
+  FILE *f = fopen(path, "wb");
+  if (f == NULL)
+  {
+    printf("Can't write %s\n", path);
+    return false;
+  }
+
+  VTermFontPackHeader header = { 0 };
+  memcpy(header.magic, VTERM_FONT_PACK_MAGIC, sizeof(header.magic));
+  header.count = count;
+  fwrite(&header, sizeof(header), 1, f);
+
+  uint32_t offset = sizeof(header) + count * sizeof(VTermFontPackEntry);
+  for (int i = 0; i < count; i++)
+  {
+    VTermFontPackEntry entry = { 0 };
+    snprintf(entry.name, sizeof(entry.name), "%s", fonts[i].name);
+    entry.width = fonts[i].width;
+    entry.height = fonts[i].height;
+    entry.offset = offset;
+    fwrite(&entry, sizeof(entry), 1, f);
+    offset += 256 * fonts[i].height * sizeof(uint16_t);
+  }
+  for (int i = 0; i < count; i++)
+    for (int c = 0; c < 256; c++)
+      fwrite(fonts[i].bits[c], sizeof(uint16_t), fonts[i].height, f);
+  fclose(f);
+  printf("Packed %d fonts into %s (%u bytes)\n", count, path, offset);
+  return true;
+}
 
 int main(int argc, char **argv)
 {
-  if (argc < 2)
+  const char *pack = NULL;
+  int first = 1;
+  if (argc > 2 && strcmp(argv[1], "-p") == 0)
+  {
+    pack = argv[2];
+    first = 3;
+  }
+  if (argc <= first)
   {
-    puts("Usage: ./make_font_headers <file-1>.ttf ... <file-n>.ttf");
+    puts("Usage: ./make_font_headers [-p <out>.pack] <file-1>.FON ... <file-n>.FON");
     return 1;
   }
 
-  Font f;
-  const char *prefix = "../fonts/headers/";
-  int prelen = strlen(prefix);
-  const char *suffix = ".h";
-  int sufflen = strlen(suffix);
-  const char *remprefix = "../fonts/int10h/pixel_outline_ttf/";
-  int remprelen = strlen(remprefix);
-  const char *remsuffix = ".ttf";
-  int remsufflen = strlen(remsuffix);
-
-  InitWindow(1,1,"font");
+  PackedFont *fonts = (PackedFont *)malloc(sizeof(PackedFont) * (argc - first));
+  char **names = (char **)calloc(argc, sizeof(char *));
+  int count = 0;
 
-  for (int i = 1; i < argc; i++)
+  for (int i = first; i < argc; i++)
   {
     const char *filename = argv[i];
     int len = strlen(filename);
-    if (strcmp(filename + len - 4, ".ttf"))
+    if (len < 4 || strcasecmp(filename + len - 4, ".fon"))
     {
-      printf("Skipped %s: invalid filetype (only ttfs supported)\n", filename);
+      printf("Skipped %s: invalid filetype (only .FON supported)\n", filename);
       continue;
     }
-    f = LoadFont(filename);
-    char *export_fname = (char *)malloc(len - remprelen - remsufflen + sufflen + prelen + 1); // NUL
-    strcpy(export_fname, prefix);
-    strcpy(export_fname + prelen, filename + remprelen);
-    strcpy(export_fname + prelen + len - remprelen - remsufflen, suffix);
-    printf("Exporting as %s... ", export_fname);
-    if (!ExportFontAsCode(f, export_fname))
-    {
-      printf("Skipped %s: ExportFontAsCode failed.\n", filename);
+    if (!LoadFON(filename, &fonts[count]))
       continue;
-    }
-    printf("Successfully exported %s to %s\n", filename, export_fname);
+    if (pack == NULL && !ExportPackedFont(&fonts[count], filename))
+      continue;
+    names[count] = fonts[count].name;
+    count++;
   }
-  CloseWindow();
-  return 0;
+
+  if (pack != NULL)
+    return ExportPack(fonts, count, pack) ? 0 : 1;
+  return ExportIndex(names, count) ? 0 : 1;
 }
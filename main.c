@@ -2,25 +2,42 @@
 #include "vterm.h"
 
 #include <stdio.h>
+#include <stdlib.h>
 
-int main() {
+int main(int argc, char **argv) {
   const uint16_t width = 800;
   const uint16_t height = 450;
   VTerm vt;
+  VTermClient client;
+  char title[VTERM_TITLE_MAX] = "vterm";
 
+  // Headless modes: benchmarks and screen dumps through the soft renderer
+  if (argc > 1 && (strcmp(argv[1], "--bench") == 0 || strcmp(argv[1], "--render") == 0))
+    return VTermBench(argc, argv);
+  // Session server: the child and its screen outlive any window
+  if (argc > 1 && strcmp(argv[1], "--server") == 0)
+    return VTermServe(argc, argv);
+  bool attached = argc > 2 && strcmp(argv[1], "--attach") == 0;
+
+  /* Swaps are paced by vsync, VTermWaitFrame sleeps on the pty in between */
+  SetConfigFlags(FLAG_VSYNC_HINT);
   InitWindow(width, height, "vterm");
 
-  if (!VTermInit(&vt, width, height, VTERM_MODE_MONOCHROME_TEXT_40_25))
+  if (attached ? !VTermAttach(&vt, &client, argv[2])
+               : !VTermInit(&vt, width, height, VTERM_MODE_MONOCHROME_TEXT_40_25))
   {
     return -1;
   }
-  // SetTargetFPS(60);
-
 
-  SetWindowState(FLAG_WINDOW_UNDECORATED);
+  SetWindowState(FLAG_WINDOW_UNDECORATED | FLAG_WINDOW_RESIZABLE);
   SetExitKey(KEY_NULL);
 
   while (!WindowShouldClose()) {
+    VTermWaitFrame(&vt);
+
+    if (IsWindowResized())
+      VTermEnsureResolution(&vt);
+
     // Handle shortcuts first
     // 1 must be keydown so polling not too quick
     if (IsKeyDown(KEY_LEFT_SUPER))
@@ -29,18 +46,46 @@ int main() {
         VTermIncreaseFontSize(&vt, 1);
       if (IsKeyPressed(KEY_MINUS) && (IsKeyDown(KEY_LEFT_SHIFT) || IsKeyDown(KEY_RIGHT_SHIFT)))
         VTermIncreaseFontSize(&vt, -1);
+      if (IsKeyPressed(KEY_L))
+        VTermStats.overlay = !VTermStats.overlay;
+      // Panes: Enter splits off a new shell, [ and ] move the focus
+      if (IsKeyPressed(KEY_ENTER) && !attached)
+        VTermSplitPane(&vt);
+      if (IsKeyPressed(KEY_LEFT_BRACKET))
+        VTermFocusPane(&vt, -1);
+      if (IsKeyPressed(KEY_RIGHT_BRACKET))
+        VTermFocusPane(&vt, 1);
     }
     // Input
     if (!VTermSendInput(&vt))
       return 1;
 
-    // Update
-    if (!VTermUpdate(&vt))
+    // Update, from the server when attached
+    if (attached)
+    {
+      if (!VTermClientFlushInput(&client, VTermGetCurrentBuffer(&vt)) || !VTermClientRead(&client, &vt))
+        break;
+    }
+    else if (!VTermUpdate(&vt))
       return 1;
 
+    // Window title follows the focused session's (OSC 0/2)
+    if (strcmp(VTermTitle(&vt), title) != 0)
+    {
+      snprintf(title, sizeof(title), "%s", VTermTitle(&vt));
+      SetWindowTitle(title);
+    }
+
+    // Mid synchronized update: no frame at all, the last one stays up
+    if (VTermHoldFrame(&vt))
+    {
+      PollInputEvents();
+      continue;
+    }
+
     // Draw
     BeginDrawing();
-    ClearBackground(DARKGRAY);
+    ClearBackground(VTermBackground(&vt));
     
     if (!VTermDraw(&vt))
       return 2;
@@ -55,10 +100,25 @@ int main() {
       20,
       (alt ? RED : GREEN)
     );
+    VTermIdleBegin(&vt);
     EndDrawing();
+    VTermIdleEnd(&vt);
+    VTermFramePresented(&vt);
   }
 
   // De-Initialization
+  if (getenv("VTERM_METRICS_FILE"))
+    VTermDumpMetrics(getenv("VTERM_METRICS_FILE"));
+  // Attached windows don't own the session, the server does
+  if (getenv("VTERM_SNAPSHOT") && !attached)
+    VTermSnapshotSave(&vt, getenv("VTERM_SNAPSHOT"));
+  VTermIdleClose();
+  VTermSoftPoolClose();
+  VTermImageClose();
+  VTermBellClose();
+  VTermRowCacheClose();
+  VTermPanesRelease(&vt);
+  VTermGlyphsClose();
   CloseWindow();
   return 0;
 }
@@ -1,39 +1,10 @@
+#define _GNU_SOURCE // posix_openpt & co. on glibc
 #define VTERM_C_SOURCE
 #include "vterm.h"
 
-bool VTermSpawnPTY(VTermPTY *pty) {
-  char *env[] = {"TERM=xterm-256color", NULL};
-
-  pid_t p = fork();
-
-  if (p == 0) {
-    /* child process */
-    close(pty->master);
-    setsid();
-    if (ioctl(pty->slave, TIOCSCTTY, NULL) == -1)
-      return false;
-    dup2(pty->slave, 0);
-    dup2(pty->slave, 1);
-    dup2(pty->slave, 2);
-    close(pty->slave);
-    execle(pty->shell, pty->shell, (char *)NULL, env);
-    return false;
-  } else if (p > 0) {
-    /* parent process */
-    close(pty->slave);
-    return true;
-  }
-
-  VTermError("fork");
-  return false;
-}
-
-bool VTermInitPTY(VTermPTY **pty_ptr) {
-  VTermPTY *pty = *pty_ptr;
-  /* PTY should NULL or free'd if initialised */
-  if (pty != NULL)
-    free(*pty_ptr);
-  pty = *pty_ptr = malloc(sizeof(VTermPTY));
+bool VTermInitPTY(VTermPTY *pty) {
+  /* pty lives in the session arena, nothing to allocate here */
+  pty->slave = -1;
   /* reading and writing, opened pt is not the controlling terminal: */
   pty->master = posix_openpt(O_RDWR | O_NOCTTY);
 
@@ -67,6 +38,12 @@ bool VTermInitPTY(VTermPTY **pty_ptr) {
     return false;
   }
 
+  /* Input is written in batches, a full pty queues instead of blocking */
+  if (fcntl(pty->master, F_SETFL, fcntl(pty->master, F_GETFL) | O_NONBLOCK) == -1) {
+    VTermError("fcntl(master, O_NONBLOCK)");
+    return false;
+  }
+
   pty->shell = "/bin/sh";
   return true;
 }
@@ -79,64 +56,130 @@ bool VTermInit(VTerm *vt, const uint16_t width, const uint16_t height, VTermMode
     return false;
   }
 
-  uint16_t i;
+  uint16_t i, sessions = 1;
   /***** INIT ALL BUFFERS TO NULL *****/
   for (i = 0; i < MAX_BUFFER_COUNT; i++)
     vt->buffers[i] = NULL;
+  vt->pane_count = 0;
 
   /***** INITIALISE OUR FONTS LIST *****/
-  //  For now all use this font
-  for (i = 0; i < 21; i++)
-    VTermTextFonts[i] = LoadFont_Px437();
-
-  /***** INITIALISE OUR ANSI COLOR LIST *****/
-#ifdef __BIG_ENDIAN__
-  VTermANSIColors[0] = 0x000000ff;
-  VTermANSIColors[1] = 0xff0000ff;
-  VTermANSIColors[2] = 0x00ff00ff;
-  VTermANSIColors[3] = 0xffff00ff;
-  VTermANSIColors[4] = 0x0000ffff;
-  VTermANSIColors[5] = 0xff00ffff;
-  VTermANSIColors[6] = 0x00ffffff;
-  VTermANSIColors[7] = 0xffffffff;
-#elif defined __LITTLE_ENDIAN__
-  VTermANSIColors[0] = 0xff000000;
-  VTermANSIColors[1] = 0xff0000ff;
-  VTermANSIColors[2] = 0xff00ff00;
-  VTermANSIColors[3] = 0xff00ffff;
-  VTermANSIColors[4] = 0xffff0000;
-  VTermANSIColors[5] = 0xffff00ff;
-  VTermANSIColors[6] = 0xffffff00;
-  VTermANSIColors[7] = 0xffffffff;
-#else
-#error "Unknown endian"
-#endif
+  VTermInitFonts(true);
 
+  /***** INITIALISE OUR COLOR PALETTE *****/
+  VTermInitPalette();
 
   /***** SET UP FIRST BUFFER *****/
   vt->pixel_width = width;
   vt->pixel_height = height;
 
-  if (!VTermInitBuffer(vt->buffers, mode)) {
+  /* VTERM_SNAPSHOT: pick up where the last run left off, with new shells */
+  const char *snapshot = getenv("VTERM_SNAPSHOT");
+  vt->buffer_ix = 0;
+  if (snapshot != NULL && access(snapshot, R_OK) == 0 && VTermSnapshotRestore(vt, snapshot))
+  {
+    sessions = 0;
+    for (i = 0; i < MAX_BUFFER_COUNT; i++)
+    {
+      if (vt->buffers[i] == NULL)
+        continue;
+      if (!VTermStartChild(vt->buffers[i]))
+        return false;
+      sessions++;
+    }
+  }
+  else if (!VTermInitBuffer(vt->buffers, mode)) {
     VTermError("VTermInitBuffer(vt, 0, mode)");
     return false;
   }
 
-  vt->buffer_ix = 0;
+  vt->server_fd = -1;
+  vt->frame_start = vt->frame_drawn = vt->frame_present = vt->frame_work = 0;
+  vt->output_parsed = 0;
 
-  VTermEnsureResolution(vt);
+  const char *renderer = getenv("VTERM_RENDERER");
+  vt->soft_render = renderer != NULL && strcmp(renderer, "soft") == 0;
+  if (vt->soft_render)
+    VTermSoftPoolInit(sysconf(_SC_NPROCESSORS_ONLN));
+
+  if (!VTermIdleInit(vt))
+  {
+    VTermError("VTermIdleInit(vt)");
+    return false;
+  }
+
+  /* Several sessions restored (saved with panes open): tile them over the
+   * window as asked for, or all but the current one would never be read */
+  if (sessions > 1)
+  {
+    SetWindowSize(vt->pixel_width, vt->pixel_height);
+    if (!VTermLayoutPanes(vt))
+    {
+      VTermError("VTermLayoutPanes(vt)");
+      return false;
+    }
+    return true;
+  }
 
+  /* Start with the window fitting the mode, from then on the grid follows */
+  VTermDataBuffer *buf = VTermGetCurrentBuffer(vt);
+  vt->pixel_width = buf->column_count * VTermCellWidth(buf);
+  vt->pixel_height = buf->row_count * buf->font_size;
+  SetWindowSize(vt->pixel_width, vt->pixel_height);
+
+  return true;
+}
+
+bool VTermInitHeadless(VTerm *vt, VTermMode mode)
+/* No window and no child: a grid to feed with VTermProcessByte and render
+ * on the CPU (screenshots, benchmarks) */
+{
+  for (int i = 0; i < MAX_BUFFER_COUNT; i++)
+    vt->buffers[i] = NULL;
+  vt->pane_count = 0;
+  VTermInitFonts(false);
+  VTermInitPalette();
+
+  if (!_VTermInitBuffer(vt->buffers, mode, false))
+  {
+    VTermError("_VTermInitBuffer(vt, 0, mode, false)");
+    return false;
+  }
+
+  vt->buffer_ix = 0;
+  VTermDataBuffer *buf = VTermGetCurrentBuffer(vt);
+  vt->server_fd = -1;
+  vt->pixel_width = buf->column_count * VTermCellWidth(buf);
+  vt->pixel_height = buf->row_count * buf->font_size;
+  vt->frame_start = vt->frame_drawn = vt->frame_present = vt->frame_work = 0;
+  vt->output_parsed = 0;
+  vt->busy = vt->idle = false;
+  vt->soft_render = true;
   return true;
 }
 
 bool VTermInitBufferFrom(VTermDataBuffer **dest, VTermDataBuffer *src)
+/* Alt screens are preallocated in src's arena, just reset and hand it out */
 {
-  if (!_VTermInitBuffer(dest, src->mode, false))
+  VTermDataBuffer *alt = (VTermDataBuffer *)src->alt_screen;
+  if (alt == NULL)
+  {
+    VTermError("VTermInitBufferFrom(src has no alt screen)");
+    return false;
+  }
+  alt->col = 0;
+  alt->row = 0;
+  alt->scroll_top = 0;
+  alt->scroll_bottom = alt->row_count;
+  alt->damage.full = true;
+  alt->font_size = src->font_size;
+  alt->fgbg_color = src->fgbg_color;
+  alt->pen = src->pen;
+  if (!VTermResetBufferData(alt, 0, 0, VTERM_RESET_BUFFER_DATA_ALL))
   {
-    VTermError("_VTermInitBuffer(dest, src->mode, false)");
+    VTermError("VTermResetBufferData(alt, 0, 0, VTERM_RESET_BUFFER_DATA_ALL)");
     return false;
   }
-  (*dest)->pty = src->pty;
+  *dest = alt;
   return true;
 }
 
@@ -145,45 +188,67 @@ bool VTermInitBuffer(VTermDataBuffer **buf_ptr, VTermMode mode)
   return _VTermInitBuffer(buf_ptr, mode, true);
 }
 
+#define VTERM_ARENA_ALIGN 16
+#define VTermAlignUp(n) (((n) + VTERM_ARENA_ALIGN - 1) & ~(size_t)(VTERM_ARENA_ALIGN - 1))
 
-bool _VTermInitBuffer(VTermDataBuffer **buf_ptr, VTermMode mode, bool pty) {
-  VTermDataBuffer *buf = *buf_ptr;
-  if (buf != NULL)
-    VTermCloseBuffer(buf);
+bool VTermArenaInit(VTermArena *arena, size_t size)
+{
+  arena->base = (uint8_t *)malloc(size);
+  arena->size = size;
+  arena->used = 0;
+  return arena->base != NULL;
+}
 
-  buf = *buf_ptr = (VTermDataBuffer *)malloc(sizeof(VTermDataBuffer));
+void *VTermArenaAlloc(VTermArena *arena, size_t size)
+{
+  size_t at = VTermAlignUp(arena->used);
+  if (at + size > arena->size)
+  {
+    VTermError("VTermArenaAlloc(out of space)");
+    return NULL;
+  }
+  arena->used = at + size;
+  return arena->base + at;
+}
 
-  buf->mode = mode;
-  buf->font_size = 20;
+void VTermArenaFree(VTermArena *arena)
+{
+  free(arena->base);
+  arena->base = NULL;
+  arena->size = arena->used = 0;
+}
 
+static size_t VTermScreenSize(uint16_t column_count, uint16_t row_count)
+{
+  size_t cells = (size_t)column_count * row_count;
+  return VTermAlignUp(sizeof(VTermDataBuffer))
+       + VTermAlignUp(cells * sizeof(uint8_t))
+       + VTermAlignUp(cells * sizeof(uint64_t))
+       + VTermAlignUp(row_count * sizeof(uint8_t))
+       + VTermAlignUp(row_count * sizeof(uint16_t))
+       + VTermAlignUp(VTERM_IMAGE_PLACEMENTS * sizeof(VTermImagePlacement));
+}
 
-  buf->col = 0;
-  buf->row = 0;
-  buf->font = VTermTextFonts[buf->mode];
-  buf->alt_buffer = NULL;
-  buf->pty = NULL;      // Inited below if needed
-  buf->default_fgbg = ((uint64_t)*(uint32_t*)&RAYWHITE << 32) | *(uint32_t*)&DARKGRAY;
-  printf("%8x : ", *(uint32_t*)&RAYWHITE);
-  printf("DEFAULT: %2x%2x%2x%2x%2x%2x%2x%2x = %16llx\n", 
-         // LITTLE ENDIAN
-         RAYWHITE.a, 
-         RAYWHITE.b, 
-         RAYWHITE.g, 
-         RAYWHITE.r, 
-
-         DARKGRAY.a, 
-         DARKGRAY.b, 
-         DARKGRAY.g, 
-         DARKGRAY.r,
-         buf->default_fgbg);
-  buf->fgbg_color = buf->default_fgbg;
+size_t VTermSessionSize(uint16_t column_count, uint16_t row_count)
+/* Everything one session owns: main, alt and scrollback view screens, pty,
+ * parser, io rings and the scrollback state */
+{
+  return 3 * VTermScreenSize(column_count, row_count)
+       + VTermAlignUp(sizeof(VTermPTY))
+       + VTermAlignUp(sizeof(VTermScrollback))
+       + VTermAlignUp(sizeof(VTermParser))
+       + 2 * VTermAlignUp(sizeof(VTermRing))
+       + VTermAlignUp(VTERM_IO_RING_SIZE)
+       + VTermAlignUp(VTERM_OUT_RING_SIZE);
+}
 
-  switch (buf->mode) {
+static bool VTermModeGeometry(VTermMode mode, uint16_t *column_count, uint16_t *row_count)
+{
+  switch (mode) {
     case VTERM_MODE_MONOCHROME_TEXT_40_25:
-      buf->buffer_size = 40 * 25;
-      buf->column_count = 40;
-      buf->row_count = 25;
-      break;
+      *column_count = 40;
+      *row_count = 25;
+      return true;
 
     case VTERM_MODE_COLOR_TEXT_40_25:
     case VTERM_MODE_MONOCHROME_TEXT_80_25:
@@ -205,25 +270,220 @@ bool _VTermInitBuffer(VTermDataBuffer **buf_ptr, VTermMode mode, bool pty) {
       VTermError("switch(mode) - unknown");
       return false;
   }
-  buf->data = (uint8_t *)calloc(buf->buffer_size, sizeof(uint8_t));
-  buf->fgbg_colors = (uint64_t *)calloc(buf->buffer_size, sizeof(uint64_t));
-  if (pty) {
-    if (!VTermInitPTY(&buf->pty)) {
-      VTermError("VTermInitPTY(buf->pty)");
-      return false;
-    }
-    if (!VTermSpawnPTY(buf->pty)) {
-      VTermError("VTermSpawnPTY(buf->pty)");
-      return false;
-    }
+}
+
+static VTermDataBuffer *VTermCarveScreen(VTermArena *arena, VTermMode mode, uint16_t column_count, uint16_t row_count)
+{
+  VTermDataBuffer *buf = (VTermDataBuffer *)VTermArenaAlloc(arena, sizeof(VTermDataBuffer));
+  memset(buf, 0, sizeof(VTermDataBuffer));
+
+  buf->mode = mode;
+  buf->font_size = 20;
+  buf->font = VTermTextFonts[buf->mode];
+  buf->glyphs = VTermModeFonts[buf->mode];
+  buf->column_count = column_count;
+  buf->row_count = row_count;
+  buf->kernels = VTermSelectKernels(column_count, true);
+  buf->buffer_size = (size_t)column_count * row_count;
+  Color fg = RAYWHITE, bg = DARKGRAY;
+  fg.a = 0; // no style
+  buf->default_fgbg = PACK(*(uint32_t*)&fg, *(uint32_t*)&bg);
+  buf->pen.fg_index = buf->pen.bg_index = VTERM_PEN_DEFAULT;
+  buf->fgbg_color = buf->default_fgbg;
+
+  buf->data = (uint8_t *)VTermArenaAlloc(arena, buf->buffer_size * sizeof(uint8_t));
+  buf->fgbg_colors = (uint64_t *)VTermArenaAlloc(arena, buf->buffer_size * sizeof(uint64_t));
+  buf->row_flags = (uint8_t *)VTermArenaAlloc(arena, buf->row_count * sizeof(uint8_t));
+  buf->row_index = (uint16_t *)VTermArenaAlloc(arena, buf->row_count * sizeof(uint16_t));
+  buf->placements = (VTermImagePlacement *)VTermArenaAlloc(arena, VTERM_IMAGE_PLACEMENTS * sizeof(VTermImagePlacement));
+  memset(buf->data, 0, buf->buffer_size * sizeof(uint8_t));
+  nmemset64(buf->fgbg_colors, buf->default_fgbg, buf->buffer_size);
+  memset(buf->row_flags, 0, buf->row_count * sizeof(uint8_t));
+  for (uint16_t r = 0; r < buf->row_count; r++)
+    buf->row_index[r] = r;
+  buf->scroll_top = 0;
+  buf->scroll_bottom = buf->row_count;
+  buf->damage.full = true;
+  return buf;
+}
+
+static VTermDataBuffer *VTermCarveSession(VTermArena *arena, VTermMode mode, uint16_t column_count, uint16_t row_count)
+{
+  /* The buffer struct comes first so freeing the arena frees the session */
+  VTermDataBuffer *buf = VTermCarveScreen(arena, mode, column_count, row_count);
+  VTermDataBuffer *alt = VTermCarveScreen(arena, mode, column_count, row_count);
+  VTermDataBuffer *view = VTermCarveScreen(arena, mode, column_count, row_count);
+
+  buf->pty = (VTermPTY *)VTermArenaAlloc(arena, sizeof(VTermPTY));
+  buf->pty->master = buf->pty->slave = -1;
+  buf->pty->shell = "/bin/sh";
+  buf->pty->pid = -1;
+
+  buf->scrollback = (VTermScrollback *)VTermArenaAlloc(arena, sizeof(VTermScrollback));
+  memset(buf->scrollback, 0, sizeof(VTermScrollback));
+  buf->scrollback->fd = buf->scrollback->index_fd = -1;
+
+  buf->parser = (VTermParser *)VTermArenaAlloc(arena, sizeof(VTermParser));
+  memset(buf->parser, 0, sizeof(VTermParser));
+  buf->parser->escape_ix = -1;
+
+  buf->in = (VTermRing *)VTermArenaAlloc(arena, sizeof(VTermRing));
+  buf->in->data = (uint8_t *)VTermArenaAlloc(arena, VTERM_IO_RING_SIZE);
+  buf->in->size = VTERM_IO_RING_SIZE;
+  buf->in->head = buf->in->tail = 0;
+
+  buf->out = (VTermRing *)VTermArenaAlloc(arena, sizeof(VTermRing));
+  buf->out->data = (uint8_t *)VTermArenaAlloc(arena, VTERM_OUT_RING_SIZE);
+  buf->out->size = VTERM_OUT_RING_SIZE;
+  buf->out->head = buf->out->tail = 0;
+
+  alt->pty = buf->pty;
+  alt->parser = buf->parser;
+  alt->in = buf->in;
+  alt->out = buf->out;
+  alt->scrollback = view->scrollback = buf->scrollback;
+  buf->alt_screen = alt;
+  buf->view_screen = view;
+  buf->arena = *arena;
+  return buf;
+}
+
+bool _VTermInitBuffer(VTermDataBuffer **buf_ptr, VTermMode mode, bool pty) {
+  uint16_t column_count, row_count;
+
+  if (!VTermModeGeometry(mode, &column_count, &row_count))
+  {
+    VTermError("VTermModeGeometry(mode)");
+    return false;
+  }
+  if (!VTermInitBufferSized(buf_ptr, mode, column_count, row_count))
+    return false;
+  if (pty)
+    return VTermStartChild(*buf_ptr);
+  return true;
+}
+
+bool VTermInitBufferSized(VTermDataBuffer **buf_ptr, VTermMode mode, uint16_t column_count, uint16_t row_count)
+/* A session of any geometry, no child (snapshots bring their own) */
+{
+  VTermDataBuffer *buf = *buf_ptr;
+  VTermArena arena;
+
+  if (buf != NULL)
+    VTermCloseBuffer(buf);
+  *buf_ptr = NULL;
+
+  if (!VTermArenaInit(&arena, VTermSessionSize(column_count, row_count)))
+  {
+    VTermError("VTermArenaInit(session)");
+    return false;
+  }
+
+  *buf_ptr = VTermCarveSession(&arena, mode, column_count, row_count);
+  return true;
+}
+
+bool VTermStartChild(VTermDataBuffer *buf)
+/* pty and shell for a session carved without them */
+{
+  if (!VTermInitPTY(buf->pty)) {
+    VTermError("VTermInitPTY(buf->pty)");
+    return false;
+  }
+  VTermSetWinSize(buf);
+  if (!VTermSpawnPTY(buf->pty)) {
+    VTermError("VTermSpawnPTY(buf->pty)");
+    return false;
   }
+  /* History is opt-in, VTERM_SCROLLBACK names the directory it goes to.
+   * A restored snapshot may have brought its own. */
+  const char *dir = getenv("VTERM_SCROLLBACK");
+  if (dir != NULL && buf->scrollback->fd == -1 && !VTermScrollbackOpen(buf->scrollback, dir))
+    VTermError("VTermScrollbackOpen(VTERM_SCROLLBACK)");
   return true;
 }
 
 void VTermCloseBuffer(VTermDataBuffer *buf) {
-  if (buf->data != NULL)
-    free(buf->data);
-  free(buf);
+  /* Alt screens live in their principal's arena, nothing to do */
+  if (buf->arena.base == NULL)
+    return;
+
+  if (buf->pty->master != -1)
+    close(buf->pty->master);
+  if (buf->pty->slave != -1)
+    close(buf->pty->slave);
+  VTermMoveChild(buf->pty, NULL); // closing master hung it up, reaped on exit
+  free(buf->paste);
+  VTermScrollbackClose(buf->scrollback);
+  VTermImageRelease(buf->parser);
+  VTermStringRelease(buf->parser);
+
+  /* buf is inside the arena, copy it out before freeing */
+  VTermArena arena = buf->arena;
+  VTermArenaFree(&arena);
+}
+
+size_t VTermRingUsed(VTermRing *ring)
+{
+  return ring->tail - ring->head;
+}
+
+ssize_t VTermRingFill(VTermRing *ring, int fd)
+/* One read() into the contiguous free span after tail */
+{
+  size_t at = ring->tail & (ring->size - 1);
+  size_t space = ring->size - VTermRingUsed(ring);
+  if (space > ring->size - at)
+    space = ring->size - at;
+  if (space == 0)
+    return 0;
+
+  ssize_t n = read(fd, ring->data + at, space);
+  if (n > 0)
+    ring->tail += n;
+  return n;
+}
+
+size_t VTermRingPush(VTermRing *ring, const void *src, size_t len)
+/* Copies as much of src as fits, returns how much that was */
+{
+  size_t space = ring->size - VTermRingUsed(ring);
+  if (len > space)
+    len = space;
+  for (size_t done = 0; done < len;)
+  {
+    size_t at = ring->tail & (ring->size - 1);
+    size_t n = ring->size - at < len - done ? ring->size - at : len - done;
+    memcpy(ring->data + at, (const uint8_t *)src + done, n);
+    ring->tail += n;
+    done += n;
+  }
+  return len;
+}
+
+ssize_t VTermRingDrain(VTermRing *ring, int fd)
+/* Writes everything queued with a single writev(), both halves if wrapped */
+{
+  struct iovec iov[2];
+  size_t used = VTermRingUsed(ring);
+  size_t at = ring->head & (ring->size - 1);
+  int iovcnt = 1;
+
+  if (used == 0)
+    return 0;
+  iov[0].iov_base = ring->data + at;
+  iov[0].iov_len = used < ring->size - at ? used : ring->size - at;
+  if (iov[0].iov_len < used)
+  {
+    iov[1].iov_base = ring->data;
+    iov[1].iov_len = used - iov[0].iov_len;
+    iovcnt = 2;
+  }
+
+  ssize_t n = writev(fd, iov, iovcnt);
+  if (n > 0)
+    ring->head += n;
+  return n;
 }
 
 void VTermGetEscapeCodeArgs(VTermEscapeArgs *args, char *argstr, int arglen)
@@ -263,64 +523,158 @@ void VTermPrintEscapeCode(char *escape, VTermEscapeArgs *args)
   printf("\n");
 }
 
+void VTermEraseCells(VTermDataBuffer *buf, uint16_t row, uint16_t col0, uint16_t col1)
+/* Blank [col0, col1) of one row */
+{
+  if (col1 > buf->column_count)
+    col1 = buf->column_count;
+  if (col0 >= col1)
+    return;
+  memset(VTermRowData(buf, row) + col0, 0, col1 - col0);
+  nmemset64(VTermRowColors(buf, row) + col0, buf->default_fgbg, col1 - col0);
+  buf->row_flags[row] |= VTERM_ROW_DIRTY;
+}
+
+static void VTermEraseRows(VTermDataBuffer *buf, uint16_t row0, uint16_t row1)
+/* Whole rows [row0, row1), wrap flags included */
+{
+  for (uint16_t r = row0; r < row1 && r < buf->row_count; r++)
+  {
+    VTermEraseCells(buf, r, 0, buf->column_count);
+    buf->row_flags[r] = VTERM_ROW_DIRTY;
+  }
+}
+
 bool VTermResetBufferData(VTermDataBuffer *buf, uint16_t row, uint16_t col, VTermResetBufferDataDir dir)
 {
-  if (dir == VTERM_RESET_BUFFER_DATA_ALL)
+  switch (dir)
   {
-    if (!VTermResetBufferData(buf, row, col, VTERM_RESET_BUFFER_DATA_BACKWARDS))
-    {
-      VTermError("VTermResetBufferData(buf, row, col, VTERM_RESET_BUFFER_DATA_BACKWARS)");
+    case VTERM_RESET_BUFFER_DATA_ALL:
+      VTermEraseRows(buf, 0, buf->row_count);
+      VTermImageClear(buf);
+      break;
+    case VTERM_RESET_BUFFER_DATA_FORWARDS: // from the cursor to the end
+      VTermEraseCells(buf, row, col, buf->column_count);
+      buf->row_flags[row] &= ~VTERM_ROW_WRAPPED;
+      VTermEraseRows(buf, row + 1, buf->row_count);
+      break;
+    case VTERM_RESET_BUFFER_DATA_BACKWARDS: // from the start to the cursor, inclusive
+      VTermEraseRows(buf, 0, row);
+      VTermEraseCells(buf, row, 0, col + 1);
+      break;
+    case VTERM_RESET_BUFFER_DATA_UP: // rows above the cursor's
+      VTermEraseRows(buf, 0, row);
+      break;
+    case VTERM_RESET_BUFFER_DATA_DOWN: // rows below the cursor's
+      VTermEraseRows(buf, row + 1, buf->row_count);
+      break;
+    default:
+      VTermError("Invalid enum VTermResetBufferDataDir");
       return false;
-    }
-    if (!VTermResetBufferData(buf, row, col, VTERM_RESET_BUFFER_DATA_FORWARDS))
+  }
+  return true;
+}
+
+static void VTermDamageScroll(VTermDataBuffer *buf, uint16_t top, uint16_t bottom, int n)
+/* Scrolls of the same region add up, anything else means a full redraw */
+{
+  VTermDamage *d = &buf->damage;
+  if (d->full)
+    return;
+  if (d->scroll != 0 && (d->scroll_top != top || d->scroll_bottom != bottom))
+  {
+    d->full = true;
+    return;
+  }
+  d->scroll_top = top;
+  d->scroll_bottom = bottom;
+  d->scroll += n;
+  if (abs(d->scroll) >= bottom - top)
+  {
+    /* Nothing on screen survives, the rows are dirty already */
+    d->scroll = 0;
+  }
+}
+
+VTermDamage VTermTakeDamage(VTermDataBuffer *buf)
+/* What changed since the last call. The caller clears VTERM_ROW_DIRTY on
+ * the rows it redraws. */
+{
+  VTermDamage d = buf->damage;
+  buf->damage = (VTermDamage){ 0 };
+  return d;
+}
+
+static void VTermShiftRows(VTermDataBuffer *buf, uint16_t top, uint16_t bottom, int n, bool spill)
+/* Rows [top, bottom) move up n rows (down if n < 0), blank ones come in.
+ * Cells stay put: the row index and flags are rotated, so a scroll costs
+ * O(rows) whatever the width. Rows leaving the top of the screen go to the
+ * history only when spill is set. */
+{
+  int height = bottom - top, k = abs(n);
+  if (height <= 0 || n == 0)
+    return;
+  if (k > height)
+    k = height;
+  VTermStats.scrolls++;
+  VTermStats.scrolled_lines += k;
+
+  uint16_t *index = buf->row_index + top;
+  uint8_t *flags = buf->row_flags + top;
+  uint16_t out[k];
+  if (n > 0)
+  {
+    /* Off the top of a main screen means into the history, if there is one */
+    VTermScrollback *sb = buf->scrollback;
+    if (spill && top == 0 && buf->alt_screen != NULL && sb->fd != -1)
     {
-      VTermError("VTermResetBufferData(buf, row, col, VTERM_RESET_BUFFER_DATA_FORWARDS)");
-      return false;
+      for (int r = 0; r < k; r++)
+        VTermScrollbackPush(sb, VTermRowData(buf, r), VTermRowColors(buf, r), buf->column_count, buf->default_fgbg, buf->row_flags[r]);
+      /* A view scrolled back stays on the same lines */
+      if (sb->view > 0)
+        sb->view = sb->view + k < sb->lines ? sb->view + k : sb->lines;
     }
+    memcpy(out, index, k * sizeof(uint16_t));
+    memmove(index, index + k, (height - k) * sizeof(uint16_t));
+    memcpy(index + height - k, out, k * sizeof(uint16_t));
+    memmove(flags, flags + k, height - k);
+    VTermEraseRows(buf, bottom - k, bottom);
   }
-  else if (dir == VTERM_RESET_BUFFER_DATA_FORWARDS)
-  {
-    nmemset(buf->data + row * buf->column_count + col, 
-             0, 
-             buf->buffer_size - (row * buf->column_count + col));
-    nmemset(buf->fgbg_colors + row * buf->column_count + col, 
-             buf->default_fgbg, 
-             buf->buffer_size - (row * buf->column_count + col));
-  } else if (dir == VTERM_RESET_BUFFER_DATA_BACKWARDS)
-  {
-    nmemset(buf->data, 
-             0, 
-             row * buf->column_count + col);
-    nmemset(buf->fgbg_colors, 
-             buf->default_fgbg, 
-             row * buf->column_count + col);
-  }
-  else if (dir == VTERM_RESET_BUFFER_DATA_UP)
-  {
-    if (row <= 0) return true;
-    nmemset(buf->data, 
-             0, 
-             (row - 1) * buf->column_count);
-    nmemset(buf->fgbg_colors, 
-             buf->default_fgbg, 
-             (row - 1) * buf->column_count);
-  }
-   else if (dir == VTERM_RESET_BUFFER_DATA_DOWN)
-  {
-    if (row >= buf->row_count - 1) return true;
-    nmemset(buf->data + (row + 1) * buf->column_count, 
-             0, 
-             buf->buffer_size - ((row + 1) * buf->column_count));
-    nmemset(buf->fgbg_colors + (row + 1) * buf->column_count, 
-             buf->default_fgbg, 
-             buf->buffer_size - ((row + 1) * buf->column_count));
-  }
-  else {
-    VTermError("Invalid enum VTermResetBufferDataDir");
-    return false;
+  else
+  {
+    memcpy(out, index + height - k, k * sizeof(uint16_t));
+    memmove(index + k, index, (height - k) * sizeof(uint16_t));
+    memcpy(index, out, k * sizeof(uint16_t));
+    memmove(flags + k, flags, height - k);
+    VTermEraseRows(buf, top, top + k);
   }
+  if (buf->placement_count > 0)
+    VTermImageScroll(buf, top, bottom, n > 0 ? k : -k);
+  VTermDamageScroll(buf, top, bottom, n > 0 ? k : -k);
+}
 
-  return true;
+void VTermScrollRegion(VTermDataBuffer *buf, uint16_t top, uint16_t bottom, int n)
+/* Scrolling proper (line feed, index, SU/SD): what scrolls off the top of a
+ * main screen is kept in the history */
+{
+  VTermShiftRows(buf, top, bottom, n, true);
+}
+
+void VTermLineFeed(VTermDataBuffer *buf)
+/* Down a row, scrolling the region when leaving its bottom row */
+{
+  if (buf->row + 1 == buf->scroll_bottom)
+    VTermScrollRegion(buf, buf->scroll_top, buf->scroll_bottom, 1);
+  else if (buf->row + 1 < buf->row_count)
+    buf->row++;
+}
+
+void VTermReverseIndex(VTermDataBuffer *buf)
+{
+  if (buf->row == buf->scroll_top)
+    VTermScrollRegion(buf, buf->scroll_top, buf->scroll_bottom, -1);
+  else if (buf->row > 0)
+    buf->row--;
 }
 
 // str at least 64
@@ -379,94 +733,413 @@ void VTermModeToStr(VTermMode mode, char *str)
   }
 }
 
+void VTermInitPalette(void)
+/* 0-15 VGA, 16-231 6x6x6 cube, 232-255 grey ramp (xterm's layout) */
+{
+  static const uint8_t vga[16][3] = {
+    {   0,   0,   0 }, { 170,   0,   0 }, {   0, 170,   0 }, { 170,  85,   0 },
+    {   0,   0, 170 }, { 170,   0, 170 }, {   0, 170, 170 }, { 170, 170, 170 },
+    {  85,  85,  85 }, { 255,  85,  85 }, {  85, 255,  85 }, { 255, 255,  85 },
+    {  85,  85, 255 }, { 255,  85, 255 }, {  85, 255, 255 }, { 255, 255, 255 },
+  };
+  static const uint8_t cube[6] = { 0, 95, 135, 175, 215, 255 };
+  int i;
+
+  for (i = 0; i < 16; i++)
+    VTermPalette[i] = (Color){ vga[i][0], vga[i][1], vga[i][2], 255 };
+  for (i = 0; i < 216; i++)
+    VTermPalette[16 + i] = (Color){ cube[i / 36], cube[(i / 6) % 6], cube[i % 6], 255 };
+  for (i = 0; i < 24; i++)
+  {
+    uint8_t grey = 8 + 10 * i;
+    VTermPalette[232 + i] = (Color){ grey, grey, grey, 255 };
+  }
+}
+
+int VTermParseParams(const char *str, int len, uint16_t *params, char *seps)
+/* Numeric CSI parameters, ';' or ':' separated, empty ones are 0. seps[i]
+ * is the separator before params[i] (0 for the first). Stops at the first
+ * non-parameter byte. Returns the count. */
+{
+  int count = 0;
+  uint32_t n = 0;
+  char sep = 0;
+  bool any = false;
+
+  for (int i = 0; i < len; i++)
+  {
+    char ch = str[i];
+    if (ch >= '0' && ch <= '9')
+    {
+      n = n * 10 + (ch - '0');
+      if (n > 0xffff)
+        n = 0xffff;
+      any = true;
+    }
+    else if (ch == ';' || ch == ':')
+    {
+      if (count < VTERM_MAX_PARAMS)
+      {
+        seps[count] = sep;
+        params[count++] = n;
+      }
+      n = 0;
+      sep = ch;
+      any = true;
+    }
+    else
+      break;
+  }
+  if (any && count < VTERM_MAX_PARAMS)
+  {
+    seps[count] = sep;
+    params[count++] = n;
+  }
+  return count;
+}
+
+void VTermUpdatePen(VTermDataBuffer *buf)
+/* Resolve the pen into the packed colour stored with each cell. Bold picks
+ * the bright variant of 0-7, faint dims, inverse/hidden swap here so the
+ * renderer only has to care about lines (underline/strike). */
+{
+  VTermPen *pen = &buf->pen;
+  uint32_t dfg = UNPACK_fg(buf->default_fgbg), dbg = UNPACK_bg(buf->default_fgbg);
+  Color fg, bg;
+
+  if (pen->fg_index == VTERM_PEN_DEFAULT)
+    fg = *(Color *)&dfg;
+  else if (pen->fg_index == VTERM_PEN_RGB)
+    fg = pen->fg;
+  else if ((pen->style & VTERM_STYLE_BOLD) && pen->fg_index < 8)
+    fg = VTermPalette[pen->fg_index + 8];
+  else
+    fg = VTermPalette[pen->fg_index];
+
+  if (pen->bg_index == VTERM_PEN_DEFAULT)
+    bg = *(Color *)&dbg;
+  else if (pen->bg_index == VTERM_PEN_RGB)
+    bg = pen->bg;
+  else
+    bg = VTermPalette[pen->bg_index];
+
+  if (pen->style & VTERM_STYLE_FAINT)
+  {
+    fg.r = fg.r * 2 / 3;
+    fg.g = fg.g * 2 / 3;
+    fg.b = fg.b * 2 / 3;
+  }
+  if (pen->style & VTERM_STYLE_INVERSE)
+  {
+    Color tmp = fg;
+    fg = bg;
+    bg = tmp;
+  }
+  if (pen->style & VTERM_STYLE_HIDDEN)
+    fg = bg;
+
+  fg.a = pen->style;
+  bg.a = 255;
+  buf->fgbg_color = PACK(*(uint32_t *)&fg, *(uint32_t *)&bg);
+}
+
+static int VTermSGRColor(uint16_t *params, char *seps, int count, int i, int16_t *index, Color *rgb)
+/* Extended colour after 38/48 at params[i]: 5;n or 2;r;g;b, also the
+ * colon forms (5:n, 2:r:g:b, 2::r:g:b). Returns how many params it used. */
+{
+  int end = i + 1;
+  if (i + 1 >= count)
+    return 0;
+
+  if (seps[i + 1] == ':')
+  {
+    /* Colon form: the whole sub-parameter group belongs to us */
+    while (end < count && seps[end] == ':')
+      end++;
+    int n = end - (i + 1);
+    if (params[i + 1] == 5 && n >= 2)
+      *index = params[i + 2] & 0xff;
+    else if (params[i + 1] == 2 && n >= 4)
+    {
+      /* 2:cs:r:g:b has a colour space id before the components */
+      int at = n >= 5 ? i + 3 : i + 2;
+      *rgb = (Color){ params[at], params[at + 1], params[at + 2], 255 };
+      *index = VTERM_PEN_RGB;
+    }
+    return end - 1 - i;
+  }
+
+  if (params[i + 1] == 5 && i + 2 < count)
+  {
+    *index = params[i + 2] & 0xff;
+    return 2;
+  }
+  if (params[i + 1] == 2 && i + 4 < count)
+  {
+    *rgb = (Color){ params[i + 2], params[i + 3], params[i + 4], 255 };
+    *index = VTERM_PEN_RGB;
+    return 4;
+  }
+  return 1;
+}
+
+void VTermSelectGraphicRendition(VTermDataBuffer *buf, const char *str, int len)
+{
+  uint16_t params[VTERM_MAX_PARAMS];
+  char seps[VTERM_MAX_PARAMS];
+  VTermPen *pen = &buf->pen;
+  int count = VTermParseParams(str, len, params, seps);
+
+  if (count == 0)
+  {
+    params[0] = 0;
+    seps[0] = 0;
+    count = 1;
+  }
+
+  for (int i = 0; i < count; i++)
+  {
+    uint16_t n = params[i];
+    /* Sub-parameters of something we don't know (e.g. 4:3 curly) */
+    if (seps[i] == ':')
+      continue;
+
+    if (n >= 30 && n <= 37)
+      pen->fg_index = n - 30;
+    else if (n >= 40 && n <= 47)
+      pen->bg_index = n - 40;
+    else if (n >= 90 && n <= 97)
+      pen->fg_index = n - 90 + 8;
+    else if (n >= 100 && n <= 107)
+      pen->bg_index = n - 100 + 8;
+    else switch (n)
+    {
+      case 0:
+        pen->fg_index = pen->bg_index = VTERM_PEN_DEFAULT;
+        pen->style = 0;
+        break;
+      case 1: pen->style |= VTERM_STYLE_BOLD; break;
+      case 2: pen->style |= VTERM_STYLE_FAINT; break;
+      case 3: pen->style |= VTERM_STYLE_ITALIC; break;
+      case 4: pen->style |= VTERM_STYLE_UNDERLINE; break;
+      case 5:
+      case 6: pen->style |= VTERM_STYLE_BLINK; break;
+      case 7: pen->style |= VTERM_STYLE_INVERSE; break;
+      case 8: pen->style |= VTERM_STYLE_HIDDEN; break;
+      case 9: pen->style |= VTERM_STYLE_STRIKE; break;
+      case 21: pen->style |= VTERM_STYLE_UNDERLINE; break;
+      case 22: pen->style &= ~(VTERM_STYLE_BOLD | VTERM_STYLE_FAINT); break;
+      case 23: pen->style &= ~VTERM_STYLE_ITALIC; break;
+      case 24: pen->style &= ~VTERM_STYLE_UNDERLINE; break;
+      case 25: pen->style &= ~VTERM_STYLE_BLINK; break;
+      case 27: pen->style &= ~VTERM_STYLE_INVERSE; break;
+      case 28: pen->style &= ~VTERM_STYLE_HIDDEN; break;
+      case 29: pen->style &= ~VTERM_STYLE_STRIKE; break;
+      case 38: i += VTermSGRColor(params, seps, count, i, &pen->fg_index, &pen->fg); break;
+      case 39: pen->fg_index = VTERM_PEN_DEFAULT; break;
+      case 48: i += VTermSGRColor(params, seps, count, i, &pen->bg_index, &pen->bg); break;
+      case 49: pen->bg_index = VTERM_PEN_DEFAULT; break;
+    }
+  }
+  VTermUpdatePen(buf);
+}
+
+static uint16_t VTermParam(uint16_t *params, int count, int i, uint16_t def)
+/* params[i], missing or 0 means def (counts and positions start at 1) */
+{
+  return i < count && params[i] != 0 ? params[i] : def;
+}
+
+static void VTermMoveCursor(VTermDataBuffer *buf, int row, int col)
+{
+  buf->row = row < 0 ? 0 : row >= buf->row_count ? buf->row_count - 1 : row;
+  buf->col = col < 0 ? 0 : col >= buf->column_count ? buf->column_count - 1 : col;
+  /* An explicit move ends the "just wrapped" state, the next LF is real */
+  buf->parser->previousWasWrap = false;
+  buf->parser->previousWasCRAfterWrap = false;
+}
+
+static void VTermShiftCells(VTermDataBuffer *buf, int n)
+/* ICH (n > 0) / DCH (n < 0) at the cursor, within the cursor's row */
+{
+  int room = buf->column_count - buf->col, k = abs(n);
+  uint8_t *data = VTermRowData(buf, buf->row) + buf->col;
+  uint64_t *colors = VTermRowColors(buf, buf->row) + buf->col;
+  if (k > room)
+    k = room;
+  if (n > 0)
+  {
+    memmove(data + k, data, room - k);
+    memmove(colors + k, colors, (room - k) * sizeof(uint64_t));
+    VTermEraseCells(buf, buf->row, buf->col, buf->col + k);
+  }
+  else
+  {
+    memmove(data, data + k, room - k);
+    memmove(colors, colors + k, (room - k) * sizeof(uint64_t));
+    VTermEraseCells(buf, buf->row, buf->column_count - k, buf->column_count);
+  }
+}
+
 bool VTermExecuteEscapeCode(VTerm *vt, char *escape, int escape_len)
+/* escape is a whole CSI sequence without ESC[, escape[escape_len - 1] is
+ * its final byte. False for ones we don't implement. */
 {
   VTermDataBuffer *buf = VTermGetCurrentBuffer(vt);
   VTermEscapeArgs args;
-  VTermResetBufferDataDir dir;
+  uint16_t params[VTERM_MAX_PARAMS];
+  char seps[VTERM_MAX_PARAMS];
+  bool private = escape[0] == '?' || escape[0] == '>' || escape[0] == '<' || escape[0] == '=';
+  int count = private ? 0 : VTermParseParams(escape, escape_len - 1, params, seps);
+  uint16_t n = VTermParam(params, count, 0, 1);
 
   VTermGetEscapeCodeArgs(&args, escape, escape_len - 1);
 
   bool high = false;
-  
+
+  /* Cursor moves stop at the margins when they start inside the region */
+  int top = buf->row >= buf->scroll_top ? buf->scroll_top : 0;
+  int bottom = buf->row < buf->scroll_bottom ? buf->scroll_bottom - 1 : buf->row_count - 1;
 
   switch (escape[escape_len - 1])
   {
-    case 'H':
-      if (args.count == 0)
-      {
-        buf->row = 0;
-        buf->col = 0;
-      } else if (args.count == 1)
-      {
-        sscanf(args.args[0], "%hd", &buf->row);
-        buf->row--; // xterm row/col start at 1
-        buf->col = 0;
-      } else {
-        sscanf(args.args[0], "%hd", &buf->row);
-        sscanf(args.args[1], "%hd", &buf->col);
-        buf->row--; // xterm row/col start at 1
-        buf->col--; // xterm row/col start at 1
-      }
-
-      buf->row %= buf->row_count;
-      buf->col %= buf->column_count;
+    case 'A': // CUU
+      VTermMoveCursor(buf, buf->row - n < top ? top : buf->row - n, buf->col);
       goto success;
-    case 'J':
-      // we don't support selective erase for now, go to success
-      if (escape[0] == '?')
-        goto success;
-
-      if (args.count == 0) // default: erase below
-        dir = VTERM_RESET_BUFFER_DATA_DOWN;
-      else if (args.args[0][0] == '0')
-        dir = VTERM_RESET_BUFFER_DATA_DOWN;
-      else if (args.args[0][0] == '1')
-        dir = VTERM_RESET_BUFFER_DATA_UP;
-      else if (args.args[0][0] == '2')
-        dir = VTERM_RESET_BUFFER_DATA_ALL;
-      else if (args.args[0][0] == '3')
-        // history not implemented, just go to success for now
+    case 'B': // CUD
+    case 'e': // VPR
+      VTermMoveCursor(buf, buf->row + n > bottom ? bottom : buf->row + n, buf->col);
+      goto success;
+    case 'C': // CUF
+    case 'a': // HPR
+      VTermMoveCursor(buf, buf->row, buf->col + n);
+      goto success;
+    case 'D': // CUB
+      VTermMoveCursor(buf, buf->row, buf->col - n);
+      goto success;
+    case 'E': // CNL
+      VTermMoveCursor(buf, buf->row + n > bottom ? bottom : buf->row + n, 0);
+      goto success;
+    case 'F': // CPL
+      VTermMoveCursor(buf, buf->row - n < top ? top : buf->row - n, 0);
+      goto success;
+    case 'G': // CHA
+    case '`': // HPA
+      VTermMoveCursor(buf, buf->row, n - 1);
+      goto success;
+    case 'd': // VPA
+      VTermMoveCursor(buf, n - 1, buf->col);
+      goto success;
+    case 'H': // CUP
+    case 'f': // HVP
+      // xterm row/col start at 1
+      VTermMoveCursor(buf, VTermParam(params, count, 0, 1) - 1, VTermParam(params, count, 1, 1) - 1);
+      goto success;
+    case 'J':
+      // we don't support selective erase for now, go to success
+      if (private)
         goto success;
-      
-      if (!VTermResetBufferData(buf, buf->row, buf->col, dir))
+      switch (count ? params[0] : 0)
       {
-        VTermError("VTermResetBufferData(buf, buf->row, buf->col, dir)");
-        return false;
+        case 0: VTermResetBufferData(buf, buf->row, buf->col, VTERM_RESET_BUFFER_DATA_FORWARDS); break;
+        case 1: VTermResetBufferData(buf, buf->row, buf->col, VTERM_RESET_BUFFER_DATA_BACKWARDS); break;
+        case 2: VTermResetBufferData(buf, buf->row, buf->col, VTERM_RESET_BUFFER_DATA_ALL); break;
+        case 3:
+          if (buf->alt_screen != NULL)
+            VTermScrollbackClear(buf->scrollback);
+          break;
       }
       goto success;
     case 'K':
       // we don't support selective erase for now, go to success
-      if (escape[0] == '?')
+      if (private)
         goto success;
-
-      if (args.count == 0) // default: erase below
-        dir = VTERM_RESET_BUFFER_DATA_FORWARDS;
-      else if (args.args[0][0] == '0')
-        dir = VTERM_RESET_BUFFER_DATA_FORWARDS;
-      else if (args.args[0][0] == '1')
-        dir = VTERM_RESET_BUFFER_DATA_BACKWARDS;
-      else if (args.args[0][0] == '2')
-        dir = VTERM_RESET_BUFFER_DATA_ALL;
-      
-      if (!VTermResetBufferData(buf, buf->row, buf->col, dir))
+      switch (count ? params[0] : 0)
       {
-        VTermError("VTermResetBufferData(buf, buf->row, buf->col, dir)");
-        return false;
+        case 0: VTermEraseCells(buf, buf->row, buf->col, buf->column_count); break;
+        case 1: VTermEraseCells(buf, buf->row, 0, buf->col + 1); break;
+        case 2: VTermEraseCells(buf, buf->row, 0, buf->column_count); break;
       }
       goto success;
+    case 'r': // DECSTBM
+    {
+      if (private)
+        goto success;
+      uint16_t t = VTermParam(params, count, 0, 1), b = VTermParam(params, count, 1, buf->row_count);
+      if (t < b && b <= buf->row_count)
+      {
+        buf->scroll_top = t - 1;
+        buf->scroll_bottom = b;
+        VTermMoveCursor(buf, 0, 0);
+      }
+      goto success;
+    }
+    case 'L': // IL
+    case 'M': // DL
+      if (buf->row >= buf->scroll_top && buf->row < buf->scroll_bottom)
+      {
+        int lines = escape[escape_len - 1] == 'L' ? -n : n;
+        VTermShiftRows(buf, buf->row, buf->scroll_bottom, lines, false); // deleted, not scrolled off
+        VTermMoveCursor(buf, buf->row, 0);
+      }
+      goto success;
+    case 'S': // SU
+      VTermScrollRegion(buf, buf->scroll_top, buf->scroll_bottom, n);
+      goto success;
+    case 'T': // SD (with more params it is mouse highlight tracking)
+      if (count <= 1)
+        VTermScrollRegion(buf, buf->scroll_top, buf->scroll_bottom, -n);
+      goto success;
+    case '@': // ICH
+      VTermShiftCells(buf, n);
+      goto success;
+    case 'P': // DCH
+      VTermShiftCells(buf, -n);
+      goto success;
+    case 'X': // ECH
+      VTermEraseCells(buf, buf->row, buf->col, buf->col + n);
+      goto success;
+    case 's': // SCOSC
+      if (private)
+        goto success;
+      buf->saved_row = buf->row;
+      buf->saved_col = buf->col;
+      goto success;
+    case 'u': // SCORC
+      if (private)
+        goto success;
+      VTermMoveCursor(buf, buf->saved_row, buf->saved_col);
+      goto success;
     case 'h':
       high = true;
     case 'l':
       if (escape[0] == '?')
       {
         VTermGetEscapeCodeArgs(&args, escape + 1, escape_len - 2);
-        if (args.count > 0)
+        for (int i = 0; i < args.count; i++)
         {
           uint32_t n;
-          sscanf(args.args[0], "%d", &n);
+          sscanf(args.args[i], "%d", &n);
           switch (n)
           {
+            case 1:
+              if (high) buf->parser->dec_modes |= VTERM_DEC_CURSOR_KEYS;
+              else buf->parser->dec_modes &= ~VTERM_DEC_CURSOR_KEYS;
+              break;
+            case 4:
+              if (high) buf->parser->dec_modes |= VTERM_DEC_SMOOTH_SCROLL;
+              else buf->parser->dec_modes &= ~VTERM_DEC_SMOOTH_SCROLL;
+              break;
+            case 2004:
+              if (high) buf->parser->dec_modes |= VTERM_DEC_BRACKETED_PASTE;
+              else buf->parser->dec_modes &= ~VTERM_DEC_BRACKETED_PASTE;
+              break;
+            case 2026:
+              if (high && !(buf->parser->dec_modes & VTERM_DEC_SYNC_OUTPUT))
+                buf->parser->sync_start = GetTime();
+              if (high) buf->parser->dec_modes |= VTERM_DEC_SYNC_OUTPUT;
+              else buf->parser->dec_modes &= ~VTERM_DEC_SYNC_OUTPUT;
+              break;
             case 1047:
             case 1049:
               if (high)
@@ -489,44 +1162,198 @@ bool VTermExecuteEscapeCode(VTerm *vt, char *escape, int escape_len)
                   pbuf->alt_buffer = NULL;
                 }
               }
+              buf = VTermGetCurrentBuffer(vt);
+              break;
           }
         }
       }
       goto success;
     case 'm':
-      if (args.count > 0)
-      {
-        for (int i = 0; i < args.count; i++)
-        {
-          uint32_t n, m10;
-          sscanf(args.args[i], "%d", &n);
-          m10 = n % 10;
-
-          if (n == 0)
-            buf->fgbg_color = buf->default_fgbg;
-          else if (m10 <= 7 && n - m10 == 30)
-            buf->fgbg_color = (uint64_t) VTermANSIColors[n % 10] << 32 | (buf->fgbg_color & 0xffffffff);
-          else if (m10 <= 7 && n - m10 == 40)
-            buf->fgbg_color = (uint64_t) (buf->fgbg_color & ((uint64_t) 0xffffffff << 32)) | VTermANSIColors[n % 10];
-        }
-      }
-
+      VTermSelectGraphicRendition(buf, escape, escape_len - 1);
       goto success;
+    case 'p': // DECRQM, CSI ? Ps $ p: is a private mode set
+    {
+      if (escape[0] != '?' || escape_len < 3 || escape[escape_len - 2] != '$')
+        return false;
+      int mode = atoi(escape + 1), state = 0; // 0 unknown, 1 set, 2 reset
+      uint32_t bit = mode == 1 ? VTERM_DEC_CURSOR_KEYS : mode == 4 ? VTERM_DEC_SMOOTH_SCROLL
+                   : mode == 2004 ? VTERM_DEC_BRACKETED_PASTE : mode == 2026 ? VTERM_DEC_SYNC_OUTPUT : 0;
+      if (bit != 0)
+        state = buf->parser->dec_modes & bit ? 1 : 2;
+      else if (mode == 1047 || mode == 1049)
+        state = VTermInAlternateBuffer(vt) ? 1 : 2;
+      char reply[32];
+      VTermRingPush(buf->out, reply, sprintf(reply, "\33[?%d;%d$y", mode, state));
+      goto success;
+    }
     default:
       return false;
   }
 success:
+#ifdef VTERM_DEBUG_ESCAPES
   VTermPrintEscapeCode(escape, &args);
+#endif
   return true;
 }
 
-bool VTermUpdate(VTerm *vt)
+static void VTermExecuteEscape(VTermDataBuffer *buf, uint8_t ch)
+/* Two byte ESC sequences */
+{
+  switch (ch)
+  {
+    case 'D': // IND
+      VTermLineFeed(buf);
+      break;
+    case 'E': // NEL
+      buf->col = 0;
+      VTermLineFeed(buf);
+      break;
+    case 'M': // RI
+      VTermReverseIndex(buf);
+      break;
+    case '7': // DECSC
+      buf->saved_row = buf->row;
+      buf->saved_col = buf->col;
+      break;
+    case '8': // DECRC, clamped like CSI u and ends a pending wrap
+      VTermMoveCursor(buf, buf->saved_row, buf->saved_col);
+      break;
+  }
+}
+
+bool VTermProcessByte(VTerm *vt, uint8_t ch)
+/* Feed one byte from the pty into the current buffer */
+{
+  VTermDataBuffer *buf = VTermGetCurrentBuffer(vt);
+  VTermParser *p = buf->parser;
+
+  /* APC strings (images) are streamed to their handler up to ST */
+  if (p->apc)
+  {
+    VTermImageByte(vt, buf, ch);
+    return true;
+  }
+  /* Other strings (OSC, DCS, SOS, PM) too, VTermProcessBytes hands them runs */
+  if (p->string && VTermStringBytes(vt, buf, &ch, 1) > 0)
+    return true;
+
+  /* Inside CSI: collect up to the final byte (0x40-0x7E), then run it
+   * whether we know it or not so unknown sequences never leak as text */
+  if (p->escape_ix >= 0 && ch != '\33')
+  {
+    if (p->escape_ix < VTERM_ESCAPE_MAX - 1)
+      p->escape_buf[p->escape_ix++] = ch;
+    else
+      p->escape_ix = VTERM_ESCAPE_MAX; // too long, swallow it
+    if (ch >= 0x40 && ch <= 0x7e)
+    {
+      if (p->escape_ix < VTERM_ESCAPE_MAX)
+      {
+        VTermStats.csi_finals[ch - 0x40]++;
+        if (!VTermExecuteEscapeCode(vt, p->escape_buf, p->escape_ix))
+          VTermStats.csi_unknown++;
+      }
+      memset(p->escape_buf, 0, VTERM_ESCAPE_MAX);
+      p->escape_ix = -1;
+    }
+    // escapes don't affect cursor
+    return true;
+  }
+  if (p->escapeIntermediate)
+  {
+    /* ESC ( B and friends (charsets), ignored up to their final byte */
+    if (ch >= 0x30 && ch <= 0x7e)
+      p->escapeIntermediate = false;
+    return true;
+  }
+  if (p->previousWasEscape && ch != '[' && ch != '\33')
+  {
+    p->previousWasEscape = false;
+    if (ch == '_')
+      p->apc = true;
+    else if (ch == ']' || ch == 'P' || ch == 'X' || ch == '^')
+      VTermStringBegin(buf, ch);
+    else if (ch >= 0x20 && ch <= 0x2f)
+      p->escapeIntermediate = true;
+    else
+      VTermExecuteEscape(buf, ch);
+    return true;
+  }
+
+  switch (ch)
+  {
+    case '\r':
+      if (p->previousWasWrap)
+        p->previousWasCRAfterWrap = true;
+      buf->col = 0;
+      break;
+    case '\n':
+      if (!p->previousWasWrap && !p->previousWasCRAfterWrap)
+        VTermLineFeed(buf);
+      break;
+    case '\b':
+      if (buf->col > 0)
+        buf->col--;
+      break;
+    case '\t':
+    {
+      uint16_t n = buf->column_count - buf->col < 4 ? buf->column_count - buf->col : 4;
+      memset(VTermRowData(buf, buf->row) + buf->col, 32, n);
+      buf->row_flags[buf->row] |= VTERM_ROW_DIRTY;
+      buf->col += n;
+      break;
+    }
+    case '\v':
+      memset(VTermRowData(buf, buf->row) + buf->col, 32, buf->column_count - buf->col);
+      buf->row_flags[buf->row] |= VTERM_ROW_DIRTY;
+      VTermLineFeed(buf);
+      break;
+    case '\a':
+      VTermBell(); // shown by VTermDraw, never blocks here
+      break;
+    case '\33':
+      p->previousWasEscape = true;
+      p->escapeIntermediate = false;
+      p->escape_ix = -1; // ESC cancels a sequence in progress
+      return true; // not affect buffer/cursor
+    case '[':
+      if (p->previousWasEscape)
+      {
+        p->escape_ix = 0;
+        p->previousWasEscape = false;
+        return true; // don't affect buffer/cursor
+      }
+    default:
+      VTermRowData(buf, buf->row)[buf->col] = ch;
+      VTermRowColors(buf, buf->row)[buf->col] = buf->fgbg_color;
+      buf->row_flags[buf->row] |= VTERM_ROW_DIRTY;
+      buf->col++;
+      VTermStats.cells_written++;
+  }
+
+  if (buf->col >= buf->column_count)
+  {
+    buf->row_flags[buf->row] |= VTERM_ROW_WRAPPED;
+    buf->col = 0;
+    VTermLineFeed(buf);
+    p->previousWasWrap = true;
+  } else {
+    p->previousWasWrap = false;
+  }
+
+  if (p->previousWasCRAfterWrap && ch != '\r')
+    p->previousWasCRAfterWrap = false;
+  return true;
+}
+
+static bool VTermUpdateSession(VTerm *vt)
+/* Reads and parses the current session's pty */
 {
   // TODO: check whether pty mode or not
   // TODO: key inputs
   VTermDataBuffer *buf = VTermGetCurrentBuffer(vt);
   VTermPTY *pty = buf->pty;
-  char char_buf[1];
+  VTermRing *in = buf->in;
 
   /* make sure tv is not NULL, as o/w select blocks indefinitely */
   struct timeval tv;
@@ -550,115 +1377,205 @@ bool VTermUpdate(VTerm *vt)
     return false;
   }
 
-  /* If master is in fact readable, read from it */
+  /* If master is in fact readable, fill the ring with whatever is there */
+  VTermDataBuffer *pbuf = VTermGetCurrentPrincipalBuffer(vt);
   if (FD_ISSET(pty->master, &readable))
-  // if (true)
   {
-    if (read(pty->master, char_buf, 1) <= 0)
+    ssize_t n = VTermRingFill(in, pty->master);
+    if (n == 0 || (n == -1 && errno != EAGAIN && errno != EINTR))
     {
       VTermError("Child empty");
       return false;
     }
-
-    // TODO: check for special characters
-    //
-    // printf("Received: '%c' = #%d\tPWrap: %s\tPEsc: %s\tPCRAW: %s\tInEsc: %s\n",
-    //        char_buf[0], char_buf[0],
-    //        previousWasWrap ? "true" : "false",
-    //        previousWasEscape ? "true" : "false",
-    //        previousWasCRAfterWrap ? "true" : "false",
-    //        currentEscapeIx >= 0 ? "true" : "false"
-    // );
-    // printf("Received %d\n", char_buf[0]);
-    switch (char_buf[0])
+    if (n > 0)
     {
-      case '\r':
-        if (previousWasWrap)
-          previousWasCRAfterWrap = true;
-        buf->col = 0;
-        break;
-      case '\n':
-        if (!previousWasWrap && !previousWasCRAfterWrap)
-          buf->row++;
-        break;
-      case '\b':
-        buf->col--;
-        break;
-      case '\t':
-        memset(buf->data + buf->column_count * buf->row + buf->col, 32, 4);
-        buf->col+= 4;
-        break;
-      case '\v':
-        memset(buf->data + buf->column_count * buf->row + buf->col, 32, buf->column_count);
-        buf->row++;
-        break;
-      case '\a':
-        // TODO: good bell, allow for playing sound using esc codes
-        system("osascript -e 'beep'");
-        break;
-      case '\33':
-        // puts("ESCAPE CODE");
-        previousWasEscape = true;
-        return true; // not affect buffer/cursor
-      case '[':
-        if (previousWasEscape)
-        {
-          currentEscapeIx = 0;
-          previousWasEscape = false;
-          return true; // don't affect buffer/cursor
-        }
-      default:
-        // If in escape (currEscIx >= 0)
-        if (currentEscapeIx >= 0)
-        {
-          if (currentEscapeIx >= 32)
-            currentEscapeIx = -1;
-          else {
-            currentEscapeBuf[currentEscapeIx++] = char_buf[0];
-            if (VTermExecuteEscapeCode(vt, currentEscapeBuf, currentEscapeIx))
-            {
-              memset(currentEscapeBuf, 0, 32);
-              currentEscapeIx = -1;
-            }
-          }
-          // escapes don't affect cursor
-          return true;
-        } else {
-          // Else: store in data buffer
-          buf->data[buf->col + buf->column_count * buf->row] = char_buf[0];
-          buf->fgbg_colors[buf->col + buf->column_count * buf->row] = buf->fgbg_color;
-          buf->col++;
-        }
+      int bucket = 0;
+      while (bucket < VTERM_READ_BUCKETS - 1 && (n >> (bucket + 1)) != 0)
+        bucket++;
+      VTermStats.read_sizes[bucket]++;
+      VTermStats.pty_reads++;
+      VTermStats.pty_bytes += n;
+    }
+    if (n > 0 && pbuf->probe_key != 0 && pbuf->probe_echo == 0)
+    {
+      pbuf->probe_echo = GetTime();
+      VTermHistAdd(&VTermStats.echo_latency, pbuf->probe_echo - pbuf->probe_key);
     }
+  }
 
-    if (char_buf[0] != '\33' && previousWasEscape)
-      previousWasEscape = false;
+  /* Parse everything buffered, the ring is shared with the alt screen so
+   * switching buffers mid-chunk is fine */
+  size_t pending = VTermRingUsed(in);
+  double parse_start = pending > 0 ? GetTime() : 0;
+  if (pending > 0)
+    vt->busy = true;
+  if (!VTermProcessRing(vt, in))
+    return false;
+  if (pending > 0)
+  {
+    double now = GetTime();
+    VTermStats.bytes_parsed += pending;
+    VTermStats.parse_seconds += now - parse_start;
+    if (vt->output_parsed == 0)
+      vt->output_parsed = now;
+  }
 
-    if (buf->col >= buf->column_count)
+  if (pbuf->probe_echo != 0 && pbuf->probe_parsed == 0)
+  {
+    pbuf->probe_parsed = GetTime();
+    VTermHistAdd(&VTermStats.parse_latency, pbuf->probe_parsed - pbuf->probe_key);
+  }
+  return true;
+}
+
+bool VTermUpdate(VTerm *vt)
+/* The current session, or with panes each of them in turn: the parser acts
+ * on the current buffer, so buffer_ix points at the pane being parsed. A
+ * pane whose child went away is closed, the last one ends the program. */
+{
+  VTermReapChildren();
+  if (vt->pane_count == 0)
+    return VTermUpdateSession(vt);
+
+  uint16_t focus = vt->buffer_ix;
+  for (int p = 0; p < vt->pane_count; p++)
+  {
+    vt->buffer_ix = vt->panes[p].buffer_ix;
+    if (VTermUpdateSession(vt))
+      continue;
+    uint16_t gone = vt->buffer_ix;
+    vt->buffer_ix = focus;
+    if (!VTermClosePane(vt, gone))
+      return false;
+    focus = vt->buffer_ix; // moved off gone if it had the focus
+    p--;                   // the panes after it moved down one
+  }
+  vt->buffer_ix = focus;
+  return true;
+}
+
+// Frames start this long before the predicted swap, on top of the work
+#define VTERM_FRAME_MARGIN 0.001
+
+int VTermWakeFds(VTerm *vt, fd_set *set)
+/* What output for the next frame arrives on: the pty, every pane's, or the
+ * server. Adds them to set, returns the highest (-1 for none). */
+{
+  int max = -1;
+
+  if (vt->server_fd != -1)
+  {
+    FD_SET(vt->server_fd, set);
+    return vt->server_fd;
+  }
+  for (int p = 0; p < (vt->pane_count > 0 ? vt->pane_count : 1); p++)
+  {
+    uint16_t ix = vt->pane_count > 0 ? vt->panes[p].buffer_ix : vt->buffer_ix;
+    int fd = vt->buffers[ix]->pty->master;
+    if (fd == -1)
+      continue;
+    FD_SET(fd, set);
+    max = fd > max ? fd : max;
+  }
+  return max;
+}
+
+void VTermWaitFrame(VTerm *vt)
+/* Frame pacer: sleep on the pty until the latest point we can still build a
+ * frame in time for the next vblank (predicted from the last swap and how
+ * long frames have been taking). Output from the child wakes us early. */
+{
+  VTermDataBuffer *buf = VTermGetCurrentBuffer(vt);
+  int hz = GetMonitorRefreshRate(GetCurrentMonitor());
+  double period = 1.0 / (hz > 0 ? hz : 60);
+  double wake = vt->frame_present + period - vt->frame_work - VTERM_FRAME_MARGIN;
+  double now = GetTime();
+
+  /* After an idle wait the last swap says nothing about vblank phase */
+  if (vt->idle)
+    wake = now;
+  /* Holding for a synchronized update: nothing to pace, sleep until the app
+   * writes (its end marker, hopefully) or a frame's worth of input is due */
+  if (vt->held)
+  {
+    double timeout = period;
+    for (int p = 0; p < (vt->pane_count > 0 ? vt->pane_count : 1); p++)
     {
-      buf->col = 0;
-      buf->row++;
-      previousWasWrap = true;
-    } else {
-      previousWasWrap = false;
+      VTermParser *parser = vt->pane_count > 0 ? vt->buffers[vt->panes[p].buffer_ix]->parser : buf->parser;
+      if ((parser->dec_modes & VTERM_DEC_SYNC_OUTPUT) && parser->sync_start + VTERM_SYNC_TIMEOUT - now < timeout)
+        timeout = parser->sync_start + VTERM_SYNC_TIMEOUT - now;
     }
-  
-    if (previousWasCRAfterWrap && char_buf[0] != '\r')
-      previousWasCRAfterWrap = false;
+    wake = now + timeout;
+  }
+  vt->busy = false;
 
-    if (buf->row >= buf->row_count)
-    {
-      memmove(buf->data, buf->data + buf->column_count, buf->buffer_size - buf->column_count);
-      memset(buf->data + buf->buffer_size - buf->column_count, 0, buf->column_count);
+  fd_set readable;
+  FD_ZERO(&readable);
+  int fd = VTermWakeFds(vt, &readable);
+  if (wake > now && fd != -1 && VTermRingUsed(buf->in) == 0)
+  {
+    struct timeval tv;
+    double timeout = wake - now;
+    tv.tv_sec = (time_t)timeout;
+    tv.tv_usec = (suseconds_t)((timeout - tv.tv_sec) * 1e6);
+    select(fd + 1, &readable, NULL, NULL, &tv);
+  }
+  vt->frame_start = GetTime();
+}
 
-      memmove(buf->fgbg_colors, buf->fgbg_colors + buf->column_count, sizeof(uint64_t)*(buf->buffer_size - buf->column_count));
-      memset(buf->fgbg_colors + buf->buffer_size - buf->column_count, buf->default_fgbg, sizeof(uint64_t)*buf->column_count);
-      buf->row--;
-    }
+bool VTermSyncHeld(VTermParser *parser, double now)
+/* True while the app is between ?2026h and ?2026l. Past VTERM_SYNC_TIMEOUT
+ * the mode is dropped and the update shows as far as it got. */
+{
+  if (!(parser->dec_modes & VTERM_DEC_SYNC_OUTPUT))
+    return false;
+  if (now - parser->sync_start > VTERM_SYNC_TIMEOUT)
+  {
+    parser->dec_modes &= ~VTERM_DEC_SYNC_OUTPUT;
+    VTermStats.sync_timeouts++;
+    return false;
   }
   return true;
 }
 
+bool VTermHoldFrame(VTerm *vt)
+/* Call after VTermUpdate(): true while the app is between ?2026h and ?2026l,
+ * then the caller skips the whole frame (no draw, no swap) and damage keeps
+ * adding up, so the update shows in one go. With panes each one is held on
+ * its own (VTermDrawPanes), the frame only when no other has changes. */
+{
+  vt->held = false;
+  if (vt->pane_count > 0 ? !VTermPanesHeld(vt) : !VTermSyncHeld(VTermGetCurrentBuffer(vt)->parser, GetTime()))
+    return false;
+  VTermStats.frames_held++;
+  vt->held = true;
+  return true;
+}
+
+void VTermFramePresented(VTerm *vt)
+/* Call right after EndDrawing() */
+{
+  VTermDataBuffer *pbuf = VTermGetCurrentPrincipalBuffer(vt);
+  double now = GetTime();
+
+  if (vt->frame_present != 0)
+    VTermHistAdd(&VTermStats.frame_time, now - vt->frame_present);
+  if (vt->frame_drawn > vt->frame_start)
+    vt->frame_work = 0.9 * vt->frame_work + 0.1 * (vt->frame_drawn - vt->frame_start);
+  vt->frame_present = now;
+
+  if (pbuf->probe_parsed != 0)
+    VTermHistAdd(&VTermStats.present_latency, now - pbuf->probe_key);
+  /* Keys with no visible echo (or none yet after 1s) end the probe too */
+  if (pbuf->probe_parsed != 0 || (pbuf->probe_key != 0 && now - pbuf->probe_key > 1.0))
+    pbuf->probe_key = pbuf->probe_echo = pbuf->probe_parsed = 0;
+
+  if (vt->output_parsed != 0)
+    VTermHistAdd(&VTermStats.output_latency, now - vt->output_parsed);
+  vt->output_parsed = 0;
+  VTermMetricsTick(now);
+}
+
 bool VTermIsTextMode(VTermDataBuffer *buf)
 {
   switch (buf->mode)
@@ -674,90 +1591,904 @@ bool VTermIsTextMode(VTermDataBuffer *buf)
   }
 }
 
-bool VTermDrawText(VTermDataBuffer *buf)
-/* Adapted from Raylib's DrawTextEx */
+typedef struct {
+  Rectangle rec;
+  uint32_t color;
+  bool pending;
+} VTermRectRun;
+
+static void VTermFlushRect(VTermRectRun *run)
 {
-  int textLineSpacing = 0;
-  Font font = buf->font;
-  Vector2 position = (Vector2){0, 0};
-  float fontSize = buf->font_size;
-  float spacing = 0;
+  if (!run->pending)
+    return;
+  DrawRectangleRec(run->rec, *(Color *)&run->color);
+  VTermStats.frame_rects++;
+  run->pending = false;
+}
 
-  uint32_t default_bg = UNPACK_bg(buf->default_fgbg);
-  if (font.texture.id == 0) font = GetFontDefault();  // Security check in case of not valid font
+static void VTermQueueRect(VTermRectRun *run, float x, float y, float w, float h, uint32_t color)
+/* Stacks a run straight under the previous one of the same span/colour
+ * into one rectangle (whole rows of the same background) */
+{
+  if (run->pending && run->color == color && run->rec.x == x && run->rec.width == w
+      && run->rec.y + run->rec.height == y)
+  {
+    run->rec.height += h;
+    return;
+  }
+  VTermFlushRect(run);
+  run->rec = (Rectangle){ x, y, w, h };
+  run->color = color;
+  run->pending = true;
+}
 
-  float textOffsetY = 0;          // Offset between lines (on linebreak '\n')
-  float textOffsetX = 0.0f;       // Offset X to next character to draw
+/* Row kernels: text writes and both draw passes, compiled once per common
+ * text mode width and once for any width. The buffer picks its entry when
+ * it is carved, which is whenever its mode or geometry changes. */
+struct VTermKernels {
+  uint16_t column_count; // 0: any
+  size_t (*write_text)(VTermDataBuffer *, const uint8_t *, size_t);
+  void (*draw_backgrounds)(VTermDataBuffer *, int, int, VTermRectRun *);
+  void (*draw_glyphs)(VTermDataBuffer *, Font, int, int);
+};
+
+#define VTERM_KERNEL(name) VTermKernel##name##40
+#define VTERM_KERNEL_COLS 40
+#include "vterm_kernels.h"
+#undef VTERM_KERNEL
+#undef VTERM_KERNEL_COLS
+
+#define VTERM_KERNEL(name) VTermKernel##name##80
+#define VTERM_KERNEL_COLS 80
+#include "vterm_kernels.h"
+#undef VTERM_KERNEL
+#undef VTERM_KERNEL_COLS
+
+#define VTERM_KERNEL(name) VTermKernel##name##Any
+#define VTERM_KERNEL_COLS 0
+#include "vterm_kernels.h"
+#undef VTERM_KERNEL
+#undef VTERM_KERNEL_COLS
+
+static const VTermKernels VTermKernelTable[] = {
+  { 40, VTermKernelWriteText40, VTermKernelDrawBackgrounds40, VTermKernelDrawGlyphs40 },
+  { 80, VTermKernelWriteText80, VTermKernelDrawBackgrounds80, VTermKernelDrawGlyphs80 },
+  { 0, VTermKernelWriteTextAny, VTermKernelDrawBackgroundsAny, VTermKernelDrawGlyphsAny },
+};
+
+const VTermKernels *VTermSelectKernels(uint16_t column_count, bool specialised)
+/* The kernels for a grid this wide, the generic ones unless specialised */
+{
+  size_t n = sizeof(VTermKernelTable) / sizeof(VTermKernelTable[0]);
+  for (size_t i = 0; specialised && i < n - 1; i++)
+    if (VTermKernelTable[i].column_count == column_count)
+      return &VTermKernelTable[i];
+  return &VTermKernelTable[n - 1];
+}
 
-  float scaleFactor = fontSize/font.baseSize;         // Character quad scaling factor
+/* Jump scroll. Plain text (printable bytes, CR, LF, SGR) only moves the
+ * cursor forward, so a line is final once the cursor leaves it. At the
+ * bottom of the scroll region with more lines coming than the region holds,
+ * everything on screen is going to scroll out, and so are all but the last
+ * region's worth of the new lines: those are laid out in a row of their own
+ * and go straight to the history, and the grid scrolls once. DECSCLM (?4h)
+ * turns it off. */
+static struct {
+  uint8_t *data;
+  uint64_t *colors;
+  uint16_t cols;
+} VTermJumpRow;
+
+typedef struct {
+  uint16_t col;
+  bool wrap, cr_after_wrap; // VTermParser's previousWasWrap/previousWasCRAfterWrap
+} VTermJumpCursor;
+
+static inline int VTermJumpStep(VTermJumpCursor *c, uint8_t ch, uint16_t cols)
+/* VTermProcessByte's cursor rules for plain text: 1 when ch leaves the line
+ * (a line feed or a wrap), -1 when ch isn't plain text */
+{
+  if (ch == '\r')
+  {
+    c->cr_after_wrap |= c->wrap;
+    c->wrap = false;
+    c->col = 0;
+    return 0;
+  }
+  if (ch == '\n')
+  {
+    int feed = !c->wrap && !c->cr_after_wrap;
+    c->wrap = c->cr_after_wrap = false;
+    return feed;
+  }
+  if (ch < 0x20)
+    return -1;
+  c->cr_after_wrap = false;
+  c->wrap = ++c->col >= cols;
+  if (c->wrap)
+    c->col = 0;
+  return c->wrap;
+}
+
+static size_t VTermJumpSGR(const uint8_t *bytes, size_t len)
+/* Length of the SGR (ESC [ digits ; : m) at bytes, 0 if there isn't a whole
+ * one. Colours don't move the cursor, logs are full of them. */
+{
+  size_t n = 2;
+  if (len < 3 || bytes[0] != '\33' || bytes[1] != '[')
+    return 0;
+  while (n < len && n < VTERM_ESCAPE_MAX && ((bytes[n] >= '0' && bytes[n] <= '9') || bytes[n] == ';' || bytes[n] == ':'))
+    n++;
+  return n < len && bytes[n] == 'm' ? n + 1 : 0;
+}
 
-  for (int i = 0; i < buf->buffer_size;)
+static size_t VTermJumpScroll(VTerm *vt, VTermDataBuffer *buf, const uint8_t *bytes, size_t len, size_t *plain)
+/* With the cursor on the region's last row: takes the plain text ahead up
+ * to the line the region will start with, if that skips the grid at least
+ * a region's worth of scrolls. Returns what it took (0: not worth it) and
+ * how much plain text there was in *plain. */
+{
+  VTermParser *p = buf->parser;
+  VTermScrollback *sb = buf->scrollback;
+  uint16_t top = buf->scroll_top, height = buf->scroll_bottom - buf->scroll_top, cols = buf->column_count;
+  VTermJumpCursor c = { buf->col, p->previousWasWrap, p->previousWasCRAfterWrap };
+  size_t first = 0, n = 0, feeds = 0;
+
+  for (; n < len; n++)
+  {
+    size_t sgr = bytes[n] == '\33' ? VTermJumpSGR(bytes + n, len - n) : 0;
+    if (sgr > 0)
+    {
+      n += sgr - 1;
+      continue;
+    }
+    int step = VTermJumpStep(&c, bytes[n], cols);
+    if (step < 0)
+      break;
+    if (step && feeds++ == 0)
+      first = n;
+  }
+  *plain = n;
+  if (feeds < height)
+    return 0;
+
+  /* Up to the first feed it is the cursor row, then the whole region goes */
+  for (n = 0; n < first; n++)
+    VTermProcessByte(vt, bytes[n]);
+  c = (VTermJumpCursor){ buf->col, p->previousWasWrap, p->previousWasCRAfterWrap };
+  if (bytes[first] >= 0x20)
+  {
+    VTermRowData(buf, buf->row)[buf->col] = bytes[first];
+    VTermRowColors(buf, buf->row)[buf->col] = buf->fgbg_color;
+    buf->row_flags[buf->row] |= VTERM_ROW_DIRTY | VTERM_ROW_WRAPPED;
+    VTermStats.cells_written++;
+  }
+  VTermJumpStep(&c, bytes[first], cols);
+  VTermScrollRegion(buf, top, top + height, height);
+
+  /* The lines in between never reach the grid */
+  bool keep = top == 0 && buf->alt_screen != NULL && sb->fd != -1; // as VTermScrollRegion
+  if (keep && VTermJumpRow.cols < cols)
+  {
+    free(VTermJumpRow.data);
+    free(VTermJumpRow.colors);
+    VTermJumpRow.data = (uint8_t *)malloc(cols);
+    VTermJumpRow.colors = (uint64_t *)malloc(cols * sizeof(uint64_t));
+    VTermJumpRow.cols = VTermJumpRow.data && VTermJumpRow.colors ? cols : 0;
+    keep = VTermJumpRow.cols != 0;
+  }
+  if (keep)
+  {
+    memset(VTermJumpRow.data, 0, cols);
+    nmemset64(VTermJumpRow.colors, buf->default_fgbg, cols);
+  }
+  size_t skip = feeds - height;
+  for (n = first + 1; skip > 0; n++)
   {
-    // Get next codepoint from byte string and glyph index in font
-    if (buf->data[i] == 0) { i++; continue; }
-    int codepointByteCount = 0;
-    int codepoint = GetCodepointNext((const char *)(buf->data + i), &codepointByteCount);
-    uint32_t fg = UNPACK_fg(buf->fgbg_colors[i]);
-    uint32_t bg = UNPACK_bg(buf->fgbg_colors[i]);
-    Color tint = *(Color*)&fg;
-    Color back = *(Color*)&bg;
-    int index = GetGlyphIndex(font, codepoint);
+    uint8_t ch = bytes[n];
+    size_t sgr = ch == '\33' ? VTermJumpSGR(bytes + n, len - n) : 0;
+    if (sgr > 0)
+    {
+      VTermStats.csi_finals['m' - 0x40]++;
+      VTermSelectGraphicRendition(buf, (const char *)bytes + n + 2, sgr - 3);
+      n += sgr - 1;
+      continue;
+    }
+    if (ch >= 0x20)
+    {
+      if (keep)
+      {
+        VTermJumpRow.data[c.col] = ch;
+        VTermJumpRow.colors[c.col] = buf->fgbg_color;
+      }
+      VTermStats.cells_written++;
+    }
+    if (VTermJumpStep(&c, ch, cols) == 0)
+      continue;
+    skip--;
+    if (!keep)
+      continue;
+    VTermScrollbackPush(sb, VTermJumpRow.data, VTermJumpRow.colors, cols, buf->default_fgbg,
+                        c.wrap ? VTERM_ROW_WRAPPED : 0);
+    if (sb->view > 0 && sb->view < sb->lines)
+      sb->view++;
+    memset(VTermJumpRow.data, 0, cols);
+    nmemset64(VTermJumpRow.colors, buf->default_fgbg, cols);
+  }
+  VTermStats.scrolled_lines += feeds - height;
+  VTermStats.jumped_lines += feeds - height;
+
+  buf->row = top;
+  buf->col = c.col;
+  p->previousWasWrap = c.wrap;
+  p->previousWasCRAfterWrap = c.cr_after_wrap;
+  return n;
+}
 
-    if (i != 0 && i % buf->column_count == 0)
+bool VTermProcessBytes(VTerm *vt, const uint8_t *bytes, size_t len)
+/* VTermProcessByte over a chunk, runs of text outside sequences go to the
+ * buffer's write kernel a row at a time */
+{
+  size_t i = 0, plain_end = 0;
+  while (i < len)
+  {
+    VTermDataBuffer *buf = VTermGetCurrentBuffer(vt); // sequences switch screens
+    VTermParser *p = buf->parser;
+    if (p->string)
+    {
+      size_t n = VTermStringBytes(vt, buf, bytes + i, len - i);
+      i += n;
+      if (n > 0)
+        continue;
+    }
+    bool ground = !p->apc && !p->string && p->escape_ix < 0 && !p->escapeIntermediate && !p->previousWasEscape;
+    /* Scanning plain text once is enough, the cursor is back here at its end */
+    if (ground && i >= plain_end && buf->row + 1 == buf->scroll_bottom && !(p->dec_modes & VTERM_DEC_SMOOTH_SCROLL))
+    {
+      size_t plain, n = VTermJumpScroll(vt, buf, bytes + i, len - i, &plain);
+      plain_end = i + plain;
+      i += n;
+      if (n > 0)
+        continue;
+    }
+    if (bytes[i] >= 0x20 && ground)
     {
-      textOffsetY += (fontSize + textLineSpacing);
-      textOffsetX = 0.0f;
+      size_t n = buf->kernels->write_text(buf, bytes + i, len - i);
+      i += n;
+      if (n > 0)
+        continue;
     }
+    if (!VTermProcessByte(vt, bytes[i++]))
+      return false;
+  }
+  return true;
+}
+
+bool VTermProcessRing(VTerm *vt, VTermRing *in)
+/* Everything buffered in the ring, in its contiguous spans */
+{
+  while (VTermRingUsed(in) > 0)
+  {
+    size_t at = in->head & (in->size - 1);
+    size_t n = in->size - at < VTermRingUsed(in) ? in->size - at : VTermRingUsed(in);
+    in->head += n;
+    if (!VTermProcessBytes(vt, in->data + at, n))
+      return false;
+  }
+  return true;
+}
+
+bool VTermDrawText(VTermDataBuffer *buf)
+/* Every cell, every frame. Backgrounds go first in their own pass: mixing
+ * shapes and glyphs swaps textures and costs raylib a draw call per switch. */
+{
+  Font font = VTermGlyphFont(buf);
+  VTermRectRun run = { 0 };
+
+  for (int row = 0; row < buf->row_count; row++)
+    buf->kernels->draw_backgrounds(buf, row, row * buf->font_size, &run);
+  VTermFlushRect(&run);
+  for (int row = 0; row < buf->row_count; row++)
+    buf->kernels->draw_glyphs(buf, font, row, row * buf->font_size);
+  return true;
+}
+
+int VTermDrawDirtyRows(VTermDataBuffer *buf)
+/* Into a target still holding buf's last frame: each VTERM_ROW_DIRTY row
+ * over a strip of the default background, the flag is cleared. Returns how
+ * many rows that was. */
+{
+  Font font = VTermGlyphFont(buf);
+  int cell_h = buf->font_size, width = buf->column_count * VTermCellWidth(buf);
+  uint32_t bg = UNPACK_bg(buf->default_fgbg) | 0xff000000u; // opaque, the target is copied as is
+  VTermRectRun run = { 0 };
+  int drawn = 0;
+
+  for (int row = 0; row < buf->row_count; row++)
+  {
+    if (!(buf->row_flags[row] & VTERM_ROW_DIRTY))
+      continue;
+    DrawRectangle(0, row * cell_h, width, cell_h, *(Color *)&bg);
+    buf->kernels->draw_backgrounds(buf, row, row * cell_h, &run);
+    drawn++;
+  }
+  VTermFlushRect(&run);
+  for (int row = 0; row < buf->row_count; row++)
+  {
+    if (!(buf->row_flags[row] & VTERM_ROW_DIRTY))
+      continue;
+    buf->kernels->draw_glyphs(buf, font, row, row * cell_h);
+    buf->row_flags[row] &= ~VTERM_ROW_DIRTY;
+  }
+  return drawn;
+}
+
+/* Row cache: rasterized rows live in one render texture, a cell high slot
+ * each, found by their contents. Scrolling moves rows without changing
+ * them, so a scrolled frame is a quad per row plus the new row drawn glyph
+ * by glyph. Slots are reused least recently shown first, there are twice as
+ * many as rows so the previous screen fits next to the current one. */
+
+#define VTERM_ROW_CACHE_MAX_HEIGHT 8192 // atlas pixels, any GL 3.3 GPU has this
+#define VTERM_ROW_CACHE_EMPTY -1
+
+static struct {
+  RenderTexture2D atlas;
+  bool broken;           // no render texture here, VTermDrawText it is
+  int cols, cell_w, cell_h, slots;
+  unsigned int font;     // texture the slots were drawn with
+  uint64_t default_fgbg; // what slots are filled with under the cells
+  uint64_t clock;        // frames drawn through the cache
+  uint64_t *shown;       // per slot: clock when last on screen, 0 if free
+  uint64_t *hashes;      // per slot
+  uint8_t *keys;         // per slot: the row's cells, then its colors
+  size_t key_size;
+  int32_t *table;        // linear probing on the hash, slot or EMPTY
+  uint32_t table_mask;
+  int32_t *row_slots;    // per row of the frame being drawn
+  uint64_t *row_hashes;
+} VTermRowCache;
+
+void VTermRowCacheClose(void)
+{
+  if (VTermRowCache.atlas.id != 0)
+    UnloadRenderTexture(VTermRowCache.atlas);
+  free(VTermRowCache.shown);
+  free(VTermRowCache.hashes);
+  free(VTermRowCache.keys);
+  free(VTermRowCache.table);
+  free(VTermRowCache.row_slots);
+  free(VTermRowCache.row_hashes);
+  bool broken = VTermRowCache.broken;
+  memset(&VTermRowCache, 0, sizeof(VTermRowCache));
+  VTermRowCache.broken = broken;
+}
+
+static bool VTermRowCacheFit(VTermDataBuffer *buf, Font font)
+/* (Re)builds the atlas when the grid, cell size, font or colors changed */
+{
+  int cell_w = VTermCellWidth(buf), cell_h = buf->font_size;
+  if (VTermRowCache.atlas.id != 0 && VTermRowCache.cols == buf->column_count
+      && VTermRowCache.slots >= 2 * buf->row_count && VTermRowCache.cell_w == cell_w
+      && VTermRowCache.cell_h == cell_h && VTermRowCache.font == font.texture.id
+      && VTermRowCache.default_fgbg == buf->default_fgbg)
+    return true;
+
+  VTermRowCacheClose();
+  int slots = 2 * buf->row_count;
+  if (slots * cell_h > VTERM_ROW_CACHE_MAX_HEIGHT)
+    slots = VTERM_ROW_CACHE_MAX_HEIGHT / cell_h;
+  if (slots < buf->row_count)
+    return false; // huge cells, not worth it
+
+  uint32_t table_size = 1;
+  while (table_size < 2 * (uint32_t)slots)
+    table_size <<= 1;
+  VTermRowCache.key_size = (size_t)buf->column_count * (1 + sizeof(uint64_t));
+  VTermRowCache.shown = calloc(slots, sizeof(uint64_t));
+  VTermRowCache.hashes = calloc(slots, sizeof(uint64_t));
+  VTermRowCache.keys = malloc(slots * VTermRowCache.key_size);
+  VTermRowCache.table = malloc(table_size * sizeof(int32_t));
+  VTermRowCache.row_slots = malloc(buf->row_count * sizeof(int32_t));
+  VTermRowCache.row_hashes = malloc(buf->row_count * sizeof(uint64_t));
+  if (!VTermRowCache.shown || !VTermRowCache.hashes || !VTermRowCache.keys || !VTermRowCache.table
+      || !VTermRowCache.row_slots || !VTermRowCache.row_hashes)
+  {
+    VTermError("VTermRowCacheFit(malloc)");
+    VTermRowCacheClose();
+    return false;
+  }
+  for (uint32_t i = 0; i < table_size; i++)
+    VTermRowCache.table[i] = VTERM_ROW_CACHE_EMPTY;
+
+  VTermRowCache.atlas = LoadRenderTexture(buf->column_count * cell_w, slots * cell_h);
+  if (VTermRowCache.atlas.id == 0)
+  {
+    VTermError("LoadRenderTexture(row cache)");
+    VTermRowCache.broken = true;
+    VTermRowCacheClose();
+    return false;
+  }
+  VTermRowCache.table_mask = table_size - 1;
+  VTermRowCache.cols = buf->column_count;
+  VTermRowCache.cell_w = cell_w;
+  VTermRowCache.cell_h = cell_h;
+  VTermRowCache.slots = slots;
+  VTermRowCache.font = font.texture.id;
+  VTermRowCache.default_fgbg = buf->default_fgbg;
+  return true;
+}
 
+static uint64_t VTermRowHash(VTermDataBuffer *buf, int row)
+{
+  const uint8_t *data = VTermRowData(buf, row);
+  const uint64_t *colors = VTermRowColors(buf, row);
+  uint64_t h = 0x9e3779b97f4a7c15ull;
+  uint16_t col = 0;
+
+  for (; col + 8 <= buf->column_count; col += 8)
+  {
+    uint64_t w;
+    memcpy(&w, data + col, 8);
+    h = (h ^ w) * 0xff51afd7ed558ccdull;
+  }
+  for (; col < buf->column_count; col++)
+    h = (h ^ data[col]) * 0x100000001b3ull;
+  for (col = 0; col < buf->column_count; col++)
+    h = ((h ^ colors[col]) * 0xc4ceb9fe1a85ec53ull) ^ (h >> 29);
+  return h ^ (h >> 32);
+}
+
+static int32_t VTermRowCacheFind(VTermDataBuffer *buf, int row, uint64_t hash)
+{
+  uint32_t i = hash & VTermRowCache.table_mask;
+  size_t cols = buf->column_count;
+
+  for (; VTermRowCache.table[i] != VTERM_ROW_CACHE_EMPTY; i = (i + 1) & VTermRowCache.table_mask)
+  {
+    int32_t slot = VTermRowCache.table[i];
+    uint8_t *key = VTermRowCache.keys + slot * VTermRowCache.key_size;
+    if (VTermRowCache.hashes[slot] == hash && memcmp(key, VTermRowData(buf, row), cols) == 0
+        && memcmp(key + cols, VTermRowColors(buf, row), cols * sizeof(uint64_t)) == 0)
+      return slot;
+  }
+  return VTERM_ROW_CACHE_EMPTY;
+}
+
+static void VTermRowCacheForget(int32_t slot)
+/* Takes slot out of the table, later entries shift back into the hole */
+{
+  uint32_t mask = VTermRowCache.table_mask;
+  uint32_t i = VTermRowCache.hashes[slot] & mask;
 
-    Vector2 where = (Vector2){ position.x + textOffsetX, position.y + textOffsetY };
-    if (bg != default_bg)
-      DrawRectangle(where.x, where.y, fontSize / 2, fontSize, back);
-    if ((codepoint != ' ') && (codepoint != '\t'))
+  while (VTermRowCache.table[i] != slot)
+    i = (i + 1) & mask;
+  VTermRowCache.table[i] = VTERM_ROW_CACHE_EMPTY;
+  for (uint32_t j = (i + 1) & mask; VTermRowCache.table[j] != VTERM_ROW_CACHE_EMPTY; j = (j + 1) & mask)
+  {
+    uint32_t home = VTermRowCache.hashes[VTermRowCache.table[j]] & mask;
+    /* Stays if its home is cyclically in (i, j] */
+    if (i <= j ? (home > i && home <= j) : (home > i || home <= j))
+      continue;
+    VTermRowCache.table[i] = VTermRowCache.table[j];
+    VTermRowCache.table[j] = VTERM_ROW_CACHE_EMPTY;
+    i = j;
+  }
+}
+
+static int32_t VTermRowCacheClaim(VTermDataBuffer *buf, int row, uint64_t hash)
+/* The least recently shown slot not on screen this frame, now holding row */
+{
+  int32_t slot = 0;
+  size_t cols = buf->column_count;
+
+  for (int32_t s = 1; s < VTermRowCache.slots; s++)
+    if (VTermRowCache.shown[s] < VTermRowCache.shown[slot])
+      slot = s;
+  if (VTermRowCache.shown[slot] != 0)
+    VTermRowCacheForget(slot);
+
+  uint8_t *key = VTermRowCache.keys + slot * VTermRowCache.key_size;
+  memcpy(key, VTermRowData(buf, row), cols);
+  memcpy(key + cols, VTermRowColors(buf, row), cols * sizeof(uint64_t));
+  VTermRowCache.hashes[slot] = hash;
+  VTermRowCache.shown[slot] = VTermRowCache.clock;
+
+  uint32_t i = hash & VTermRowCache.table_mask;
+  while (VTermRowCache.table[i] != VTERM_ROW_CACHE_EMPTY)
+    i = (i + 1) & VTermRowCache.table_mask;
+  VTermRowCache.table[i] = slot;
+  return slot;
+}
+
+bool VTermDrawRows(VTermDataBuffer *buf)
+/* VTermDrawText through the row cache: rows seen before are copied from the
+ * atlas, the rest are drawn into it first (one render target switch) */
+{
+  Font font = VTermGlyphFont(buf);
+  int cell_h = buf->font_size, width = buf->column_count * VTermCellWidth(buf);
+  int misses = 0;
+
+  if (VTermRowCache.broken || !VTermRowCacheFit(buf, font))
+    return VTermDrawText(buf);
+
+  VTermRowCache.clock++;
+  for (int row = 0; row < buf->row_count; row++)
+  {
+    uint64_t hash = VTermRowHash(buf, row);
+    int32_t slot = VTermRowCacheFind(buf, row, hash);
+    VTermRowCache.row_hashes[row] = hash;
+    VTermRowCache.row_slots[row] = slot;
+    if (slot != VTERM_ROW_CACHE_EMPTY)
+      VTermRowCache.shown[slot] = VTermRowCache.clock; // not to be claimed below
+    else
+      misses++;
+  }
+  VTermStats.rows_cached += buf->row_count - misses;
+  VTermStats.rows_drawn += misses;
+
+  if (misses > 0)
+  {
+    uint32_t bg = UNPACK_bg(buf->default_fgbg) | 0xff000000u; // opaque, slots are copied as is
+    BeginTextureMode(VTermRowCache.atlas);
+    for (int row = 0; row < buf->row_count; row++)
     {
-      DrawTextCodepoint(font, codepoint, where, fontSize, tint);
+      if (VTermRowCache.row_slots[row] != VTERM_ROW_CACHE_EMPTY)
+        continue;
+      int32_t slot = VTermRowCacheClaim(buf, row, VTermRowCache.row_hashes[row]);
+      int y = slot * cell_h;
+      VTermRectRun run = { 0 };
+      VTermRowCache.row_slots[row] = slot;
+      DrawRectangle(0, y, width, cell_h, *(Color *)&bg);
+      buf->kernels->draw_backgrounds(buf, row, y, &run);
+      VTermFlushRect(&run);
+      buf->kernels->draw_glyphs(buf, font, row, y);
     }
+    EndTextureMode();
+  }
 
-    if (font.glyphs[index].advanceX == 0) textOffsetX += ((float)font.recs[index].width*scaleFactor + spacing);
-    else textOffsetX += ((float)font.glyphs[index].advanceX*scaleFactor + spacing);
-    i += codepointByteCount;   // Move text bytes counter to next codepoint
+  /* Render textures are upside down: negative source heights flip them
+   * back, rows in consecutive slots go out as one quad */
+  int atlas_h = VTermRowCache.slots * cell_h;
+  for (int row = 0; row < buf->row_count;)
+  {
+    int32_t slot = VTermRowCache.row_slots[row];
+    int n = 1;
+    while (row + n < buf->row_count && VTermRowCache.row_slots[row + n] == slot + n)
+      n++;
+    DrawTextureRec(VTermRowCache.atlas.texture,
+                   (Rectangle){ 0, atlas_h - (slot + n) * cell_h, width, -n * cell_h },
+                   (Vector2){ 0, row * cell_h }, WHITE);
+    VTermStats.frame_rects++;
+    row += n;
   }
   return true;
 }
 
+Color VTermBackground(VTerm *vt)
+/* What to clear the frame with, VTermDrawText skips cells of this colour */
+{
+  uint32_t bg = UNPACK_bg(VTermGetCurrentBuffer(vt)->default_fgbg);
+  return *(Color *)&bg;
+}
+
 bool VTermDraw(VTerm *vt)
 {
   VTermDataBuffer *buf = VTermGetCurrentBuffer(vt);
+  uint64_t view = buf->scrollback->view;
+  VTermStats.frame_rects = 0;
+  VTermStats.frame_glyphs = 0;
+  if (vt->pane_count > 0)
+  {
+    VTermDrawPanes(vt);
+    if (VTermBellDraw(vt))
+      vt->busy = true;
+    if (VTermStats.overlay)
+      VTermDrawMetricsOverlay(vt);
+    vt->frame_drawn = GetTime();
+    return true;
+  }
   // TODO: check if pty mode or not
-  VTermDrawText(buf);
+  /* Scrolled back: draw the view, the cursor moves down with the live rows */
+  VTermDataBuffer *screen = view > 0 && !VTermInAlternateBuffer(vt) ? VTermScrollbackView(buf) : buf;
+  if (VTermImageRefresh(buf))
+    vt->busy = true; // decodes out, don't go idle on them
+  if (vt->soft_render)
+    VTermSoftDraw(screen); // images are composited with the cells
+  else
+  {
+    VTermDrawRows(screen);
+    if (VTermGlyphsBuilding())
+      vt->busy = true; // until this size's atlas is swapped in
+    if (screen == buf)
+      VTermImageDraw(buf);
+  }
   // draw cursor:
-  DrawRectangle(buf->col * buf->font_size / 2, buf->row * buf->font_size, buf->font_size / 2, buf->font_size, RAYWHITE);
+  if (VTermCursorVisible() && (screen == buf || buf->row + view < buf->row_count))
+  {
+    int row = screen == buf ? buf->row : buf->row + view;
+    DrawRectangle(buf->col * VTermCellWidth(buf), row * buf->font_size, VTermCellWidth(buf), buf->font_size, RAYWHITE);
+    VTermStats.frame_rects++;
+  }
+  if (VTermBellDraw(vt))
+    vt->busy = true; // keep frames coming until the flash is cleared
 
+  if (VTermStats.overlay)
+    VTermDrawMetricsOverlay(vt);
+  vt->frame_drawn = GetTime();
   return true;
 }
 
+size_t VTermEncodeUTF8(uint32_t cp, char *out)
+{
+  if (cp < 0x80) {
+    out[0] = cp;
+    return 1;
+  } else if (cp < 0x800) {
+    out[0] = 0xc0 | (cp >> 6);
+    out[1] = 0x80 | (cp & 0x3f);
+    return 2;
+  } else if (cp < 0x10000) {
+    out[0] = 0xe0 | (cp >> 12);
+    out[1] = 0x80 | ((cp >> 6) & 0x3f);
+    out[2] = 0x80 | (cp & 0x3f);
+    return 3;
+  } else if (cp < 0x110000) {
+    out[0] = 0xf0 | (cp >> 18);
+    out[1] = 0x80 | ((cp >> 12) & 0x3f);
+    out[2] = 0x80 | ((cp >> 6) & 0x3f);
+    out[3] = 0x80 | (cp & 0x3f);
+    return 4;
+  }
+  return 0;
+}
+
+// Modifier bits as xterm numbers them (sent as 1 + mods)
+#define VTERM_MOD_SHIFT 1
+#define VTERM_MOD_ALT   2
+#define VTERM_MOD_CTRL  4
+
+static const struct { int key; char final; } VTermLetterKeys[] = {
+  { KEY_UP, 'A' }, { KEY_DOWN, 'B' }, { KEY_RIGHT, 'C' }, { KEY_LEFT, 'D' },
+  { KEY_HOME, 'H' }, { KEY_END, 'F' },
+  { KEY_F1, 'P' }, { KEY_F2, 'Q' }, { KEY_F3, 'R' }, { KEY_F4, 'S' },
+};
+
+static const struct { int key; int code; } VTermTildeKeys[] = {
+  { KEY_INSERT, 2 }, { KEY_DELETE, 3 }, { KEY_PAGE_UP, 5 }, { KEY_PAGE_DOWN, 6 },
+  { KEY_F5, 15 }, { KEY_F6, 17 }, { KEY_F7, 18 }, { KEY_F8, 19 },
+  { KEY_F9, 20 }, { KEY_F10, 21 }, { KEY_F11, 23 }, { KEY_F12, 24 },
+};
+
+size_t VTermEncodeKey(VTermDataBuffer *buf, int key, int mods, char *out)
+/* Escape sequence for a non-printing key, out must hold 16 bytes */
+{
+  size_t i;
+  switch (key)
+  {
+    case KEY_ENTER:
+    case KEY_KP_ENTER:
+      out[0] = '\r';
+      return 1;
+    case KEY_BACKSPACE:
+      out[0] = 0x7f;
+      return 1;
+    case KEY_TAB:
+      if (mods & VTERM_MOD_SHIFT)
+        return sprintf(out, "\33[Z");
+      out[0] = '\t';
+      return 1;
+    case KEY_ESCAPE:
+      out[0] = '\33';
+      return 1;
+  }
+
+  for (i = 0; i < sizeof(VTermLetterKeys) / sizeof(VTermLetterKeys[0]); i++)
+  {
+    if (VTermLetterKeys[i].key != key)
+      continue;
+    char final = VTermLetterKeys[i].final;
+    if (mods)
+      return sprintf(out, "\33[1;%d%c", 1 + mods, final);
+    /* F1-F4 are always SS3, arrows only in application cursor mode */
+    if ((final >= 'P' && final <= 'S') || (buf->parser->dec_modes & VTERM_DEC_CURSOR_KEYS))
+      return sprintf(out, "\33O%c", final);
+    return sprintf(out, "\33[%c", final);
+  }
+
+  for (i = 0; i < sizeof(VTermTildeKeys) / sizeof(VTermTildeKeys[0]); i++)
+  {
+    if (VTermTildeKeys[i].key != key)
+      continue;
+    if (mods)
+      return sprintf(out, "\33[%d;%d~", VTermTildeKeys[i].code, 1 + mods);
+    return sprintf(out, "\33[%d~", VTermTildeKeys[i].code);
+  }
+  return 0;
+}
+
+static void VTermQueueInput(VTermDataBuffer *buf, const char *bytes, size_t len)
+{
+  if (len == 0)
+    return;
+  if (VTermRingUsed(buf->out) == 0 && buf->paste == NULL)
+    buf->out_stamp = GetTime();
+  if (buf->probe_key == 0)
+    buf->probe_key = GetTime();
+  /* Typing goes back to the live screen */
+  buf->scrollback->view = 0;
+  /* Keystrokes never outgrow the ring; a full one means the child stopped
+   * reading, dropping is what a real tty would do */
+  VTermRingPush(buf->out, bytes, len);
+}
+
+bool VTermPaste(VTerm *vt, const char *text)
+{
+  VTermDataBuffer *buf = VTermGetCurrentPrincipalBuffer(vt);
+  bool bracketed = buf->parser->dec_modes & VTERM_DEC_BRACKETED_PASTE;
+  size_t len;
+
+  if (text == NULL || (len = strlen(text)) == 0)
+    return true;
+  buf->scrollback->view = 0;
+
+  /* A paste still draining goes first, then the new one queues behind it */
+  if (buf->paste != NULL || VTermRingUsed(buf->out) + len + 12 > buf->out->size)
+  {
+    size_t old = buf->paste_len - buf->paste_at;
+    char *paste = (char *)malloc(old + len + 12);
+    if (paste == NULL)
+    {
+      VTermError("malloc(paste)");
+      return false;
+    }
+    size_t at = 0;
+    if (buf->paste != NULL)
+      memcpy(paste, buf->paste + buf->paste_at, old), at = old;
+    if (bracketed) memcpy(paste + at, "\33[200~", 6), at += 6;
+    memcpy(paste + at, text, len), at += len;
+    if (bracketed) memcpy(paste + at, "\33[201~", 6), at += 6;
+    if (VTermRingUsed(buf->out) == 0 && buf->paste == NULL)
+      buf->out_stamp = GetTime();
+    free(buf->paste);
+    buf->paste = paste;
+    buf->paste_len = at;
+    buf->paste_at = 0;
+    return true;
+  }
+
+  if (bracketed)
+    VTermQueueInput(buf, "\33[200~", 6);
+  VTermQueueInput(buf, text, len);
+  if (bracketed)
+    VTermQueueInput(buf, "\33[201~", 6);
+  return true;
+}
+
+bool VTermFlushInput(VTermDataBuffer *buf)
+/* One non-blocking writev() per frame, EAGAIN leaves it queued for the next */
+{
+  int master = buf->pty->master;
+
+  /* Top the ring up from a pending paste before writing */
+  if (buf->paste != NULL)
+  {
+    buf->paste_at += VTermRingPush(buf->out, buf->paste + buf->paste_at, buf->paste_len - buf->paste_at);
+    if (buf->paste_at == buf->paste_len)
+    {
+      free(buf->paste);
+      buf->paste = NULL;
+      buf->paste_len = buf->paste_at = 0;
+    }
+  }
+
+  /* No child (attached clients): whoever owns the ring forwards it */
+  if (VTermRingUsed(buf->out) == 0 || master == -1)
+    return true;
+
+  ssize_t n = VTermRingDrain(buf->out, master);
+  if (n == -1)
+  {
+    if (errno == EAGAIN || errno == EINTR)
+      return true;
+    VTermError("writev(master)");
+    return false;
+  }
+  VTermStats.input_bytes += n;
+  VTermStats.input_writes++;
+
+  if (VTermRingUsed(buf->out) == 0 && buf->paste == NULL)
+  {
+    VTermHistAdd(&VTermStats.input_latency, GetTime() - buf->out_stamp);
+    buf->out_stamp = 0;
+  }
+  return true;
+}
+
+static const int VTermSpecialKeys[] = {
+  KEY_ENTER, KEY_KP_ENTER, KEY_BACKSPACE, KEY_TAB, KEY_ESCAPE,
+  KEY_UP, KEY_DOWN, KEY_RIGHT, KEY_LEFT, KEY_HOME, KEY_END,
+  KEY_INSERT, KEY_DELETE, KEY_PAGE_UP, KEY_PAGE_DOWN,
+  KEY_F1, KEY_F2, KEY_F3, KEY_F4, KEY_F5, KEY_F6,
+  KEY_F7, KEY_F8, KEY_F9, KEY_F10, KEY_F11, KEY_F12,
+};
+
 bool VTermSendInput(VTerm *vt) {
   int ch, kc;
-  VTermDataBuffer *buf = VTermGetCurrentBuffer(vt);
-  int master = buf->pty->master;
+  char seq[16];
+  size_t n, i;
+  /* The output queue is per session, it lives on the principal buffer */
+  VTermDataBuffer *buf = VTermGetCurrentPrincipalBuffer(vt);
+
+  bool shift = IsKeyDown(KEY_LEFT_SHIFT) || IsKeyDown(KEY_RIGHT_SHIFT);
+  bool ctrl = IsKeyDown(KEY_LEFT_CONTROL) || IsKeyDown(KEY_RIGHT_CONTROL);
+  bool alt = IsKeyDown(KEY_LEFT_ALT) || IsKeyDown(KEY_RIGHT_ALT);
+  bool super = IsKeyDown(KEY_LEFT_SUPER) || IsKeyDown(KEY_RIGHT_SUPER);
+  int mods = (shift ? VTERM_MOD_SHIFT : 0) | (alt ? VTERM_MOD_ALT : 0) | (ctrl ? VTERM_MOD_CTRL : 0);
+
+  /* Super is ours (shortcuts), its characters never reach the child */
+  if (super)
+  {
+    while (GetCharPressed());
+    if (IsKeyPressed(KEY_V))
+      VTermPaste(vt, GetClipboardText());
+    vt->busy = true;
+    return VTermFlushInput(buf);
+  }
+
   while ((ch = GetCharPressed()))
   {
-    // printf("Unicode %d pressed: '%c'\n", ch, *(char *)&ch);
-    write(master, (const char *)&ch, 1);
+    n = 0;
+    if (alt)
+      seq[n++] = '\33';
+    n += VTermEncodeUTF8(ch, seq + n);
+    VTermQueueInput(buf, seq, n);
   }
-  while ((kc = GetKeyPressed()))
+
+  /* Control characters, the char callback does not fire for these */
+  if (ctrl && shift && IsKeyPressed(KEY_V))
+    VTermPaste(vt, GetClipboardText());
+  else if (ctrl)
   {
-    switch (kc)
+    for (kc = KEY_A; kc <= KEY_Z; kc++)
     {
-      case KEY_BACKSPACE:
-        write(master, "\b", 1);
-        break;
-      case KEY_ENTER:
-        write(master, "\n", 1);
-        break;
+      if (!IsKeyPressed(kc) && !IsKeyPressedRepeat(kc))
+        continue;
+      n = 0;
+      if (alt)
+        seq[n++] = '\33';
+      seq[n++] = kc - KEY_A + 1;
+      VTermQueueInput(buf, seq, n);
     }
+    if (IsKeyPressed(KEY_LEFT_BRACKET)) VTermQueueInput(buf, "\33", 1);
+    if (IsKeyPressed(KEY_BACKSLASH)) VTermQueueInput(buf, "\34", 1);
+    if (IsKeyPressed(KEY_RIGHT_BRACKET)) VTermQueueInput(buf, "\35", 1);
+    if (IsKeyPressed(KEY_SPACE)) VTermQueueInput(buf, "\0", 1);
   }
-  return true;
+
+  for (i = 0; i < sizeof(VTermSpecialKeys) / sizeof(VTermSpecialKeys[0]); i++)
+  {
+    kc = VTermSpecialKeys[i];
+    if (!IsKeyPressed(kc) && !IsKeyPressedRepeat(kc))
+      continue;
+    /* Shift+PgUp/PgDn page through the scrollback, if there is one */
+    if (mods == VTERM_MOD_SHIFT && (kc == KEY_PAGE_UP || kc == KEY_PAGE_DOWN)
+        && VTermScrollView(vt, (kc == KEY_PAGE_UP ? 1 : -1) * (buf->row_count - 1)))
+      continue;
+    /* Shift/ctrl only travel as a parameter on cursor and function keys */
+    if ((n = VTermEncodeKey(buf, kc, kc == KEY_TAB ? mods & VTERM_MOD_SHIFT : mods, seq)) > 0)
+      VTermQueueInput(buf, seq, n);
+  }
+  /* Drain raylib's key queue, everything was polled above */
+  while (GetKeyPressed());
+
+  float wheel = GetMouseWheelMove();
+  if (wheel != 0)
+    VTermScrollView(vt, (int)(wheel * 3));
+
+  if (VTermRingUsed(buf->out) > 0 || buf->paste != NULL)
+    vt->busy = true;
+  return VTermFlushInput(buf);
 }
 
 void VTermMoveCursorBy(int dx, int dy) {
@@ -766,8 +2497,11 @@ void VTermMoveCursorBy(int dx, int dy) {
 
 void VTermIncreaseFontSize(VTerm *vt, int32_t delta)
 {
-  VTermDataBuffer *buf = VTermGetCurrentBuffer(vt);
+  VTermDataBuffer *buf = VTermGetCurrentPrincipalBuffer(vt);
+  if (buf->font_size + delta < 2)
+    return;
   buf->font_size += delta;
+  ((VTermDataBuffer *)buf->alt_screen)->font_size = buf->font_size;
   VTermEnsureResolution(vt);
 }
 
@@ -797,12 +2531,267 @@ bool VTermInAlternateBuffer(VTerm *vt)
 }
 
 void VTermEnsureResolution(VTerm *vt)
+/* Grid follows the window: recompute rows/cols from its size */
 {
   // TODO: check and implement this for gfx types
   // TODO: check for fullscreen (margin)
-  VTermDataBuffer *buf = VTermGetCurrentBuffer(vt);
-  vt->pixel_width = buf->column_count * buf->font_size/2;
-  vt->pixel_height = buf->row_count * buf->font_size;
-  SetWindowSize(vt->pixel_width, vt->pixel_height);
+  VTermDataBuffer *buf = VTermGetCurrentPrincipalBuffer(vt);
+  uint16_t cell_w = VTermCellWidth(buf), cell_h = buf->font_size;
+  vt->pixel_width = GetScreenWidth();
+  vt->pixel_height = GetScreenHeight();
+  if (vt->pane_count > 0)
+  {
+    vt->busy = true;
+    VTermLayoutPanes(vt); // each pane fits its tile
+    return;
+  }
+
+  uint16_t cols = vt->pixel_width / cell_w;
+  uint16_t rows = vt->pixel_height / cell_h;
+  if (cols < 1) cols = 1;
+  if (rows < 1) rows = 1;
+
+  vt->busy = true;
+  if (cols == buf->column_count && rows == buf->row_count)
+    return;
+  /* Attached: the server resizes the session, the next snapshot brings it */
+  if (vt->server_fd != -1)
+  {
+    VTermWireResize size = { cols, rows };
+    VTermWireSend(vt->server_fd, VTERM_WIRE_RESIZE, &size, sizeof(size));
+  }
+  else
+    VTermResize(vt, cols, rows);
+}
+
+bool VTermSetWinSize(VTermDataBuffer *buf)
+/* Tell the child (SIGWINCH) about the new grid */
+{
+  if (buf->pty == NULL || buf->pty->master == -1)
+    return true;
+
+  struct winsize ws;
+  ws.ws_col = buf->column_count;
+  ws.ws_row = buf->row_count;
+  ws.ws_xpixel = buf->column_count * VTermCellWidth(buf);
+  ws.ws_ypixel = buf->row_count * buf->font_size;
+  if (ioctl(buf->pty->master, TIOCSWINSZ, &ws) == -1)
+  {
+    VTermError("ioctl(master, TIOCSWINSZ)");
+    return false;
+  }
+  return true;
 }
 
+bool VTermResize(VTerm *vt, uint16_t column_count, uint16_t row_count)
+{
+  for (int i = 0; i < MAX_BUFFER_COUNT; i++)
+  {
+    if (vt->buffers[i] == NULL)
+      continue;
+    if (!VTermResizeBuffer(&vt->buffers[i], column_count, row_count))
+    {
+      VTermError("VTermResizeBuffer(vt->buffers[i], column_count, row_count)");
+      return false;
+    }
+  }
+  return true;
+}
+
+static void VTermCopyScreenState(VTermDataBuffer *dst, VTermDataBuffer *src)
+{
+  dst->font_size = src->font_size;
+  dst->font = src->font;
+  dst->glyphs = src->glyphs;
+  dst->fgbg_color = src->fgbg_color;
+  dst->default_fgbg = src->default_fgbg;
+  dst->pen = src->pen;
+}
+
+bool VTermResizeBuffer(VTermDataBuffer **buf_ptr, uint16_t column_count, uint16_t row_count)
+/* Moves a whole session into a fresh arena of the new geometry */
+{
+  VTermDataBuffer *old = *buf_ptr;
+  VTermDataBuffer *old_alt = (VTermDataBuffer *)old->alt_screen;
+  VTermArena arena;
+
+  if (!VTermArenaInit(&arena, VTermSessionSize(column_count, row_count)))
+  {
+    VTermError("VTermArenaInit(session)");
+    return false;
+  }
+
+  VTermDataBuffer *buf = VTermCarveSession(&arena, old->mode, column_count, row_count);
+  VTermDataBuffer *alt = (VTermDataBuffer *)buf->alt_screen;
+
+  /* Session-wide state moves over as is */
+  *buf->pty = *old->pty;
+  VTermMoveChild(old->pty, buf->pty);
+  *buf->parser = *old->parser;
+  memcpy(buf->in->data, old->in->data, old->in->size);
+  buf->in->head = old->in->head;
+  buf->in->tail = old->in->tail;
+  memcpy(buf->out->data, old->out->data, old->out->size);
+  buf->out->head = old->out->head;
+  buf->out->tail = old->out->tail;
+  buf->out_stamp = old->out_stamp;
+  buf->paste = old->paste;
+  buf->paste_len = old->paste_len;
+  buf->paste_at = old->paste_at;
+  buf->probe_key = old->probe_key;
+  buf->probe_echo = old->probe_echo;
+  buf->probe_parsed = old->probe_parsed;
+  *buf->scrollback = *old->scrollback;
+
+  VTermCopyScreenState(buf, old);
+  VTermCopyScreenState(alt, old_alt);
+  VTermReflow(buf, old);
+  /* Images keep their place relative to the cursor line */
+  VTermImageMove(buf, old, buf->row - old->row);
+
+  /* Apps redraw the alt screen on SIGWINCH, just keep the top-left */
+  uint16_t cols = column_count < old_alt->column_count ? column_count : old_alt->column_count;
+  uint16_t rows = row_count < old_alt->row_count ? row_count : old_alt->row_count;
+  VTermResetBufferData(alt, 0, 0, VTERM_RESET_BUFFER_DATA_ALL);
+  for (uint16_t r = 0; r < rows; r++)
+  {
+    memcpy(VTermRowData(alt, r), VTermRowData(old_alt, r), cols);
+    memcpy(VTermRowColors(alt, r), VTermRowColors(old_alt, r), cols * sizeof(uint64_t));
+  }
+  alt->row = old_alt->row < row_count ? old_alt->row : row_count - 1;
+  alt->col = old_alt->col < column_count ? old_alt->col : column_count - 1;
+  /* After the reset, which clears placements: the alt screen's stay put */
+  VTermImageMove(alt, old_alt, 0);
+  if (old->alt_buffer != NULL)
+    buf->alt_buffer = alt;
+
+  VTermArena old_arena = old->arena;
+  VTermArenaFree(&old_arena);
+  *buf_ptr = buf;
+
+  return VTermSetWinSize(buf);
+}
+
+static uint16_t VTermRowLength(VTermDataBuffer *buf, uint16_t row)
+{
+  uint8_t *data = VTermRowData(buf, row);
+  uint16_t len = buf->column_count;
+  while (len > 0 && data[len - 1] == 0)
+    len--;
+  return len;
+}
+
+static void VTermReflowSpill(VTermDataBuffer *dst, VTermDataBuffer *src, uint32_t start, size_t len, size_t k,
+                             bool wrapped, uint8_t *data, uint64_t *colors)
+/* Row k of the logical line at src row start, at dst's width, into the
+ * history instead of the screen */
+{
+  uint16_t W = src->column_count, W2 = dst->column_count;
+  size_t at = k * W2, end = at + W2 < len ? at + W2 : len, n;
+
+  memset(data, 0, W2);
+  nmemset64(colors, dst->default_fgbg, W2);
+  for (; at < end; at += n)
+  {
+    size_t src_row = start + at / W, src_col = at % W;
+    n = W - src_col < end - at ? W - src_col : end - at;
+    memcpy(data + at - k * W2, VTermRowData(src, src_row) + src_col, n);
+    memcpy(colors + at - k * W2, VTermRowColors(src, src_row) + src_col, n * sizeof(uint64_t));
+  }
+  VTermScrollbackPush(dst->scrollback, data, colors, W2, dst->default_fgbg, wrapped ? VTERM_ROW_WRAPPED : 0);
+  if (dst->scrollback->view > 0 && dst->scrollback->view < dst->scrollback->lines)
+    dst->scrollback->view++;
+}
+
+void VTermReflow(VTermDataBuffer *dst, VTermDataBuffer *src)
+/* Re-splits src's logical lines (runs of VTERM_ROW_WRAPPED rows) at dst's
+ * width. One pass to count output rows, one to copy, so it is linear in the
+ * cells touched. If the result is taller than dst the top rows go to the
+ * history of a main screen that keeps one, otherwise they fall off. */
+{
+  uint16_t W = src->column_count, W2 = dst->column_count;
+  size_t total = 0, skip, out_row;
+  uint32_t r, start;
+  uint8_t *spill_data = NULL;
+  uint64_t *spill_colors = NULL;
+
+  /* Lines after the cursor's that are entirely blank are dropped */
+  uint32_t last = src->row;
+  while (last + 1 < src->row_count && (src->row_flags[last] & VTERM_ROW_WRAPPED))
+    last++;
+  for (r = last + 1; r < src->row_count; r++)
+    if (VTermRowLength(src, r) > 0)
+      last = r;
+
+  /* Pass 1: how many rows does each logical line need at the new width */
+  for (start = 0; start <= last; start = r + 1)
+  {
+    size_t len;
+    r = start;
+    while (r < last && (src->row_flags[r] & VTERM_ROW_WRAPPED))
+      r++;
+    len = (size_t)(r - start) * W + VTermRowLength(src, r);
+    if (src->row >= start && src->row <= r)
+    {
+      size_t at = (size_t)(src->row - start) * W + src->col;
+      if (at + 1 > len)
+        len = at + 1;
+    }
+    total += len == 0 ? 1 : (len + W2 - 1) / W2;
+  }
+  skip = total > dst->row_count ? total - dst->row_count : 0;
+  if (skip > 0 && dst->alt_screen != NULL && dst->scrollback->fd != -1)
+  {
+    spill_data = (uint8_t *)malloc(W2);
+    spill_colors = (uint64_t *)malloc(W2 * sizeof(uint64_t));
+  }
+
+  /* Pass 2: copy cell runs into place */
+  out_row = 0;
+  dst->row = 0;
+  dst->col = 0;
+  for (start = 0; start <= last; start = r + 1)
+  {
+    size_t len, at, n;
+    r = start;
+    while (r < last && (src->row_flags[r] & VTERM_ROW_WRAPPED))
+      r++;
+    len = (size_t)(r - start) * W + VTermRowLength(src, r);
+
+    bool has_cursor = src->row >= start && src->row <= r;
+    size_t cursor_at = has_cursor ? (size_t)(src->row - start) * W + src->col : 0;
+    size_t span = len;
+    if (has_cursor && cursor_at + 1 > span)
+      span = cursor_at + 1;
+    size_t rows = span == 0 ? 1 : (span + W2 - 1) / W2;
+
+    for (at = 0; at < len; at += n)
+    {
+      /* Copy the largest chunk that stays within one src and one dst row */
+      size_t src_row = start + at / W, src_col = at % W;
+      size_t dst_row = out_row + at / W2, dst_col = at % W2;
+      n = W - src_col < W2 - dst_col ? W - src_col : W2 - dst_col;
+      if (n > len - at)
+        n = len - at;
+      if (dst_row < skip)
+        continue;
+      memcpy(VTermRowData(dst, dst_row - skip) + dst_col, VTermRowData(src, src_row) + src_col, n);
+      memcpy(VTermRowColors(dst, dst_row - skip) + dst_col, VTermRowColors(src, src_row) + src_col, n * sizeof(uint64_t));
+    }
+    for (size_t k = 0; k + 1 < rows; k++)
+      if (out_row + k >= skip)
+        dst->row_flags[out_row + k - skip] |= VTERM_ROW_WRAPPED;
+    for (size_t k = 0; k < rows && out_row + k < skip && spill_data && spill_colors; k++)
+      VTermReflowSpill(dst, src, start, len, k, k + 1 < rows, spill_data, spill_colors);
+
+    if (has_cursor)
+    {
+      size_t cr = out_row + cursor_at / W2;
+      dst->row = cr < skip ? 0 : cr - skip;
+      dst->col = cursor_at % W2;
+    }
+    out_row += rows;
+  }
+  free(spill_data);
+  free(spill_colors);
+}
@@ -7,12 +7,15 @@
 #include <string.h>
 #include <unistd.h>
 #include <sys/select.h>
+#include <sys/uio.h>
+#include <errno.h>
 #include <sys/ioctl.h>
 #include <sys/types.h>
 #include <sys/time.h>
+#include <time.h>
 #include <fcntl.h>
 
-#include "Px437_IBM_VGA_8x16.h"
+#include "vterm_font_format.h"
 
 #include <stdio.h>
 
@@ -26,16 +29,98 @@
 
 #define nmemset(ptr, val, count) memset(ptr, val, sizeof(*(ptr)) * (count))
 
+// memset only takes a byte, packed colours need the whole word
+static inline void nmemset64(uint64_t *ptr, uint64_t val, size_t count)
+{
+  while (count--)
+    *ptr++ = val;
+}
+
+// Style bits ride in the fg alpha byte of a packed cell, cells are always
+// drawn opaque so the alpha is free
+#define VTERM_STYLE_BOLD      0x01
+#define VTERM_STYLE_FAINT     0x02
+#define VTERM_STYLE_ITALIC    0x04
+#define VTERM_STYLE_UNDERLINE 0x08
+#define VTERM_STYLE_BLINK     0x10
+#define VTERM_STYLE_INVERSE   0x20
+#define VTERM_STYLE_HIDDEN    0x40
+#define VTERM_STYLE_STRIKE    0x80
+
+#define VTERM_MAX_PARAMS 32
+#define VTERM_ESCAPE_MAX 128
+
+// Log scale, 4 buckets per octave starting at 1us, the last one is >= ~1s
+#define VTERM_HIST_BUCKETS 80
+// Powers of two of bytes per read(), the last one is >= 64KiB
+#define VTERM_READ_BUCKETS 17
+typedef struct {
+  uint32_t buckets[VTERM_HIST_BUCKETS];
+  uint64_t count;
+  double sum, max; // seconds
+} VTermHistogram;
+
+typedef struct {
+  uint64_t input_bytes;            // bytes written to ptys
+  uint64_t input_writes;           // write syscalls it took
+  VTermHistogram input_latency;    // key event -> write()
+  VTermHistogram echo_latency;     // key event -> first byte read back
+  VTermHistogram parse_latency;    // key event -> that read parsed
+  VTermHistogram present_latency;  // key event -> buffer swap showing it
+  VTermHistogram frame_time;       // swap to swap
+  VTermHistogram wake_latency;     // idle watcher saw the pty -> loop resumed
+  VTermHistogram output_latency;   // pty bytes parsed -> first frame with them presented
+  uint64_t pty_reads;              // read()s that returned child output
+  uint64_t pty_bytes;              // what they returned
+  uint32_t read_sizes[VTERM_READ_BUCKETS]; // bytes per read(), bucket i holds [2^i, 2^(i+1))
+  uint64_t bytes_parsed;
+  double parse_seconds;            // spent in VTermProcessByte loops, for bytes/s
+  uint64_t csi_finals[0x3f];       // CSI sequences by final byte, 0x40-0x7e
+  uint64_t csi_unknown;            // of those, ones VTermExecuteEscapeCode doesn't do
+  uint64_t scrolls;                // VTermScrollRegion calls
+  uint64_t scrolled_lines;
+  uint64_t jumped_lines;           // of those, straight to the history (jump scroll)
+  uint64_t cells_written;          // printable bytes stored in a cell
+  uint64_t idle_waits;             // frames that blocked instead of polling
+  uint64_t wakes_pty, wakes_timeout, wakes_event;
+  uint64_t frames_held;            // skipped mid synchronized update (?2026)
+  uint64_t sync_timeouts;          // updates that never ended in time
+  uint64_t children_reaped;        // shells waited for after SIGCHLD
+  uint64_t bells;                  // BELs from the child
+  uint64_t bells_coalesced;        // of those, inside VTERM_BELL_INTERVAL of a ring
+  uint64_t bells_rung;             // flashes/tones actually shown
+  uint64_t images_decoded;         // inline images the worker decoded
+  uint64_t images_evicted;         // dropped to stay under the budget
+  uint64_t image_bytes;            // decoded pixels cached now
+  uint64_t texture_bytes;          // of those, uploaded to the GPU
+  uint64_t rows_cached;            // rows copied from the row cache
+  uint64_t rows_drawn;             // rows rasterized into it
+  uint64_t glyph_atlases;          // per size glyph atlases swapped in
+  uint64_t glyph_scaled;           // draws scaled, their size's atlas not ready
+  uint64_t strings_osc;            // OSC strings read to their end
+  uint64_t strings_dcs;            // DCS, SOS and PM strings
+  uint64_t strings_dropped;        // cancelled, or over VTERM_STRING_MAX
+  uint64_t clipboard_bytes;        // decoded from OSC 52 into the clipboard
+  uint64_t pane_redraws;           // pane textures brought up to date
+  uint64_t pane_rows;              // rows rasterized into them
+  uint64_t pane_reused;            // panes shown from their last frame as is
+  uint64_t pane_deferred;          // updates left for the next frame, over the budget
+  uint64_t pane_held;              // panes kept on their last frame mid synchronized update
+  uint32_t frame_rects;            // rectangles drawn last frame
+  uint32_t frame_glyphs;           // glyphs drawn last frame
+  bool overlay;
+} VTermMetrics;
+
 #ifndef VTERM_C_SOURCE
 extern Font VTermTextFonts[21];
+extern const VTermPackedFont *VTermModeFonts[21];
+extern Color VTermPalette[256];
+extern VTermMetrics VTermStats;
 #else
 Font VTermTextFonts[21];
-uint32_t VTermANSIColors[8];
-bool previousWasEscape = false;
-bool previousWasWrap = false;
-bool previousWasCRAfterWrap = false;
-char currentEscapeBuf[32];
-int currentEscapeIx = -1;
+const VTermPackedFont *VTermModeFonts[21]; // glyph tables, TextFonts are built from them
+Color VTermPalette[256]; // xterm 256 colours, 0-15 are the VGA ones
+VTermMetrics VTermStats;
 #endif
 
 #ifndef VTERM_H
@@ -72,17 +157,223 @@ typedef struct
 typedef struct {
   int master, slave;
   const char *shell;
+  pid_t pid;   // the shell, -1 before it was spawned
+  bool exited; // reaped, status is its wait status
+  int status;
 } VTermPTY;
 
+/* One malloc per session, everything else is carved out of it */
+typedef struct {
+  uint8_t *base;
+  size_t size;
+  size_t used;
+} VTermArena;
+
+// dec_modes bits, private modes set by ESC[?<n>h
+#define VTERM_DEC_CURSOR_KEYS     0x01 // ?1    arrows send SS3 instead of CSI
+#define VTERM_DEC_BRACKETED_PASTE 0x02 // ?2004 wrap pastes in ESC[200~/ESC[201~
+#define VTERM_DEC_SYNC_OUTPUT     0x04 // ?2026 app is mid update, keep the last frame up
+#define VTERM_DEC_SMOOTH_SCROLL   0x08 // ?4    DECSCLM, scroll a line at a time (no jump scroll)
+
+// An app that dies mid synchronized update doesn't freeze the screen
+#define VTERM_SYNC_TIMEOUT 0.15
+
+// Bell: at most one ring per interval, the flash and the tone last this long
+#define VTERM_BELL_INTERVAL 0.2
+#define VTERM_BELL_FLASH 0.1
+#define VTERM_BELL_TONE 0.08
+
+/* Inline images, a subset of kitty's graphics protocol (vterm_image.c):
+ * ESC _ G <key>=<value>,... ; <base64> ESC \. Payloads stream into the
+ * session's transfer, never through escape_buf, and a worker thread decodes
+ * them. Decoded images are kept by id in one LRU for all sessions, at most
+ * VTERM_IMAGE_BUDGET bytes (VTERM_IMAGE_MEMORY=<MiB> overrides it); GPU
+ * copies have a budget of their own. Placements belong to a screen's rows
+ * and scroll with them. */
+#define VTERM_IMAGE_BUDGET (256 << 20)
+#define VTERM_IMAGE_TEXTURE_BUDGET (128 << 20)
+#define VTERM_IMAGE_MAX_PAYLOAD (64 << 20) // decoded bytes of one transfer
+#define VTERM_IMAGE_MAX 1024               // images cached at once
+#define VTERM_IMAGE_PLACEMENTS 64          // per screen, the oldest go first
+
+typedef struct {
+  uint32_t image;      // id within the session
+  uint16_t slot;       // cache slot it was last found in, checked before use
+  int16_t row;         // top row, negative once partly scrolled off
+  uint16_t col;
+  uint16_t cols, rows; // cells covered, the image is scaled to fill them
+} VTermImagePlacement;
+
+typedef struct VTermImageTransfer VTermImageTransfer; // vterm_image.c
+
+/* Control strings (vterm_osc.c): OSC (ESC ]), DCS (ESC P), SOS and PM are
+ * streamed a chunk at a time up to their terminator (ST, BEL too for OSC),
+ * never through escape_buf, into a per session buffer that grows up to
+ * VTERM_STRING_MAX; past it the rest of the string is dropped. OSC 52
+ * (clipboard) payloads are base64 decoded as they arrive, 16 characters at
+ * a time with vector instructions, so only the decoded bytes are kept.
+ * Handled: OSC 0/2 window title, OSC 52 setting the clipboard (reading it
+ * back is refused). The rest are read to their end and ignored. */
+#define VTERM_STRING_MAX (16 << 20) // bytes kept of one string, decoded for OSC 52
+#define VTERM_STRING_KEEP 65536     // a buffer up to this size stays for the next string
+#define VTERM_TITLE_MAX 256
+
+enum {
+  VTERM_STRING_NONE,
+  VTERM_STRING_OSC,
+  VTERM_STRING_DCS,
+  VTERM_STRING_IGNORE, // SOS, PM
+};
+
+typedef struct VTermString VTermString; // vterm_osc.c
+
+/* Base64 decoding state between chunks: the characters of a quantum not
+ * complete yet */
+typedef struct {
+  uint32_t quad;
+  int quad_len;
+} VTermBase64;
+
+// Room VTermBase64Decode may write for len characters (whole 4 byte stores)
+#define VTERM_BASE64_ROOM(len) ((len) / 4 * 3 + 8)
+
+// Row loops specialised by width, see VTermSelectKernels
+typedef struct VTermKernels VTermKernels;
+
+/* Escape/wrap state, shared by a buffer and its alt screen */
+typedef struct {
+  uint32_t dec_modes;
+  bool previousWasEscape;
+  bool escapeIntermediate; // ESC followed by 0x20-0x2F, waiting for its final byte
+  bool previousWasWrap;
+  bool previousWasCRAfterWrap;
+  double sync_start; // GetTime() when ?2026 was set
+  char escape_buf[VTERM_ESCAPE_MAX];
+  int escape_ix;
+  bool apc;                  // inside ESC _ ... ST
+  uint8_t string;            // VTERM_STRING_* while inside OSC/DCS/SOS/PM ... ST
+  VTermString *str;          // its state and payload (heap), NULL until the first
+  char title[VTERM_TITLE_MAX]; // OSC 0/2, empty until the app sets one
+  uint32_t image_owner;      // cache key of the session's images, 0 until the first
+  VTermImageTransfer *image; // command being streamed (heap), NULL between them
+} VTermParser;
+
+/* SGR state; resolved into fgbg_color whenever it changes so writing a cell
+ * stays a single store */
+#define VTERM_PEN_DEFAULT -1 // fg/bg_index: use the buffer default
+#define VTERM_PEN_RGB     -2 // fg/bg_index: use fg/bg as is
+typedef struct {
+  int16_t fg_index, bg_index;
+  Color fg, bg;
+  uint8_t style;
+} VTermPen;
+
+// size must be a power of 2, head/tail only ever grow
+#define VTERM_IO_RING_SIZE 4096
+#define VTERM_OUT_RING_SIZE 16384
+typedef struct {
+  uint8_t *data;
+  size_t size;
+  size_t head; // next byte to consume
+  size_t tail; // next byte to fill
+} VTermRing;
+
+// row_flags bits, they follow the row when it moves
+#define VTERM_ROW_WRAPPED 0x01 // row soft-wrapped into the next one
+#define VTERM_ROW_DIRTY   0x02 // cells changed since the last VTermTakeDamage
+
+/* What a renderer keeping the previous frame has to redo. Rows that only
+ * moved (scrolls inside one region) are a shift, not dirt: shift the pixels
+ * of [scroll_top, scroll_bottom) up by scroll rows (down if negative), then
+ * redraw the VTERM_ROW_DIRTY rows. */
+typedef struct {
+  bool full;
+  int16_t scroll;
+  uint16_t scroll_top, scroll_bottom;
+} VTermDamage;
+
+/* Disk scrollback: rows scrolled off the top of a main screen are appended
+ * to <dir>/vterm-XXXXXX (records) and <path>.idx (one uint64_t offset per
+ * record) and read back through small read-only maps that slide over the
+ * flushed part. The write buffers and two windows are all that lives in
+ * memory, however long the history gets. */
+#define VTERM_SCROLLBACK_PENDING 65536 // data bytes buffered before a write()
+#define VTERM_SCROLLBACK_PENDING_LINES 4096
+#define VTERM_SCROLLBACK_WINDOW (4 << 20) // bytes mapped per file, power of 2
+
+/* A record, 8 byte aligned: the header, uint64_t colors[runs], uint16_t
+ * counts[runs] (cells per colour run), then data[length]. Trailing blank
+ * cells are not stored. */
+typedef struct {
+  uint16_t length;
+  uint16_t runs;
+  uint8_t flags; // row_flags when it left the screen (VTERM_ROW_WRAPPED)
+  uint8_t reserved[3];
+} VTermScrollbackLine;
+
+// The cells of a record, after its colour runs
+static inline const uint8_t *VTermScrollbackText(const VTermScrollbackLine *line)
+{
+  return (const uint8_t *)(line + 1) + line->runs * (sizeof(uint64_t) + sizeof(uint16_t));
+}
+
+typedef struct {
+  const uint8_t *base; // NULL until the first read
+  uint64_t offset;     // file offset of base, page aligned
+  size_t size;
+} VTermScrollbackWindow;
+
+/* Search index over the scrollback: every VTERM_SEARCH_PAGE_LINES lines get
+ * a trigram signature (one bit per hashed trigram present) that a background
+ * thread appends to <path>.tri. Queries only scan the pages whose signature
+ * has every trigram the match needs. */
+#define VTERM_SEARCH_PAGE_LINES 256
+#define VTERM_SEARCH_SIGNATURE_BITS 16384
+#define VTERM_SEARCH_REGEX    0x01 // POSIX extended regex, else a literal
+#define VTERM_SEARCH_NO_INDEX 0x02 // scan every line (benchmarks)
+
+typedef struct VTermSearchIndex VTermSearchIndex; // vterm_search.c
+
+typedef struct {
+  uint64_t line; // scrollback line, 0 is the oldest
+  uint16_t col, length;
+} VTermSearchHit;
+
+typedef struct {
+  int fd, index_fd;    // -1 when there is no scrollback
+  char path[256];
+  uint64_t lines;      // records appended
+  uint64_t size;       // data file bytes, pending ones included
+  uint64_t view;       // lines scrolled back, 0 shows the live screen
+
+  uint64_t flushed_lines, flushed_size; // what the windows may cover
+  VTermScrollbackWindow data_window, index_window;
+
+  uint8_t *pending;    // records not yet written
+  size_t pending_len, pending_cap;
+  uint64_t *pending_index;
+  uint32_t pending_lines;
+  VTermSearchIndex *search; // NULL if the index thread did not start
+} VTermScrollback;
+
 typedef struct {
   uint8_t *data;
   uint64_t *fgbg_colors;
+  uint8_t *row_flags;  // by screen row
+  uint16_t *row_index; // screen row -> row in data/fgbg_colors, scrolls rotate this
   uint16_t column_count;
   uint16_t row_count;
   uint16_t col;
   uint16_t row;
+  uint16_t saved_col, saved_row; // DECSC / CSI s
+  uint16_t scroll_top, scroll_bottom; // DECSTBM region, [top, bottom)
+  VTermDamage damage;
+  VTermImagePlacement *placements; // VTERM_IMAGE_PLACEMENTS of them
+  uint16_t placement_count;
+  uint32_t images_seen; // decodes finished when the placements were last redrawn
   VTermPTY *pty;  // pseudo-terminal
   VTermMode mode; // Mode this buffer is using
+  const VTermKernels *kernels; // row loops for this width
   size_t buffer_size;
   uint16_t font_size;
 
@@ -91,46 +382,373 @@ typedef struct {
   // Packed:
   uint64_t fgbg_color;
   uint64_t default_fgbg;
+  VTermPen pen;
 
   Font font;
-  void *alt_buffer;
+  const VTermPackedFont *glyphs; // cell is glyphs->width x glyphs->height at 1x
+  void *alt_buffer; // == alt_screen while in the alternate buffer
+  void *alt_screen; // preallocated in the arena, NULL for alt screens
+  void *view_screen; // scrollback view, VTermScrollbackView fills it
+  VTermScrollback *scrollback; // session-wide, shared with the alt screen
+
+  VTermParser *parser;
+  VTermRing *in;    // bytes read from the pty not yet parsed
+  VTermRing *out;   // encoded input not yet written to the pty
+  double out_stamp; // GetTime() of the oldest event in out, 0 if empty
+  char *paste;      // what did not fit in out (heap, freed when drained)
+  size_t paste_len, paste_at;
+
+  // Latency probe, one key event in flight at a time (GetTime(), 0 = unset)
+  double probe_key;
+  double probe_echo;
+  double probe_parsed;
+  VTermArena arena; // base is NULL for alt screens (owned by principal)
 } VTermDataBuffer;
 
+/***** PANES *****/
+/* Sessions tiled side by side in one window (Super+Enter splits). A pane
+ * keeps its last frame in a render texture and redraws only what its
+ * session damaged, so a pane flooding output doesn't cost the idle ones
+ * anything; the window frame is a quad per pane. What all panes rasterize
+ * in a frame is capped, updates over the cap wait for the next frame. */
+#define VTERM_PANE_GAP 4          // pixels between panes, the focus border goes in it
+#define VTERM_PANE_ROW_BUDGET 160 // rows rasterized per frame, all panes together
+
+typedef struct {
+  uint16_t buffer_ix;        // session shown
+  int x, y, width, height;   // viewport, window pixels
+  RenderTexture2D target[2]; // last frame, and where a scroll shifts it to
+  int front;                 // target holding the last frame
+  const void *shown;         // screen it shows, another one is a full redraw
+  unsigned int font;         // glyph texture it was drawn with
+  uint64_t view;             // scrollback view it was drawn at
+  bool valid;                // front holds a whole frame
+} VTermPane;
+
 typedef struct {
   VTermDataBuffer *buffers[MAX_BUFFER_COUNT]; // At most can have MAX_BUFFERS
+  VTermPane panes[MAX_BUFFER_COUNT]; // by buffer index, pane_count of them
+  uint16_t pane_count; // 0: the current buffer fills the window
 
   uint16_t pixel_width;
   uint16_t pixel_height;
   uint16_t buffer_ix; // current buffer index
+
+  // Frame pacing (GetTime() seconds)
+  double frame_start;   // woke up to build this frame
+  double frame_drawn;   // VTermDraw done, only the swap is left
+  double frame_present; // last swap returned
+  double frame_work;    // moving average of start -> drawn
+
+  double output_parsed; // GetTime() of the oldest parse not presented yet, 0 if none
+
+  bool busy; // this frame parsed/sent/resized something
+  bool idle; // EndDrawing() may block in the window system this frame
+  bool soft_render; // composite on the CPU (VTERM_RENDERER=soft)
+  bool held; // last frame was skipped for a synchronized update
+  int server_fd; // attached to a session server (--attach), else -1
 } VTerm;
 
+/***** SOFTWARE RENDERER *****/
+#define VTERM_SOFT_MAX_THREADS 15 // workers, the caller renders a band too
+
+typedef struct {
+  Color *pixels; // RGBA, width * height
+  int width, height;
+} VTermFramebuffer;
+
+#define VTERM_CURSOR_BLINK 0.5 // seconds per blink phase
+
+/***** SNAPSHOTS *****/
+/* A whole VTerm in one file (VTERM_SNAPSHOT=<path>: restored on start, saved
+ * on exit). Grids are stored the way they are in memory, row_index and all,
+ * at 8 byte aligned offsets: a restore maps the file and copies each array
+ * into a new session without looking at it. Scrollbacks and their search
+ * signatures are hard linked beside it as <path>.<buffer>{,.idx,.tri}. */
+#define VTERM_SNAPSHOT_MAGIC "VTSNAP1"
+#define VTERM_SNAPSHOT_VERSION 1
+
+typedef struct {
+  char magic[8];
+  uint32_t version;
+  uint16_t buffer_ix;
+  uint16_t reserved;
+  uint64_t size;                       // of the whole file
+  uint64_t sessions[MAX_BUFFER_COUNT]; // VTermSnapshotSession offsets, 0 for none
+} VTermSnapshotHeader;
+
+// A scrollback as a snapshot recorded it, the files may have grown since
+typedef struct {
+  uint64_t lines, size;
+  uint64_t pages; // search signatures
+} VTermScrollbackSaved;
+
+typedef struct {
+  uint32_t mode;
+  uint16_t column_count, row_count;
+  uint16_t col, row, saved_col, saved_row;
+  uint16_t scroll_top, scroll_bottom;
+  uint16_t font_size;
+  int16_t fg_index, bg_index; // VTermPen
+  uint8_t style, reserved[3];
+  uint32_t fg, bg;
+  uint64_t fgbg_color, default_fgbg;
+  uint64_t data, colors, row_flags, row_index; // offsets of the arrays
+} VTermSnapshotScreen;
+
+typedef struct {
+  VTermSnapshotScreen screens[2]; // main, alt
+  uint32_t dec_modes;
+  uint8_t in_alt, wrap, cr_after_wrap, reserved;
+  VTermScrollbackSaved saved;
+  char scrollback[256]; // file name beside the snapshot, "" for none
+} VTermSnapshotSession;
+
+/***** SESSION SERVER *****/
+/* vterm --server <socket> owns the child and the screen, vterm --attach
+ * <socket> windows come and go. Every message is a VTermWireHeader and
+ * length bytes of payload, in host byte order (both ends share a machine). */
+#define VTERM_SERVER_MAX_CLIENTS 16
+#define VTERM_SERVER_FRAME 0.008     // seconds between damage frames at most
+#define VTERM_WIRE_MAX (64 << 20)    // longest message either end accepts
+
+typedef enum {
+  VTERM_WIRE_SNAPSHOT = 1, // server: VTermWireFrame, every row as a span
+  VTERM_WIRE_DAMAGE,       // server: VTermWireFrame, the spans that changed
+  VTERM_WIRE_EXIT,         // server: the child is gone, so is the server
+  VTERM_WIRE_INPUT = 16,   // client: bytes for the child
+  VTERM_WIRE_RESIZE,       // client: VTermWireResize
+  VTERM_WIRE_ACK,          // client: uint32_t seq of the frame it applied
+} VTermWireType;
+
+typedef struct {
+  uint32_t type, length;
+} VTermWireHeader;
+
+/* A frame brings the client from what it last got straight to the server's
+ * current screen, frames in between are never sent: the next one waits for
+ * the client's ACK. scroll moves rows of [scroll_top, scroll_bottom) like
+ * VTermScrollRegion before the spans go on. */
+typedef struct {
+  uint32_t seq;
+  uint16_t column_count, row_count;
+  uint16_t col, row;
+  uint32_t dec_modes;
+  int16_t scroll;
+  uint16_t scroll_top, scroll_bottom;
+  uint16_t spans;
+} VTermWireFrame;
+
+// Followed by uint64_t colors[count], then count cell bytes padded to 8
+typedef struct {
+  uint16_t row, col, count, reserved;
+} VTermWireSpan;
+
+typedef struct {
+  uint16_t column_count, row_count;
+} VTermWireResize;
+
+/* Client end, VTermClientRead applies frames to a VTerm of its own */
+typedef struct {
+  int fd;
+  uint8_t *in; // partial message
+  size_t in_len, in_cap;
+  uint32_t seq;    // last frame applied
+  uint64_t bytes;  // received so far
+  uint32_t frames; // applied so far
+  bool exited;
+} VTermClient;
+
+// Cells keep the font's aspect, font_size is the cell height in pixels
+static inline int VTermCellWidth(const VTermDataBuffer *buf)
+{
+  return buf->font_size * buf->glyphs->width / buf->glyphs->height;
+}
+
+// Rows are not contiguous across the screen, always go through these
+static inline uint8_t *VTermRowData(const VTermDataBuffer *buf, uint16_t row)
+{
+  return buf->data + (size_t)buf->row_index[row] * buf->column_count;
+}
+
+static inline uint64_t *VTermRowColors(const VTermDataBuffer *buf, uint16_t row)
+{
+  return buf->fgbg_colors + (size_t)buf->row_index[row] * buf->column_count;
+}
+
 
 bool VTermInit(VTerm *, const uint16_t, const uint16_t, VTermMode);
+bool VTermInitHeadless(VTerm *, VTermMode);
 bool VTermSpawn(VTerm *);
-bool VTermInitPTY(VTermPTY **);
+bool VTermInitPTY(VTermPTY *);
 bool VTermSpawnPTY(VTermPTY *);
+int VTermChildFd(void);
+int VTermReapChildren(void);
+void VTermMoveChild(VTermPTY *, VTermPTY *);
 
 /*   TODO: Set global variable VTERM_ERROR or something which is set if err
  * returned */
 bool VTermUpdate(VTerm *);
 bool VTermDraw(VTerm *);
 bool VTermDrawText(VTermDataBuffer *);
+bool VTermDrawRows(VTermDataBuffer *);
+int VTermDrawDirtyRows(VTermDataBuffer *);
+void VTermRowCacheClose(void);
+Color VTermBackground(VTerm *);
 bool VTermSendInput(VTerm *);
+bool VTermPaste(VTerm *, const char *);
+bool VTermFlushInput(VTermDataBuffer *);
+size_t VTermEncodeUTF8(uint32_t, char *);
+size_t VTermEncodeKey(VTermDataBuffer *, int, int, char *);
 
 
 bool VTermExecuteEscapeCode(VTerm *, char *, int);
+int VTermParseParams(const char *, int, uint16_t *, char *);
+void VTermSelectGraphicRendition(VTermDataBuffer *, const char *, int);
+void VTermUpdatePen(VTermDataBuffer *);
+void VTermInitPalette(void);
+bool VTermProcessByte(VTerm *, uint8_t);
+bool VTermProcessBytes(VTerm *, const uint8_t *, size_t);
+bool VTermProcessRing(VTerm *, VTermRing *);
+const VTermKernels *VTermSelectKernels(uint16_t, bool);
 
 bool VTermIsTextMode(VTermDataBuffer *);
 
+int VTermWakeFds(VTerm *, fd_set *);
+void VTermWaitFrame(VTerm *);
+bool VTermSyncHeld(VTermParser *, double);
+bool VTermHoldFrame(VTerm *);
+void VTermFramePresented(VTerm *);
+
+bool VTermIdleInit(VTerm *);
+void VTermIdleClose(void);
+void VTermIdleBegin(VTerm *);
+void VTermIdleEnd(VTerm *);
+double VTermNextBlink(void);
+bool VTermCursorVisible(void);
+
+void VTermStringBegin(VTermDataBuffer *, uint8_t);
+size_t VTermStringBytes(VTerm *, VTermDataBuffer *, const uint8_t *, size_t);
+void VTermStringRelease(VTermParser *);
+const char *VTermTitle(VTerm *);
+size_t VTermBase64Decode(VTermBase64 *, const uint8_t *, size_t, uint8_t *, bool);
+size_t VTermBase64Finish(VTermBase64 *, uint8_t *);
+
+void VTermBell(void);
+bool VTermBellDraw(VTerm *);
+void VTermBellClose(void);
+
+bool VTermLayoutPanes(VTerm *);
+bool VTermSplitPane(VTerm *);
+bool VTermClosePane(VTerm *, uint16_t);
+void VTermFocusPane(VTerm *, int);
+bool VTermDrawPanes(VTerm *);
+bool VTermPanesHeld(VTerm *);
+void VTermPanesRelease(VTerm *);
+
+Font VTermGlyphFont(VTermDataBuffer *);
+bool VTermGlyphsBuilding(void);
+void VTermGlyphsWait(void);
+void VTermGlyphsClose(void);
+
+void VTermHistAdd(VTermHistogram *, double);
+double VTermHistPercentile(VTermHistogram *, double);
+void VTermDrawMetricsOverlay(VTerm *);
+bool VTermWriteMetrics(FILE *);
+bool VTermDumpMetrics(const char *);
+void VTermMetricsTick(double);
+
+const VTermPackedFont *VTermModeFont(VTermMode);
+const VTermPackedFont *VTermFindFont(const char *);
+bool VTermFontPackOpen(const char *);
+void VTermFontPackClose(void);
+Font VTermLoadPackedFont(const VTermPackedFont *);
+bool VTermInitFonts(bool);
+
+bool VTermFramebufferInit(VTermFramebuffer *, VTermDataBuffer *);
+void VTermFramebufferClose(VTermFramebuffer *);
+void VTermSoftRenderRows(VTermDataBuffer *, VTermFramebuffer *, uint16_t, uint16_t, bool);
+bool VTermSoftRender(VTermDataBuffer *, VTermFramebuffer *);
+bool VTermSoftRenderDamage(VTermDataBuffer *, VTermFramebuffer *);
+bool VTermSoftPoolInit(int);
+void VTermSoftPoolClose(void);
+bool VTermFramebufferExport(VTermFramebuffer *, const char *);
+void VTermSoftDraw(VTermDataBuffer *);
+
+int VTermBench(int, char **);
+
+int VTermServe(int, char **);
+bool VTermAttach(VTerm *, VTermClient *, const char *);
+int VTermServerRun(const char *, VTermMode, uint16_t, uint16_t);
+bool VTermClientConnect(VTermClient *, const char *);
+void VTermClientClose(VTermClient *);
+bool VTermClientRead(VTermClient *, VTerm *);
+bool VTermWireSend(int, VTermWireType, const void *, size_t);
+bool VTermClientFlushInput(VTermClient *, VTermDataBuffer *);
+
+void VTermImageByte(VTerm *, VTermDataBuffer *, uint8_t);
+void VTermImageRelease(VTermParser *);
+void VTermImageScroll(VTermDataBuffer *, uint16_t, uint16_t, int);
+void VTermImageClear(VTermDataBuffer *);
+void VTermImageMove(VTermDataBuffer *, VTermDataBuffer *, int);
+bool VTermImageRefresh(VTermDataBuffer *);
+void VTermImageCompositeRow(VTermDataBuffer *, VTermFramebuffer *, uint16_t);
+void VTermImageDraw(VTermDataBuffer *);
+void VTermImageWait(void);
+void VTermImageClose(void);
+
+bool VTermSnapshotSave(VTerm *, const char *);
+bool VTermSnapshotRestore(VTerm *, const char *);
+
+bool VTermScrollbackOpen(VTermScrollback *, const char *);
+void VTermScrollbackClose(VTermScrollback *);
+bool VTermScrollbackPush(VTermScrollback *, const uint8_t *, const uint64_t *, uint16_t, uint64_t, uint8_t);
+bool VTermScrollbackFlush(VTermScrollback *);
+bool VTermScrollbackRead(VTermScrollback *, uint64_t, uint8_t *, uint64_t *, uint16_t, uint64_t, uint8_t *);
+void VTermScrollbackClear(VTermScrollback *);
+bool VTermScrollbackReplace(int, const char *, const char *);
+bool VTermScrollbackTake(int, const char *, const char *, uint64_t);
+bool VTermScrollbackLink(VTermScrollback *, const char *, VTermScrollbackSaved *);
+bool VTermScrollbackAdopt(VTermScrollback *, const char *, const char *, const VTermScrollbackSaved *);
+VTermDataBuffer *VTermScrollbackView(VTermDataBuffer *);
+bool VTermScrollView(VTerm *, int);
+const uint8_t *VTermScrollbackAt(int, VTermScrollbackWindow *, uint64_t, size_t);
+const VTermScrollbackLine *VTermScrollbackRecord(int, int, VTermScrollbackWindow *, VTermScrollbackWindow *, uint64_t);
+
+bool VTermSearchOpen(VTermScrollback *);
+void VTermSearchClose(VTermSearchIndex *);
+void VTermSearchNotify(VTermSearchIndex *, uint64_t);
+void VTermSearchReset(VTermSearchIndex *);
+void VTermSearchWait(VTermSearchIndex *);
+uint64_t VTermSearchLink(VTermSearchIndex *, const char *);
+bool VTermSearchAdopt(VTermSearchIndex *, const char *, uint64_t);
+int VTermSearch(VTermScrollback *, const char *, int, VTermSearchHit *, int);
+
 void VTermIncreaseFontSize(VTerm *, int32_t);
 void VTermEnsureResolution(VTerm *);
+bool VTermResize(VTerm *, uint16_t, uint16_t);
+bool VTermResizeBuffer(VTermDataBuffer **, uint16_t, uint16_t);
+void VTermReflow(VTermDataBuffer *, VTermDataBuffer *);
+bool VTermSetWinSize(VTermDataBuffer *);
 void VTermModeToStr(VTermMode, char *);
 
 bool _VTermInitBuffer(VTermDataBuffer **, VTermMode, bool);
+bool VTermStartChild(VTermDataBuffer *);
+bool VTermInitBufferSized(VTermDataBuffer **, VTermMode, uint16_t, uint16_t);
 bool VTermInitBuffer(VTermDataBuffer **, VTermMode);
 bool VTermInitBufferFrom(VTermDataBuffer **, VTermDataBuffer *);
 void VTermCloseBuffer(VTermDataBuffer *);
 
+size_t VTermSessionSize(uint16_t, uint16_t);
+bool VTermArenaInit(VTermArena *, size_t);
+void *VTermArenaAlloc(VTermArena *, size_t);
+void VTermArenaFree(VTermArena *);
+
+ssize_t VTermRingFill(VTermRing *, int);
+ssize_t VTermRingDrain(VTermRing *, int);
+size_t VTermRingUsed(VTermRing *);
+size_t VTermRingPush(VTermRing *, const void *, size_t);
+
 typedef enum {
   VTERM_RESET_BUFFER_DATA_FORWARDS,
   VTERM_RESET_BUFFER_DATA_BACKWARDS,
@@ -140,6 +758,11 @@ typedef enum {
 } VTermResetBufferDataDir;
 
 bool VTermResetBufferData(VTermDataBuffer *, uint16_t, uint16_t, VTermResetBufferDataDir);
+void VTermEraseCells(VTermDataBuffer *, uint16_t, uint16_t, uint16_t);
+void VTermScrollRegion(VTermDataBuffer *, uint16_t, uint16_t, int);
+void VTermLineFeed(VTermDataBuffer *);
+void VTermReverseIndex(VTermDataBuffer *);
+VTermDamage VTermTakeDamage(VTermDataBuffer *);
 
 VTermDataBuffer *VTermGetCurrentBuffer(VTerm *);
 VTermDataBuffer *VTermGetCurrentPrincipalBuffer(VTerm *);
@@ -0,0 +1,133 @@
+#include "vterm.h"
+
+/* Bell: BEL only records that a bell is due, the frame loop shows it. A
+ * burst of BELs (`yes $'\a'`, a failing tab completion held down) rings at
+ * most once per VTERM_BELL_INTERVAL, the rest are counted as coalesced.
+ * VTERM_BELL picks what ringing does: visual (default), audible, both or
+ * none. The tone is synthesised once and handed to raylib's mixer, which
+ * plays it on its own thread, so neither path blocks the parser. */
+
+enum {
+  VTERM_BELL_VISUAL = 1,
+  VTERM_BELL_AUDIBLE = 2,
+};
+
+static struct {
+  int mode;           // VTERM_BELL_* bits, -1 until VTERM_BELL is read
+  double last;        // when the bell last rang, 0 if never
+  double flash_until; // end of the flash in progress
+  bool flashing;      // the last frame drew the flash, the next one clears it
+  bool pending;       // rang since the last frame, the tone is still to play
+  bool audio;         // InitAudioDevice was ours to close
+  bool sound_loaded;
+  Sound sound;
+} VTermBellState = { .mode = -1 };
+
+static double VTermBellNow(void)
+/* Parsing happens without a window too (--server, --bench), GetTime() needs one */
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int VTermBellMode(void)
+{
+  if (VTermBellState.mode < 0)
+  {
+    const char *env = getenv("VTERM_BELL");
+    VTermBellState.mode = VTERM_BELL_VISUAL;
+    if (env && strcmp(env, "none") == 0)
+      VTermBellState.mode = 0;
+    else if (env && strcmp(env, "audible") == 0)
+      VTermBellState.mode = VTERM_BELL_AUDIBLE;
+    else if (env && strcmp(env, "both") == 0)
+      VTermBellState.mode = VTERM_BELL_VISUAL | VTERM_BELL_AUDIBLE;
+  }
+  return VTermBellState.mode;
+}
+
+void VTermBell(void)
+/* BEL from the child, called by the parser: bookkeeping only */
+{
+  double now = VTermBellNow();
+  VTermStats.bells++;
+  if (VTermBellMode() == 0)
+    return;
+  if (VTermBellState.last != 0 && now - VTermBellState.last < VTERM_BELL_INTERVAL)
+  {
+    VTermStats.bells_coalesced++;
+    return;
+  }
+  VTermBellState.last = now;
+  VTermBellState.flash_until = now + VTERM_BELL_FLASH;
+  VTermBellState.pending = true;
+}
+
+static bool VTermBellLoadSound(void)
+/* A short decaying 880Hz tone, 16 bit mono */
+{
+  const unsigned rate = 44100, frames = rate * VTERM_BELL_TONE;
+  int16_t *samples;
+
+  if (VTermBellState.sound_loaded)
+    return true;
+  if (!IsAudioDeviceReady())
+  {
+    InitAudioDevice();
+    if (!IsAudioDeviceReady())
+      return false;
+    VTermBellState.audio = true;
+  }
+  samples = malloc(frames * sizeof(int16_t));
+  if (!samples)
+    return false;
+  for (unsigned i = 0; i < frames; i++)
+  {
+    double t = (double)i / rate;
+    samples[i] = (int16_t)(8000 * sin(2 * PI * 880 * t) * (1 - (double)i / frames));
+  }
+  VTermBellState.sound = LoadSoundFromWave((Wave){
+    .frameCount = frames, .sampleRate = rate, .sampleSize = 16, .channels = 1, .data = samples,
+  });
+  free(samples); // the sound has its own copy
+  VTermBellState.sound_loaded = true;
+  return true;
+}
+
+bool VTermBellDraw(VTerm *vt)
+/* Once per frame after the cells: plays a pending tone and draws the flash.
+ * True while the flash is up, or it was and this frame has to clear it */
+{
+  int mode = VTermBellMode();
+  bool was = VTermBellState.flashing;
+
+  if (VTermBellState.pending)
+  {
+    VTermBellState.pending = false;
+    VTermStats.bells_rung++;
+    if ((mode & VTERM_BELL_AUDIBLE) && VTermBellLoadSound())
+      PlaySound(VTermBellState.sound);
+    else if (mode & VTERM_BELL_AUDIBLE)
+      mode |= VTERM_BELL_VISUAL; // no audio device, don't ring silently
+    if (!(mode & VTERM_BELL_VISUAL))
+      VTermBellState.flash_until = 0;
+  }
+
+  VTermBellState.flashing = VTermBellNow() < VTermBellState.flash_until;
+  if (VTermBellState.flashing)
+  {
+    DrawRectangle(0, 0, vt->pixel_width, vt->pixel_height, (Color){ 255, 255, 255, 64 });
+    VTermStats.frame_rects++;
+  }
+  return VTermBellState.flashing || was;
+}
+
+void VTermBellClose(void)
+{
+  if (VTermBellState.sound_loaded)
+    UnloadSound(VTermBellState.sound);
+  if (VTermBellState.audio)
+    CloseAudioDevice();
+  VTermBellState.sound_loaded = VTermBellState.audio = false;
+}
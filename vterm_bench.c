@@ -0,0 +1,1279 @@
+#include "vterm.h"
+#include <limits.h>
+#include <poll.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+/* Headless entry points, no window is opened:
+ *   vterm --bench soft [cols rows [frames]]
+ *   vterm --bench vim [cols rows [pages]]
+ *   vterm --bench replay <capture> [cols rows]
+ *   vterm --bench scrollback [cols rows [lines]]
+ *   vterm --bench search [cols rows [lines]]
+ *   vterm --bench server [cols rows [lines]]
+ *   vterm --bench snapshot [cols rows [lines]]
+ *   vterm --bench images [cols rows [images]]
+ *   vterm --bench spawn [sessions [ballast MiB...]]
+ *   vterm --bench rows [cols rows [frames]]
+ *   vterm --bench zoom [sweeps]
+ *   vterm --bench kernels [lines]
+ *   vterm --bench jump [cols rows [lines]]
+ *   vterm --bench panes [panes [frames]]
+ *   vterm --bench osc [MiB]
+ *   vterm --render <input> <out.ppm|png> [cols rows] */
+
+static double VTermBenchNow(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static bool VTermBenchGrid(VTerm *vt, int argc, char **argv, int at)
+{
+  if (!VTermInitHeadless(vt, VTERM_MODE_MONOCHROME_TEXT_40_25))
+    return false;
+  if (argc > at + 1)
+    return VTermResize(vt, atoi(argv[at]), atoi(argv[at + 1]));
+  return true;
+}
+
+static int VTermBenchSoft(int argc, char **argv)
+/* Random glyphs and palette colours, every frame renders the whole grid */
+{
+  VTerm vt;
+  VTermFramebuffer fb;
+  int frames = argc > 5 ? atoi(argv[5]) : 200;
+  int cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+  if (!VTermBenchGrid(&vt, argc, argv, 3))
+    return 1;
+  VTermDataBuffer *buf = VTermGetCurrentBuffer(&vt);
+  if (!VTermFramebufferInit(&fb, buf))
+    return 1;
+
+  srand(1);
+  for (int i = 0; i < buf->column_count * buf->row_count; i++)
+  {
+    Color fg = VTermPalette[rand() % 256], bg = VTermPalette[rand() % 16];
+    fg.a = rand() % 8 == 0 ? VTERM_STYLE_UNDERLINE : 0;
+    buf->data[i] = 32 + rand() % 95;
+    buf->fgbg_colors[i] = PACK(*(uint32_t *)&fg, *(uint32_t *)&bg);
+  }
+
+  printf("soft: %ux%u cells, %dx%d px, %d frames\n", buf->column_count, buf->row_count, fb.width, fb.height, frames);
+  for (int threads = 1; threads <= cpus && threads <= VTERM_SOFT_MAX_THREADS + 1; threads *= 2)
+  {
+    VTermSoftPoolInit(threads);
+    VTermSoftRender(buf, &fb); // warm up the workers and caches
+    double start = VTermBenchNow();
+    for (int f = 0; f < frames; f++)
+      VTermSoftRender(buf, &fb);
+    double elapsed = VTermBenchNow() - start;
+    printf("  %2d threads: %8.1f frames/s  %8.1f Mpx/s\n", threads,
+           frames / elapsed, (double)fb.width * fb.height * frames / elapsed / 1e6);
+  }
+  VTermSoftPoolClose();
+  VTermFramebufferClose(&fb);
+  VTermCloseBuffer(buf);
+  return 0;
+}
+
+static size_t VTermBenchVimLine(char *out, int number, int cols)
+/* A source line the way vim paints it: line number, a bit of syntax colour,
+ * clear to end of line */
+{
+  static const char *words[] = { "static", "int", "return", "buf->row", "count", "if", "(", ")", "{", "}", "0", "+=", "memmove" };
+  size_t n = sprintf(out, "\33[33m%4d \33[0m", number);
+  int width = 5;
+  for (int w = (number * 7) % 11; width < cols - 12; w++)
+  {
+    const char *word = words[(w * 5 + number) % 13];
+    bool keyword = word[0] >= 'a' && word[0] <= 'z' && w % 3 == 0;
+    n += sprintf(out + n, keyword ? "\33[32m%s\33[0m " : "%s ", word);
+    width += strlen(word) + 1;
+  }
+  n += sprintf(out + n, "\33[K");
+  return n;
+}
+
+static size_t VTermBenchVimPage(char *out, int cols, int rows, int top, int step, bool scroll)
+/* What vim sends to move the view down step lines (from top): either the
+ * whole text area repainted, or DL inside a scroll region and only the
+ * lines that came in painted. The status line is redrawn either way. */
+{
+  int text = rows - 1, first = 0;
+  size_t n = 0;
+
+  if (scroll && step < text)
+  {
+    n += sprintf(out + n, "\33[1;%dr\33[1;1H\33[%dM\33[r", text, step);
+    first = text - step;
+  }
+  for (int r = first; r < text; r++)
+  {
+    n += sprintf(out + n, "\33[%d;1H", r + 1);
+    n += VTermBenchVimLine(out + n, top + step + r + 1, cols);
+  }
+  n += sprintf(out + n, "\33[%d;1H\33[7mbench.c  line %d\33[K\33[0m\33[1;1H", rows, top + step + 1);
+  return n;
+}
+
+static void VTermBenchFeed(VTerm *vt, const char *bytes, size_t len)
+{
+  VTermProcessBytes(vt, (const uint8_t *)bytes, len);
+}
+
+static int VTermBenchVim(int argc, char **argv)
+/* vim paging through a file at full and half page steps, repainting vs
+ * scrolling the region. Reports bytes on the wire, parse time and soft
+ * render time with damage (shift + dirty rows) and without. */
+{
+  static const struct { const char *name; int divisor; bool scroll; } runs[] = {
+    { "page   repaint", 1, false },
+    { "page   scroll ", 1, true },
+    { "half   repaint", 2, false },
+    { "half   scroll ", 2, true },
+    { "line   repaint", 0, false },
+    { "line   scroll ", 0, true },
+  };
+  int pages = argc > 5 ? atoi(argv[5]) : 500;
+  VTerm vt;
+
+  if (!VTermBenchGrid(&vt, argc, argv, 3))
+    return 1;
+  VTermDataBuffer *buf = VTermGetCurrentBuffer(&vt);
+  int cols = buf->column_count, rows = buf->row_count;
+  char *page = (char *)malloc((size_t)rows * (cols * 8 + 64));
+
+  VTermFramebuffer fb;
+  if (!VTermFramebufferInit(&fb, buf))
+    return 1;
+  printf("vim: %dx%d, %d steps per run\n", cols, rows, pages);
+  printf("  %-14s %9s %10s %11s %11s\n", "step", "bytes", "parse us", "damage us", "full us");
+  for (size_t i = 0; i < sizeof(runs) / sizeof(runs[0]); i++)
+  {
+    int step = runs[i].divisor ? (rows - 1) / runs[i].divisor : 1;
+    double parse = 0, damage = 0, full = 0;
+    size_t bytes = 0;
+
+    VTermResetBufferData(buf, 0, 0, VTERM_RESET_BUFFER_DATA_ALL);
+    VTermSoftRender(buf, &fb);
+    VTermTakeDamage(buf);
+    for (int p = 0; p < pages; p++)
+    {
+      size_t n = VTermBenchVimPage(page, cols, rows, p * step, step, runs[i].scroll);
+      double t0 = VTermBenchNow();
+      VTermBenchFeed(&vt, page, n);
+      double t1 = VTermBenchNow();
+      VTermSoftRenderDamage(buf, &fb);
+      double t2 = VTermBenchNow();
+      bytes += n;
+      parse += t1 - t0;
+      damage += t2 - t1;
+    }
+    /* Reference: the same frames rendered from scratch */
+    double t0 = VTermBenchNow();
+    for (int p = 0; p < pages; p++)
+      VTermSoftRender(buf, &fb);
+    full = VTermBenchNow() - t0;
+
+    printf("  %-14s %9zu %10.2f %11.2f %11.2f\n", runs[i].name, bytes / pages,
+           parse / pages * 1e6, damage / pages * 1e6, full / pages * 1e6);
+  }
+  free(page);
+  VTermFramebufferClose(&fb);
+  VTermCloseBuffer(buf);
+  return 0;
+}
+
+static int VTermBenchReplay(int argc, char **argv)
+/* A captured pty stream (e.g. `script -q -c "vim file" capture`) fed in
+ * frame sized chunks, parse and damage render timed separately */
+{
+  VTerm vt;
+  VTermFramebuffer fb;
+  size_t len = 0, cap = 1 << 16, chunk = VTERM_IO_RING_SIZE;
+  char *bytes;
+  FILE *in;
+
+  if (argc < 4 || (in = fopen(argv[3], "rb")) == NULL)
+  {
+    fprintf(stderr, "usage: %s --bench replay <capture> [cols rows]\n", argv[0]);
+    return 1;
+  }
+  bytes = (char *)malloc(cap);
+  for (size_t n; (n = fread(bytes + len, 1, cap - len, in)) > 0; )
+    if ((len += n) == cap)
+      bytes = (char *)realloc(bytes, cap *= 2);
+  fclose(in);
+
+  if (!VTermBenchGrid(&vt, argc, argv, 4))
+    return 1;
+  VTermDataBuffer *buf = VTermGetCurrentBuffer(&vt);
+  if (!VTermFramebufferInit(&fb, buf))
+    return 1;
+
+  double parse = 0, render = 0;
+  int frames = 0;
+  for (size_t at = 0; at < len; at += chunk, frames++)
+  {
+    size_t n = len - at < chunk ? len - at : chunk;
+    double t0 = VTermBenchNow();
+    VTermBenchFeed(&vt, bytes + at, n);
+    double t1 = VTermBenchNow();
+    /* The alt screen may have come or gone, damage is per screen */
+    if (VTermGetCurrentBuffer(&vt) != buf)
+    {
+      buf = VTermGetCurrentBuffer(&vt);
+      buf->damage.full = true;
+    }
+    VTermSoftRenderDamage(buf, &fb);
+    render += VTermBenchNow() - t1;
+    parse += t1 - t0;
+  }
+  printf("replay: %zu bytes, %d chunks of %zu\n", len, frames, chunk);
+  printf("  parse  %8.2f ms  %8.1f MB/s\n", parse * 1e3, len / parse / 1e6);
+  printf("  render %8.2f ms  %8.2f us/chunk\n", render * 1e3, render / frames * 1e6);
+  free(bytes);
+  VTermFramebufferClose(&fb);
+  VTermCloseBuffer(VTermGetCurrentPrincipalBuffer(&vt));
+  return 0;
+}
+
+static long VTermBenchRSS(void)
+/* Peak resident set in KiB (ru_maxrss is bytes on macOS) */
+{
+  struct rusage ru;
+  getrusage(RUSAGE_SELF, &ru);
+#ifdef __APPLE__
+  return ru.ru_maxrss / 1024;
+#else
+  return ru.ru_maxrss;
+#endif
+}
+
+static int VTermBenchScrollback(int argc, char **argv)
+/* A log of lines scrolling off into a disk scrollback, then read back at
+ * random and paged through from the oldest line to the newest. Last the
+ * window shrinks, and the rows it cuts off must land in the history. */
+{
+  long lines = argc > 5 ? atol(argv[5]) : 10000000;
+  const char *dir = getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp";
+  char line[128];
+  VTerm vt;
+
+  if (!VTermBenchGrid(&vt, argc, argv, 3))
+    return 1;
+  VTermDataBuffer *buf = VTermGetCurrentBuffer(&vt);
+  VTermScrollback *sb = buf->scrollback;
+  if (!VTermScrollbackOpen(sb, dir))
+    return 1;
+  long rss = VTermBenchRSS();
+
+  /* Spill: every line goes through the parser like a build log would */
+  double t0 = VTermBenchNow();
+  for (long i = 0; i < lines; i++)
+  {
+    size_t n = sprintf(line, "\33[3%dm%09ld\33[0m cc -c vterm_%ld.c -o vterm_%ld.o\r\n", (int)(i % 8), i, i % 97, i % 97);
+    VTermBenchFeed(&vt, line, n);
+  }
+  VTermScrollbackFlush(sb);
+  double spill = VTermBenchNow() - t0;
+  printf("scrollback: %dx%d, %lu lines spilled, %.1f MB data + %.1f MB index\n", buf->column_count, buf->row_count,
+         (unsigned long)sb->lines, sb->size / 1e6, sb->lines * 8 / 1e6);
+  printf("  spill   %8.2f s   %8.2f Mlines/s (parse included)\n", spill, sb->lines / spill / 1e6);
+
+  /* Random access, each one an index lookup and a record */
+  uint8_t *data = (uint8_t *)malloc(buf->column_count);
+  uint64_t *colors = (uint64_t *)malloc(buf->column_count * sizeof(uint64_t));
+  int reads = sb->lines > 0 ? 1000000 : 0, bad = 0;
+  srand(1);
+  t0 = VTermBenchNow();
+  for (int i = 0; i < reads; i++)
+  {
+    uint64_t n = ((uint64_t)rand() * RAND_MAX + rand()) % sb->lines;
+    VTermScrollbackRead(sb, n, data, colors, buf->column_count, buf->default_fgbg, NULL);
+    bad += atol((char *)data) != (long)n;
+  }
+  double random = VTermBenchNow() - t0;
+  printf("  random  %8.2f s   %8.1f ns/line  (%d wrong)\n", random, random / reads * 1e9, bad);
+
+  /* Page from the top of the history to the live screen */
+  long pages = 0;
+  t0 = VTermBenchNow();
+  for (sb->view = sb->lines; ; sb->view -= sb->view < buf->row_count ? sb->view : buf->row_count, pages++)
+  {
+    VTermDataBuffer *view = VTermScrollbackView(buf);
+    bad += sb->view > 0 && atol((char *)VTermRowData(view, 0)) != (long)(sb->lines - sb->view);
+    if (sb->view == 0)
+      break;
+  }
+  double paging = VTermBenchNow() - t0;
+  printf("  paging  %8.2f s   %8.1f us/page  (%ld pages, %d wrong)\n", paging, paging / pages * 1e6, pages, bad);
+  printf("  peak RSS %ld KiB before spilling, %ld KiB after\n", rss, VTermBenchRSS());
+
+  /* Halving the height of a full screen spills the rows that no longer fit
+   * (the log leaves the cursor on the last row), none is lost */
+  uint64_t before = sb->lines;
+  uint16_t rows = buf->row_count, used = buf->row + 1, top = buf->column_count; // same width, not re-split
+  memcpy(data, VTermRowData(buf, 0), top);
+  if (!VTermResize(&vt, buf->column_count, rows > 1 ? rows / 2 : 1))
+    return 1;
+  buf = VTermGetCurrentBuffer(&vt);
+  sb = buf->scrollback;
+  uint64_t spilled = sb->lines - before, expected = used > buf->row_count ? used - buf->row_count : 0;
+  uint8_t *back = (uint8_t *)calloc(buf->column_count, 1);
+  if (spilled > 0)
+    VTermScrollbackRead(sb, before, back, colors, buf->column_count, buf->default_fgbg, NULL);
+  bad += spilled != expected || (spilled > 0 && memcmp(back, data, top) != 0);
+  printf("  shrink  %u to %u rows, %lu lines spilled%s\n", rows, buf->row_count, (unsigned long)spilled,
+         spilled == expected ? "" : " (WRONG)");
+  free(back);
+
+  free(data);
+  free(colors);
+  VTermCloseBuffer(buf);
+  return bad != 0;
+}
+
+static int VTermBenchSearch(int argc, char **argv)
+/* A build log in the scrollback, then queries with and without the index */
+{
+  static const struct { const char *query; int flags; } queries[] = {
+    { "undefined reference to `sym_424'", 0 },
+    { "000777777", 0 },
+    { "segfault", 0 },
+    { "sym_4[0-9]{2}'", VTERM_SEARCH_REGEX },
+    { "mod_(12|13)\\.o", VTERM_SEARCH_REGEX },
+    { "worker 3]", 0 },
+  };
+  long lines = argc > 5 ? atol(argv[5]) : 1000000;
+  const char *dir = getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp";
+  VTermSearchHit hits[100];
+  char line[160];
+  VTerm vt;
+
+  if (!VTermBenchGrid(&vt, argc, argv, 3))
+    return 1;
+  VTermDataBuffer *buf = VTermGetCurrentBuffer(&vt);
+  VTermScrollback *sb = buf->scrollback;
+  if (!VTermScrollbackOpen(sb, dir) || sb->search == NULL)
+    return 1;
+
+  double t0 = VTermBenchNow();
+  for (long i = 0; i < lines; i++)
+  {
+    size_t n = i % 1000 == 999
+      ? sprintf(line, "%09ld error: undefined reference to `sym_%ld'\r\n", i, i / 1000)
+      : sprintf(line, "%09ld [worker %ld] cc -c mod_%ld.c -o mod_%ld.o\r\n", i, i % 8, i % 97, i % 97);
+    VTermBenchFeed(&vt, line, n);
+  }
+  VTermScrollbackFlush(sb);
+  double spill = VTermBenchNow() - t0;
+  VTermSearchWait(sb->search);
+  double indexed = VTermBenchNow() - t0;
+  printf("search: %lu lines, spilled in %.2f s, indexed %.2f s after the first line\n",
+         (unsigned long)sb->lines, spill, indexed);
+  printf("  %-36s %6s %12s %12s\n", "query", "hits", "indexed ms", "scan ms");
+  for (size_t i = 0; i < sizeof(queries) / sizeof(queries[0]); i++)
+  {
+    double t1 = VTermBenchNow();
+    int found = VTermSearch(sb, queries[i].query, queries[i].flags, hits, 100);
+    double t2 = VTermBenchNow();
+    int scanned = VTermSearch(sb, queries[i].query, queries[i].flags | VTERM_SEARCH_NO_INDEX, hits, 100);
+    double t3 = VTermBenchNow();
+    printf("  %-36s %6d %12.3f %12.3f%s\n", queries[i].query, found, (t2 - t1) * 1e3, (t3 - t2) * 1e3,
+           found == scanned ? "" : "  MISMATCH");
+  }
+  VTermCloseBuffer(buf);
+  return 0;
+}
+
+static bool VTermBenchScreenHas(VTerm *vt, const char *text)
+{
+  VTermDataBuffer *buf = VTermGetCurrentBuffer(vt);
+  size_t len = strlen(text);
+  for (uint16_t r = 0; r < buf->row_count; r++)
+    if (len <= buf->column_count && memcmp(VTermRowData(buf, r), text, len) == 0)
+      return true;
+  return false;
+}
+
+static bool VTermBenchSameScreen(VTerm *a, VTerm *b)
+{
+  VTermDataBuffer *x = VTermGetCurrentBuffer(a), *y = VTermGetCurrentBuffer(b);
+  if (x->column_count != y->column_count || x->row_count != y->row_count
+      || x->col != y->col || x->row != y->row)
+    return false;
+  for (uint16_t r = 0; r < x->row_count; r++)
+    if (memcmp(VTermRowData(x, r), VTermRowData(y, r), x->column_count) != 0
+        || memcmp(VTermRowColors(x, r), VTermRowColors(y, r), x->column_count * sizeof(uint64_t)) != 0)
+      return false;
+  return true;
+}
+
+static int VTermBenchServer(int argc, char **argv)
+/* A session server in a child process and two clients: one reads as fast as
+ * it can, the other every 50 ms. Both have to end on the same screen, the
+ * slow one having been sent fewer frames rather than a backlog. */
+{
+  long lines = argc > 5 ? atol(argv[5]) : 200000;
+  uint16_t cols = argc > 4 ? atoi(argv[3]) : 80, rows = argc > 4 ? atoi(argv[4]) : 25;
+  const char *dir = getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp";
+  char path[108], cmd[128];
+  struct stat st;
+
+  snprintf(path, sizeof(path), "%s/vterm-bench-%d.sock", dir, (int)getpid());
+  unlink(path);
+  pid_t pid = fork();
+  if (pid == 0)
+    _exit(VTermServerRun(path, VTERM_MODE_MONOCHROME_TEXT_40_25, cols, rows));
+  for (int i = 0; i < 200 && stat(path, &st) == -1; i++)
+    usleep(10000);
+
+  VTerm fast, slow;
+  VTermClient fc, sc;
+  if (!VTermInitHeadless(&fast, VTERM_MODE_MONOCHROME_TEXT_40_25)
+      || !VTermInitHeadless(&slow, VTERM_MODE_MONOCHROME_TEXT_40_25)
+      || !VTermClientConnect(&fc, path) || !VTermClientConnect(&sc, path))
+  {
+    kill(pid, SIGTERM);
+    return 1;
+  }
+
+  /* The marker is computed by the shell, so the echoed command can't match */
+  uint64_t raw = 0;
+  for (long i = 1; i <= lines; i++)
+    raw += snprintf(cmd, sizeof(cmd), "%ld\r\n", i);
+  size_t n = snprintf(cmd, sizeof(cmd), "seq 1 %ld; echo bench-$((6*7))\n", lines);
+  double t0 = VTermBenchNow(), done = 0, next_slow = t0;
+  VTermWireSend(fc.fd, VTERM_WIRE_INPUT, cmd, n);
+
+  while (VTermBenchNow() - t0 < 60)
+  {
+    struct pollfd pfd = { fc.fd, POLLIN, 0 };
+    poll(&pfd, 1, 5);
+    if (!VTermClientRead(&fc, &fast))
+      break;
+    double now = VTermBenchNow();
+    if (now >= next_slow)
+    {
+      if (!VTermClientRead(&sc, &slow))
+        break;
+      next_slow = now + 0.05;
+    }
+    if (done == 0 && VTermBenchScreenHas(&fast, "bench-42"))
+      done = now;
+    if (done != 0 && VTermBenchSameScreen(&fast, &slow))
+      break;
+  }
+  double elapsed = (done != 0 ? done : VTermBenchNow()) - t0;
+  bool same = done != 0 && VTermBenchSameScreen(&fast, &slow);
+
+  printf("server: seq 1 %ld on %ux%u, %.1f KiB of pty output in %.2f s\n",
+         lines, cols, rows, raw / 1024.0, elapsed);
+  printf("  %-6s %8s %12s %10s\n", "client", "frames", "KiB", "of output");
+  printf("  %-6s %8u %12.1f %9.1f%%\n", "fast", fc.frames, fc.bytes / 1024.0, 100.0 * fc.bytes / raw);
+  printf("  %-6s %8u %12.1f %9.1f%%\n", "slow", sc.frames, sc.bytes / 1024.0, 100.0 * sc.bytes / raw);
+  printf("  screens %s\n", same ? "match" : "DIFFER");
+
+  /* exit ends the child, the server says EXIT to both and goes away */
+  VTermWireSend(fc.fd, VTERM_WIRE_INPUT, "exit\n", 5);
+  for (double t1 = VTermBenchNow(); VTermBenchNow() - t1 < 5 && !(fc.exited && sc.exited);)
+  {
+    struct pollfd pfds[2] = { { fc.fd, POLLIN, 0 }, { sc.fd, POLLIN, 0 } };
+    poll(pfds, 2, 10);
+    VTermClientRead(&fc, &fast);
+    VTermClientRead(&sc, &slow);
+  }
+  if (!(fc.exited && sc.exited))
+    kill(pid, SIGTERM);
+  waitpid(pid, NULL, 0);
+  VTermClientClose(&fc);
+  VTermClientClose(&sc);
+  VTermCloseBuffer(fast.buffers[0]);
+  VTermCloseBuffer(slow.buffers[0]);
+  return same ? 0 : 1;
+}
+
+static uint64_t VTermBenchBufferHash(VTermDataBuffer *buf)
+/* Both screens, cursors, regions and a sample of the history, FNV-1a */
+{
+  uint64_t h = 14695981039346656037ull;
+#define VTERM_BENCH_HASH(p, n) \
+  for (size_t at = 0; at < (n); at++) \
+    h = (h ^ ((const uint8_t *)(p))[at]) * 1099511628211ull
+
+  for (int k = 0; k < 2; k++)
+  {
+    VTermDataBuffer *x = k ? (VTermDataBuffer *)buf->alt_screen : buf;
+    uint16_t state[] = { x->col, x->row, x->scroll_top, x->scroll_bottom };
+    VTERM_BENCH_HASH(state, sizeof(state));
+    for (uint16_t r = 0; r < x->row_count; r++)
+    {
+      VTERM_BENCH_HASH(VTermRowData(x, r), x->column_count);
+      VTERM_BENCH_HASH(VTermRowColors(x, r), x->column_count * sizeof(uint64_t));
+    }
+  }
+  VTermScrollback *sb = buf->scrollback;
+  uint64_t state[] = { buf->alt_buffer != NULL, sb->lines };
+  VTERM_BENCH_HASH(state, sizeof(state));
+  uint8_t data[1024];
+  uint64_t colors[1024];
+  uint16_t cols = buf->column_count < 1024 ? buf->column_count : 1024;
+  for (uint64_t n = 0; n < sb->lines; n += sb->lines / 7 + 1)
+  {
+    VTermScrollbackRead(sb, n, data, colors, cols, buf->default_fgbg, NULL);
+    VTERM_BENCH_HASH(data, cols);
+    VTERM_BENCH_HASH(colors, cols * sizeof(uint64_t));
+  }
+#undef VTERM_BENCH_HASH
+  return h;
+}
+
+static int VTermBenchSnapshot(int argc, char **argv)
+/* Every buffer in use, each with a deep scrollback and half of them on the
+ * alt screen: rebuilding that by replaying the output vs save + restore */
+{
+  long lines = argc > 5 ? atol(argv[5]) : 100000;
+  const char *dir = getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp";
+  char path[PATH_MAX], line[160];
+  VTerm vt, restored;
+  uint64_t bytes = 0;
+  int bad = 0;
+
+  if (!VTermBenchGrid(&vt, argc, argv, 3) || !VTermInitHeadless(&restored, VTERM_MODE_MONOCHROME_TEXT_40_25))
+    return 1;
+  VTermDataBuffer *first = vt.buffers[0];
+  for (int i = 1; i < MAX_BUFFER_COUNT; i++)
+    if (!VTermInitBufferSized(&vt.buffers[i], first->mode, first->column_count, first->row_count))
+      return 1;
+
+  double t0 = VTermBenchNow();
+  for (int i = 0; i < MAX_BUFFER_COUNT; i++)
+  {
+    vt.buffer_ix = i;
+    if (!VTermScrollbackOpen(vt.buffers[i]->scrollback, dir))
+      return 1;
+    for (long n = 0; n < lines; n++)
+    {
+      size_t len = sprintf(line, "\33[3%dm%02d:%09ld\33[0m [worker %ld] cc -c mod_%ld.c\r\n", (int)(n % 8), i, n, n % 8, n % 97);
+      VTermBenchFeed(&vt, line, len);
+      bytes += len;
+    }
+    if (i % 2 == 1)
+    {
+      size_t len = sprintf(line, "\33[?1049h\33[2J\33[5;20r\33[10;4H\33[1;44malt %d\33[0m", i);
+      VTermBenchFeed(&vt, line, len);
+      bytes += len;
+    }
+  }
+  vt.buffer_ix = 3;
+  double replay = VTermBenchNow() - t0;
+  /* Index threads still catching up would be timed with the restore */
+  for (int i = 0; i < MAX_BUFFER_COUNT; i++)
+    if (vt.buffers[i]->scrollback->search != NULL)
+      VTermSearchWait(vt.buffers[i]->scrollback->search);
+
+  /* What restore has to bring back, taken before the session goes away */
+  uint64_t hashes[MAX_BUFFER_COUNT];
+  for (int i = 0; i < MAX_BUFFER_COUNT; i++)
+    hashes[i] = VTermBenchBufferHash(vt.buffers[i]);
+  int buffer_ix = vt.buffer_ix;
+  uint16_t cols = first->column_count, rows = first->row_count;
+
+  snprintf(path, sizeof(path), "%s/vterm-bench-%d.snap", dir, (int)getpid());
+  double t1 = VTermBenchNow();
+  bool saved = VTermSnapshotSave(&vt, path);
+  double t2 = VTermBenchNow();
+  for (int i = 0; i < MAX_BUFFER_COUNT; i++)
+    VTermCloseBuffer(vt.buffers[i]);
+  double t3 = VTermBenchNow();
+  bool loaded = saved && VTermSnapshotRestore(&restored, path);
+  double t4 = VTermBenchNow();
+  if (!loaded)
+    return 1;
+
+  for (int i = 0; i < MAX_BUFFER_COUNT; i++)
+    if (restored.buffers[i] == NULL || VTermBenchBufferHash(restored.buffers[i]) != hashes[i])
+      bad++;
+  if (restored.buffer_ix != buffer_ix)
+    bad++;
+
+  struct stat st;
+  stat(path, &st);
+  printf("snapshot: %d buffers of %ux%u, %ld lines of scrollback each (%.1f MiB of output)\n",
+         MAX_BUFFER_COUNT, cols, rows, lines, bytes / 1048576.0);
+  printf("  replay  %10.2f ms\n", replay * 1e3);
+  printf("  save    %10.2f ms  (%ld KiB, scrollback linked)\n", (t2 - t1) * 1e3, (long)st.st_size / 1024);
+  printf("  restore %10.2f ms  (%d wrong)\n", (t4 - t3) * 1e3, bad);
+
+  for (int i = 0; i < MAX_BUFFER_COUNT; i++)
+  {
+    char link_path[PATH_MAX + 16];
+    snprintf(link_path, sizeof(link_path), "%s.%d", path, i);
+    unlink(link_path);
+    strcat(link_path, ".idx");
+    unlink(link_path);
+    strcpy(link_path + strlen(link_path) - 4, ".tri");
+    unlink(link_path);
+    VTermCloseBuffer(restored.buffers[i]);
+  }
+  unlink(path);
+  return bad != 0;
+}
+
+static int VTermBenchRows(int argc, char **argv)
+/* A `seq` flood drawn on the GPU in a hidden window, every cell each frame
+ * (VTermDrawText) against the row cache (VTermDrawRows). Frames show 1, 4
+ * and a screenful of new lines: the cache saves the most when few rows are
+ * new, and with all of them new it costs a render target switch. */
+{
+  int frames = argc > 5 ? atoi(argv[5]) : 2000;
+  VTerm vt;
+  char line[32];
+  long n = 0;
+
+  SetConfigFlags(FLAG_WINDOW_HIDDEN);
+  InitWindow(640, 480, "vterm --bench rows");
+  VTermInitFonts(true); // the raylib fonts, before the grid picks its one
+  if (!VTermBenchGrid(&vt, argc, argv, 3))
+    return 1;
+  VTermDataBuffer *buf = VTermGetCurrentBuffer(&vt);
+  SetWindowSize(vt.pixel_width, vt.pixel_height);
+  int per_frame[3] = { 1, 4, buf->row_count };
+
+  printf("rows: %ux%u cells, %d frames per run\n", buf->column_count, buf->row_count, frames);
+  printf("  %-10s %6s %10s %12s %12s\n", "draw", "lines", "frame us", "glyphs/frame", "rows/frame");
+  for (int p = 0; p < 3; p++)
+    for (int cached = 0; cached < 2; cached++)
+    {
+      uint64_t glyphs = 0, drawn = VTermStats.rows_drawn;
+      double start = VTermBenchNow();
+      for (int f = 0; f < frames; f++)
+      {
+        for (int i = 0; i < per_frame[p]; i++)
+          VTermBenchFeed(&vt, line, snprintf(line, sizeof(line), "%ld\r\n", ++n));
+        VTermStats.frame_glyphs = 0;
+        BeginDrawing();
+        ClearBackground(VTermBackground(&vt));
+        if (cached)
+          VTermDrawRows(buf);
+        else
+          VTermDrawText(buf);
+        EndDrawing();
+        glyphs += VTermStats.frame_glyphs;
+      }
+      double elapsed = VTermBenchNow() - start;
+      printf("  %-10s %6d %10.1f %12.1f %12.1f\n", cached ? "row cache" : "every cell", per_frame[p],
+             elapsed / frames * 1e6, (double)glyphs / frames,
+             cached ? (double)(VTermStats.rows_drawn - drawn) / frames : buf->row_count);
+    }
+
+  VTermRowCacheClose();
+  VTermGlyphsClose();
+  VTermCloseBuffer(buf);
+  CloseWindow();
+  return 0;
+}
+
+static int VTermBenchZoom(int argc, char **argv)
+/* A full screen zoomed from 12 to 48 px and back, a step per frame: atlases
+ * from the worker, drawn scaled until they're in, against waiting for each
+ * one in the frame that needs it, as building on the render thread would. */
+{
+  int sweeps = argc > 3 ? atoi(argv[3]) : 4;
+  VTerm vt;
+  char line[96];
+
+  SetConfigFlags(FLAG_WINDOW_HIDDEN);
+  InitWindow(640, 480, "vterm --bench zoom");
+  VTermInitFonts(true);
+  if (!VTermBenchGrid(&vt, 0, argv, 3))
+    return 1;
+  VTermDataBuffer *buf = VTermGetCurrentBuffer(&vt);
+  for (int i = 0; i < buf->row_count; i++)
+    VTermBenchFeed(&vt, line, snprintf(line, sizeof(line), "%04d The quick brown fox jumps over the lazy dog\r\n", i));
+
+  printf("zoom: %ux%u cells, 12..48 px, %d sweeps\n", buf->column_count, buf->row_count, sweeps);
+  printf("  %-10s %8s %10s %10s %8s\n", "atlases", "frames", "mean us", "worst us", "scaled");
+  for (int wait = 0; wait < 2; wait++)
+  {
+    double total = 0, worst = 0;
+    int frames = 0;
+    uint64_t scaled = VTermStats.glyph_scaled;
+
+    VTermGlyphsClose(); // both runs start without atlases
+    for (int s = 0; s < sweeps; s++)
+      for (int step = 0; step < 2 * 36; step++)
+      {
+        buf->font_size = step < 36 ? 12 + step : 48 - (step - 36);
+        double start = VTermBenchNow();
+        if (wait)
+        {
+          VTermGlyphFont(buf);
+          VTermGlyphsWait();
+        }
+        BeginDrawing();
+        ClearBackground(VTermBackground(&vt));
+        VTermDrawRows(buf);
+        EndDrawing();
+        double elapsed = VTermBenchNow() - start;
+        total += elapsed;
+        worst = elapsed > worst ? elapsed : worst;
+        frames++;
+      }
+    printf("  %-10s %8d %10.1f %10.1f %8llu\n", wait ? "in frame" : "worker", frames, total / frames * 1e6,
+           worst * 1e6, (unsigned long long)(VTermStats.glyph_scaled - scaled));
+  }
+
+  VTermGlyphsClose();
+  VTermRowCacheClose();
+  VTermCloseBuffer(buf);
+  CloseWindow();
+  return 0;
+}
+
+static int VTermBenchKernels(int argc, char **argv)
+/* The row kernels at 40x25 and 80x25: a colored `ls -l` style stream parsed
+ * a byte at a time, through the generic kernels and the ones compiled for
+ * the width, then frames drawn with each (hidden window). The screens all
+ * three parses leave must hash the same. */
+{
+  int lines = argc > 3 ? atoi(argv[3]) : 200000, frames = 2000;
+  static const uint16_t widths[] = { 40, 80 };
+  static const char *names[] = { "per byte", "generic", "specialised" };
+  size_t len = 0, cap = (size_t)lines * 96;
+  uint8_t *stream = malloc(cap);
+  bool same = true;
+
+  srand(1);
+  for (int i = 0; i < lines && stream; i++)
+  {
+    int n = 20 + rand() % 70;
+    if (i % 5 == 0)
+      len += snprintf((char *)stream + len, cap - len, "\33[3%dm", 1 + rand() % 7);
+    for (int k = 0; k < n; k++)
+      stream[len++] = 'a' + rand() % 26 - (k % 8 == 7 ? 'a' - ' ' : 0);
+    len += snprintf((char *)stream + len, cap - len, "%s\r\n", i % 5 == 0 ? "\33[m" : "");
+  }
+
+  SetConfigFlags(FLAG_WINDOW_HIDDEN);
+  InitWindow(640, 480, "vterm --bench kernels");
+  VTermInitFonts(true);
+  printf("kernels: %d lines, %.1f MB, %d frames\n", lines, len / 1e6, frames);
+  printf("  %-6s %-12s %10s %10s\n", "grid", "kernels", "parse MB/s", "frame us");
+  for (int w = 0; w < 2; w++)
+  {
+    uint64_t hashes[3];
+    for (int k = 0; k < 3; k++)
+    {
+      VTerm vt;
+      char cols[8], rows[8] = "25";
+      char *grid[] = { argv[0], argv[1], argv[2], cols, rows };
+      snprintf(cols, sizeof(cols), "%u", widths[w]);
+      if (!VTermBenchGrid(&vt, 5, grid, 3))
+        return 1;
+      VTermDataBuffer *buf = VTermGetCurrentBuffer(&vt);
+      buf->kernels = ((VTermDataBuffer *)buf->alt_screen)->kernels = VTermSelectKernels(widths[w], k == 2);
+
+      double start = VTermBenchNow();
+      if (k == 0)
+        for (size_t i = 0; i < len; i++)
+          VTermProcessByte(&vt, stream[i]);
+      else
+        VTermProcessBytes(&vt, stream, len);
+      double parse = VTermBenchNow() - start;
+      hashes[k] = VTermBenchBufferHash(buf);
+
+      start = VTermBenchNow();
+      for (int f = 0; f < frames; f++)
+      {
+        BeginDrawing();
+        ClearBackground(VTermBackground(&vt));
+        VTermDrawText(buf);
+        EndDrawing();
+      }
+      double draw = VTermBenchNow() - start;
+      printf("  %2ux%-3u %-12s %10.1f %10.1f\n", widths[w], 25, names[k], len / parse / 1e6, draw / frames * 1e6);
+      VTermCloseBuffer(buf);
+    }
+    same = same && hashes[0] == hashes[1] && hashes[1] == hashes[2];
+  }
+  printf("  screens %s\n", same ? "identical" : "DIFFER");
+
+  VTermGlyphsClose();
+  CloseWindow();
+  free(stream);
+  return same ? 0 : 1;
+}
+
+static int VTermBenchJump(int argc, char **argv)
+/* A `seq` flood and a build log fed in 64 KiB chunks, scrolling a line at a
+ * time (DECSCLM set) against jump scroll, with no history and with a disk
+ * scrollback. The screens and histories both leave must hash the same. */
+{
+  long lines = argc > 5 ? atol(argv[5]) : 2000000;
+  const char *dir = getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp";
+  static const char *names[] = { "seq", "build log" };
+  size_t cap = (size_t)lines * 64, len;
+  char *stream = malloc(cap);
+  bool same = true;
+
+  if (stream == NULL)
+    return 1;
+  printf("jump: %ld lines per stream, 64 KiB chunks\n", lines);
+  printf("  %-10s %-10s %-8s %10s %12s %10s\n", "stream", "history", "scroll", "MB/s", "Mlines/s", "jumped");
+  for (int s = 0; s < 2; s++)
+  {
+    len = 0;
+    for (long i = 0; i < lines; i++)
+      len += s == 0 ? snprintf(stream + len, cap - len, "%ld\r\n", i + 1)
+                    : snprintf(stream + len, cap - len, "\33[3%dm%09ld\33[0m cc -c vterm_%ld.c -o vterm_%ld.o\r\n",
+                               (int)(i % 8), i, i % 97, i % 97);
+    for (int history = 0; history < 2; history++)
+    {
+      uint64_t hashes[2];
+      for (int jump = 0; jump < 2; jump++)
+      {
+        VTerm vt;
+        if (!VTermBenchGrid(&vt, argc, argv, 3))
+          return 1;
+        VTermDataBuffer *buf = VTermGetCurrentBuffer(&vt);
+        if (history && !VTermScrollbackOpen(buf->scrollback, dir))
+          return 1;
+        if (!jump)
+          VTermBenchFeed(&vt, "\33[?4h", 5);
+        uint64_t jumped = VTermStats.jumped_lines;
+        double start = VTermBenchNow();
+        for (size_t at = 0; at < len; at += 65536)
+          VTermProcessBytes(&vt, (const uint8_t *)stream + at, len - at < 65536 ? len - at : 65536);
+        VTermScrollbackFlush(buf->scrollback);
+        double elapsed = VTermBenchNow() - start;
+        hashes[jump] = VTermBenchBufferHash(buf);
+        printf("  %-10s %-10s %-8s %10.1f %12.2f %10llu\n", names[s], history ? "disk" : "none",
+               jump ? "jump" : "smooth", len / elapsed / 1e6, lines / elapsed / 1e6,
+               (unsigned long long)(VTermStats.jumped_lines - jumped));
+        VTermCloseBuffer(buf);
+      }
+      same = same && hashes[0] == hashes[1];
+    }
+  }
+  printf("  screens and history %s\n", same ? "identical" : "DIFFER");
+  free(stream);
+  return same ? 0 : 1;
+}
+
+static int VTermBenchPanes(int argc, char **argv)
+/* Tiled panes in a hidden window, one of them taking a `seq` flood while
+ * the others only update a clock now and then. Every pane redrawn each
+ * frame against per pane damage, where the idle panes are shown from their
+ * last frame and the busy one is shifted and gets its new rows. */
+{
+  int count = argc > 3 ? atoi(argv[3]) : 4, frames = argc > 4 ? atoi(argv[4]) : 2000;
+  VTerm vt;
+  char line[64];
+  long n = 0;
+
+  if (count < 2 || count > MAX_BUFFER_COUNT)
+  {
+    fprintf(stderr, "panes: 2..%d panes\n", MAX_BUFFER_COUNT);
+    return 1;
+  }
+  SetConfigFlags(FLAG_WINDOW_HIDDEN);
+  InitWindow(1280, 720, "vterm --bench panes");
+  VTermInitFonts(true);
+  if (!VTermInitHeadless(&vt, VTERM_MODE_MONOCHROME_TEXT_40_25))
+    return 1;
+  for (int i = 1; i < count; i++)
+    if (!_VTermInitBuffer(&vt.buffers[i], VTERM_MODE_MONOCHROME_TEXT_40_25, false))
+      return 1;
+  vt.pixel_width = 1280;
+  vt.pixel_height = 720;
+  if (!VTermLayoutPanes(&vt))
+    return 1;
+  for (int p = 0; p < vt.pane_count; p++)
+  {
+    vt.buffer_ix = vt.panes[p].buffer_ix;
+    for (int r = 0; r < 40; r++)
+      VTermBenchFeed(&vt, line, snprintf(line, sizeof(line), "\r\n\33[3%dmpane %d line %d\33[0m", r % 8, p, r));
+  }
+  vt.buffer_ix = vt.panes[0].buffer_ix;
+
+  printf("panes: %d panes of %ux%u cells, %d frames per run\n", vt.pane_count,
+         vt.buffers[0]->column_count, vt.buffers[0]->row_count, frames);
+  printf("  %-12s %10s %12s %12s\n", "draw", "frame us", "rows/frame", "reused/frame");
+  for (int damage = 0; damage < 2; damage++)
+  {
+    uint64_t rows = VTermStats.pane_rows, reused = VTermStats.pane_reused;
+    double start = VTermBenchNow();
+    for (int f = 0; f < frames; f++)
+    {
+      vt.buffer_ix = vt.panes[0].buffer_ix;
+      for (int i = 0; i < 4; i++)
+        VTermBenchFeed(&vt, line, snprintf(line, sizeof(line), "\r\n%ld", ++n));
+      if (f % 60 == 0)
+        for (int p = 1; p < vt.pane_count; p++)
+        {
+          vt.buffer_ix = vt.panes[p].buffer_ix;
+          VTermBenchFeed(&vt, line, snprintf(line, sizeof(line), "\33[s\33[1;1H%08d\33[u", f));
+        }
+      vt.buffer_ix = vt.panes[0].buffer_ix;
+      if (!damage)
+        for (int p = 0; p < vt.pane_count; p++)
+          vt.buffers[vt.panes[p].buffer_ix]->damage.full = true;
+      BeginDrawing();
+      ClearBackground(VTermBackground(&vt));
+      VTermDrawPanes(&vt);
+      EndDrawing();
+    }
+    double elapsed = VTermBenchNow() - start;
+    printf("  %-12s %10.1f %12.1f %12.1f\n", damage ? "damage" : "every pane", elapsed / frames * 1e6,
+           (double)(VTermStats.pane_rows - rows) / frames, (double)(VTermStats.pane_reused - reused) / frames);
+  }
+
+  VTermPanesRelease(&vt);
+  VTermGlyphsClose();
+  for (int i = 0; i < MAX_BUFFER_COUNT; i++)
+    if (vt.buffers[i] != NULL)
+      VTermCloseBuffer(vt.buffers[i]);
+  CloseWindow();
+  return 0;
+}
+
+static int VTermBenchSpawn(int argc, char **argv)
+/* Session spawn latency as the emulator grows: the parent side of starting a
+ * shell on a fresh pty, against fork() of the same process. The emulator is
+ * grown with touched ballast to each size. Every shell is hung up after and
+ * has to be reaped through SIGCHLD. */
+{
+  enum { SESSIONS_MAX = 32 };
+  int sessions = argc > 3 ? atoi(argv[3]) : 16;
+  int sizes[8] = { 0, 256, 1024 }, size_count = 3;
+  static VTermPTY ptys[SESSIONS_MAX];
+  uint8_t *ballast = NULL;
+  size_t ballast_size = 0;
+  int reaped = 0, total = 0;
+
+  if (sessions < 1 || sessions > SESSIONS_MAX)
+    sessions = SESSIONS_MAX;
+  if (argc > 4)
+    for (size_count = 0; size_count < 8 && 4 + size_count < argc; size_count++)
+      sizes[size_count] = atoi(argv[4 + size_count]);
+
+  printf("spawn: %d sessions of /bin/sh per size\n", sessions);
+  printf("  %10s %10s %12s %12s\n", "ballast", "RSS MiB", "spawn us", "fork us");
+  for (int s = 0; s < size_count; s++)
+  {
+    size_t want = (size_t)sizes[s] << 20;
+    if (want > ballast_size)
+    {
+      uint8_t *grown = realloc(ballast, want);
+      if (!grown)
+        break;
+      ballast = grown;
+      memset(ballast + ballast_size, 1, want - ballast_size);
+      ballast_size = want;
+    }
+
+    double spawn = 0, forked = 0;
+    for (int i = 0; i < sessions; i++)
+    {
+      ptys[i].shell = "/bin/sh";
+      double t0 = VTermBenchNow();
+      if (!VTermInitPTY(&ptys[i]) || !VTermSpawnPTY(&ptys[i]))
+        return 1;
+      double t1 = VTermBenchNow();
+      pid_t pid = fork();
+      if (pid == 0)
+        _exit(0);
+      double t2 = VTermBenchNow();
+      waitpid(pid, NULL, 0);
+      spawn += t1 - t0;
+      forked += t2 - t1;
+    }
+    printf("  %7d MiB %10.1f %12.1f %12.1f\n", sizes[s], VTermBenchRSS() / 1024.0,
+           spawn / sessions * 1e6, forked / sessions * 1e6);
+
+    /* Hang them all up, then wait for the reaper to see every exit */
+    for (int i = 0; i < sessions; i++)
+      close(ptys[i].master);
+    total += sessions;
+    for (double t0 = VTermBenchNow(); reaped < total && VTermBenchNow() - t0 < 5;)
+    {
+      struct pollfd pfd = { VTermChildFd(), POLLIN, 0 };
+      poll(&pfd, 1, 10);
+      reaped += VTermReapChildren();
+    }
+  }
+  free(ballast);
+  printf("  reaped %d of %d shells\n", reaped, total);
+  return reaped == total ? 0 : 1;
+}
+
+static size_t VTermBenchBase64(const uint8_t *src, size_t len, char *out)
+{
+  static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  size_t n = 0;
+  for (size_t i = 0; i < len; i += 3)
+  {
+    uint32_t v = src[i] << 16 | (i + 1 < len ? src[i + 1] << 8 : 0) | (i + 2 < len ? src[i + 2] : 0);
+    out[n++] = alphabet[v >> 18 & 63];
+    out[n++] = alphabet[v >> 12 & 63];
+    out[n++] = i + 1 < len ? alphabet[v >> 6 & 63] : '=';
+    out[n++] = i + 2 < len ? alphabet[v & 63] : '=';
+  }
+  return n;
+}
+
+static size_t VTermBenchImage(char *out, const char *b64, size_t b64_len, int id, int size)
+/* One thumbnail in 4K chunks, as kitty's clients send them */
+{
+  size_t n = 0;
+  for (size_t at = 0; at < b64_len; at += 4096)
+  {
+    size_t len = b64_len - at < 4096 ? b64_len - at : 4096;
+    int more = at + len < b64_len;
+    if (at == 0)
+      n += sprintf(out + n, "\33_Ga=T,f=32,s=%d,v=%d,i=%d,c=8,r=4,q=2,m=%d;", size, size, id, more);
+    else
+      n += sprintf(out + n, "\33_Gm=%d;", more);
+    memcpy(out + n, b64 + at, len);
+    n += len;
+    n += sprintf(out + n, "\33\\");
+  }
+  return n;
+}
+
+static int VTermBenchImages(int argc, char **argv)
+/* A log with a 256x256 thumbnail every few lines: streaming them through
+ * the decoder and cache, then redrawing from the cache vs decoding again
+ * on every redraw */
+{
+  VTerm vt;
+  VTermFramebuffer fb;
+  int images = argc > 5 ? atoi(argv[5]) : 2000, size = 256, redraws = 100;
+  size_t raw = (size_t)size * size * 4;
+  uint8_t *pixels = (uint8_t *)malloc(raw);
+  char *b64 = (char *)malloc(raw / 3 * 4 + 8), *cmd = (char *)malloc(raw / 3 * 4 + 65536);
+
+  if (pixels == NULL || b64 == NULL || cmd == NULL || !VTermBenchGrid(&vt, argc, argv, 3))
+    return 1;
+  VTermDataBuffer *buf = VTermGetCurrentBuffer(&vt);
+  if (!VTermFramebufferInit(&fb, buf))
+    return 1;
+  for (size_t i = 0; i < raw; i++)
+    pixels[i] = i * 7 + (i >> 10);
+  size_t b64_len = VTermBenchBase64(pixels, raw, b64);
+
+  /* Frames as a window would draw them, one per few images */
+  double t0 = VTermBenchNow();
+  uint64_t bytes = 0, peak = 0;
+  for (int i = 0; i < images; i++)
+  {
+    size_t n = VTermBenchImage(cmd, b64, b64_len, i + 1, size);
+    n += sprintf(cmd + n, "\r\nthumbnail %d\r\n", i);
+    VTermBenchFeed(&vt, cmd, n);
+    bytes += n;
+    if (i % 8 == 7)
+    {
+      VTermImageRefresh(buf);
+      VTermSoftRenderDamage(buf, &fb);
+      peak = VTermStats.image_bytes > peak ? VTermStats.image_bytes : peak;
+    }
+  }
+  VTermImageWait();
+  VTermImageRefresh(buf);
+  double stream = VTermBenchNow() - t0;
+  peak = VTermStats.image_bytes > peak ? VTermStats.image_bytes : peak;
+  uint64_t decodes = VTermStats.images_decoded, evictions = VTermStats.images_evicted;
+
+  /* The screen as it is now: cached images are only composited... */
+  double t1 = VTermBenchNow();
+  for (int f = 0; f < redraws; f++)
+  {
+    VTermImageRefresh(buf);
+    VTermSoftRender(buf, &fb);
+  }
+  double cached = (VTermBenchNow() - t1) / redraws;
+
+  /* ...where re-decoding every visible image would cost this */
+  int visible = buf->placement_count;
+  double t2 = VTermBenchNow();
+  for (int f = 0; f < redraws; f++)
+  {
+    for (int i = 0; i < visible; i++)
+    {
+      size_t n = VTermBenchImage(cmd, b64, b64_len, buf->placements[i].image, size);
+      VTermBenchFeed(&vt, cmd, n);
+    }
+    VTermImageWait();
+    VTermImageRefresh(buf);
+    VTermSoftRender(buf, &fb);
+  }
+  double decoded = (VTermBenchNow() - t2) / redraws;
+
+  printf("images: %d of %dx%d on %ux%u, budget %s MiB\n", images, size, size,
+         buf->column_count, buf->row_count, getenv("VTERM_IMAGE_MEMORY") ? getenv("VTERM_IMAGE_MEMORY") : "default");
+  printf("  stream  %10.2f ms  (%.1f MiB of escapes, %.1f MiB/s)\n", stream * 1e3, bytes / 1048576.0, bytes / 1048576.0 / stream);
+  printf("  cache   %10.1f MiB peak, %llu decoded, %llu evicted\n", peak / 1048576.0,
+         (unsigned long long)decodes, (unsigned long long)evictions);
+  printf("  redraw  %10.3f ms/frame cached, %.3f ms/frame decoding %d visible images again\n",
+         cached * 1e3, decoded * 1e3, visible);
+
+  VTermFramebufferClose(&fb);
+  VTermCloseBuffer(VTermGetCurrentPrincipalBuffer(&vt));
+  VTermImageClose();
+  free(pixels);
+  free(b64);
+  free(cmd);
+  return 0;
+}
+
+static int VTermBenchOsc(int argc, char **argv)
+/* An OSC 52 copy of a few MiB, as from remote vim: the bare decoder a
+ * character at a time against the vector path (outputs must match), then
+ * the whole sequence through the parser in 4 KiB reads and a byte at a time */
+{
+  size_t size = (size_t)(argc > 3 ? atoi(argv[3]) : 8) << 20;
+  size_t b64_len = (size + 2) / 3 * 4;
+  uint8_t *src = malloc(size);
+  char *stream = malloc(b64_len + 16);
+  uint8_t *out[2] = { malloc(VTERM_BASE64_ROOM(b64_len)), malloc(VTERM_BASE64_ROOM(b64_len)) };
+  static const char *names[] = { "scalar", "vector" };
+  size_t got[2] = { 0, 0 };
+  int runs = 8;
+
+  if (!src || !stream || !out[0] || !out[1])
+    return 1;
+  srand(1);
+  for (size_t i = 0; i < size; i++)
+    src[i] = rand();
+  size_t len = (size_t)snprintf(stream, 16, "\33]52;c;");
+  len += VTermBenchBase64(src, size, stream + len);
+  stream[len++] = '\a';
+
+  printf("osc: %.1f MiB clipboard, %.1f MB of base64\n", size / 1048576.0, b64_len / 1e6);
+  for (int v = 0; v < 2; v++)
+  {
+    double start = VTermBenchNow();
+    for (int r = 0; r < runs; r++)
+    {
+      VTermBase64 b64 = { 0 };
+      got[v] = VTermBase64Decode(&b64, (uint8_t *)stream + 7, b64_len, out[v], v == 1);
+      got[v] += VTermBase64Finish(&b64, out[v] + got[v]);
+    }
+    printf("  decode %-8s %10.1f MB/s\n", names[v], b64_len * (double)runs / (VTermBenchNow() - start) / 1e6);
+  }
+  bool same = got[0] == size && got[1] == size && memcmp(out[0], src, size) == 0 && memcmp(out[1], src, size) == 0;
+
+  for (int per_byte = 0; per_byte < 2; per_byte++)
+  {
+    VTerm vt;
+    if (!VTermInitHeadless(&vt, VTERM_MODE_MONOCHROME_TEXT_40_25))
+      return 1;
+    uint64_t before = VTermStats.clipboard_bytes;
+    double start = VTermBenchNow();
+    if (per_byte)
+      for (size_t i = 0; i < len; i++)
+        VTermProcessByte(&vt, stream[i]);
+    else
+      for (size_t i = 0; i < len; i += 4096)
+        VTermProcessBytes(&vt, (uint8_t *)stream + i, len - i < 4096 ? len - i : 4096);
+    double took = VTermBenchNow() - start;
+    printf("  parser %-8s %10.1f MB/s\n", per_byte ? "per byte" : "4K reads", len / took / 1e6);
+    same = same && VTermStats.clipboard_bytes - before == size;
+    same = same && VTermGetCurrentBuffer(&vt)->col == 0 && VTermGetCurrentBuffer(&vt)->row == 0;
+    VTermCloseBuffer(VTermGetCurrentBuffer(&vt));
+  }
+  printf("  payloads %s\n", same ? "identical" : "DIFFER");
+
+  free(src);
+  free(stream);
+  free(out[0]);
+  free(out[1]);
+  return same ? 0 : 1;
+}
+
+static int VTermRender(int argc, char **argv)
+/* Feeds a captured byte stream through the parser and dumps the screen */
+{
+  VTerm vt;
+  VTermFramebuffer fb;
+  uint8_t chunk[4096];
+  size_t n;
+
+  if (argc < 4)
+  {
+    fprintf(stderr, "usage: %s --render <input> <out.ppm|png> [cols rows]\n", argv[0]);
+    return 1;
+  }
+  FILE *in = strcmp(argv[2], "-") == 0 ? stdin : fopen(argv[2], "rb");
+  if (in == NULL)
+  {
+    VTermError("fopen(render input)");
+    return 1;
+  }
+  if (!VTermBenchGrid(&vt, argc, argv, 4))
+    return 1;
+
+  while ((n = fread(chunk, 1, sizeof(chunk), in)) > 0)
+    VTermProcessBytes(&vt, chunk, n);
+  if (in != stdin)
+    fclose(in);
+
+  VTermDataBuffer *buf = VTermGetCurrentBuffer(&vt);
+  if (!VTermFramebufferInit(&fb, buf))
+    return 1;
+  /* Inline images in the capture show up once decoded */
+  VTermImageWait();
+  VTermImageRefresh(buf);
+  VTermSoftPoolInit(sysconf(_SC_NPROCESSORS_ONLN));
+  bool ok = VTermSoftRender(buf, &fb) && VTermFramebufferExport(&fb, argv[3]);
+  VTermSoftPoolClose();
+  VTermFramebufferClose(&fb);
+  VTermCloseBuffer(VTermGetCurrentPrincipalBuffer(&vt));
+  VTermImageClose();
+  return ok ? 0 : 1;
+}
+
+int VTermBench(int argc, char **argv)
+/* argv[1] is --bench or --render, returns the process exit code */
+{
+  if (strcmp(argv[1], "--render") == 0)
+    return VTermRender(argc, argv);
+  if (argc > 2 && strcmp(argv[2], "soft") == 0)
+    return VTermBenchSoft(argc, argv);
+  if (argc > 2 && strcmp(argv[2], "vim") == 0)
+    return VTermBenchVim(argc, argv);
+  if (argc > 2 && strcmp(argv[2], "replay") == 0)
+    return VTermBenchReplay(argc, argv);
+  if (argc > 2 && strcmp(argv[2], "scrollback") == 0)
+    return VTermBenchScrollback(argc, argv);
+  if (argc > 2 && strcmp(argv[2], "search") == 0)
+    return VTermBenchSearch(argc, argv);
+  if (argc > 2 && strcmp(argv[2], "server") == 0)
+    return VTermBenchServer(argc, argv);
+  if (argc > 2 && strcmp(argv[2], "snapshot") == 0)
+    return VTermBenchSnapshot(argc, argv);
+  if (argc > 2 && strcmp(argv[2], "images") == 0)
+    return VTermBenchImages(argc, argv);
+  if (argc > 2 && strcmp(argv[2], "spawn") == 0)
+    return VTermBenchSpawn(argc, argv);
+  if (argc > 2 && strcmp(argv[2], "rows") == 0)
+    return VTermBenchRows(argc, argv);
+  if (argc > 2 && strcmp(argv[2], "zoom") == 0)
+    return VTermBenchZoom(argc, argv);
+  if (argc > 2 && strcmp(argv[2], "kernels") == 0)
+    return VTermBenchKernels(argc, argv);
+  if (argc > 2 && strcmp(argv[2], "jump") == 0)
+    return VTermBenchJump(argc, argv);
+  if (argc > 2 && strcmp(argv[2], "panes") == 0)
+    return VTermBenchPanes(argc, argv);
+  if (argc > 2 && strcmp(argv[2], "osc") == 0)
+    return VTermBenchOsc(argc, argv);
+  fprintf(stderr, "usage: %s --bench soft|vim|replay|scrollback|search|server|snapshot|images|spawn|rows|zoom|kernels|jump|panes|osc ...\n", argv[0]);
+  return 1;
+}
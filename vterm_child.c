@@ -0,0 +1,201 @@
+#define _GNU_SOURCE // POSIX_SPAWN_SETSID, ptsname_r on glibc
+#include "vterm.h"
+#include <signal.h>
+#include <spawn.h>
+#include <sys/wait.h>
+
+/* Children: shells are started with posix_spawn, which glibc implements with
+ * a vfork-style clone, so the cost doesn't grow with the emulator's RSS the
+ * way fork() copying the page tables does. The child becomes a session
+ * leader and opening the pty slave makes it the controlling terminal.
+ * Elsewhere (macOS before POSIX_SPAWN_SETSID, other BSDs) vfork() + exec does
+ * the same with TIOCSCTTY.
+ *
+ * Exits are reaped through SIGCHLD: the handler writes to a self-pipe the
+ * event loops can poll, VTermReapChildren waitpid()s the pids we started and
+ * no others, so children forked elsewhere are left to whoever waits on them. */
+
+#if defined(__linux__) && defined(POSIX_SPAWN_SETSID)
+#define VTERM_SPAWN_POSIX 1
+#endif
+
+#define VTERM_CHILD_MAX 64 // running, or closed and not yet reaped
+
+static struct {
+  pid_t pids[VTERM_CHILD_MAX];
+  VTermPTY *ptys[VTERM_CHILD_MAX]; // NULL once the session was closed
+  int count;
+  int pipe[2];                     // SIGCHLD -> event loop
+  volatile sig_atomic_t pending;   // a SIGCHLD came since the last reap
+} VTermChildren = { .pipe = { -1, -1 } };
+
+static void VTermChildSignal(int sig)
+{
+  int saved = errno;
+  VTermChildren.pending = 1;
+  ssize_t n = write(VTermChildren.pipe[1], "", 1); // full pipe: a wakeup is queued anyway
+  (void)n;
+  errno = saved;
+  (void)sig;
+}
+
+static bool VTermChildInit(void)
+{
+  struct sigaction sa;
+
+  if (VTermChildren.pipe[0] != -1)
+    return true;
+  if (pipe(VTermChildren.pipe) == -1)
+  {
+    VTermError("pipe(SIGCHLD)");
+    return false;
+  }
+  for (int i = 0; i < 2; i++)
+  {
+    fcntl(VTermChildren.pipe[i], F_SETFL, O_NONBLOCK);
+    fcntl(VTermChildren.pipe[i], F_SETFD, FD_CLOEXEC);
+  }
+
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_handler = VTermChildSignal;
+  sa.sa_flags = SA_RESTART | SA_NOCLDSTOP;
+  sigemptyset(&sa.sa_mask);
+  if (sigaction(SIGCHLD, &sa, NULL) == -1)
+  {
+    VTermError("sigaction(SIGCHLD)");
+    return false;
+  }
+  return true;
+}
+
+int VTermChildFd(void)
+/* Readable after a child exited, -1 before anything was spawned */
+{
+  return VTermChildren.pipe[0];
+}
+
+bool VTermSpawnPTY(VTermPTY *pty)
+/* Starts pty->shell on the slave, the slave is closed in the parent after */
+{
+  char *argv[] = { (char *)pty->shell, NULL };
+  char *env[] = { "TERM=xterm-256color", NULL };
+  pid_t pid;
+
+  if (!VTermChildInit())
+    return false;
+  if (VTermChildren.count == VTERM_CHILD_MAX)
+  {
+    VTermError("too many children");
+    return false;
+  }
+  /* Neither end of this pty may leak into later children */
+  fcntl(pty->master, F_SETFD, FD_CLOEXEC);
+  fcntl(pty->slave, F_SETFD, FD_CLOEXEC);
+
+#ifdef VTERM_SPAWN_POSIX
+  char slave_name[128];
+  posix_spawnattr_t attr;
+  posix_spawn_file_actions_t actions;
+  sigset_t none;
+
+  if (ptsname_r(pty->master, slave_name, sizeof(slave_name)) != 0)
+  {
+    VTermError("ptsname_r(master)");
+    return false;
+  }
+  /* setsid, then the first tty the session leader opens becomes its
+   * controlling terminal. The SIGCHLD handler must not run in the child. */
+  sigemptyset(&none);
+  posix_spawnattr_init(&attr);
+  posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSID | POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF);
+  posix_spawnattr_setsigmask(&attr, &none);
+  sigaddset(&none, SIGCHLD);
+  sigaddset(&none, SIGPIPE);
+  posix_spawnattr_setsigdefault(&attr, &none);
+  posix_spawn_file_actions_init(&actions);
+  posix_spawn_file_actions_addopen(&actions, 0, slave_name, O_RDWR, 0);
+  posix_spawn_file_actions_adddup2(&actions, 0, 1);
+  posix_spawn_file_actions_adddup2(&actions, 0, 2);
+
+  int err = posix_spawn(&pid, pty->shell, &actions, &attr, argv, env);
+  posix_spawn_file_actions_destroy(&actions);
+  posix_spawnattr_destroy(&attr);
+  if (err != 0)
+  {
+    errno = err;
+    VTermError("posix_spawn(shell)");
+    return false;
+  }
+#else
+  pid = vfork();
+  if (pid == 0)
+  {
+    /* Shares our memory until exec: system calls only, then _exit */
+    signal(SIGCHLD, SIG_DFL);
+    signal(SIGPIPE, SIG_DFL);
+    setsid();
+    if (ioctl(pty->slave, TIOCSCTTY, NULL) == -1)
+      _exit(126);
+    dup2(pty->slave, 0);
+    dup2(pty->slave, 1);
+    dup2(pty->slave, 2);
+    execve(pty->shell, argv, env);
+    _exit(127);
+  }
+  if (pid == -1)
+  {
+    VTermError("vfork");
+    return false;
+  }
+#endif
+
+  close(pty->slave);
+  pty->slave = -1;
+  pty->pid = pid;
+  pty->exited = false;
+  VTermChildren.pids[VTermChildren.count] = pid;
+  VTermChildren.ptys[VTermChildren.count] = pty;
+  VTermChildren.count++;
+  return true;
+}
+
+void VTermMoveChild(VTermPTY *from, VTermPTY *to)
+/* The session's pty was copied to a new arena, or is going away (to NULL):
+ * either way the child is still reaped when it exits */
+{
+  for (int i = 0; i < VTermChildren.count; i++)
+    if (VTermChildren.ptys[i] == from)
+      VTermChildren.ptys[i] = to;
+}
+
+int VTermReapChildren(void)
+/* Collects the children that exited, their ptys get exited/status set.
+ * Cheap when no SIGCHLD came in: one flag check. Returns how many. */
+{
+  char drain[64];
+  int reaped = 0, status;
+
+  if (!VTermChildren.pending)
+    return 0;
+  VTermChildren.pending = 0;
+  while (read(VTermChildren.pipe[0], drain, sizeof(drain)) > 0)
+    ;
+
+  for (int i = VTermChildren.count - 1; i >= 0; i--)
+  {
+    if (waitpid(VTermChildren.pids[i], &status, WNOHANG) != VTermChildren.pids[i])
+      continue;
+    VTermPTY *pty = VTermChildren.ptys[i];
+    if (pty != NULL)
+    {
+      pty->exited = true;
+      pty->status = status;
+    }
+    VTermChildren.count--;
+    VTermChildren.pids[i] = VTermChildren.pids[VTermChildren.count];
+    VTermChildren.ptys[i] = VTermChildren.ptys[VTermChildren.count];
+    VTermStats.children_reaped++;
+    reaped++;
+  }
+  return reaped;
+}
@@ -0,0 +1,187 @@
+#include "vterm.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* Fonts come pre-baked by make_font_headers as packed 1-bpp tables: the
+ * ones the modes need are compiled in, the rest of int10h can be loaded
+ * from a font pack (VTERM_FONT=<name>, VTERM_FONT_PACK=<path>). */
+#include "vterm_fonts.h"
+
+#define VTERM_FONT_PACK_DEFAULT "vterm_fonts.pack"
+
+static struct {
+  void *map;
+  size_t size;
+  VTermPackedFont *fonts;
+  uint32_t count;
+} VTermFontPack;
+
+const VTermPackedFont *VTermModeFont(VTermMode mode)
+/* The font the real adapter used for the mode */
+{
+  switch (mode) {
+    case VTERM_MODE_4COLOR_GRAPHICS_300_200:
+    case VTERM_MODE_MONOCHROME_GRAPHICS_300_200:
+    case VTERM_MODE_MONOCHROME_GRAPHICS_640_200:
+    case VTERM_MODE_COLOR_GRAPHICS_320_200:
+    case VTERM_MODE_16COLOR_GRAPHICS_640_200:
+    case VTERM_MODE_256COLOR_GRAPHICS_320_200:
+      return &VTermFont_Bm437_IBM_CGA;
+    case VTERM_MODE_MONOCHROME_GRAPHICS_640_350:
+    case VTERM_MODE_16COLOR_GRAPHICS_640_350:
+      return &VTermFont_Bm437_IBM_EGA_8x14;
+    default:
+      return &VTermFont_Bm437_IBM_VGA_8x16;
+  }
+}
+
+bool VTermFontPackOpen(const char *path)
+{
+  struct stat st;
+  int fd = open(path, O_RDONLY);
+  if (fd == -1)
+  {
+    VTermError("open(font pack)");
+    return false;
+  }
+  if (fstat(fd, &st) == -1 || (size_t)st.st_size < sizeof(VTermFontPackHeader))
+  {
+    VTermError("fstat(font pack)");
+    close(fd);
+    return false;
+  }
+
+  void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED)
+  {
+    VTermError("mmap(font pack)");
+    return false;
+  }
+
+  VTermFontPackHeader *header = (VTermFontPackHeader *)map;
+  VTermFontPackEntry *entries = (VTermFontPackEntry *)(header + 1);
+  if (memcmp(header->magic, VTERM_FONT_PACK_MAGIC, sizeof(header->magic)) != 0
+      || sizeof(*header) + (size_t)header->count * sizeof(*entries) > (size_t)st.st_size)
+  {
+    VTermError("VTermFontPackOpen(bad header)");
+    munmap(map, st.st_size);
+    return false;
+  }
+
+  VTermFontPackClose();
+  VTermFontPack.fonts = (VTermPackedFont *)calloc(header->count, sizeof(VTermPackedFont));
+  VTermFontPack.map = map;
+  VTermFontPack.size = st.st_size;
+  VTermFontPack.count = 0;
+  for (uint32_t i = 0; i < header->count; i++)
+  {
+    VTermFontPackEntry *e = &entries[i];
+    if (e->width == 0 || e->width > VTERM_FONT_MAX_WIDTH || e->height > VTERM_FONT_MAX_HEIGHT
+        || e->offset + 256 * e->height * sizeof(uint16_t) > (size_t)st.st_size
+        || memchr(e->name, '\0', VTERM_FONT_NAME_MAX) == NULL)
+      continue;
+    VTermFontPack.fonts[VTermFontPack.count++] = (VTermPackedFont){
+      e->name, e->width, e->height, (const uint16_t *)((uint8_t *)map + e->offset)
+    };
+  }
+  return true;
+}
+
+void VTermFontPackClose(void)
+{
+  if (VTermFontPack.map == NULL)
+    return;
+  munmap(VTermFontPack.map, VTermFontPack.size);
+  free(VTermFontPack.fonts);
+  VTermFontPack.map = NULL;
+  VTermFontPack.fonts = NULL;
+  VTermFontPack.count = 0;
+}
+
+const VTermPackedFont *VTermFindFont(const char *name)
+/* Compiled in fonts first, then the pack if one is open */
+{
+  for (size_t i = 0; i < sizeof(VTermPackedFonts) / sizeof(VTermPackedFonts[0]); i++)
+    if (strcmp(VTermPackedFonts[i]->name, name) == 0)
+      return VTermPackedFonts[i];
+  for (uint32_t i = 0; i < VTermFontPack.count; i++)
+    if (strcmp(VTermFontPack.fonts[i].name, name) == 0)
+      return &VTermFontPack.fonts[i];
+  return NULL;
+}
+
+Font VTermLoadPackedFont(const VTermPackedFont *packed)
+/* Raylib font for the GPU path: a 16x16 glyph atlas, glyph value = CP437
+ * byte, so DrawTextCodepoint() takes cell bytes as they are */
+{
+  Font font = { 0 };
+  int w = packed->width, h = packed->height;
+  Image atlas = {
+    .data = MemAlloc(16 * w * 16 * h * 2),
+    .width = 16 * w,
+    .height = 16 * h,
+    .mipmaps = 1,
+    .format = PIXELFORMAT_UNCOMPRESSED_GRAY_ALPHA,
+  };
+  uint8_t *pixels = (uint8_t *)atlas.data;
+
+  font.baseSize = h;
+  font.glyphCount = 256;
+  font.glyphPadding = 0;
+  font.recs = (Rectangle *)MemAlloc(256 * sizeof(Rectangle));
+  font.glyphs = (GlyphInfo *)MemAlloc(256 * sizeof(GlyphInfo));
+  for (int c = 0; c < 256; c++)
+  {
+    int gx = (c % 16) * w, gy = (c / 16) * h;
+    for (int y = 0; y < h; y++)
+    {
+      uint16_t bits = packed->bits[c * h + y];
+      for (int x = 0; x < w; x++)
+      {
+        uint8_t *px = pixels + ((gy + y) * atlas.width + gx + x) * 2;
+        px[0] = 255;
+        px[1] = (bits & (0x8000 >> x)) ? 255 : 0;
+      }
+    }
+    font.recs[c] = (Rectangle){ gx, gy, w, h };
+    font.glyphs[c] = (GlyphInfo){ .value = c, .offsetX = 0, .offsetY = 0, .advanceX = w };
+  }
+
+  font.texture = LoadTextureFromImage(atlas);
+  UnloadImage(atlas);
+  return font;
+}
+
+bool VTermInitFonts(bool textures)
+/* Picks each mode's font, VTERM_FONT overrides them all. textures needs a
+ * window (InitWindow) and builds the raylib fonts too. */
+{
+  const char *name = getenv("VTERM_FONT");
+  const VTermPackedFont *override = NULL;
+
+  if (name != NULL)
+  {
+    override = VTermFindFont(name);
+    if (override == NULL)
+    {
+      const char *pack = getenv("VTERM_FONT_PACK");
+      if (VTermFontPackOpen(pack ? pack : VTERM_FONT_PACK_DEFAULT))
+        override = VTermFindFont(name);
+    }
+    if (override == NULL)
+      VTermError("VTermFindFont(VTERM_FONT)");
+  }
+
+  for (int i = 0; i < 21; i++)
+  {
+    VTermModeFonts[i] = override ? override : VTermModeFont(i);
+    if (!textures)
+      continue;
+    /* Modes share fonts, build each atlas once */
+    int j;
+    for (j = 0; j < i && VTermModeFonts[j] != VTermModeFonts[i]; j++);
+    VTermTextFonts[i] = j < i ? VTermTextFonts[j] : VTermLoadPackedFont(VTermModeFonts[i]);
+  }
+  return true;
+}
@@ -0,0 +1,309 @@
+#include "vterm.h"
+#include <pthread.h>
+
+/* Glyph atlases, one per (font, cell size). Every glyph is rasterized at
+ * the cell's exact pixel size with nearest neighbour scaling, so drawing is
+ * a 1:1 copy and the bitmap fonts stay sharp: integer multiples of the font
+ * are pixel replication, sizes in between repeat rows and columns evenly.
+ * A worker builds them and the render thread only uploads a finished one,
+ * drawing with the atlas it had until then, so a zoom step never stalls a
+ * frame. The sizes either side of a requested one are built right after it,
+ * the next step usually finds its atlas ready. */
+
+#define VTERM_GLYPH_ATLASES 8
+#define VTERM_GLYPH_MAX_CELL 512 // pixels, an atlas is 16 cells a side
+
+typedef enum {
+  VTERM_GLYPHS_FREE,
+  VTERM_GLYPHS_QUEUED,
+  VTERM_GLYPHS_BUILDING,
+  VTERM_GLYPHS_BUILT,  // pixels and glyph table done, not uploaded yet
+  VTERM_GLYPHS_READY,
+  VTERM_GLYPHS_FAILED, // no texture, not asked for again
+} VTermGlyphState;
+
+typedef struct {
+  const VTermPackedFont *packed;
+  uint16_t cell_w, cell_h;
+  VTermGlyphState state;
+  uint64_t order; // the worker builds the lowest first
+  uint64_t used;  // VTermGlyphs.clock when last drawn with
+  Image image;    // BUILT
+  Font font;      // recs/glyphs once BUILT, the texture once READY
+} VTermGlyphAtlas;
+
+static struct {
+  pthread_mutex_t lock; // state, image and font of QUEUED..BUILT atlases
+  pthread_cond_t wake, idle;
+  pthread_t thread;
+  bool running;
+  int pending; // QUEUED or BUILDING
+
+  /* Main thread only */
+  VTermGlyphAtlas atlases[VTERM_GLYPH_ATLASES];
+  uint64_t clock, orders;
+} VTermGlyphs = {
+  .lock = PTHREAD_MUTEX_INITIALIZER,
+  .wake = PTHREAD_COND_INITIALIZER,
+  .idle = PTHREAD_COND_INITIALIZER,
+};
+
+/***** Worker *****/
+
+static void VTermGlyphRasterize(VTermGlyphAtlas *atlas)
+/* Same layout as VTermLoadPackedFont: 16x16 cells, glyph value = CP437 byte */
+{
+  const VTermPackedFont *packed = atlas->packed;
+  int w = atlas->cell_w, h = atlas->cell_h;
+  uint16_t src_x[VTERM_GLYPH_MAX_CELL], src_y[VTERM_GLYPH_MAX_CELL];
+  Image image = {
+    .data = MemAlloc(16 * w * 16 * h * 2),
+    .width = 16 * w,
+    .height = 16 * h,
+    .mipmaps = 1,
+    .format = PIXELFORMAT_UNCOMPRESSED_GRAY_ALPHA,
+  };
+  Font font = { .baseSize = h, .glyphCount = 256 };
+  uint8_t *pixels = (uint8_t *)image.data;
+
+  font.recs = (Rectangle *)MemAlloc(256 * sizeof(Rectangle));
+  font.glyphs = (GlyphInfo *)MemAlloc(256 * sizeof(GlyphInfo));
+  for (int x = 0; x < w; x++)
+    src_x[x] = x * packed->width / w;
+  for (int y = 0; y < h; y++)
+    src_y[y] = y * packed->height / h;
+
+  for (int c = 0; c < 256; c++)
+  {
+    int gx = (c % 16) * w, gy = (c / 16) * h;
+    for (int y = 0; y < h; y++)
+    {
+      uint16_t bits = packed->bits[c * packed->height + src_y[y]];
+      uint8_t *px = pixels + ((size_t)(gy + y) * image.width + gx) * 2;
+      for (int x = 0; x < w; x++, px += 2)
+      {
+        px[0] = 255;
+        px[1] = (bits & (0x8000 >> src_x[x])) ? 255 : 0;
+      }
+    }
+    font.recs[c] = (Rectangle){ gx, gy, w, h };
+    font.glyphs[c] = (GlyphInfo){ .value = c, .advanceX = w };
+  }
+  atlas->image = image;
+  atlas->font = font;
+}
+
+static void *VTermGlyphWorker(void *unused)
+{
+  pthread_mutex_lock(&VTermGlyphs.lock);
+  while (true)
+  {
+    while (VTermGlyphs.running && VTermGlyphs.pending == 0)
+      pthread_cond_wait(&VTermGlyphs.wake, &VTermGlyphs.lock);
+    if (!VTermGlyphs.running)
+      break;
+
+    VTermGlyphAtlas *atlas = NULL;
+    for (int i = 0; i < VTERM_GLYPH_ATLASES; i++)
+    {
+      VTermGlyphAtlas *a = &VTermGlyphs.atlases[i];
+      if (a->state == VTERM_GLYPHS_QUEUED && (atlas == NULL || a->order < atlas->order))
+        atlas = a;
+    }
+    atlas->state = VTERM_GLYPHS_BUILDING;
+    pthread_mutex_unlock(&VTermGlyphs.lock);
+
+    VTermGlyphRasterize(atlas);
+
+    pthread_mutex_lock(&VTermGlyphs.lock);
+    atlas->state = VTERM_GLYPHS_BUILT;
+    if (--VTermGlyphs.pending == 0)
+      pthread_cond_broadcast(&VTermGlyphs.idle);
+  }
+  pthread_mutex_unlock(&VTermGlyphs.lock);
+  return NULL;
+}
+
+/***** Cache, main thread *****/
+
+static VTermGlyphAtlas *VTermGlyphFind(const VTermPackedFont *packed, int cell_w, int cell_h)
+{
+  for (int i = 0; i < VTERM_GLYPH_ATLASES; i++)
+  {
+    VTermGlyphAtlas *a = &VTermGlyphs.atlases[i];
+    if (a->state != VTERM_GLYPHS_FREE && a->packed == packed && a->cell_w == cell_w && a->cell_h == cell_h)
+      return a;
+  }
+  return NULL;
+}
+
+static void VTermGlyphFree(VTermGlyphAtlas *atlas)
+/* READY, BUILT or FAILED ones only, the worker may hold the others */
+{
+  if (atlas->state == VTERM_GLYPHS_READY)
+    UnloadFont(atlas->font);
+  else if (atlas->state == VTERM_GLYPHS_BUILT)
+  {
+    UnloadImage(atlas->image);
+    MemFree(atlas->font.recs);
+    MemFree(atlas->font.glyphs);
+  }
+  memset(atlas, 0, sizeof(*atlas));
+}
+
+static void VTermGlyphQueue(const VTermPackedFont *packed, int cell_w, int cell_h)
+/* Caller holds the lock. Takes a free slot or the least recently drawn
+ * finished one that isn't in use this frame. */
+{
+  VTermGlyphAtlas *slot = NULL;
+
+  if (cell_w < 1 || cell_h < 1 || cell_w > VTERM_GLYPH_MAX_CELL || cell_h > VTERM_GLYPH_MAX_CELL
+      || VTermGlyphFind(packed, cell_w, cell_h) != NULL)
+    return;
+  for (int i = 0; i < VTERM_GLYPH_ATLASES; i++)
+  {
+    VTermGlyphAtlas *a = &VTermGlyphs.atlases[i];
+    if (a->state == VTERM_GLYPHS_FREE)
+    {
+      slot = a;
+      break;
+    }
+    if ((a->state == VTERM_GLYPHS_READY || a->state == VTERM_GLYPHS_BUILT || a->state == VTERM_GLYPHS_FAILED)
+        && a->used != VTermGlyphs.clock && (slot == NULL || a->used < slot->used))
+      slot = a;
+  }
+  if (slot == NULL)
+    return;
+
+  VTermGlyphFree(slot);
+  slot->packed = packed;
+  slot->cell_w = cell_w;
+  slot->cell_h = cell_h;
+  slot->order = ++VTermGlyphs.orders;
+  slot->state = VTERM_GLYPHS_QUEUED;
+  VTermGlyphs.pending++;
+  pthread_cond_signal(&VTermGlyphs.wake);
+}
+
+static bool VTermGlyphStart(void)
+{
+  if (VTermGlyphs.running)
+    return true;
+  VTermGlyphs.running = true;
+  if (pthread_create(&VTermGlyphs.thread, NULL, VTermGlyphWorker, NULL) != 0)
+  {
+    VTermError("pthread_create(glyph atlases)");
+    VTermGlyphs.running = false;
+    return false;
+  }
+  return true;
+}
+
+Font VTermGlyphFont(VTermDataBuffer *buf)
+/* The font to draw buf with this frame: its size's atlas once built (drawn
+ * 1:1), until then the last one drawn with for this font, scaled */
+{
+  const VTermPackedFont *packed = buf->glyphs;
+  int cell_w = VTermCellWidth(buf), cell_h = buf->font_size;
+  Font fallback = buf->font.texture.id != 0 ? buf->font : GetFontDefault();
+  VTermGlyphAtlas *atlas, *previous = NULL;
+
+  if (packed == NULL || !VTermGlyphStart())
+    return fallback;
+  VTermGlyphs.clock++;
+
+  pthread_mutex_lock(&VTermGlyphs.lock);
+  atlas = VTermGlyphFind(packed, cell_w, cell_h);
+  if (atlas == NULL)
+  {
+    /* Then the sizes a zoom step either way lands on */
+    VTermGlyphQueue(packed, cell_w, cell_h);
+    VTermGlyphQueue(packed, (cell_h + 1) * packed->width / packed->height, cell_h + 1);
+    VTermGlyphQueue(packed, (cell_h - 1) * packed->width / packed->height, cell_h - 1);
+    atlas = VTermGlyphFind(packed, cell_w, cell_h);
+  }
+  VTermGlyphState state = atlas != NULL ? atlas->state : VTERM_GLYPHS_FAILED;
+  pthread_mutex_unlock(&VTermGlyphs.lock);
+
+  if (state == VTERM_GLYPHS_BUILT)
+  {
+    atlas->font.texture = LoadTextureFromImage(atlas->image);
+    UnloadImage(atlas->image);
+    atlas->image.data = NULL;
+    state = atlas->font.texture.id != 0 ? VTERM_GLYPHS_READY : VTERM_GLYPHS_FAILED;
+    pthread_mutex_lock(&VTermGlyphs.lock); // the worker reads it looking for work
+    atlas->state = state;
+    pthread_mutex_unlock(&VTermGlyphs.lock);
+    if (state == VTERM_GLYPHS_READY)
+      VTermStats.glyph_atlases++;
+    else
+    {
+      MemFree(atlas->font.recs);
+      MemFree(atlas->font.glyphs);
+      atlas->font = (Font){ 0 };
+    }
+  }
+  if (state == VTERM_GLYPHS_READY)
+  {
+    atlas->used = VTermGlyphs.clock;
+    return atlas->font;
+  }
+
+  VTermStats.glyph_scaled++;
+  pthread_mutex_lock(&VTermGlyphs.lock);
+  for (int i = 0; i < VTERM_GLYPH_ATLASES; i++)
+  {
+    VTermGlyphAtlas *a = &VTermGlyphs.atlases[i];
+    if (a->state == VTERM_GLYPHS_READY && a->packed == packed && (previous == NULL || a->used > previous->used))
+      previous = a;
+  }
+  pthread_mutex_unlock(&VTermGlyphs.lock);
+  if (previous == NULL)
+    return fallback;
+  previous->used = VTermGlyphs.clock; // what's on screen until the swap
+  return previous->font;
+}
+
+bool VTermGlyphsBuilding(void)
+/* True while an atlas is on its way, frames must keep coming to swap it in */
+{
+  bool building;
+  if (!VTermGlyphs.running)
+    return false;
+  pthread_mutex_lock(&VTermGlyphs.lock);
+  building = VTermGlyphs.pending > 0;
+  for (int i = 0; i < VTERM_GLYPH_ATLASES && !building; i++)
+    building = VTermGlyphs.atlases[i].state == VTERM_GLYPHS_BUILT;
+  pthread_mutex_unlock(&VTermGlyphs.lock);
+  return building;
+}
+
+void VTermGlyphsWait(void)
+/* Until every queued atlas is built (benchmarks) */
+{
+  if (!VTermGlyphs.running)
+    return;
+  pthread_mutex_lock(&VTermGlyphs.lock);
+  while (VTermGlyphs.pending > 0)
+    pthread_cond_wait(&VTermGlyphs.idle, &VTermGlyphs.lock);
+  pthread_mutex_unlock(&VTermGlyphs.lock);
+}
+
+void VTermGlyphsClose(void)
+{
+  if (!VTermGlyphs.running)
+    return;
+  pthread_mutex_lock(&VTermGlyphs.lock);
+  VTermGlyphs.running = false;
+  pthread_cond_signal(&VTermGlyphs.wake);
+  pthread_mutex_unlock(&VTermGlyphs.lock);
+  pthread_join(VTermGlyphs.thread, NULL);
+
+  /* Queued ones were never started, nothing to free */
+  for (int i = 0; i < VTERM_GLYPH_ATLASES; i++)
+    if (VTermGlyphs.atlases[i].state == VTERM_GLYPHS_QUEUED)
+      memset(&VTermGlyphs.atlases[i], 0, sizeof(VTermGlyphAtlas));
+  for (int i = 0; i < VTERM_GLYPH_ATLASES; i++)
+    VTermGlyphFree(&VTermGlyphs.atlases[i]);
+  VTermGlyphs.pending = 0;
+}
@@ -0,0 +1,215 @@
+#include "vterm.h"
+#include <pthread.h>
+
+/* Idle mode: when a frame changed nothing, EndDrawing() is allowed to block
+ * in the window system (raylib's event waiting). A watcher thread selects
+ * on the ptys (every pane's) and a self-pipe and posts an empty window
+ * event when a child writes or the cursor is due to blink, so one wait
+ * covers both sources. */
+
+#if defined(PLATFORM_DESKTOP)
+// raylib links GLFW in statically, this one is documented thread safe
+void glfwPostEmptyEvent(void);
+#define VTERM_IDLE_THREAD 1
+#endif
+
+// Without a watcher thread we can't wake the window wait, poll at this rate
+#define VTERM_IDLE_FALLBACK 0.05
+
+typedef enum {
+  VTERM_WAKE_NONE,
+  VTERM_WAKE_PTY,
+  VTERM_WAKE_TIMEOUT,
+  VTERM_WAKE_EVENT,
+} VTermWakeCause;
+
+static struct {
+  pthread_t thread;
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  int pipe[2];        // main -> watcher: stop selecting, we're awake
+  bool running;
+  bool armed;
+  fd_set fds;         // pty masters to watch
+  int fd;             // the highest of them, -1 for none
+  double deadline;    // GetTime() to give up and wake anyway
+  double ready;       // when the watcher saw the fd/deadline, 0 if not yet
+  VTermWakeCause cause;
+} VTermIdle = { .pipe = { -1, -1 }, .fd = -1 };
+
+#ifdef VTERM_IDLE_THREAD
+static void *VTermIdleWatch(void *unused)
+{
+  (void)unused;
+  pthread_mutex_lock(&VTermIdle.lock);
+  while (VTermIdle.running)
+  {
+    while (VTermIdle.running && !VTermIdle.armed)
+      pthread_cond_wait(&VTermIdle.cond, &VTermIdle.lock);
+    if (!VTermIdle.running)
+      break;
+
+    int fd = VTermIdle.fd;
+    fd_set readable = VTermIdle.fds;
+    double timeout = VTermIdle.deadline - GetTime();
+    pthread_mutex_unlock(&VTermIdle.lock);
+
+    struct timeval tv;
+    int nfds = VTermIdle.pipe[0];
+    FD_SET(VTermIdle.pipe[0], &readable);
+    if (fd > nfds)
+      nfds = fd;
+    if (timeout < 0)
+      timeout = 0;
+    tv.tv_sec = (time_t)timeout;
+    tv.tv_usec = (suseconds_t)((timeout - tv.tv_sec) * 1e6);
+    int n = select(nfds + 1, &readable, NULL, NULL, &tv);
+
+    pthread_mutex_lock(&VTermIdle.lock);
+    if (n > 0 && FD_ISSET(VTermIdle.pipe[0], &readable))
+    {
+      /* Main thread woke up by itself (window event), just drain */
+      char drain[16];
+      while (read(VTermIdle.pipe[0], drain, sizeof(drain)) > 0);
+      continue;
+    }
+    if (VTermIdle.armed)
+    {
+      VTermIdle.armed = false;
+      VTermIdle.ready = GetTime();
+      VTermIdle.cause = n > 0 ? VTERM_WAKE_PTY : VTERM_WAKE_TIMEOUT;
+      glfwPostEmptyEvent();
+    }
+  }
+  pthread_mutex_unlock(&VTermIdle.lock);
+  return NULL;
+}
+#endif
+
+bool VTermIdleInit(VTerm *vt)
+{
+  vt->busy = true;
+  vt->idle = false;
+#ifdef VTERM_IDLE_THREAD
+  if (pipe(VTermIdle.pipe) == -1)
+  {
+    VTermError("pipe(idle)");
+    return false;
+  }
+  fcntl(VTermIdle.pipe[0], F_SETFL, O_NONBLOCK);
+  fcntl(VTermIdle.pipe[1], F_SETFL, O_NONBLOCK);
+  pthread_mutex_init(&VTermIdle.lock, NULL);
+  pthread_cond_init(&VTermIdle.cond, NULL);
+  VTermIdle.running = true;
+  if (pthread_create(&VTermIdle.thread, NULL, VTermIdleWatch, NULL) != 0)
+  {
+    VTermError("pthread_create(idle)");
+    VTermIdle.running = false;
+    return false;
+  }
+#endif
+  return true;
+}
+
+void VTermIdleClose(void)
+{
+#ifdef VTERM_IDLE_THREAD
+  if (!VTermIdle.running)
+    return;
+  pthread_mutex_lock(&VTermIdle.lock);
+  VTermIdle.running = false;
+  pthread_cond_signal(&VTermIdle.cond);
+  pthread_mutex_unlock(&VTermIdle.lock);
+  ssize_t n = write(VTermIdle.pipe[1], "", 1); // full pipe: a wakeup is queued anyway
+  (void)n;
+  pthread_join(VTermIdle.thread, NULL);
+  close(VTermIdle.pipe[0]);
+  close(VTermIdle.pipe[1]);
+#endif
+}
+
+double VTermNextBlink(void)
+/* Seconds until the cursor blink toggles */
+{
+  double now = GetTime();
+  return VTERM_CURSOR_BLINK - fmod(now, VTERM_CURSOR_BLINK);
+}
+
+bool VTermCursorVisible(void)
+{
+  return (int)(GetTime() / VTERM_CURSOR_BLINK) % 2 == 0;
+}
+
+void VTermIdleBegin(VTerm *vt)
+/* Call right before EndDrawing(): lets it block if this frame was a no-op */
+{
+  vt->idle = !vt->busy;
+  if (!vt->idle)
+  {
+    DisableEventWaiting();
+    return;
+  }
+
+  VTermStats.idle_waits++;
+#ifdef VTERM_IDLE_THREAD
+  pthread_mutex_lock(&VTermIdle.lock);
+  FD_ZERO(&VTermIdle.fds);
+  VTermIdle.fd = VTermWakeFds(vt, &VTermIdle.fds);
+  VTermIdle.deadline = GetTime() + VTermNextBlink();
+  VTermIdle.ready = 0;
+  VTermIdle.cause = VTERM_WAKE_NONE;
+  VTermIdle.armed = true;
+  pthread_cond_signal(&VTermIdle.cond);
+  pthread_mutex_unlock(&VTermIdle.lock);
+  EnableEventWaiting();
+#else
+  /* No way to interrupt the window wait, sleep on the pty in slices */
+  double timeout = VTermNextBlink();
+  if (timeout > VTERM_IDLE_FALLBACK)
+    timeout = VTERM_IDLE_FALLBACK;
+  fd_set readable;
+  FD_ZERO(&readable);
+  int fd = VTermWakeFds(vt, &readable);
+  if (fd != -1)
+  {
+    struct timeval tv;
+    tv.tv_sec = 0;
+    tv.tv_usec = (suseconds_t)(timeout * 1e6);
+    select(fd + 1, &readable, NULL, NULL, &tv);
+  }
+#endif
+}
+
+void VTermIdleEnd(VTerm *vt)
+/* Call right after EndDrawing(), accounts for what woke us */
+{
+  if (!vt->idle)
+    return;
+#ifdef VTERM_IDLE_THREAD
+  double now = GetTime();
+  pthread_mutex_lock(&VTermIdle.lock);
+  if (VTermIdle.armed)
+  {
+    /* Window event got there first, kick the watcher out of select() */
+    VTermIdle.armed = false;
+    VTermIdle.cause = VTERM_WAKE_EVENT;
+    ssize_t n = write(VTermIdle.pipe[1], "", 1); // full pipe: a wakeup is queued anyway
+    (void)n;
+  }
+  switch (VTermIdle.cause)
+  {
+    case VTERM_WAKE_PTY:
+      VTermStats.wakes_pty++;
+      VTermHistAdd(&VTermStats.wake_latency, now - VTermIdle.ready);
+      break;
+    case VTERM_WAKE_TIMEOUT:
+      VTermStats.wakes_timeout++;
+      VTermHistAdd(&VTermStats.wake_latency, now - VTermIdle.ready);
+      break;
+    default:
+      VTermStats.wakes_event++;
+      break;
+  }
+  pthread_mutex_unlock(&VTermIdle.lock);
+#endif
+}
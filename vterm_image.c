@@ -0,0 +1,790 @@
+#include "vterm.h"
+#include <pthread.h>
+
+/* Inline images (see vterm.h). Keys understood:
+ *   a     t transmit, T transmit and place, p place, d delete, q query
+ *   f     24 RGB or 32 RGBA (s, v: width and height) or 100 PNG
+ *   i     image id; m=1 more chunks follow, those only carry m
+ *   c, r  cells to cover, else the image's own size in cells
+ *   C=1   the cursor stays put; q=1 no OK, q=2 no replies at all
+ *   d     for a=d: a/A every placement, i/I those of image i, upper case
+ *         frees the image as well
+ * Payloads are sent in the escape (t=d), uncompressed. The worker thread
+ * only decodes; the cache and placements belong to the main thread, which
+ * takes finished decodes in VTermImageRefresh once a frame. */
+
+struct VTermImageTransfer {
+  char control[VTERM_ESCAPE_MAX]; // keys of the chunk being read
+  int control_len;
+  bool started;  // the byte after ESC _ was seen
+  bool ignore;   // not a G command, or out of memory
+  bool payload;  // past the ';'
+  bool escape;   // ESC seen, ST when a backslash follows
+  bool chunked;  // an earlier chunk said m=1, its keys stand
+  bool failed;   // payload too big, the rest is swallowed
+  char action, delete_what;
+  uint32_t format, width, height, id, cols, rows, quiet, no_move, more;
+  VTermBase64 b64; // bits of a quantum not flushed yet
+  uint8_t *data;
+  size_t len, cap;
+};
+
+typedef struct VTermImageJob {
+  struct VTermImageJob *next;
+  uint32_t owner, id, serial;
+  uint32_t format, width, height;
+  uint8_t *data;
+  size_t len;
+  Color *pixels; // the result, NULL if it did not decode
+} VTermImageJob;
+
+typedef struct {
+  uint32_t owner, id; // owner 0: free slot
+  uint32_t serial;    // which transmission, a decode for an older one is dropped
+  uint32_t width, height;
+  Color *pixels;      // NULL while decoding or when it failed
+  Texture2D texture;  // id 0 until VTermImageDraw needs it
+  uint64_t used, drawn; // VTermImages.clock at last use / last texture draw
+} VTermImage;
+
+static struct {
+  pthread_mutex_t lock; // todo, done
+  pthread_cond_t wake, idle;
+  pthread_t thread;
+  bool running;
+  VTermImageJob *todo, *done;
+  bool decoding;
+
+  /* Main thread only */
+  VTermImage images[VTERM_IMAGE_MAX];
+  uint64_t budget, clock;
+  uint32_t outstanding; // jobs queued and not collected yet
+  uint32_t ready;       // decodes collected, VTermDataBuffer.images_seen
+  uint32_t owners, serials, anonymous;
+} VTermImages = {
+  .lock = PTHREAD_MUTEX_INITIALIZER,
+  .wake = PTHREAD_COND_INITIALIZER,
+  .idle = PTHREAD_COND_INITIALIZER,
+};
+
+/***** Worker *****/
+
+static Color *VTermImageDecode(VTermImageJob *job)
+{
+  size_t count = (size_t)job->width * job->height;
+  Color *pixels = NULL;
+
+  if (job->format == 100)
+  {
+    Image image = LoadImageFromMemory(".png", job->data, (int)job->len);
+    if (image.data == NULL)
+      return NULL;
+    ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+    if ((uint32_t)image.width == job->width && (uint32_t)image.height == job->height
+        && (pixels = (Color *)malloc(count * sizeof(Color))) != NULL)
+      memcpy(pixels, image.data, count * sizeof(Color));
+    UnloadImage(image);
+    return pixels;
+  }
+
+  if ((pixels = (Color *)malloc(count * sizeof(Color))) == NULL)
+    return NULL;
+  if (job->format == 32)
+    memcpy(pixels, job->data, count * sizeof(Color));
+  else
+    for (size_t i = 0; i < count; i++)
+      pixels[i] = (Color){ job->data[3 * i], job->data[3 * i + 1], job->data[3 * i + 2], 255 };
+  return pixels;
+}
+
+static void *VTermImageWorker(void *unused)
+{
+  (void)unused;
+  pthread_mutex_lock(&VTermImages.lock);
+  while (true)
+  {
+    while (VTermImages.running && VTermImages.todo == NULL)
+      pthread_cond_wait(&VTermImages.wake, &VTermImages.lock);
+    if (!VTermImages.running)
+      break;
+    VTermImageJob *job = VTermImages.todo;
+    VTermImages.todo = job->next;
+    VTermImages.decoding = true;
+    pthread_mutex_unlock(&VTermImages.lock);
+
+    job->pixels = VTermImageDecode(job);
+    free(job->data);
+    job->data = NULL;
+
+    pthread_mutex_lock(&VTermImages.lock);
+    job->next = VTermImages.done;
+    VTermImages.done = job;
+    VTermImages.decoding = false;
+    if (VTermImages.todo == NULL)
+      pthread_cond_broadcast(&VTermImages.idle);
+  }
+  pthread_mutex_unlock(&VTermImages.lock);
+  return NULL;
+}
+
+static bool VTermImageStart(void)
+{
+  if (VTermImages.running)
+    return true;
+  const char *memory = getenv("VTERM_IMAGE_MEMORY");
+  VTermImages.budget = memory != NULL ? (uint64_t)atol(memory) << 20 : VTERM_IMAGE_BUDGET;
+  VTermImages.running = true;
+  if (pthread_create(&VTermImages.thread, NULL, VTermImageWorker, NULL) != 0)
+  {
+    VTermError("pthread_create(image decoder)");
+    VTermImages.running = false;
+    return false;
+  }
+  return true;
+}
+
+/***** Cache, main thread *****/
+
+static int VTermImageFind(uint32_t owner, uint32_t id, uint16_t hint)
+{
+  if (hint < VTERM_IMAGE_MAX && VTermImages.images[hint].owner == owner && VTermImages.images[hint].id == id)
+    return hint;
+  for (int i = 0; i < VTERM_IMAGE_MAX; i++)
+    if (VTermImages.images[i].owner == owner && VTermImages.images[i].id == id)
+      return i;
+  return -1;
+}
+
+static void VTermImageUnload(VTermImage *image)
+{
+  if (image->texture.id == 0)
+    return;
+  UnloadTexture(image->texture);
+  image->texture.id = 0;
+  VTermStats.texture_bytes -= (uint64_t)image->width * image->height * sizeof(Color);
+}
+
+static void VTermImageFree(VTermImage *image)
+{
+  VTermImageUnload(image);
+  if (image->pixels != NULL)
+    VTermStats.image_bytes -= (uint64_t)image->width * image->height * sizeof(Color);
+  free(image->pixels);
+  memset(image, 0, sizeof(*image));
+}
+
+static int VTermImageOldest(int keep, bool decoded)
+/* Least recently used slot other than keep, only decoded ones if asked */
+{
+  int oldest = -1;
+  for (int i = 0; i < VTERM_IMAGE_MAX; i++)
+  {
+    VTermImage *image = &VTermImages.images[i];
+    if (i == keep || image->owner == 0 || (decoded && image->pixels == NULL))
+      continue;
+    if (oldest < 0 || image->used < VTermImages.images[oldest].used)
+      oldest = i;
+  }
+  return oldest;
+}
+
+static bool VTermImageFit(uint64_t bytes, int keep)
+/* Evicts the least recently used images until bytes more fit the budget */
+{
+  if (bytes > VTermImages.budget)
+    return false;
+  while (VTermStats.image_bytes + bytes > VTermImages.budget)
+  {
+    int oldest = VTermImageOldest(keep, true);
+    if (oldest < 0)
+      return false;
+    VTermImageFree(&VTermImages.images[oldest]);
+    VTermStats.images_evicted++;
+  }
+  return true;
+}
+
+static void VTermImageCollect(void)
+/* Finished decodes into their slots, unless the image was replaced or
+ * dropped meanwhile */
+{
+  pthread_mutex_lock(&VTermImages.lock);
+  VTermImageJob *job = VTermImages.done;
+  VTermImages.done = NULL;
+  pthread_mutex_unlock(&VTermImages.lock);
+
+  while (job != NULL)
+  {
+    VTermImageJob *next = job->next;
+    int slot = VTermImageFind(job->owner, job->id, VTERM_IMAGE_MAX);
+    VTermImage *image = slot >= 0 ? &VTermImages.images[slot] : NULL;
+    uint64_t bytes = (uint64_t)job->width * job->height * sizeof(Color);
+    if (image != NULL && image->serial == job->serial && job->pixels != NULL && VTermImageFit(bytes, slot))
+    {
+      image->pixels = job->pixels;
+      VTermStats.image_bytes += bytes;
+      VTermStats.images_decoded++;
+    }
+    else
+      free(job->pixels);
+    free(job);
+    VTermImages.outstanding--;
+    VTermImages.ready++;
+    job = next;
+  }
+}
+
+static int VTermImageStore(VTermParser *p, VTermImageTransfer *t, uint32_t id)
+/* A slot for the transfer's image and a job decoding it, -1 on failure.
+ * The payload goes to the job. */
+{
+  VTermImageJob *job = (VTermImageJob *)malloc(sizeof(VTermImageJob));
+  if (job == NULL)
+    return -1;
+
+  int slot = VTermImageFind(p->image_owner, id, VTERM_IMAGE_MAX);
+  for (int i = 0; slot < 0 && i < VTERM_IMAGE_MAX; i++)
+    if (VTermImages.images[i].owner == 0)
+      slot = i;
+  if (slot < 0)
+  {
+    slot = VTermImageOldest(-1, false);
+    VTermStats.images_evicted++;
+  }
+  VTermImage *image = &VTermImages.images[slot];
+  VTermImageFree(image);
+  image->owner = p->image_owner;
+  image->id = id;
+  image->serial = ++VTermImages.serials;
+  image->width = t->width;
+  image->height = t->height;
+  image->used = VTermImages.clock;
+
+  *job = (VTermImageJob){ NULL, image->owner, id, image->serial, t->format, t->width, t->height, t->data, t->len, NULL };
+  t->data = NULL;
+  t->len = t->cap = 0;
+  pthread_mutex_lock(&VTermImages.lock);
+  VTermImageJob **tail = &VTermImages.todo;
+  while (*tail != NULL)
+    tail = &(*tail)->next;
+  *tail = job;
+  pthread_cond_signal(&VTermImages.wake);
+  pthread_mutex_unlock(&VTermImages.lock);
+  VTermImages.outstanding++;
+  return slot;
+}
+
+/***** Placements *****/
+
+static void VTermImageDirty(VTermDataBuffer *buf, const VTermImagePlacement *p)
+{
+  int row1 = p->row + p->rows < buf->row_count ? p->row + p->rows : buf->row_count;
+  for (int r = p->row > 0 ? p->row : 0; r < row1; r++)
+    buf->row_flags[r] |= VTERM_ROW_DIRTY;
+}
+
+static void VTermImagePlace(VTermDataBuffer *buf, uint32_t id, int slot, uint16_t cols, uint16_t rows)
+{
+  if (buf->placement_count == VTERM_IMAGE_PLACEMENTS)
+  {
+    VTermImageDirty(buf, &buf->placements[0]);
+    memmove(buf->placements, buf->placements + 1, --buf->placement_count * sizeof(VTermImagePlacement));
+  }
+  VTermImagePlacement *p = &buf->placements[buf->placement_count++];
+  *p = (VTermImagePlacement){ id, slot, buf->row, buf->col, cols, rows };
+  VTermImageDirty(buf, p);
+}
+
+static void VTermImageDelete(VTermDataBuffer *buf, uint32_t id, bool all, bool free_images)
+{
+  uint32_t owner = buf->parser->image_owner;
+  int kept = 0;
+  for (int i = 0; i < buf->placement_count; i++)
+  {
+    VTermImagePlacement p = buf->placements[i];
+    if (!all && p.image != id)
+    {
+      buf->placements[kept++] = p;
+      continue;
+    }
+    VTermImageDirty(buf, &p);
+    int slot = free_images ? VTermImageFind(owner, p.image, p.slot) : -1;
+    if (slot >= 0)
+      VTermImageFree(&VTermImages.images[slot]);
+  }
+  buf->placement_count = kept;
+  if (!all && free_images)
+  {
+    int slot = VTermImageFind(owner, id, VTERM_IMAGE_MAX);
+    if (slot >= 0)
+      VTermImageFree(&VTermImages.images[slot]);
+  }
+}
+
+void VTermImageScroll(VTermDataBuffer *buf, uint16_t top, uint16_t bottom, int n)
+/* Placements in [top, bottom) move with the rows VTermScrollRegion moved,
+ * those pushed out of the region are dropped. At the top of the screen
+ * they hang off the edge until their last row goes. */
+{
+  int kept = 0;
+  for (int i = 0; i < buf->placement_count; i++)
+  {
+    VTermImagePlacement p = buf->placements[i];
+    if ((p.row >= top || top == 0) && p.row < bottom)
+    {
+      p.row -= n;
+      if (p.row >= bottom || p.row + p.rows <= top || (top > 0 && p.row < top))
+        continue;
+    }
+    buf->placements[kept++] = p;
+  }
+  buf->placement_count = kept;
+}
+
+void VTermImageClear(VTermDataBuffer *buf)
+/* ED 2 and friends: the screen's placements go, the images stay cached */
+{
+  for (int i = 0; i < buf->placement_count; i++)
+    VTermImageDirty(buf, &buf->placements[i]);
+  buf->placement_count = 0;
+}
+
+void VTermImageMove(VTermDataBuffer *dst, VTermDataBuffer *src, int delta)
+/* src's placements onto dst, delta rows further down (a resize) */
+{
+  dst->placement_count = 0;
+  for (int i = 0; i < src->placement_count; i++)
+  {
+    VTermImagePlacement p = src->placements[i];
+    p.row += delta;
+    if (p.row >= dst->row_count || p.row + p.rows <= 0 || p.col >= dst->column_count)
+      continue;
+    dst->placements[dst->placement_count++] = p;
+    VTermImageDirty(dst, &p);
+  }
+}
+
+/***** Protocol *****/
+
+static void VTermImageReply(VTermDataBuffer *buf, VTermImageTransfer *t, const char *error)
+/* Only commands that named an image get one, as in kitty */
+{
+  if (t->id == 0 || t->quiet >= (error == NULL ? 1 : 2))
+    return;
+  char reply[96];
+  VTermRingPush(buf->out, reply, snprintf(reply, sizeof(reply), "\33_Gi=%u;%s\33\\", t->id, error != NULL ? error : "OK"));
+}
+
+static const char *VTermImageCheck(VTermImageTransfer *t)
+/* Size and format of a transfer, PNG sizes come from its header */
+{
+  if (t->format == 100)
+  {
+    static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+    if (t->len < 24 || memcmp(t->data, signature, 8) != 0 || memcmp(t->data + 12, "IHDR", 4) != 0)
+      return "EBADPNG:not a PNG";
+    const uint8_t *d = t->data + 16;
+    t->width = (uint32_t)d[0] << 24 | d[1] << 16 | d[2] << 8 | d[3];
+    t->height = (uint32_t)d[4] << 24 | d[5] << 16 | d[6] << 8 | d[7];
+  }
+  else if (t->format != 24 && t->format != 32)
+    return "EINVAL:unsupported format";
+  if (t->width == 0 || t->height == 0 || t->width > 16384 || t->height > 16384)
+    return "EINVAL:bad size";
+  if (t->format != 100 && t->len != (size_t)t->width * t->height * (t->format / 8))
+    return "ENODATA:payload does not match the size";
+  if ((uint64_t)t->width * t->height * sizeof(Color) > VTermImages.budget)
+    return "EFBIG:over the image budget";
+  return NULL;
+}
+
+static void VTermImageCommand(VTermDataBuffer *buf, VTermImageTransfer *t)
+{
+  VTermParser *p = buf->parser;
+  uint32_t id = t->id;
+  int slot = -1;
+  const char *error = NULL;
+
+  if (t->failed)
+    error = "EFBIG:payload too big";
+  else if (t->action == 't' || t->action == 'T' || t->action == 'q')
+  {
+    if (!VTermImageStart())
+      error = "ENOMEM:no decoder";
+    else if ((error = VTermImageCheck(t)) == NULL && t->action != 'q')
+    {
+      /* Placed without an id: one of ours, nobody can name it */
+      if (id == 0)
+        id = 0x80000000u | ++VTermImages.anonymous;
+      if ((slot = VTermImageStore(p, t, id)) < 0)
+        error = "ENOMEM:no decoder";
+    }
+  }
+  else if (t->action == 'p')
+  {
+    if ((slot = VTermImageFind(p->image_owner, id, VTERM_IMAGE_MAX)) < 0)
+      error = "ENOENT:no such image";
+    else
+    {
+      t->width = VTermImages.images[slot].width;
+      t->height = VTermImages.images[slot].height;
+    }
+  }
+  else if (t->action == 'd')
+  {
+    bool all = t->delete_what == 0 || t->delete_what == 'a' || t->delete_what == 'A';
+    VTermImageDelete(buf, id, all, t->delete_what == 'A' || t->delete_what == 'I');
+    return;
+  }
+  else
+    error = "EINVAL:unknown action";
+
+  VTermImageReply(buf, t, error);
+  if (error != NULL || (t->action != 'T' && t->action != 'p'))
+    return;
+
+  /* Cells covered: asked for, or the image at its size in the cells the
+   * child was told about (VTermSetWinSize) */
+  int cell_w = VTermCellWidth(buf), cell_h = buf->font_size;
+  uint32_t cols = t->cols ? t->cols : (t->width + cell_w - 1) / cell_w;
+  uint32_t rows = t->rows ? t->rows : (t->height + cell_h - 1) / cell_h;
+  cols = cols < buf->column_count ? cols : buf->column_count;
+  rows = rows < 1000 ? rows : 1000;
+  uint16_t col = buf->col;
+  VTermImagePlace(buf, id, slot, cols, rows);
+  if (t->no_move)
+    return;
+  /* Like text: the cursor ends up after the image, on its last row */
+  for (uint32_t r = 1; r < rows; r++)
+    VTermLineFeed(buf);
+  buf->col = col + cols < buf->column_count ? col + cols : buf->column_count - 1u;
+}
+
+static bool VTermImageGrow(VTermImageTransfer *t, size_t n)
+{
+  if (t->len + n <= t->cap)
+    return true;
+  size_t cap = t->cap ? t->cap * 2 : 4096;
+  uint8_t *data = cap <= VTERM_IMAGE_MAX_PAYLOAD ? (uint8_t *)realloc(t->data, cap) : NULL;
+  if (data == NULL)
+  {
+    t->failed = true;
+    return false;
+  }
+  t->data = data;
+  t->cap = cap;
+  return true;
+}
+
+static void VTermImageFlushPayload(VTermImageTransfer *t)
+/* Padding, or the end: a quantum cut short still holds 1 or 2 bytes */
+{
+  if (t->failed || !VTermImageGrow(t, 2))
+    return;
+  t->len += VTermBase64Finish(&t->b64, t->data + t->len);
+}
+
+static void VTermImagePayload(VTermImageTransfer *t, uint8_t ch)
+/* One base64 character, anything outside the alphabet is skipped */
+{
+  if (t->failed || !VTermImageGrow(t, VTERM_BASE64_ROOM(1)))
+    return;
+  t->len += VTermBase64Decode(&t->b64, &ch, 1, t->data + t->len, false);
+}
+
+static void VTermImageKeys(VTermImageTransfer *t)
+/* key=value,... of one chunk; a continuation only changes m (and q) */
+{
+  char *save = NULL;
+  t->control[t->control_len] = '\0';
+  for (char *key = strtok_r(t->control, ",", &save); key != NULL; key = strtok_r(NULL, ",", &save))
+  {
+    if (key[0] == '\0' || key[1] != '=')
+      continue;
+    char *value = key + 2;
+    uint32_t n = (uint32_t)strtoul(value, NULL, 10);
+    if (key[0] == 'm')
+      t->more = n;
+    else if (key[0] == 'q')
+      t->quiet = n;
+    else if (t->chunked)
+      continue;
+    switch (key[0])
+    {
+      case 'a': t->action = value[0]; break;
+      case 'd': t->delete_what = value[0]; break;
+      case 'f': t->format = n; break;
+      case 's': t->width = n; break;
+      case 'v': t->height = n; break;
+      case 'i': t->id = n; break;
+      case 'c': t->cols = n; break;
+      case 'r': t->rows = n; break;
+      case 'C': t->no_move = n; break;
+      case 'o': case 't':
+        /* Compressed, or sent through a file: not supported */
+        if (value[0] != 'd')
+          t->failed = true;
+        break;
+    }
+  }
+}
+
+static void VTermImageReset(VTermImageTransfer *t)
+/* Ready for the next command, a payload buffer of ordinary size is kept */
+{
+  uint8_t *data = t->data;
+  size_t cap = t->cap;
+  if (cap > 65536)
+  {
+    free(data);
+    data = NULL;
+    cap = 0;
+  }
+  memset(t, 0, sizeof(*t));
+  t->data = data;
+  t->cap = cap;
+}
+
+static void VTermImageEnd(VTermDataBuffer *buf)
+{
+  VTermImageTransfer *t = buf->parser->image;
+  if (t->ignore)
+  {
+    VTermImageReset(t);
+    return;
+  }
+  bool chunked = t->chunked;
+  t->more = 0;
+  VTermImageKeys(t);
+  if (!chunked && t->action == 0)
+    t->action = 't';
+  if (!chunked && t->format == 0)
+    t->format = 32;
+  if (t->more)
+  {
+    /* Keys and payload so far stay, the next chunk picks up from here */
+    t->chunked = true;
+    t->control_len = 0;
+    t->started = t->payload = t->escape = false;
+    return;
+  }
+  VTermImageFlushPayload(t);
+  VTermImageCommand(buf, t);
+  VTermImageReset(t);
+}
+
+void VTermImageByte(VTerm *vt, VTermDataBuffer *buf, uint8_t ch)
+/* Everything between ESC _ and ST comes here, the parser is in p->apc */
+{
+  VTermParser *p = buf->parser;
+  if (p->image == NULL && (p->image = (VTermImageTransfer *)calloc(1, sizeof(VTermImageTransfer))) == NULL)
+  {
+    VTermError("calloc(image transfer)");
+    p->apc = false;
+    return;
+  }
+  VTermImageTransfer *t = p->image;
+  if (p->image_owner == 0)
+    p->image_owner = ++VTermImages.owners;
+
+  if (t->escape || ch == '\a')
+  {
+    p->apc = false;
+    VTermImageEnd(buf);
+    /* ESC that isn't ST ends the string and starts a sequence */
+    if (ch != '\\' && ch != '\a')
+    {
+      p->previousWasEscape = true;
+      VTermProcessByte(vt, ch);
+    }
+    return;
+  }
+  if (ch == '\33')
+  {
+    t->escape = true;
+    return;
+  }
+  if (!t->started)
+  {
+    t->started = true;
+    t->ignore = ch != 'G';
+    return;
+  }
+  if (t->ignore)
+    return;
+  if (t->payload)
+    VTermImagePayload(t, ch);
+  else if (ch == ';')
+    t->payload = true;
+  else if (t->control_len < VTERM_ESCAPE_MAX - 1)
+    t->control[t->control_len++] = ch;
+}
+
+void VTermImageRelease(VTermParser *p)
+/* The session is closing: its transfer and cached images go */
+{
+  if (p->image != NULL)
+    free(p->image->data);
+  free(p->image);
+  p->image = NULL;
+  p->apc = false;
+  if (p->image_owner == 0)
+    return;
+  for (int i = 0; i < VTERM_IMAGE_MAX; i++)
+    if (VTermImages.images[i].owner == p->image_owner)
+      VTermImageFree(&VTermImages.images[i]);
+}
+
+/***** Drawing *****/
+
+bool VTermImageRefresh(VTermDataBuffer *buf)
+/* Once a frame before buf is drawn: takes in finished decodes and redraws
+ * the rows of the placements they completed. True while decodes are still
+ * out, the frame loop should not go idle. */
+{
+  VTermImageCollect();
+  VTermImages.clock++;
+  uint32_t owner = buf->parser->image_owner;
+  for (int i = 0; i < buf->placement_count; i++)
+  {
+    VTermImagePlacement *p = &buf->placements[i];
+    int slot = VTermImageFind(owner, p->image, p->slot);
+    if (slot < 0)
+      continue;
+    p->slot = slot;
+    VTermImages.images[slot].used = VTermImages.clock;
+  }
+  if (buf->images_seen != VTermImages.ready)
+  {
+    for (int i = 0; i < buf->placement_count; i++)
+      VTermImageDirty(buf, &buf->placements[i]);
+    buf->images_seen = VTermImages.ready;
+  }
+  return VTermImages.outstanding > 0;
+}
+
+static const VTermImage *VTermImageOf(VTermDataBuffer *buf, const VTermImagePlacement *p)
+/* The decoded image of a placement, whatever VTermImageRefresh found */
+{
+  const VTermImage *image = p->slot < VTERM_IMAGE_MAX ? &VTermImages.images[p->slot] : NULL;
+  if (image == NULL || image->owner != buf->parser->image_owner || image->id != p->image || image->pixels == NULL)
+    return NULL;
+  return image;
+}
+
+void VTermImageCompositeRow(VTermDataBuffer *buf, VTermFramebuffer *fb, uint16_t row)
+/* The soft renderer's part: placements over one cell row of fb, after its
+ * cells, scaled nearest neighbour and blended on alpha. Read only, bands
+ * run it in parallel. */
+{
+  int cw = buf->glyphs->width, ch = buf->glyphs->height;
+
+  for (int i = 0; i < buf->placement_count; i++)
+  {
+    const VTermImagePlacement *p = &buf->placements[i];
+    const VTermImage *image = VTermImageOf(buf, p);
+    if (image == NULL || row < p->row || row >= p->row + p->rows)
+      continue;
+    int w = p->cols * cw, h = p->rows * ch, x0 = p->col * cw;
+    int x1 = x0 + w < fb->width ? x0 + w : fb->width;
+    for (int y = 0; y < ch; y++)
+    {
+      int sy = (int)((int64_t)((row - p->row) * ch + y) * image->height / h);
+      const Color *src = image->pixels + (size_t)sy * image->width;
+      Color *dst = fb->pixels + ((size_t)row * ch + y) * fb->width;
+      for (int x = x0; x < x1; x++)
+      {
+        Color s = src[(int64_t)(x - x0) * image->width / w];
+        if (s.a == 255)
+          dst[x] = s;
+        else if (s.a != 0)
+        {
+          Color d = dst[x];
+          dst[x] = (Color){ (s.r * s.a + d.r * (255 - s.a)) / 255, (s.g * s.a + d.g * (255 - s.a)) / 255,
+                            (s.b * s.a + d.b * (255 - s.a)) / 255, 255 };
+        }
+      }
+    }
+  }
+}
+
+static bool VTermImageUpload(VTermImage *image)
+/* Texture for an image, other textures not drawn this frame make room */
+{
+  uint64_t bytes = (uint64_t)image->width * image->height * sizeof(Color);
+  while (VTermStats.texture_bytes + bytes > VTERM_IMAGE_TEXTURE_BUDGET)
+  {
+    VTermImage *oldest = NULL;
+    for (int i = 0; i < VTERM_IMAGE_MAX; i++)
+    {
+      VTermImage *other = &VTermImages.images[i];
+      if (other->texture.id != 0 && other->drawn != VTermImages.clock && (oldest == NULL || other->drawn < oldest->drawn))
+        oldest = other;
+    }
+    if (oldest == NULL)
+      return false;
+    VTermImageUnload(oldest);
+  }
+  Image pixels = { image->pixels, image->width, image->height, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 };
+  image->texture = LoadTextureFromImage(pixels);
+  if (image->texture.id == 0)
+    return false;
+  VTermStats.texture_bytes += bytes;
+  return true;
+}
+
+void VTermImageDraw(VTermDataBuffer *buf)
+/* The raylib renderer's part: placements over the cells as textured quads */
+{
+  int cell_w = VTermCellWidth(buf), cell_h = buf->font_size;
+
+  for (int i = 0; i < buf->placement_count; i++)
+  {
+    const VTermImagePlacement *p = &buf->placements[i];
+    VTermImage *image = (VTermImage *)VTermImageOf(buf, p);
+    if (image == NULL || (image->texture.id == 0 && !VTermImageUpload(image)))
+      continue;
+    image->drawn = VTermImages.clock;
+    DrawTexturePro(image->texture,
+                   (Rectangle){ 0, 0, image->width, image->height },
+                   (Rectangle){ p->col * cell_w, p->row * cell_h, p->cols * cell_w, p->rows * cell_h },
+                   (Vector2){ 0, 0 }, 0, WHITE);
+    VTermStats.frame_rects++;
+  }
+}
+
+void VTermImageWait(void)
+/* Until every queued decode is done and collected (benchmarks, dumps) */
+{
+  if (!VTermImages.running)
+    return;
+  pthread_mutex_lock(&VTermImages.lock);
+  while (VTermImages.todo != NULL || VTermImages.decoding)
+    pthread_cond_wait(&VTermImages.idle, &VTermImages.lock);
+  pthread_mutex_unlock(&VTermImages.lock);
+  VTermImageCollect();
+}
+
+void VTermImageClose(void)
+{
+  if (!VTermImages.running)
+    return;
+  pthread_mutex_lock(&VTermImages.lock);
+  VTermImages.running = false;
+  pthread_cond_signal(&VTermImages.wake);
+  pthread_mutex_unlock(&VTermImages.lock);
+  pthread_join(VTermImages.thread, NULL);
+
+  /* Jobs nobody will decode now */
+  while (VTermImages.todo != NULL)
+  {
+    VTermImageJob *job = VTermImages.todo;
+    VTermImages.todo = job->next;
+    free(job->data);
+    job->next = VTermImages.done;
+    VTermImages.done = job;
+  }
+  VTermImageCollect();
+  for (int i = 0; i < VTERM_IMAGE_MAX; i++)
+    VTermImageFree(&VTermImages.images[i]);
+}
@@ -0,0 +1,135 @@
+/* Per width copies of the hot row loops, included by vterm.c once for each
+ * entry of VTermKernelTable: VTERM_KERNEL_COLS is the width compiled in (0
+ * reads buf->column_count) and VTERM_KERNEL(name) names the copy. With the
+ * width constant the row addressing is a multiply by a constant and the
+ * loops have fixed trip counts the compiler can unroll. No include guard,
+ * it is meant to be included more than once. */
+
+#if VTERM_KERNEL_COLS
+#define VTERM_KERNEL_WIDTH(buf) VTERM_KERNEL_COLS
+#else
+#define VTERM_KERNEL_WIDTH(buf) ((buf)->column_count)
+#endif
+
+static size_t VTERM_KERNEL(WriteText)(VTermDataBuffer *buf, const uint8_t *bytes, size_t len)
+/* What VTermProcessByte does with printable bytes in the ground state, a row
+ * at a time. Stops at the first control byte, returns how many it took. */
+{
+  const uint16_t cols = VTERM_KERNEL_WIDTH(buf);
+  const uint64_t color = buf->fgbg_color;
+  VTermParser *p = buf->parser;
+  size_t done = 0;
+
+  while (done < len && buf->col < cols)
+  {
+    uint16_t row = buf->row, col = buf->col;
+    uint8_t *data = buf->data + (size_t)buf->row_index[row] * cols;
+    uint64_t *colors = buf->fgbg_colors + (size_t)buf->row_index[row] * cols;
+    size_t room = len - done < (size_t)(cols - col) ? len - done : (size_t)(cols - col);
+    size_t n = 0;
+
+    while (n < room && bytes[done + n] >= 0x20)
+    {
+      data[col + n] = bytes[done + n];
+      colors[col + n] = color;
+      n++;
+    }
+    if (n == 0)
+      break;
+    buf->row_flags[row] |= VTERM_ROW_DIRTY;
+    buf->col += n;
+    done += n;
+    VTermStats.cells_written += n;
+
+    p->previousWasWrap = buf->col >= cols;
+    if (p->previousWasWrap)
+    {
+      buf->row_flags[row] |= VTERM_ROW_WRAPPED;
+      buf->col = 0;
+      VTermLineFeed(buf);
+    }
+  }
+  if (done > 0)
+    p->previousWasCRAfterWrap = false;
+  return done;
+}
+
+static void VTERM_KERNEL(DrawBackgrounds)(VTermDataBuffer *buf, int row, int y, VTermRectRun *run)
+/* One scan merging equal backgrounds into runs; the default one is what the
+ * frame was cleared with so it is skipped */
+{
+  const uint16_t cols = VTERM_KERNEL_WIDTH(buf);
+  int cell_w = VTermCellWidth(buf), cell_h = buf->font_size;
+  uint32_t default_bg = UNPACK_bg(buf->default_fgbg);
+  uint64_t *colors = buf->fgbg_colors + (size_t)buf->row_index[row] * cols;
+  int start = 0;
+  uint32_t bg = UNPACK_bg(colors[0]);
+
+  for (int col = 1; col <= cols; col++)
+  {
+    uint32_t next = col < cols ? UNPACK_bg(colors[col]) : ~bg;
+    if (next == bg)
+      continue;
+    if (bg != default_bg)
+      VTermQueueRect(run, start * cell_w, y, (col - start) * cell_w, cell_h, bg);
+    start = col;
+    bg = next;
+  }
+}
+
+static void VTERM_KERNEL(DrawGlyphs)(VTermDataBuffer *buf, Font font, int row, int y)
+/* Adapted from Raylib's DrawTextEx, cells sit on a fixed grid */
+{
+  const uint16_t cols = VTERM_KERNEL_WIDTH(buf);
+  uint8_t *data = buf->data + (size_t)buf->row_index[row] * cols;
+  uint64_t *colors = buf->fgbg_colors + (size_t)buf->row_index[row] * cols;
+  float fontSize = buf->font_size;
+  int cell_w = VTermCellWidth(buf), cell_h = buf->font_size;
+  int line_h = cell_h / 16 > 0 ? cell_h / 16 : 1; // underline/strike thickness
+
+  /* Underline/strike are drawn once per run of same coloured cells */
+  int line_start = -1;
+  uint8_t line_style = 0;
+  uint32_t line_fg = 0;
+
+  for (int col = 0; col <= cols; col++)
+  {
+    uint32_t fg = 0;
+    uint8_t style = 0;
+    if (col < cols)
+    {
+      fg = UNPACK_fg(colors[col]);
+      style = ((Color *)&fg)->a & (VTERM_STYLE_UNDERLINE | VTERM_STYLE_STRIKE);
+      ((Color *)&fg)->a = 255;
+    }
+
+    if (line_start >= 0 && (style != line_style || fg != line_fg))
+    {
+      Color tint = *(Color *)&line_fg;
+      int w = (col - line_start) * cell_w;
+      if (line_style & VTERM_STYLE_UNDERLINE)
+        DrawRectangle(line_start * cell_w, y + cell_h - line_h, w, line_h, tint);
+      if (line_style & VTERM_STYLE_STRIKE)
+        DrawRectangle(line_start * cell_w, y + cell_h / 2, w, line_h, tint);
+      VTermStats.frame_rects += !!(line_style & VTERM_STYLE_UNDERLINE) + !!(line_style & VTERM_STYLE_STRIKE);
+      line_start = -1;
+    }
+    if (col == cols)
+      break;
+    if (style && line_start < 0)
+    {
+      line_start = col;
+      line_style = style;
+      line_fg = fg;
+    }
+
+    int codepoint = data[col];
+    if (codepoint != 0 && codepoint != ' ' && codepoint != '\t')
+    {
+      DrawTextCodepoint(font, codepoint, (Vector2){ col * cell_w, y }, fontSize, *(Color *)&fg);
+      VTermStats.frame_glyphs++;
+    }
+  }
+}
+
+#undef VTERM_KERNEL_WIDTH
@@ -0,0 +1,232 @@
+#include "vterm.h"
+
+/* Buckets are quarter octaves of microseconds: bucket i holds samples in
+ * [2^(i/4), 2^((i+1)/4)) us, anything under 1us goes to bucket 0 */
+
+void VTermHistAdd(VTermHistogram *h, double seconds)
+{
+  double us = seconds * 1e6;
+  int i = us <= 1 ? 0 : (int)(4 * log2(us));
+  if (i >= VTERM_HIST_BUCKETS)
+    i = VTERM_HIST_BUCKETS - 1;
+
+  h->buckets[i]++;
+  h->count++;
+  h->sum += seconds;
+  if (seconds > h->max)
+    h->max = seconds;
+}
+
+double VTermHistPercentile(VTermHistogram *h, double p)
+/* Upper bound of the bucket holding the p-th sample (p in 0..1), seconds */
+{
+  uint64_t want, seen = 0;
+  if (h->count == 0)
+    return 0;
+  want = (uint64_t)ceil(p * h->count);
+  if (want == 0)
+    want = 1;
+  for (int i = 0; i < VTERM_HIST_BUCKETS; i++)
+  {
+    seen += h->buckets[i];
+    if (seen >= want)
+    {
+      double upper = pow(2, (i + 1) / 4.0) * 1e-6;
+      return upper < h->max ? upper : h->max;
+    }
+  }
+  return h->max;
+}
+
+typedef struct {
+  const char *name;
+  VTermHistogram *hist;
+} VTermNamedHistogram;
+
+static VTermNamedHistogram VTermHistograms[] = {
+  { "key_to_write",   &VTermStats.input_latency },
+  { "key_to_echo",    &VTermStats.echo_latency },
+  { "key_to_parsed",  &VTermStats.parse_latency },
+  { "key_to_present", &VTermStats.present_latency },
+  { "frame_time",     &VTermStats.frame_time },
+  { "idle_wake",      &VTermStats.wake_latency },
+  { "parse_to_present", &VTermStats.output_latency },
+};
+#define VTERM_HISTOGRAM_COUNT (sizeof(VTermHistograms) / sizeof(VTermHistograms[0]))
+
+void VTermDrawMetricsOverlay(VTerm *vt)
+/* Top left: p50/p99 per stage and the key -> present distribution */
+{
+  const int font = 10, line = 12, bar_h = 40;
+  int x = 4, y = 4, w = 300;
+  int h = (VTERM_HISTOGRAM_COUNT + 3) * line + bar_h + 12;
+  VTermHistogram *present = &VTermStats.present_latency;
+  uint32_t peak = 1;
+
+  DrawRectangle(0, 0, w + 8, h, (Color){ 0, 0, 0, 200 });
+  DrawText("latency          p50      p99      max     n", x, y, font, YELLOW);
+  for (size_t i = 0; i < VTERM_HISTOGRAM_COUNT; i++)
+  {
+    VTermHistogram *hist = VTermHistograms[i].hist;
+    y += line;
+    DrawText(TextFormat("%-16s %6.2fms %6.2fms %6.2fms %llu",
+                        VTermHistograms[i].name,
+                        VTermHistPercentile(hist, 0.5) * 1e3,
+                        VTermHistPercentile(hist, 0.99) * 1e3,
+                        hist->max * 1e3,
+                        (unsigned long long)hist->count),
+             x, y, font, RAYWHITE);
+  }
+
+  y += line;
+  DrawText(TextFormat("last frame: %u rects, %u glyphs, bells: %llu rung of %llu",
+                      VTermStats.frame_rects, VTermStats.frame_glyphs,
+                      (unsigned long long)VTermStats.bells_rung, (unsigned long long)VTermStats.bells),
+           x, y, font, RAYWHITE);
+
+  y += line;
+  DrawText(TextFormat("parse %.1f MB/s, %llu B/read, %llu scrolls, %llu unknown CSI",
+                      VTermStats.parse_seconds > 0 ? VTermStats.bytes_parsed / VTermStats.parse_seconds / 1e6 : 0,
+                      (unsigned long long)(VTermStats.pty_reads ? VTermStats.pty_bytes / VTermStats.pty_reads : 0),
+                      (unsigned long long)VTermStats.scrolls, (unsigned long long)VTermStats.csi_unknown),
+           x, y, font, RAYWHITE);
+
+  /* Bars from 64us (bucket 24) up to ~1s */
+  y += line + 4;
+  for (int i = 24; i < VTERM_HIST_BUCKETS; i++)
+    if (present->buckets[i] > peak)
+      peak = present->buckets[i];
+  for (int i = 24; i < VTERM_HIST_BUCKETS; i++)
+  {
+    int bh = (int)((double)present->buckets[i] * bar_h / peak);
+    DrawRectangle(x + (i - 24) * 5, y + bar_h - bh, 4, bh, GREEN);
+  }
+}
+
+bool VTermWriteMetrics(FILE *f)
+/* JSON, one object per histogram with its summary and raw buckets */
+{
+  fprintf(f, "{\n  \"input_bytes\": %llu,\n  \"input_writes\": %llu",
+          (unsigned long long)VTermStats.input_bytes,
+          (unsigned long long)VTermStats.input_writes);
+  fprintf(f, ",\n  \"idle_waits\": %llu,\n  \"wakes\": {\"pty\": %llu, \"timeout\": %llu, \"event\": %llu}",
+          (unsigned long long)VTermStats.idle_waits,
+          (unsigned long long)VTermStats.wakes_pty,
+          (unsigned long long)VTermStats.wakes_timeout,
+          (unsigned long long)VTermStats.wakes_event);
+  fprintf(f, ",\n  \"pty_reads\": {\"count\": %llu, \"bytes\": %llu, \"buckets\": [",
+          (unsigned long long)VTermStats.pty_reads,
+          (unsigned long long)VTermStats.pty_bytes);
+  for (int b = 0; b < VTERM_READ_BUCKETS; b++)
+    fprintf(f, "%s%u", b ? "," : "", VTermStats.read_sizes[b]);
+  fprintf(f, "]}");
+  fprintf(f, ",\n  \"parse\": {\"bytes\": %llu, \"seconds\": %g, \"bytes_per_second\": %g, \"cells_written\": %llu}",
+          (unsigned long long)VTermStats.bytes_parsed, VTermStats.parse_seconds,
+          VTermStats.parse_seconds > 0 ? VTermStats.bytes_parsed / VTermStats.parse_seconds : 0,
+          (unsigned long long)VTermStats.cells_written);
+  /* Only the finals that were seen, keyed by the byte itself */
+  fprintf(f, ",\n  \"csi\": {\"unknown\": %llu, \"by_final\": {", (unsigned long long)VTermStats.csi_unknown);
+  for (int c = 0, first = 1; c < 0x3f; c++)
+  {
+    if (VTermStats.csi_finals[c] == 0)
+      continue;
+    fprintf(f, "%s\"%s%c\": %llu", first ? "" : ", ", c + 0x40 == '\\' ? "\\" : "", c + 0x40,
+            (unsigned long long)VTermStats.csi_finals[c]);
+    first = 0;
+  }
+  fprintf(f, "}}");
+  fprintf(f, ",\n  \"scrolls\": {\"count\": %llu, \"lines\": %llu, \"jumped\": %llu}",
+          (unsigned long long)VTermStats.scrolls,
+          (unsigned long long)VTermStats.scrolled_lines,
+          (unsigned long long)VTermStats.jumped_lines);
+  fprintf(f, ",\n  \"strings\": {\"osc\": %llu, \"dcs\": %llu, \"dropped\": %llu, \"clipboard_bytes\": %llu}",
+          (unsigned long long)VTermStats.strings_osc,
+          (unsigned long long)VTermStats.strings_dcs,
+          (unsigned long long)VTermStats.strings_dropped,
+          (unsigned long long)VTermStats.clipboard_bytes);
+  fprintf(f, ",\n  \"frames_held\": %llu,\n  \"sync_timeouts\": %llu",
+          (unsigned long long)VTermStats.frames_held,
+          (unsigned long long)VTermStats.sync_timeouts);
+  fprintf(f, ",\n  \"row_cache\": {\"hits\": %llu, \"misses\": %llu}",
+          (unsigned long long)VTermStats.rows_cached,
+          (unsigned long long)VTermStats.rows_drawn);
+  fprintf(f, ",\n  \"glyph_atlases\": {\"built\": %llu, \"scaled_frames\": %llu}",
+          (unsigned long long)VTermStats.glyph_atlases,
+          (unsigned long long)VTermStats.glyph_scaled);
+  fprintf(f, ",\n  \"panes\": {\"redraws\": %llu, \"rows\": %llu, \"reused\": %llu, \"deferred\": %llu, \"held\": %llu}",
+          (unsigned long long)VTermStats.pane_redraws,
+          (unsigned long long)VTermStats.pane_rows,
+          (unsigned long long)VTermStats.pane_reused,
+          (unsigned long long)VTermStats.pane_deferred,
+          (unsigned long long)VTermStats.pane_held);
+  fprintf(f, ",\n  \"children_reaped\": %llu", (unsigned long long)VTermStats.children_reaped);
+  fprintf(f, ",\n  \"bell\": {\"received\": %llu, \"coalesced\": %llu, \"rung\": %llu}",
+          (unsigned long long)VTermStats.bells,
+          (unsigned long long)VTermStats.bells_coalesced,
+          (unsigned long long)VTermStats.bells_rung);
+  fprintf(f, ",\n  \"images\": {\"decoded\": %llu, \"evicted\": %llu, \"bytes\": %llu, \"texture_bytes\": %llu}",
+          (unsigned long long)VTermStats.images_decoded,
+          (unsigned long long)VTermStats.images_evicted,
+          (unsigned long long)VTermStats.image_bytes,
+          (unsigned long long)VTermStats.texture_bytes);
+  fprintf(f, ",\n  \"frame_rects\": %u,\n  \"frame_glyphs\": %u",
+          VTermStats.frame_rects, VTermStats.frame_glyphs);
+  for (size_t i = 0; i < VTERM_HISTOGRAM_COUNT; i++)
+  {
+    VTermHistogram *hist = VTermHistograms[i].hist;
+    fprintf(f, ",\n  \"%s\": {\"count\": %llu, \"mean\": %g, \"p50\": %g, \"p99\": %g, \"max\": %g, \"buckets\": [",
+            VTermHistograms[i].name,
+            (unsigned long long)hist->count,
+            hist->count ? hist->sum / hist->count : 0,
+            VTermHistPercentile(hist, 0.5),
+            VTermHistPercentile(hist, 0.99),
+            hist->max);
+    for (int b = 0; b < VTERM_HIST_BUCKETS; b++)
+      fprintf(f, "%s%u", b ? "," : "", hist->buckets[b]);
+    fprintf(f, "]}");
+  }
+  fprintf(f, "\n}\n");
+  return !ferror(f);
+}
+
+bool VTermDumpMetrics(const char *path)
+/* VTermWriteMetrics to path, replaced whole so a reader never sees half */
+{
+  char tmp[4096];
+  snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+  FILE *f = fopen(tmp, "w");
+  if (f == NULL)
+  {
+    VTermError("fopen(metrics dump)");
+    return false;
+  }
+  bool ok = VTermWriteMetrics(f);
+  ok = fclose(f) == 0 && ok;
+  if (!ok || rename(tmp, path) == -1)
+  {
+    VTermError("VTermDumpMetrics");
+    unlink(tmp);
+    return false;
+  }
+  return true;
+}
+
+void VTermMetricsTick(double now)
+/* Once a frame: VTERM_METRICS_INTERVAL=<seconds> with VTERM_METRICS_FILE
+ * rewrites the dump that often, to watch a live session */
+{
+  static double interval = -1, next = 0;
+  static const char *path = NULL;
+
+  if (interval < 0)
+  {
+    const char *env = getenv("VTERM_METRICS_INTERVAL");
+    path = getenv("VTERM_METRICS_FILE");
+    interval = env && path ? atof(env) : 0;
+    next = now + interval;
+  }
+  if (interval <= 0 || now < next)
+    return;
+  next = now + interval;
+  VTermDumpMetrics(path);
+}
@@ -0,0 +1,351 @@
+#include "vterm.h"
+
+/* Control strings (see vterm.h). The parser hands over everything after
+ * ESC ] / P / X / ^ in chunks; the terminator is looked for once per chunk
+ * and the bytes before it go to the string in one go. An OSC is
+ * <number>;<text>, the number picks what the text is for. OSC 52 is
+ * 52;<targets>;<base64>: the payload is decoded straight into the string
+ * buffer, so a multi megabyte copy costs its decoded size and one pass. */
+
+enum {
+  VTERM_STRING_COMMAND, // OSC number, up to the first ';'
+  VTERM_STRING_TARGETS, // OSC 52 selection targets, up to the second ';'
+  VTERM_STRING_PAYLOAD, // OSC 52 base64
+  VTERM_STRING_TEXT,    // kept as is
+  VTERM_STRING_SKIP,    // read to the end, not kept
+};
+
+struct VTermString {
+  uint8_t phase;  // VTERM_STRING_COMMAND and on
+  int command;    // OSC number, -1 if it wasn't one
+  bool escape;    // ESC ended the last chunk, ST if a backslash follows
+  bool failed;    // over VTERM_STRING_MAX, the rest is dropped
+  bool query;     // OSC 52 payload is '?', the app wants the clipboard
+  VTermBase64 b64;
+  uint8_t *data;
+  size_t len, cap;
+};
+
+/***** BASE64 *****/
+
+static int8_t VTermBase64Table[256];
+
+static void VTermBase64Init(void)
+{
+  const char *alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  memset(VTermBase64Table, -1, sizeof(VTermBase64Table));
+  for (int i = 0; i < 64; i++)
+    VTermBase64Table[(uint8_t)alphabet[i]] = i;
+}
+
+#if defined(__GNUC__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+/* GCC/clang vector extensions: SSE2 on x86-64, NEON on arm64, no intrinsics */
+#define VTERM_BASE64_VECTOR 1
+typedef uint8_t VTermU8x16 __attribute__((vector_size(16)));
+typedef uint16_t VTermU16x8 __attribute__((vector_size(16)));
+typedef uint32_t VTermU32x4 __attribute__((vector_size(16)));
+
+static bool VTermBase64Block(const uint8_t *in, uint8_t *out)
+/* 16 characters to 12 bytes (16 are stored). False, and nothing written,
+ * unless all 16 are in the alphabet: padding, newlines and such go through
+ * the scalar loop. */
+{
+  VTermU8x16 c;
+  memcpy(&c, in, 16);
+
+  /* Classify by range, each lane takes the offset of the range it is in */
+  VTermU8x16 upper = (VTermU8x16)(c >= 'A') & (VTermU8x16)(c <= 'Z');
+  VTermU8x16 lower = (VTermU8x16)(c >= 'a') & (VTermU8x16)(c <= 'z');
+  VTermU8x16 digit = (VTermU8x16)(c >= '0') & (VTermU8x16)(c <= '9');
+  VTermU8x16 plus = (VTermU8x16)(c == '+'), slash = (VTermU8x16)(c == '/');
+  VTermU8x16 valid = upper | lower | digit | plus | slash;
+  uint64_t halves[2];
+  memcpy(halves, &valid, 16);
+  if ((halves[0] & halves[1]) != ~(uint64_t)0)
+    return false;
+  VTermU8x16 v = (upper & (c - 'A')) | (lower & (c - ('a' - 26))) | (digit & (c + (52 - '0')))
+               | (plus & 62) | (slash & 63);
+
+  /* Merge 6 bit values: byte pairs into 12 bits, then those into 24 */
+  VTermU16x8 pairs = (VTermU16x8)v;
+  pairs = ((pairs & 0x3f) << 6) | (pairs >> 8);
+  VTermU32x4 quads = (VTermU32x4)pairs;
+  quads = ((quads & 0xffff) << 12) | (quads >> 16);
+  /* Most significant byte first, the 4th byte is overwritten by the next */
+  quads = ((quads >> 16) & 0xff) | (quads & 0xff00) | ((quads & 0xff) << 16);
+  for (int k = 0; k < 4; k++)
+  {
+    uint32_t lane = quads[k];
+    memcpy(out + 3 * k, &lane, 4);
+  }
+  return true;
+}
+
+static size_t VTermStringPlain(const uint8_t *bytes, size_t len)
+/* How many bytes come before the first C0 control, 16 at a time */
+{
+  size_t n = 0;
+  for (; len - n >= 16; n += 16)
+  {
+    VTermU8x16 c;
+    uint64_t halves[2];
+    memcpy(&c, bytes + n, 16);
+    c = (VTermU8x16)(c < 0x20);
+    memcpy(halves, &c, 16);
+    if (halves[0] | halves[1])
+      break;
+  }
+  while (n < len && bytes[n] >= 0x20)
+    n++;
+  return n;
+}
+#else
+static size_t VTermStringPlain(const uint8_t *bytes, size_t len)
+{
+  size_t n = 0;
+  while (n < len && bytes[n] >= 0x20)
+    n++;
+  return n;
+}
+#endif
+
+size_t VTermBase64Decode(VTermBase64 *b64, const uint8_t *in, size_t len, uint8_t *out, bool vector)
+/* Streams len characters into out, which has VTERM_BASE64_ROOM(len) bytes.
+ * Characters outside the alphabet are skipped, '=' ends a quantum early.
+ * Whole blocks go through the vector path when vector is set and one is
+ * compiled in. Returns the bytes written. */
+{
+  size_t i = 0, n = 0;
+
+  if (VTermBase64Table['B'] == 0)
+    VTermBase64Init();
+  while (i < len)
+  {
+#ifdef VTERM_BASE64_VECTOR
+    /* On a quantum boundary: 16 characters at a time while they're clean */
+    while (vector && b64->quad_len == 0 && len - i >= 16 && VTermBase64Block(in + i, out + n))
+    {
+      i += 16;
+      n += 12;
+    }
+    if (i == len)
+      break;
+#endif
+    /* A character at a time up to the next quantum boundary */
+    do
+    {
+      uint8_t ch = in[i++];
+      int8_t v = VTermBase64Table[ch];
+      if (ch == '=')
+        n += VTermBase64Finish(b64, out + n);
+      if (v < 0)
+        continue;
+      b64->quad = b64->quad << 6 | v;
+      if (++b64->quad_len < 4)
+        continue;
+      out[n++] = b64->quad >> 16;
+      out[n++] = b64->quad >> 8;
+      out[n++] = b64->quad;
+      b64->quad = 0;
+      b64->quad_len = 0;
+    } while (i < len && b64->quad_len != 0);
+  }
+  return n;
+}
+
+size_t VTermBase64Finish(VTermBase64 *b64, uint8_t *out)
+/* Padding, or the end: a quantum cut short still holds 1 or 2 bytes */
+{
+  int n = b64->quad_len;
+  uint32_t quad = b64->quad << 6 * (4 - n);
+
+  b64->quad = 0;
+  b64->quad_len = 0;
+  if (n < 2)
+    return 0;
+  out[0] = quad >> 16;
+  if (n == 3)
+    out[1] = quad >> 8;
+  return n - 1;
+}
+
+/***** STRINGS *****/
+
+static bool VTermStringGrow(VTermString *s, size_t n)
+{
+  if (s->len + n <= s->cap)
+    return true;
+  size_t cap = s->cap ? s->cap : 4096;
+  while (cap < s->len + n)
+    cap *= 2;
+  uint8_t *data = s->len + n <= VTERM_STRING_MAX + VTERM_BASE64_ROOM(0) ? (uint8_t *)realloc(s->data, cap) : NULL;
+  if (data == NULL)
+  {
+    s->failed = true;
+    return false;
+  }
+  s->data = data;
+  s->cap = cap;
+  return true;
+}
+
+void VTermStringBegin(VTermDataBuffer *buf, uint8_t ch)
+/* ESC ch started a string, ch is ] P X or ^ */
+{
+  VTermParser *p = buf->parser;
+
+  if (p->str == NULL && (p->str = (VTermString *)calloc(1, sizeof(VTermString))) == NULL)
+  {
+    VTermError("calloc(control string)");
+    return;
+  }
+  p->string = ch == ']' ? VTERM_STRING_OSC : ch == 'P' ? VTERM_STRING_DCS : VTERM_STRING_IGNORE;
+  p->str->phase = p->string == VTERM_STRING_OSC ? VTERM_STRING_COMMAND
+                : p->string == VTERM_STRING_DCS ? VTERM_STRING_TEXT : VTERM_STRING_SKIP;
+}
+
+static void VTermStringData(VTermString *s, const uint8_t *bytes, size_t n)
+/* A run of the string's bytes, none of them a terminator */
+{
+  size_t i = 0;
+
+  while (i < n && s->phase == VTERM_STRING_COMMAND)
+  {
+    uint8_t ch = bytes[i++];
+    if (ch == ';')
+      s->phase = s->command == 52 ? VTERM_STRING_TARGETS : VTERM_STRING_TEXT;
+    else if (ch >= '0' && ch <= '9' && s->command >= 0 && s->command < 100000)
+      s->command = s->command * 10 + ch - '0';
+    else
+      s->command = -1;
+  }
+  while (i < n && s->phase == VTERM_STRING_TARGETS)
+    if (bytes[i++] == ';')
+      s->phase = VTERM_STRING_PAYLOAD;
+  if (i == n || s->failed || s->phase == VTERM_STRING_SKIP)
+    return;
+
+  if (s->phase == VTERM_STRING_PAYLOAD)
+  {
+    if (s->len == 0 && s->b64.quad_len == 0 && bytes[i] == '?')
+      s->query = true;
+    if (!s->query && VTermStringGrow(s, VTERM_BASE64_ROOM(n - i)))
+      s->len += VTermBase64Decode(&s->b64, bytes + i, n - i, s->data + s->len, true);
+  }
+  else if (VTermStringGrow(s, n - i))
+  {
+    memcpy(s->data + s->len, bytes + i, n - i);
+    s->len += n - i;
+  }
+  if (s->len > VTERM_STRING_MAX)
+    s->failed = true;
+}
+
+static void VTermStringTitle(VTermParser *p, VTermString *s)
+/* OSC 0/2: the text, control characters dropped */
+{
+  size_t n = 0;
+  for (size_t i = 0; i < s->len && n < VTERM_TITLE_MAX - 1; i++)
+    if (s->data[i] >= 0x20 && s->data[i] != 0x7f)
+      p->title[n++] = s->data[i];
+  p->title[n] = '\0';
+}
+
+static void VTermStringEnd(VTermDataBuffer *buf, bool terminated)
+/* The string is over: run it if it ended with its terminator, then get
+ * ready for the next one. A big buffer isn't kept around. */
+{
+  VTermParser *p = buf->parser;
+  VTermString *s = p->str;
+
+  if (p->string == VTERM_STRING_OSC)
+    VTermStats.strings_osc++;
+  else
+    VTermStats.strings_dcs++;
+  if (!terminated || s->failed)
+    VTermStats.strings_dropped++;
+  else if (p->string == VTERM_STRING_OSC && (s->command == 0 || s->command == 2))
+    VTermStringTitle(p, s);
+  else if (p->string == VTERM_STRING_OSC && s->phase == VTERM_STRING_PAYLOAD && !s->query
+           && VTermStringGrow(s, VTERM_BASE64_ROOM(0)))
+  {
+    s->len += VTermBase64Finish(&s->b64, s->data + s->len);
+    s->data[s->len] = '\0'; // raylib wants a C string, a NUL inside cuts it short
+    VTermStats.clipboard_bytes += s->len;
+    /* Headless (server, benchmarks) there is no clipboard to set */
+    if (IsWindowReady())
+      SetClipboardText((const char *)s->data);
+  }
+
+  uint8_t *data = s->data;
+  size_t cap = s->cap;
+  if (cap > VTERM_STRING_KEEP)
+  {
+    free(data);
+    data = NULL;
+    cap = 0;
+  }
+  memset(s, 0, sizeof(*s));
+  s->data = data;
+  s->cap = cap;
+  p->string = VTERM_STRING_NONE;
+}
+
+size_t VTermStringBytes(VTerm *vt, VTermDataBuffer *buf, const uint8_t *bytes, size_t len)
+/* Bytes from the pty while the parser is in a string: takes them up to and
+ * including the terminator, or all of them. Returns how many it took. An
+ * ESC that doesn't start ST, CAN or SUB cancel the string instead. */
+{
+  VTermParser *p = buf->parser;
+  VTermString *s = p->str;
+  size_t n = 0;
+
+  if (s == NULL)
+  {
+    p->string = VTERM_STRING_NONE; // out of memory at the start, drop it as text
+    return 0;
+  }
+  if (s->escape)
+  {
+    uint8_t ch = bytes[0];
+    VTermStringEnd(buf, ch == '\\');
+    if (ch != '\\')
+    {
+      /* ESC that isn't ST starts a sequence */
+      p->previousWasEscape = true;
+      VTermProcessByte(vt, ch);
+    }
+    return 1;
+  }
+
+  bool bel = p->string == VTERM_STRING_OSC;
+  /* Terminators are all C0 controls, other controls are part of the text */
+  while ((n += VTermStringPlain(bytes + n, len - n)) < len &&
+         bytes[n] != '\33' && bytes[n] != 0x18 && bytes[n] != 0x1a && !(bel && bytes[n] == '\a'))
+    n++;
+  VTermStringData(s, bytes, n);
+  if (n == len)
+    return n;
+  if (bytes[n] == '\33')
+    s->escape = true;
+  else
+    VTermStringEnd(buf, bytes[n] == '\a');
+  return n + 1;
+}
+
+void VTermStringRelease(VTermParser *p)
+/* The session is closing */
+{
+  if (p->str != NULL)
+    free(p->str->data);
+  free(p->str);
+  p->str = NULL;
+  p->string = VTERM_STRING_NONE;
+}
+
+const char *VTermTitle(VTerm *vt)
+/* The focused session's title, "vterm" until it sets one */
+{
+  const char *title = VTermGetCurrentBuffer(vt)->parser->title;
+  return title[0] != '\0' ? title : "vterm";
+}
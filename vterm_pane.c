@@ -0,0 +1,401 @@
+#include "vterm.h"
+#include <limits.h>
+
+/* Panes: the open sessions tiled over the window, one per buffer. Layout
+ * gives each a viewport and sizes its grid to it (the child gets SIGWINCH
+ * like on any resize). Drawing keeps each pane's last frame in a render
+ * texture: a frame redraws the rows its session damaged, shifts the pixels
+ * of a scroll instead of redrawing them, and leaves panes with no damage
+ * alone. The window itself is then one pass of a quad per pane, all panes
+ * drawing from the same glyph atlases (VTermGlyphFont). The rows all panes
+ * rasterize in a frame are capped by VTERM_PANE_ROW_BUDGET; a pane over it
+ * keeps its damage and shows its last frame until a later one. */
+
+static struct {
+  uint16_t next; // pane index the budget goes to first after the focused one
+} VTermPanes;
+
+static void VTermPaneRelease(VTermPane *pane)
+{
+  for (int i = 0; i < 2; i++)
+  {
+    if (pane->target[i].id != 0)
+      UnloadRenderTexture(pane->target[i]);
+    memset(&pane->target[i], 0, sizeof(pane->target[i]));
+  }
+  pane->valid = false;
+}
+
+void VTermPanesRelease(VTerm *vt)
+/* Every pane's textures, before CloseWindow */
+{
+  for (int p = 0; p < vt->pane_count; p++)
+    VTermPaneRelease(&vt->panes[p]);
+}
+
+static int VTermPaneOf(VTerm *vt, uint16_t ix)
+{
+  for (int p = 0; p < vt->pane_count; p++)
+    if (vt->panes[p].buffer_ix == ix)
+      return p;
+  return -1;
+}
+
+static bool VTermPaneFit(VTerm *vt, uint16_t ix, int width, int height)
+/* Session ix's grid to as many cells as fit width x height pixels */
+{
+  VTermDataBuffer *buf = vt->buffers[ix];
+  int cols = width / VTermCellWidth(buf), rows = height / buf->font_size;
+
+  if (cols < 1) cols = 1;
+  if (rows < 1) rows = 1;
+  if (cols == buf->column_count && rows == buf->row_count)
+    return true;
+  return VTermResizeBuffer(&vt->buffers[ix], cols, rows);
+}
+
+bool VTermLayoutPanes(VTerm *vt)
+/* Tiles the open sessions over the window in buffer order: a near square
+ * grid, the panes of a short last row share its width. A single session
+ * gets the whole window back and panes are off. */
+{
+  uint16_t ixs[MAX_BUFFER_COUNT];
+  int n = 0;
+
+  for (int i = 0; i < MAX_BUFFER_COUNT; i++)
+    if (vt->buffers[i] != NULL)
+      ixs[n++] = i;
+  VTermPanesRelease(vt);
+  vt->pane_count = 0;
+  vt->busy = true;
+  if (n <= 1)
+    return n == 0 || VTermPaneFit(vt, ixs[0], vt->pixel_width, vt->pixel_height);
+
+  int grid_cols = 1;
+  while (grid_cols * grid_cols < n)
+    grid_cols++;
+  int grid_rows = (n + grid_cols - 1) / grid_cols;
+  int half = VTERM_PANE_GAP / 2;
+
+  for (int k = 0; k < n; k++)
+  {
+    VTermPane *pane = &vt->panes[k];
+    int r = k / grid_cols, c = k % grid_cols;
+    int in_row = r == grid_rows - 1 ? n - r * grid_cols : grid_cols;
+    int x0 = vt->pixel_width * c / in_row, x1 = vt->pixel_width * (c + 1) / in_row;
+    int y0 = vt->pixel_height * r / grid_rows, y1 = vt->pixel_height * (r + 1) / grid_rows;
+
+    /* The gap is split between the two panes either side of it */
+    x0 += c > 0 ? half : 0;
+    x1 -= c + 1 < in_row ? VTERM_PANE_GAP - half : 0;
+    y0 += r > 0 ? half : 0;
+    y1 -= r + 1 < grid_rows ? VTERM_PANE_GAP - half : 0;
+
+    memset(pane, 0, sizeof(*pane));
+    pane->buffer_ix = ixs[k];
+    pane->x = x0;
+    pane->y = y0;
+    pane->width = x1 > x0 ? x1 - x0 : 1;
+    pane->height = y1 > y0 ? y1 - y0 : 1;
+    if (!VTermPaneFit(vt, ixs[k], pane->width, pane->height))
+    {
+      VTermError("VTermPaneFit(vt, ix, width, height)");
+      return false;
+    }
+  }
+  vt->pane_count = n;
+  VTermPanes.next = 0;
+  return true;
+}
+
+bool VTermSplitPane(VTerm *vt)
+/* A new shell in a pane of its own, which gets the focus */
+{
+  uint16_t ix = 0;
+
+  if (vt->server_fd != -1)
+  {
+    VTermError("VTermSplitPane: the server owns the session");
+    return false;
+  }
+  while (ix < MAX_BUFFER_COUNT && vt->buffers[ix] != NULL)
+    ix++;
+  if (ix == MAX_BUFFER_COUNT)
+  {
+    VTermError("VTermSplitPane: MAX_BUFFER_COUNT sessions open");
+    return false;
+  }
+  if (!VTermInitBuffer(&vt->buffers[ix], VTermGetCurrentPrincipalBuffer(vt)->mode))
+  {
+    VTermError("VTermInitBuffer(&vt->buffers[ix], mode)");
+    if (vt->buffers[ix] != NULL)
+      VTermCloseBuffer(vt->buffers[ix]);
+    vt->buffers[ix] = NULL;
+    return false;
+  }
+  vt->buffer_ix = ix;
+  return VTermLayoutPanes(vt);
+}
+
+bool VTermClosePane(VTerm *vt, uint16_t ix)
+/* Session ix is gone (its child exited): the rest are laid out again and
+ * the focus moves to a neighbour if it was on ix. False if none are left. */
+{
+  int p = VTermPaneOf(vt, ix);
+
+  if (p < 0)
+    return false;
+  VTermCloseBuffer(vt->buffers[ix]);
+  vt->buffers[ix] = NULL;
+  if (vt->buffer_ix == ix)
+    vt->buffer_ix = vt->panes[p + 1 < vt->pane_count ? p + 1 : p - 1].buffer_ix;
+  return VTermLayoutPanes(vt);
+}
+
+void VTermFocusPane(VTerm *vt, int delta)
+/* Keyboard input goes delta panes on, wrapping around */
+{
+  int p = VTermPaneOf(vt, vt->buffer_ix);
+
+  if (p < 0)
+    return;
+  p = ((p + delta) % vt->pane_count + vt->pane_count) % vt->pane_count;
+  vt->buffer_ix = vt->panes[p].buffer_ix;
+  vt->busy = true;
+}
+
+static bool VTermPaneDamaged(VTermDataBuffer *buf)
+{
+  if (buf->damage.full || buf->damage.scroll != 0)
+    return true;
+  for (int r = 0; r < buf->row_count; r++)
+    if (buf->row_flags[r] & VTERM_ROW_DIRTY)
+      return true;
+  return false;
+}
+
+bool VTermPanesHeld(VTerm *vt)
+/* The whole frame can be skipped while some pane is mid synchronized update
+ * and none of the others has anything new to show. Every pane's update is
+ * timed out here, not just the focused one's. */
+{
+  double now = GetTime();
+  bool held = false, changed = false;
+
+  for (int p = 0; p < vt->pane_count; p++)
+  {
+    VTermPane *pane = &vt->panes[p];
+    VTermDataBuffer *pbuf = vt->buffers[pane->buffer_ix];
+    VTermDataBuffer *live = pbuf->alt_buffer != NULL ? pbuf->alt_buffer : pbuf;
+    uint64_t shown_view = pane->shown == pbuf->view_screen ? pane->view : 0;
+
+    if (VTermSyncHeld(pbuf->parser, now))
+      held = true;
+    else if (!pane->valid || VTermPaneDamaged(live) || (live == pbuf && pbuf->scrollback->view != shown_view))
+      changed = true;
+  }
+  return held && !changed;
+}
+
+static VTermDataBuffer *VTermPaneScreen(VTermPane *pane, VTermDataBuffer *pbuf)
+/* What the pane shows: the live screen, or the scrollback view. The view is
+ * only rebuilt from the history when it moved or the live rows changed. */
+{
+  VTermDataBuffer *live = pbuf->alt_buffer != NULL ? pbuf->alt_buffer : pbuf;
+  uint64_t view = pbuf->scrollback->view;
+
+  if (view == 0 || live != pbuf)
+    return live;
+  if (view != pane->view || pane->shown != pbuf->view_screen || VTermPaneDamaged(pbuf))
+  {
+    VTermTakeDamage(pbuf);
+    for (int r = 0; r < pbuf->row_count; r++)
+      pbuf->row_flags[r] &= ~VTERM_ROW_DIRTY; // all redrawn when the view goes back to 0
+    pane->view = view;
+    return VTermScrollbackView(pbuf);
+  }
+  return pbuf->view_screen;
+}
+
+static bool VTermPaneTargets(VTermPane *pane, int width, int height)
+/* Both targets the size of the pane's grid, false without render textures */
+{
+  if (pane->target[0].id != 0 && pane->target[0].texture.width == width
+      && pane->target[0].texture.height == height)
+    return true;
+  VTermPaneRelease(pane);
+  for (int i = 0; i < 2; i++)
+    pane->target[i] = LoadRenderTexture(width, height);
+  pane->front = 0;
+  return pane->target[0].id != 0 && pane->target[1].id != 0;
+}
+
+static void VTermPaneShift(VTermPane *pane, VTermDamage *d, int cell_h, int width, int height)
+/* The last frame copied to the other target with [scroll_top, scroll_bottom)
+ * moved up d->scroll rows (down if negative), the copy becomes the front.
+ * The rows that came in blank are dirty, they are drawn after. */
+{
+  Texture2D from = pane->target[pane->front].texture;
+  int k = abs(d->scroll), n = d->scroll_bottom - d->scroll_top - k;
+  int src = d->scroll > 0 ? d->scroll_top + k : d->scroll_top;
+  int dst = d->scroll > 0 ? d->scroll_top : d->scroll_top + k;
+
+  pane->front ^= 1;
+  BeginTextureMode(pane->target[pane->front]);
+  DrawTextureRec(from, (Rectangle){ 0, 0, width, -height }, (Vector2){ 0, 0 }, WHITE);
+  DrawTextureRec(from, (Rectangle){ 0, height - (src + n) * cell_h, width, -n * cell_h },
+                 (Vector2){ 0, dst * cell_h }, WHITE);
+  EndTextureMode();
+}
+
+static int VTermPaneRedraw(VTermPane *pane, VTermDataBuffer *screen, int budget)
+/* Brings the pane's texture up to date with screen if that takes at most
+ * budget rows. Returns the rows rasterized, -1 when it has to wait. */
+{
+  int cell_h = screen->font_size, width = screen->column_count * VTermCellWidth(screen);
+  int height = screen->row_count * cell_h;
+  unsigned int font = VTermGlyphFont(screen).texture.id;
+  bool full = !pane->valid || pane->shown != screen || pane->font != font || screen->damage.full;
+  int rows = 0;
+
+  if (!VTermPaneTargets(pane, width, height))
+    return -1;
+  if (full)
+    rows = screen->row_count;
+  else
+    for (int r = 0; r < screen->row_count; r++)
+      rows += (screen->row_flags[r] & VTERM_ROW_DIRTY) != 0;
+  if (rows == 0 && screen->damage.scroll == 0)
+  {
+    VTermStats.pane_reused++;
+    return 0;
+  }
+  if (rows > budget)
+  {
+    VTermStats.pane_deferred++;
+    return -1;
+  }
+
+  VTermDamage damage = VTermTakeDamage(screen);
+  if (full)
+  {
+    uint32_t bg = UNPACK_bg(screen->default_fgbg) | 0xff000000u; // opaque, copied as is
+    BeginTextureMode(pane->target[pane->front]);
+    ClearBackground(*(Color *)&bg);
+    VTermDrawText(screen);
+    EndTextureMode();
+    for (int r = 0; r < screen->row_count; r++)
+      screen->row_flags[r] &= ~VTERM_ROW_DIRTY;
+  }
+  else
+  {
+    if (damage.scroll != 0)
+      VTermPaneShift(pane, &damage, cell_h, width, height);
+    BeginTextureMode(pane->target[pane->front]);
+    VTermDrawDirtyRows(screen);
+    EndTextureMode();
+  }
+  pane->valid = true;
+  pane->shown = screen;
+  pane->font = font;
+  VTermStats.pane_redraws++;
+  VTermStats.pane_rows += rows;
+  return rows;
+}
+
+bool VTermDrawPanes(VTerm *vt)
+/* The window with panes on: textures updated, focused pane first, then a
+ * quad per pane, the focus border and the focused pane's cursor */
+{
+  VTermDataBuffer *screens[MAX_BUFFER_COUNT];
+  int order[MAX_BUFFER_COUNT], count = 0;
+  int focus = VTermPaneOf(vt, vt->buffer_ix), drawn = 0, waiting = -1;
+  bool focus_held = false;
+  double now = GetTime();
+
+  /* Focused pane first, then round robin from the one left waiting last */
+  if (focus >= 0)
+    order[count++] = focus;
+  for (int k = 0; k < vt->pane_count; k++)
+    if ((VTermPanes.next + k) % vt->pane_count != focus)
+      order[count++] = (VTermPanes.next + k) % vt->pane_count;
+
+  for (int k = 0; k < count; k++)
+  {
+    int p = order[k];
+    VTermPane *pane = &vt->panes[p];
+    VTermDataBuffer *pbuf = vt->buffers[pane->buffer_ix];
+
+    if (VTermImageRefresh(pbuf))
+      vt->busy = true;
+    /* Mid synchronized update: the last frame stays up, damage adds up */
+    if (pane->valid && VTermSyncHeld(pbuf->parser, now))
+    {
+      screens[p] = (VTermDataBuffer *)pane->shown;
+      focus_held = focus_held || p == focus;
+      VTermStats.pane_held++;
+      vt->busy = true; // back next frame, for the end marker or the timeout
+      continue;
+    }
+    screens[p] = VTermPaneScreen(pane, pbuf);
+    /* The first pane to draw anything always may, or a grid taller than
+     * the budget would never show */
+    int rows = VTermPaneRedraw(pane, screens[p], drawn == 0 ? INT_MAX : VTERM_PANE_ROW_BUDGET - drawn);
+    if (rows < 0 && pane->target[0].id != 0)
+    {
+      vt->busy = true; // its damage is still there for the next frame
+      if (waiting < 0)
+        waiting = p;
+    }
+    drawn += rows > 0 ? rows : 0;
+  }
+  if (waiting >= 0)
+    VTermPanes.next = waiting;
+  if (VTermGlyphsBuilding())
+    vt->busy = true;
+
+  for (int p = 0; p < vt->pane_count; p++)
+  {
+    VTermPane *pane = &vt->panes[p];
+    VTermDataBuffer *screen = screens[p];
+    VTermDataBuffer *pbuf = vt->buffers[pane->buffer_ix];
+    VTermDataBuffer *live = pbuf->alt_buffer != NULL ? pbuf->alt_buffer : pbuf;
+    int width = screen->column_count * VTermCellWidth(screen), height = screen->row_count * screen->font_size;
+    uint32_t bg = UNPACK_bg(screen->default_fgbg);
+    Camera2D at = { .offset = { pane->x, pane->y }, .zoom = 1 };
+
+    DrawRectangle(pane->x, pane->y, pane->width, pane->height, *(Color *)&bg);
+    if (pane->valid)
+      DrawTextureRec(pane->target[pane->front].texture, (Rectangle){ 0, 0, width, -height },
+                     (Vector2){ pane->x, pane->y }, WHITE);
+    else
+    {
+      /* No render textures here: every cell, straight to the window */
+      BeginMode2D(at);
+      VTermDrawText(screen);
+      EndMode2D();
+    }
+    VTermStats.frame_rects += 2;
+    if (screen == live && live->placement_count > 0)
+    {
+      BeginMode2D(at);
+      VTermImageDraw(live);
+      EndMode2D();
+    }
+  }
+
+  if (focus >= 0)
+  {
+    VTermPane *pane = &vt->panes[focus];
+    VTermDataBuffer *pbuf = vt->buffers[pane->buffer_ix];
+    VTermDataBuffer *live = pbuf->alt_buffer != NULL ? pbuf->alt_buffer : pbuf;
+    uint64_t view = live == pbuf ? pbuf->scrollback->view : 0;
+    int cell_w = VTermCellWidth(live), cell_h = live->font_size;
+
+    DrawRectangleLines(pane->x - 1, pane->y - 1, pane->width + 2, pane->height + 2, (Color){ 255, 255, 255, 96 });
+    if (VTermCursorVisible() && !focus_held && live->row + view < live->row_count)
+      DrawRectangle(pane->x + live->col * cell_w, pane->y + (live->row + view) * cell_h, cell_w, cell_h, RAYWHITE);
+    VTermStats.frame_rects += 2;
+  }
+  return true;
+}
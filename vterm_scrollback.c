@@ -0,0 +1,422 @@
+#include "vterm.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <limits.h>
+
+#define VTermScrollbackAlign(n) (((n) + 7) & ~(size_t)7)
+
+bool VTermScrollbackOpen(VTermScrollback *sb, const char *dir)
+/* A fresh pair of files in dir, removed again by VTermScrollbackClose */
+{
+  char index_path[sizeof(sb->path) + 4];
+
+  memset(sb, 0, sizeof(*sb));
+  sb->fd = sb->index_fd = -1;
+  snprintf(sb->path, sizeof(sb->path), "%s/vterm-XXXXXX", dir);
+  if ((sb->fd = mkstemp(sb->path)) == -1)
+  {
+    VTermError("mkstemp(scrollback)");
+    return false;
+  }
+  snprintf(index_path, sizeof(index_path), "%s.idx", sb->path);
+  if ((sb->index_fd = open(index_path, O_RDWR | O_CREAT | O_EXCL | O_TRUNC, 0600)) == -1)
+  {
+    VTermError("open(scrollback index)");
+    VTermScrollbackClose(sb);
+    return false;
+  }
+
+  sb->pending_cap = VTERM_SCROLLBACK_PENDING;
+  sb->pending = (uint8_t *)malloc(sb->pending_cap);
+  sb->pending_index = (uint64_t *)malloc(VTERM_SCROLLBACK_PENDING_LINES * sizeof(uint64_t));
+  if (sb->pending == NULL || sb->pending_index == NULL)
+  {
+    VTermError("malloc(scrollback)");
+    VTermScrollbackClose(sb);
+    return false;
+  }
+  /* History without an index still works, searches just scan it all */
+  if (!VTermSearchOpen(sb))
+    VTermError("VTermSearchOpen(sb)");
+  return true;
+}
+
+void VTermScrollbackClose(VTermScrollback *sb)
+{
+  char index_path[sizeof(sb->path) + 4];
+
+  /* The index thread reads the files, it goes first */
+  if (sb->search != NULL)
+    VTermSearchClose(sb->search);
+  if (sb->data_window.base != NULL)
+    munmap((void *)sb->data_window.base, sb->data_window.size);
+  if (sb->index_window.base != NULL)
+    munmap((void *)sb->index_window.base, sb->index_window.size);
+  if (sb->fd != -1)
+  {
+    close(sb->fd);
+    unlink(sb->path);
+  }
+  if (sb->index_fd != -1)
+  {
+    close(sb->index_fd);
+    snprintf(index_path, sizeof(index_path), "%s.idx", sb->path);
+    unlink(index_path);
+  }
+  free(sb->pending);
+  free(sb->pending_index);
+  memset(sb, 0, sizeof(*sb));
+  sb->fd = sb->index_fd = -1;
+}
+
+static bool VTermScrollbackWrite(int fd, const void *src, size_t len)
+{
+  const uint8_t *p = (const uint8_t *)src;
+  while (len > 0)
+  {
+    ssize_t n = write(fd, p, len);
+    if (n == -1 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      return false;
+    p += n;
+    len -= n;
+  }
+  return true;
+}
+
+bool VTermScrollbackFlush(VTermScrollback *sb)
+/* Records first, then their offsets: a line is readable once both are out */
+{
+  if (sb->fd == -1)
+    return false;
+  if (!VTermScrollbackWrite(sb->fd, sb->pending, sb->pending_len)
+      || !VTermScrollbackWrite(sb->index_fd, sb->pending_index, sb->pending_lines * sizeof(uint64_t)))
+  {
+    VTermError("write(scrollback)");
+    return false;
+  }
+  sb->flushed_size += sb->pending_len;
+  sb->flushed_lines += sb->pending_lines;
+  sb->pending_len = 0;
+  sb->pending_lines = 0;
+  if (sb->search != NULL)
+    VTermSearchNotify(sb->search, sb->flushed_lines);
+  return true;
+}
+
+bool VTermScrollbackPush(VTermScrollback *sb, const uint8_t *data, const uint64_t *colors, uint16_t cols, uint64_t blank, uint8_t flags)
+/* Appends one row, blank is the colour erased cells have */
+{
+  uint16_t length = cols, runs = 0;
+
+  if (sb->fd == -1)
+    return false;
+  while (length > 0 && data[length - 1] == 0 && colors[length - 1] == blank)
+    length--;
+  for (uint16_t c = 0; c < length; c++)
+    if (c == 0 || colors[c] != colors[c - 1])
+      runs++;
+
+  size_t size = VTermScrollbackAlign(sizeof(VTermScrollbackLine) + runs * (sizeof(uint64_t) + sizeof(uint16_t)) + length);
+  if (sb->pending_len + size > sb->pending_cap || sb->pending_lines == VTERM_SCROLLBACK_PENDING_LINES)
+    if (!VTermScrollbackFlush(sb))
+      return false;
+  if (size > sb->pending_cap)
+  {
+    /* Only rows wider than the buffer get here, it grows once per width */
+    uint8_t *pending = (uint8_t *)realloc(sb->pending, size);
+    if (pending == NULL)
+    {
+      VTermError("realloc(scrollback)");
+      return false;
+    }
+    sb->pending = pending;
+    sb->pending_cap = size;
+  }
+
+  uint8_t *record = sb->pending + sb->pending_len;
+  VTermScrollbackLine *line = (VTermScrollbackLine *)record;
+  uint64_t *run_colors = (uint64_t *)(line + 1);
+  uint16_t *run_counts = (uint16_t *)(run_colors + runs);
+  memset(record, 0, size);
+  line->length = length;
+  line->runs = runs;
+  line->flags = flags & VTERM_ROW_WRAPPED;
+  for (uint16_t c = 0, r = 0; c < length; c++)
+  {
+    if (c > 0 && colors[c] == colors[c - 1])
+    {
+      run_counts[r - 1]++;
+      continue;
+    }
+    run_colors[r] = colors[c];
+    run_counts[r++] = 1;
+  }
+  memcpy(run_counts + runs, data, length);
+
+  sb->pending_index[sb->pending_lines++] = sb->size;
+  sb->pending_len += size;
+  sb->size += size;
+  sb->lines++;
+  return true;
+}
+
+const uint8_t *VTermScrollbackAt(int fd, VTermScrollbackWindow *w, uint64_t offset, size_t len)
+/* [offset, offset + len) through the window, sliding it when it is not in
+ * there. The new window is centred on offset, paging either way stays in
+ * it for a while. */
+{
+  if (w->base != NULL && offset >= w->offset && offset + len <= w->offset + w->size)
+    return w->base + (offset - w->offset);
+
+  uint64_t half = VTERM_SCROLLBACK_WINDOW / 2;
+  uint64_t start = offset > half ? (offset - half) & ~(uint64_t)(sysconf(_SC_PAGESIZE) - 1) : 0;
+  size_t size = VTERM_SCROLLBACK_WINDOW;
+  if (offset + len - start > size)
+    size = offset + len - start; // a record wider than the window, rare
+  void *m = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, start);
+  if (m == MAP_FAILED)
+  {
+    VTermError("mmap(scrollback)");
+    return NULL;
+  }
+  if (w->base != NULL)
+    munmap((void *)w->base, w->size);
+  w->base = (const uint8_t *)m;
+  w->offset = start;
+  w->size = size;
+  return w->base + (offset - start);
+}
+
+const VTermScrollbackLine *VTermScrollbackRecord(int fd, int index_fd, VTermScrollbackWindow *data, VTermScrollbackWindow *index, uint64_t n)
+/* Record of flushed line n through the given windows; the index thread has
+ * its own, so this takes the files rather than the scrollback */
+{
+  const uint64_t *offset = (const uint64_t *)VTermScrollbackAt(index_fd, index, n * sizeof(uint64_t), sizeof(uint64_t));
+  if (offset == NULL)
+    return NULL;
+  uint64_t at = *offset;
+  const VTermScrollbackLine *line = (const VTermScrollbackLine *)VTermScrollbackAt(fd, data, at, sizeof(VTermScrollbackLine));
+  if (line == NULL)
+    return NULL;
+  /* The header gives the record's size, the second lookup slides the
+   * window if the rest of it is not mapped */
+  return (const VTermScrollbackLine *)VTermScrollbackAt(fd, data, at, sizeof(VTermScrollbackLine) + line->runs * (sizeof(uint64_t) + sizeof(uint16_t)) + line->length);
+}
+
+bool VTermScrollbackRead(VTermScrollback *sb, uint64_t n, uint8_t *data, uint64_t *colors, uint16_t cols, uint64_t blank, uint8_t *flags)
+/* Line n (0 is the oldest) into a cols wide row: one index lookup, one
+ * record. Longer lines are cut, shorter ones padded with blank cells. */
+{
+  if (sb->fd == -1 || n >= sb->lines)
+    return false;
+  if (n >= sb->flushed_lines && !VTermScrollbackFlush(sb))
+    return false;
+  const VTermScrollbackLine *line = VTermScrollbackRecord(sb->fd, sb->index_fd, &sb->data_window, &sb->index_window, n);
+  if (line == NULL)
+    return false;
+
+  const uint64_t *run_colors = (const uint64_t *)(line + 1);
+  const uint16_t *run_counts = (const uint16_t *)(run_colors + line->runs);
+  uint16_t length = line->length < cols ? line->length : cols;
+  uint16_t c = 0;
+
+  memcpy(data, VTermScrollbackText(line), length);
+  memset(data + length, 0, cols - length);
+  for (uint16_t r = 0; r < line->runs && c < length; r++)
+    for (uint16_t k = 0; k < run_counts[r] && c < length; k++)
+      colors[c++] = run_colors[r];
+  nmemset64(colors + c, blank, cols - c);
+  if (flags != NULL)
+    *flags = line->flags;
+  return true;
+}
+
+bool VTermScrollbackReplace(int fd, const char *path, const char *from)
+/* Points path (and fd, same number: the index thread holds it) at from's
+ * file, or at a new empty one when from is NULL. Not a rename over path,
+ * ext4 would write back from's dirty pages first. */
+{
+  int new_fd = -1;
+
+  unlink(path);
+  if (from == NULL)
+    new_fd = open(path, O_RDWR | O_CREAT | O_EXCL, 0600);
+  else if (link(from, path) == 0)
+    new_fd = open(path, O_RDWR);
+  if (new_fd == -1)
+    return false;
+  dup2(new_fd, fd);
+  close(new_fd);
+  lseek(fd, 0, SEEK_END);
+  return true;
+}
+
+bool VTermScrollbackTake(int fd, const char *path, const char *from, uint64_t size)
+/* Gives the empty file fd/path the first size bytes of from. Linked (and
+ * cut to size) when no other file name shares from, so no session is still
+ * writing to it; copied otherwise. */
+{
+  struct stat st;
+  uint8_t chunk[1 << 16];
+
+  if (stat(from, &st) == -1 || (uint64_t)st.st_size < size)
+    return false;
+  if (st.st_nlink == 1 && VTermScrollbackReplace(fd, path, from))
+  {
+    if (ftruncate(fd, size) == -1)
+      return false;
+    lseek(fd, size, SEEK_SET);
+    return true;
+  }
+
+  int src = open(from, O_RDONLY);
+  if (src == -1)
+    return false;
+  while (size > 0)
+  {
+    ssize_t n = read(src, chunk, size < sizeof(chunk) ? size : sizeof(chunk));
+    if (n <= 0 || !VTermScrollbackWrite(fd, chunk, n))
+      break;
+    size -= n;
+  }
+  close(src);
+  return size == 0;
+}
+
+bool VTermScrollbackAdopt(VTermScrollback *sb, const char *dir, const char *from, const VTermScrollbackSaved *saved)
+/* History a snapshot kept in from, from.idx and from.tri, as a fresh
+ * scrollback in dir; nothing is re-read or re-indexed */
+{
+  char from_index[PATH_MAX], index_path[sizeof(sb->path) + 4];
+
+  if (!VTermScrollbackOpen(sb, dir))
+    return false;
+  snprintf(from_index, sizeof(from_index), "%s.idx", from);
+  snprintf(index_path, sizeof(index_path), "%s.idx", sb->path);
+  if (!VTermScrollbackTake(sb->fd, sb->path, from, saved->size)
+      || !VTermScrollbackTake(sb->index_fd, index_path, from_index, saved->lines * sizeof(uint64_t)))
+  {
+    VTermError("VTermScrollbackTake(snapshot)");
+    VTermScrollbackClose(sb);
+    return false;
+  }
+  sb->lines = sb->flushed_lines = saved->lines;
+  sb->size = sb->flushed_size = saved->size;
+  if (sb->search != NULL)
+  {
+    /* Pages the snapshot had signed stay signed, the thread does the rest */
+    snprintf(from_index, sizeof(from_index), "%s.tri", from);
+    VTermSearchAdopt(sb->search, from_index, saved->pages);
+    VTermSearchNotify(sb->search, sb->lines);
+  }
+  return true;
+}
+
+bool VTermScrollbackLink(VTermScrollback *sb, const char *to, VTermScrollbackSaved *saved)
+/* to, to.idx and to.tri name the history (and its index) as it is now. All
+ * links, saving costs the same however deep it is. */
+{
+  char index_path[sizeof(sb->path) + 4], to_index[PATH_MAX];
+
+  if (sb->fd == -1 || !VTermScrollbackFlush(sb))
+    return false;
+  snprintf(index_path, sizeof(index_path), "%s.idx", sb->path);
+  snprintf(to_index, sizeof(to_index), "%s.idx", to);
+  unlink(to);
+  unlink(to_index);
+  if (link(sb->path, to) == -1 || link(index_path, to_index) == -1)
+  {
+    VTermError("link(scrollback)");
+    return false;
+  }
+  saved->lines = sb->lines;
+  saved->size = sb->size;
+  snprintf(to_index, sizeof(to_index), "%s.tri", to);
+  saved->pages = sb->search != NULL ? VTermSearchLink(sb->search, to_index) : 0;
+  return true;
+}
+
+void VTermScrollbackClear(VTermScrollback *sb)
+/* ED 3: history goes, the files are cut back to nothing */
+{
+  struct stat st;
+
+  if (sb->fd == -1)
+    return;
+  /* Stops the index thread reading lines before they are cut */
+  if (sb->search != NULL)
+    VTermSearchReset(sb->search);
+  if (fstat(sb->fd, &st) == 0 && st.st_nlink > 1)
+  {
+    /* A snapshot links these files, it keeps them and we start new ones */
+    char index_path[sizeof(sb->path) + 4];
+    snprintf(index_path, sizeof(index_path), "%s.idx", sb->path);
+    if (!VTermScrollbackReplace(sb->fd, sb->path, NULL) || !VTermScrollbackReplace(sb->index_fd, index_path, NULL))
+      VTermError("VTermScrollbackReplace(scrollback)");
+  }
+  else if (ftruncate(sb->fd, 0) == -1 || ftruncate(sb->index_fd, 0) == -1)
+    VTermError("ftruncate(scrollback)");
+  /* Whatever the windows cover is gone, touching it would fault */
+  if (sb->data_window.base != NULL)
+    munmap((void *)sb->data_window.base, sb->data_window.size);
+  if (sb->index_window.base != NULL)
+    munmap((void *)sb->index_window.base, sb->index_window.size);
+  sb->data_window.base = sb->index_window.base = NULL;
+  lseek(sb->fd, 0, SEEK_SET);
+  lseek(sb->index_fd, 0, SEEK_SET);
+  sb->lines = sb->size = sb->view = 0;
+  sb->flushed_lines = sb->flushed_size = 0;
+  sb->pending_len = 0;
+  sb->pending_lines = 0;
+}
+
+VTermDataBuffer *VTermScrollbackView(VTermDataBuffer *buf)
+/* buf (a main screen) as seen scrolled back by view lines: history on top,
+ * the live rows that still fit below it */
+{
+  VTermScrollback *sb = buf->scrollback;
+  VTermDataBuffer *view = (VTermDataBuffer *)buf->view_screen;
+  uint16_t history = sb->view < buf->row_count ? sb->view : buf->row_count;
+
+  view->font_size = buf->font_size;
+  view->font = buf->font;
+  view->glyphs = buf->glyphs;
+  view->default_fgbg = buf->default_fgbg;
+  for (uint16_t r = 0; r < buf->row_count; r++)
+  {
+    uint8_t *data = VTermRowData(view, r);
+    uint64_t *colors = VTermRowColors(view, r);
+    if (r < history)
+      VTermScrollbackRead(sb, sb->lines - sb->view + r, data, colors, view->column_count, buf->default_fgbg, NULL);
+    else
+    {
+      memcpy(data, VTermRowData(buf, r - sb->view), buf->column_count);
+      memcpy(colors, VTermRowColors(buf, r - sb->view), buf->column_count * sizeof(uint64_t));
+    }
+    view->row_flags[r] = VTERM_ROW_DIRTY;
+  }
+  view->damage.full = true;
+  return view;
+}
+
+bool VTermScrollView(VTerm *vt, int lines)
+/* Scrolls the view back (lines > 0) or forward; false when there is no
+ * history to show, so the caller can hand the key to the child instead */
+{
+  VTermDataBuffer *pbuf = VTermGetCurrentPrincipalBuffer(vt);
+  VTermScrollback *sb = pbuf->scrollback;
+
+  if (sb->fd == -1 || VTermInAlternateBuffer(vt))
+    return false;
+  int64_t view = (int64_t)sb->view + lines;
+  if (view < 0)
+    view = 0;
+  if ((uint64_t)view > sb->lines)
+    view = sb->lines;
+  if ((uint64_t)view != sb->view)
+    vt->busy = true;
+  sb->view = view;
+  return true;
+}
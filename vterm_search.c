@@ -0,0 +1,404 @@
+#define _GNU_SOURCE // memmem
+#include "vterm.h"
+#include <pthread.h>
+#include <regex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* Scrollback search. Each page of VTERM_SEARCH_PAGE_LINES lines gets a
+ * signature, a bitmap of the (hashed) trigrams its lines contain; a match
+ * can only be on a page holding every trigram of the literal text it needs.
+ * Signatures are built by one thread per scrollback as pages fill up and
+ * appended to <path>.tri, so the index costs disk, not memory. */
+
+#define VTERM_SEARCH_SIGNATURE_BYTES (VTERM_SEARCH_SIGNATURE_BITS / 8)
+#define VTERM_SEARCH_MAX_TRIGRAMS 64
+
+struct VTermSearchIndex {
+  pthread_t thread;
+  pthread_mutex_t lock;    // lines, pages, generation, running
+  pthread_mutex_t reading; // held while the thread reads the scrollback
+  pthread_cond_t wake, idle;
+  bool running;
+  uint32_t generation;     // bumped by VTermSearchReset
+
+  int fd, index_fd, tri_fd;
+  char tri_path[sizeof(((VTermScrollback *)0)->path) + 4];
+  uint64_t lines;          // flushed lines, safe for the thread to read
+  uint64_t pages;          // signatures in tri_fd
+
+  VTermScrollbackWindow data, index; // the thread's own windows
+  VTermScrollbackWindow tri;         // the searching thread's
+  uint8_t signature[VTERM_SEARCH_SIGNATURE_BYTES];
+};
+
+static inline uint32_t VTermTrigram(uint8_t a, uint8_t b, uint8_t c)
+{
+  uint32_t x = (uint32_t)a << 16 | (uint32_t)b << 8 | c;
+  return (x * 2654435761u >> 8) & (VTERM_SEARCH_SIGNATURE_BITS - 1);
+}
+
+// Blank cells are stored as 0, they read as spaces
+#define VTermSearchChar(c) ((c) == 0 ? ' ' : (c))
+
+static int VTermSearchTrigrams(const char *text, size_t len, uint32_t *trigrams, int count)
+/* Appends text's trigrams, as many as fit */
+{
+  for (size_t i = 0; i + 2 < len && count < VTERM_SEARCH_MAX_TRIGRAMS; i++)
+    trigrams[count++] = VTermTrigram(text[i], text[i + 1], text[i + 2]);
+  return count;
+}
+
+static int VTermSearchRegexTrigrams(const char *re, uint32_t *trigrams)
+/* Trigrams of the literal runs any match must contain. Conservative: groups
+ * and bracket expressions break runs, a quantifier takes its character out,
+ * and a top-level alternation means nothing is required. */
+{
+  char run[256];
+  size_t n = 0;
+  int count = 0, depth = 0;
+
+  for (const char *p = re; ; p++)
+  {
+    char c = *p;
+    bool literal = false;
+
+    if (c == '\\' && p[1] != '\0')
+    {
+      c = *++p;
+      /* \w, \b, \<... are classes and anchors, not characters */
+      literal = !((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9'));
+    }
+    else if (c == '[')
+    {
+      /* A ']' first in the expression is a member, not the end */
+      p += p[1] == '^' ? 2 : 1;
+      if (*p == ']')
+        p++;
+      while (*p != '\0' && *p != ']')
+        p++;
+    }
+    else if (c == '(')
+      depth++;
+    else if (c == ')')
+      depth--;
+    else if (c == '|' && depth == 0)
+      return 0;
+    else if (c == '*' || c == '?' || c == '{')
+    {
+      if (depth == 0 && n > 0)
+        n--;
+    }
+    else if (c != '\0' && c != '.' && c != '^' && c != '$' && c != '+' && c != '}')
+      literal = true;
+
+    if (literal && depth == 0 && n < sizeof(run))
+    {
+      run[n++] = c;
+      continue;
+    }
+    count = VTermSearchTrigrams(run, n, trigrams, count);
+    n = 0;
+    if (c == '{')
+      while (p[1] != '\0' && *p != '}')
+        p++;
+    if (*p == '\0')
+      break;
+  }
+  return count;
+}
+
+static void VTermSearchBuildPage(VTermSearchIndex *idx, uint64_t page)
+{
+  memset(idx->signature, 0, sizeof(idx->signature));
+  for (uint64_t n = page * VTERM_SEARCH_PAGE_LINES; n < (page + 1) * VTERM_SEARCH_PAGE_LINES; n++)
+  {
+    const VTermScrollbackLine *line = VTermScrollbackRecord(idx->fd, idx->index_fd, &idx->data, &idx->index, n);
+    if (line == NULL)
+      return;
+    const uint8_t *text = VTermScrollbackText(line);
+    for (int i = 0; i + 2 < line->length; i++)
+    {
+      uint32_t t = VTermTrigram(VTermSearchChar(text[i]), VTermSearchChar(text[i + 1]), VTermSearchChar(text[i + 2]));
+      idx->signature[t >> 3] |= 1 << (t & 7);
+    }
+  }
+}
+
+static void *VTermSearchWorker(void *arg)
+/* Signs every page as soon as all its lines are flushed */
+{
+  VTermSearchIndex *idx = (VTermSearchIndex *)arg;
+
+  pthread_mutex_lock(&idx->lock);
+  while (idx->running)
+  {
+    if ((idx->pages + 1) * VTERM_SEARCH_PAGE_LINES > idx->lines)
+    {
+      pthread_cond_broadcast(&idx->idle);
+      pthread_cond_wait(&idx->wake, &idx->lock);
+      continue;
+    }
+    uint64_t page = idx->pages;
+    uint32_t generation = idx->generation;
+    pthread_mutex_unlock(&idx->lock);
+
+    /* A reset between the two locks cut the files, the page is gone */
+    pthread_mutex_lock(&idx->reading);
+    bool current = idx->generation == generation;
+    if (current)
+    {
+      VTermSearchBuildPage(idx, page);
+      if (pwrite(idx->tri_fd, idx->signature, sizeof(idx->signature), page * sizeof(idx->signature)) != sizeof(idx->signature))
+        VTermError("pwrite(search index)");
+    }
+    pthread_mutex_unlock(&idx->reading);
+
+    pthread_mutex_lock(&idx->lock);
+    if (current && idx->generation == generation)
+      idx->pages = page + 1;
+  }
+  pthread_mutex_unlock(&idx->lock);
+  return NULL;
+}
+
+bool VTermSearchOpen(VTermScrollback *sb)
+{
+  VTermSearchIndex *idx = (VTermSearchIndex *)calloc(1, sizeof(VTermSearchIndex));
+  if (idx == NULL)
+  {
+    VTermError("calloc(search index)");
+    return false;
+  }
+  idx->fd = sb->fd;
+  idx->index_fd = sb->index_fd;
+  snprintf(idx->tri_path, sizeof(idx->tri_path), "%s.tri", sb->path);
+  if ((idx->tri_fd = open(idx->tri_path, O_RDWR | O_CREAT | O_EXCL | O_TRUNC, 0600)) == -1)
+  {
+    VTermError("open(search index)");
+    free(idx);
+    return false;
+  }
+
+  pthread_mutex_init(&idx->lock, NULL);
+  pthread_mutex_init(&idx->reading, NULL);
+  pthread_cond_init(&idx->wake, NULL);
+  pthread_cond_init(&idx->idle, NULL);
+  idx->running = true;
+  if (pthread_create(&idx->thread, NULL, VTermSearchWorker, idx) != 0)
+  {
+    VTermError("pthread_create(search index)");
+    idx->running = false;
+    VTermSearchClose(idx);
+    return false;
+  }
+  sb->search = idx;
+  return true;
+}
+
+void VTermSearchClose(VTermSearchIndex *idx)
+{
+  pthread_mutex_lock(&idx->lock);
+  bool running = idx->running;
+  idx->running = false;
+  pthread_cond_broadcast(&idx->wake);
+  pthread_mutex_unlock(&idx->lock);
+  if (running)
+    pthread_join(idx->thread, NULL);
+
+  VTermScrollbackWindow *windows[] = { &idx->data, &idx->index, &idx->tri };
+  for (int i = 0; i < 3; i++)
+    if (windows[i]->base != NULL)
+      munmap((void *)windows[i]->base, windows[i]->size);
+  close(idx->tri_fd);
+  unlink(idx->tri_path);
+  pthread_mutex_destroy(&idx->lock);
+  pthread_mutex_destroy(&idx->reading);
+  pthread_cond_destroy(&idx->wake);
+  pthread_cond_destroy(&idx->idle);
+  free(idx);
+}
+
+void VTermSearchNotify(VTermSearchIndex *idx, uint64_t lines)
+/* More lines are flushed, called from VTermScrollbackFlush */
+{
+  pthread_mutex_lock(&idx->lock);
+  idx->lines = lines;
+  if ((idx->pages + 1) * VTERM_SEARCH_PAGE_LINES <= lines)
+    pthread_cond_signal(&idx->wake);
+  pthread_mutex_unlock(&idx->lock);
+}
+
+void VTermSearchReset(VTermSearchIndex *idx)
+/* The scrollback is about to be cut: wait out a page being read, then start
+ * the index over */
+{
+  pthread_mutex_lock(&idx->reading);
+  pthread_mutex_lock(&idx->lock);
+  idx->generation++;
+  idx->lines = idx->pages = 0;
+  VTermScrollbackWindow *windows[] = { &idx->data, &idx->index, &idx->tri };
+  for (int i = 0; i < 3; i++)
+  {
+    if (windows[i]->base != NULL)
+      munmap((void *)windows[i]->base, windows[i]->size);
+    windows[i]->base = NULL;
+  }
+  /* A snapshot linking the signatures keeps them, we start a new file */
+  struct stat st;
+  if (fstat(idx->tri_fd, &st) == 0 && st.st_nlink > 1)
+  {
+    if (!VTermScrollbackReplace(idx->tri_fd, idx->tri_path, NULL))
+      VTermError("VTermScrollbackReplace(search index)");
+  }
+  else if (ftruncate(idx->tri_fd, 0) == -1)
+    VTermError("ftruncate(search index)");
+  pthread_mutex_unlock(&idx->lock);
+  pthread_mutex_unlock(&idx->reading);
+}
+
+uint64_t VTermSearchLink(VTermSearchIndex *idx, const char *to)
+/* Links the signatures to to for a snapshot, returns how many are done */
+{
+  pthread_mutex_lock(&idx->lock);
+  uint64_t pages = idx->pages;
+  unlink(to);
+  if (link(idx->tri_path, to) == -1)
+    pages = 0;
+  pthread_mutex_unlock(&idx->lock);
+  return pages;
+}
+
+bool VTermSearchAdopt(VTermSearchIndex *idx, const char *from, uint64_t pages)
+/* The first pages signatures from a snapshot, before any lines are notified */
+{
+  pthread_mutex_lock(&idx->reading);
+  pthread_mutex_lock(&idx->lock);
+  bool ok = pages > 0 && VTermScrollbackTake(idx->tri_fd, idx->tri_path, from, pages * VTERM_SEARCH_SIGNATURE_BYTES);
+  if (ok)
+    idx->pages = pages;
+  pthread_mutex_unlock(&idx->lock);
+  pthread_mutex_unlock(&idx->reading);
+  return ok;
+}
+
+void VTermSearchWait(VTermSearchIndex *idx)
+/* Until every full page flushed so far is signed */
+{
+  pthread_mutex_lock(&idx->lock);
+  while (idx->running && (idx->pages + 1) * VTERM_SEARCH_PAGE_LINES <= idx->lines)
+    pthread_cond_wait(&idx->idle, &idx->lock);
+  pthread_mutex_unlock(&idx->lock);
+}
+
+static int VTermSearchLine(const char *text, size_t len, const char *query, size_t qlen, regex_t *re,
+                           uint64_t n, VTermSearchHit *hits, int count, int max_hits)
+/* Every match in one line, left to right */
+{
+  const char *at = text;
+  regmatch_t m;
+
+  while (count < max_hits && at < text + len)
+  {
+    size_t start, length;
+    if (re != NULL)
+    {
+      if (regexec(re, at, 1, &m, at == text ? 0 : REG_NOTBOL) != 0)
+        break;
+      start = at - text + m.rm_so;
+      length = m.rm_eo - m.rm_so;
+    }
+    else
+    {
+      const char *found = (const char *)memmem(at, text + len - at, query, qlen);
+      if (found == NULL)
+        break;
+      start = found - text;
+      length = qlen;
+    }
+    hits[count++] = (VTermSearchHit){ n, start, length };
+    at = text + start + (length > 0 ? length : 1);
+  }
+  return count;
+}
+
+int VTermSearch(VTermScrollback *sb, const char *query, int flags, VTermSearchHit *hits, int max_hits)
+/* Up to max_hits matches of query, newest line first; -1 if the regex does
+ * not compile or out of memory. Pages not signed yet (the newest ones) are
+ * always scanned. */
+{
+  VTermSearchIndex *idx = sb->search;
+  uint32_t trigrams[VTERM_SEARCH_MAX_TRIGRAMS];
+  size_t qlen = strlen(query);
+  regex_t re;
+  int ntri, count = 0;
+  uint64_t pages = 0;
+
+  if (sb->fd == -1 || qlen == 0 || max_hits <= 0)
+    return 0;
+  if (flags & VTERM_SEARCH_REGEX)
+  {
+    if (regcomp(&re, query, REG_EXTENDED) != 0)
+    {
+      VTermError("regcomp(search)");
+      return -1;
+    }
+    ntri = VTermSearchRegexTrigrams(query, trigrams);
+  }
+  else
+    ntri = VTermSearchTrigrams(query, qlen, trigrams, 0);
+  if (!VTermScrollbackFlush(sb))
+  {
+    if (flags & VTERM_SEARCH_REGEX)
+      regfree(&re);
+    return 0;
+  }
+  char *text = (char *)malloc(UINT16_MAX + 1);
+  if (text == NULL)
+  {
+    VTermError("malloc(search)");
+    if (flags & VTERM_SEARCH_REGEX)
+      regfree(&re);
+    return -1;
+  }
+
+  if (idx != NULL && ntri > 0 && !(flags & VTERM_SEARCH_NO_INDEX))
+  {
+    pthread_mutex_lock(&idx->lock);
+    pages = idx->pages;
+    pthread_mutex_unlock(&idx->lock);
+  }
+
+  for (uint64_t end = sb->lines; end > 0 && count < max_hits; )
+  {
+    uint64_t page = (end - 1) / VTERM_SEARCH_PAGE_LINES, start = page * VTERM_SEARCH_PAGE_LINES;
+    if (page < pages)
+    {
+      const uint8_t *signature = VTermScrollbackAt(idx->tri_fd, &idx->tri, page * VTERM_SEARCH_SIGNATURE_BYTES, VTERM_SEARCH_SIGNATURE_BYTES);
+      int i = 0;
+      while (signature != NULL && i < ntri && (signature[trigrams[i] >> 3] & (1 << (trigrams[i] & 7))))
+        i++;
+      if (signature != NULL && i < ntri)
+      {
+        end = start;
+        continue;
+      }
+    }
+    for (uint64_t n = end; n-- > start && count < max_hits; )
+    {
+      const VTermScrollbackLine *line = VTermScrollbackRecord(sb->fd, sb->index_fd, &sb->data_window, &sb->index_window, n);
+      if (line == NULL)
+        break;
+      const uint8_t *cells = VTermScrollbackText(line);
+      for (int i = 0; i < line->length; i++)
+        text[i] = VTermSearchChar(cells[i]);
+      text[line->length] = '\0';
+      count = VTermSearchLine(text, line->length, query, qlen, flags & VTERM_SEARCH_REGEX ? &re : NULL, n, hits, count, max_hits);
+    }
+    end = start;
+  }
+  free(text);
+  if (flags & VTERM_SEARCH_REGEX)
+    regfree(&re);
+  return count;
+}
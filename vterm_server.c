@@ -0,0 +1,790 @@
+#include "vterm.h"
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+/* Session server: one headless VTerm with the child on a pty, any number of
+ * windows attached over a Unix socket. Each client gets a snapshot, then
+ * frames diffed against a shadow of what it was last sent. A frame is only
+ * built once the client acked the previous one, so a slow client skips
+ * states instead of finding them queued in the socket. */
+
+#define VTermWireAlign(n) (((n) + 7) & ~(size_t)7)
+
+/* One attached client, as the server sees it */
+typedef struct {
+  int fd;
+  uint8_t *out; // the frame being written
+  size_t out_len, out_at, out_cap;
+  uint8_t *in;  // partial message
+  size_t in_len, in_cap;
+  uint8_t *data; // what the client shows, row major
+  uint64_t *colors;
+  uint16_t cols, rows; // 0 until it got a snapshot
+  uint16_t col, row;
+  uint32_t dec_modes;
+  VTermDamage damage; // scrolls it has not seen yet
+  bool behind;        // the screen changed since its last frame
+  bool unacked;       // its last frame is not applied yet
+} VTermServerClient;
+
+typedef struct {
+  VTerm vt;
+  int listen_fd;
+  VTermServerClient clients[VTERM_SERVER_MAX_CLIENTS];
+  int count;
+  uint32_t seq;
+  VTermDataBuffer *last; // screen the last damage was taken from
+  double sync_start;     // when ?2026 was first seen set, 0 if it isn't
+} VTermServer;
+
+static double VTermServerNow(void)
+/* GetTime() needs a window, the server has none */
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static bool VTermWireReserve(uint8_t **p, size_t *cap, size_t need)
+{
+  if (need <= *cap)
+    return true;
+  size_t size = *cap > 0 ? *cap : 4096;
+  while (size < need)
+    size *= 2;
+  uint8_t *grown = (uint8_t *)realloc(*p, size);
+  if (grown == NULL)
+  {
+    VTermError("realloc(wire)");
+    return false;
+  }
+  *p = grown;
+  *cap = size;
+  return true;
+}
+
+static void VTermDamageMerge(VTermDamage *acc, VTermDamage d)
+/* Same rules as VTermDamageScroll, for damage a client has not seen */
+{
+  if (acc->full)
+    return;
+  if (d.full || (d.scroll != 0 && acc->scroll != 0
+                 && (acc->scroll_top != d.scroll_top || acc->scroll_bottom != d.scroll_bottom)))
+  {
+    acc->full = true;
+    return;
+  }
+  if (d.scroll == 0)
+    return;
+  acc->scroll_top = d.scroll_top;
+  acc->scroll_bottom = d.scroll_bottom;
+  acc->scroll += d.scroll;
+  if (abs(acc->scroll) >= acc->scroll_bottom - acc->scroll_top)
+    acc->scroll = 0;
+}
+
+static void VTermServerScroll(VTermServerClient *c, VTermDamage d, uint64_t blank)
+/* The shadow does what VTermScrollRegion will do on the client */
+{
+  size_t cols = c->cols, k = abs(d.scroll);
+  size_t keep = (d.scroll_bottom - d.scroll_top - k) * cols;
+  uint8_t *data = c->data + d.scroll_top * cols;
+  uint64_t *colors = c->colors + d.scroll_top * cols;
+
+  if (d.scroll > 0)
+  {
+    memmove(data, data + k * cols, keep);
+    memmove(colors, colors + k * cols, keep * sizeof(uint64_t));
+    memset(data + keep, 0, k * cols);
+    nmemset64(colors + keep, blank, k * cols);
+  }
+  else
+  {
+    memmove(data + k * cols, data, keep);
+    memmove(colors + k * cols, colors, keep * sizeof(uint64_t));
+    memset(data, 0, k * cols);
+    nmemset64(colors, blank, k * cols);
+  }
+}
+
+static bool VTermServerFrame(VTermServer *s, VTermServerClient *c)
+/* Diffs the screen against c's shadow into c->out, one span per changed
+ * row from its first to its last differing cell. Only called with c->out
+ * empty; nothing is queued when the client is up to date. */
+{
+  VTermDataBuffer *buf = VTermGetCurrentBuffer(&s->vt);
+  uint16_t cols = buf->column_count, rows = buf->row_count;
+  VTermWireHeader header = { VTERM_WIRE_DAMAGE, 0 };
+  VTermWireFrame frame = { 0 };
+
+  c->behind = false;
+  if (c->cols != cols || c->rows != rows)
+  {
+    /* New client or new geometry: the shadow starts over */
+    size_t cells = (size_t)cols * rows;
+    uint8_t *data = (uint8_t *)realloc(c->data, cells);
+    if (data != NULL)
+      c->data = data;
+    uint64_t *colors = (uint64_t *)realloc(c->colors, cells * sizeof(uint64_t));
+    if (colors != NULL)
+      c->colors = colors;
+    if (data == NULL || colors == NULL)
+    {
+      VTermError("realloc(shadow)");
+      return false;
+    }
+    c->cols = cols;
+    c->rows = rows;
+    header.type = VTERM_WIRE_SNAPSHOT;
+  }
+  else if (!c->damage.full && c->damage.scroll != 0 && c->damage.scroll_bottom <= rows)
+  {
+    VTermServerScroll(c, c->damage, buf->default_fgbg);
+    frame.scroll = c->damage.scroll;
+    frame.scroll_top = c->damage.scroll_top;
+    frame.scroll_bottom = c->damage.scroll_bottom;
+  }
+  c->damage = (VTermDamage){ 0 };
+
+  size_t worst = sizeof(header) + sizeof(frame)
+                 + rows * (sizeof(VTermWireSpan) + VTermWireAlign(cols) + cols * sizeof(uint64_t));
+  if (!VTermWireReserve(&c->out, &c->out_cap, worst))
+    return false;
+
+  uint8_t *p = c->out + sizeof(header) + sizeof(frame);
+  for (uint16_t r = 0; r < rows; r++)
+  {
+    const uint8_t *data = VTermRowData(buf, r);
+    const uint64_t *colors = VTermRowColors(buf, r);
+    uint8_t *shadow_data = c->data + (size_t)r * cols;
+    uint64_t *shadow_colors = c->colors + (size_t)r * cols;
+    uint16_t first = 0, last = cols;
+
+    if (header.type == VTERM_WIRE_DAMAGE)
+    {
+      while (first < cols && data[first] == shadow_data[first] && colors[first] == shadow_colors[first])
+        first++;
+      if (first == cols)
+        continue;
+      while (data[last - 1] == shadow_data[last - 1] && colors[last - 1] == shadow_colors[last - 1])
+        last--;
+    }
+
+    uint16_t count = last - first;
+    VTermWireSpan span = { r, first, count, 0 };
+    memcpy(p, &span, sizeof(span));
+    p += sizeof(span);
+    memcpy(p, colors + first, count * sizeof(uint64_t));
+    p += count * sizeof(uint64_t);
+    memcpy(p, data + first, count);
+    memset(p + count, 0, VTermWireAlign(count) - count);
+    p += VTermWireAlign(count);
+
+    memcpy(shadow_data + first, data + first, count);
+    memcpy(shadow_colors + first, colors + first, count * sizeof(uint64_t));
+    frame.spans++;
+  }
+
+  uint32_t dec_modes = buf->parser->dec_modes & ~VTERM_DEC_SYNC_OUTPUT;
+  if (header.type == VTERM_WIRE_DAMAGE && frame.spans == 0 && frame.scroll == 0
+      && buf->col == c->col && buf->row == c->row && dec_modes == c->dec_modes)
+    return true;
+
+  frame.seq = s->seq;
+  frame.column_count = cols;
+  frame.row_count = rows;
+  frame.col = c->col = buf->col;
+  frame.row = c->row = buf->row;
+  frame.dec_modes = c->dec_modes = dec_modes;
+  header.length = (p - c->out) - sizeof(header);
+  memcpy(c->out, &header, sizeof(header));
+  memcpy(c->out + sizeof(header), &frame, sizeof(frame));
+  c->out_len = p - c->out;
+  c->out_at = 0;
+  c->unacked = true;
+  return true;
+}
+
+static bool VTermServerWrite(VTermServerClient *c)
+/* As much of the pending frame as the socket takes, false if it is gone */
+{
+  while (c->out_at < c->out_len)
+  {
+    ssize_t n = write(c->fd, c->out + c->out_at, c->out_len - c->out_at);
+    if (n > 0)
+    {
+      c->out_at += n;
+      continue;
+    }
+    if (n == -1 && errno == EINTR)
+      continue;
+    return n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK);
+  }
+  c->out_len = c->out_at = 0;
+  return true;
+}
+
+static bool VTermServerSend(VTermServer *s, VTermServerClient *c)
+/* Next frame for c if it took the last one and has something to see */
+{
+  if (c->unacked || !c->behind)
+    return true;
+  return VTermServerFrame(s, c) && VTermServerWrite(c);
+}
+
+static void VTermServerInput(VTermDataBuffer *buf, const uint8_t *p, size_t len)
+/* Into the out ring, what does not fit queues behind it like a paste */
+{
+  if (buf->paste == NULL)
+  {
+    size_t n = VTermRingPush(buf->out, p, len);
+    p += n;
+    len -= n;
+  }
+  if (len == 0)
+    return;
+  char *paste = (char *)realloc(buf->paste, buf->paste_len + len);
+  if (paste == NULL)
+  {
+    VTermError("realloc(paste)");
+    return;
+  }
+  memcpy(paste + buf->paste_len, p, len);
+  buf->paste = paste;
+  buf->paste_len += len;
+}
+
+static bool VTermServerRead(VTermServer *s, VTermServerClient *c)
+/* Whatever c sent, false once it hung up or sent garbage */
+{
+  if (!VTermWireReserve(&c->in, &c->in_cap, c->in_len + 65536))
+    return false;
+  ssize_t n = read(c->fd, c->in + c->in_len, c->in_cap - c->in_len);
+  if (n == 0)
+    return false;
+  if (n == -1)
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+  c->in_len += n;
+
+  size_t at = 0;
+  VTermWireHeader header;
+  while (c->in_len - at >= sizeof(header))
+  {
+    memcpy(&header, c->in + at, sizeof(header));
+    if (header.length > VTERM_WIRE_MAX)
+      return false;
+    if (c->in_len - at - sizeof(header) < header.length)
+      break;
+    const uint8_t *payload = c->in + at + sizeof(header);
+    VTermDataBuffer *buf = VTermGetCurrentBuffer(&s->vt);
+
+    switch (header.type)
+    {
+      case VTERM_WIRE_INPUT:
+        VTermServerInput(buf, payload, header.length);
+        break;
+      case VTERM_WIRE_RESIZE:
+      {
+        VTermWireResize size;
+        if (header.length < sizeof(size))
+          return false;
+        memcpy(&size, payload, sizeof(size));
+        if (size.column_count == 0 || size.row_count == 0)
+          return false;
+        if ((size.column_count != buf->column_count || size.row_count != buf->row_count)
+            && !VTermResize(&s->vt, size.column_count, size.row_count))
+          VTermError("VTermResize(client)");
+        break;
+      }
+      case VTERM_WIRE_ACK:
+        c->unacked = false;
+        if (!VTermServerSend(s, c))
+          return false;
+        break;
+      default:
+        break; // newer client, skip what we don't know
+    }
+    at += sizeof(header) + header.length;
+  }
+  memmove(c->in, c->in + at, c->in_len - at);
+  c->in_len -= at;
+  return true;
+}
+
+static void VTermServerDrop(VTermServer *s, int i)
+{
+  VTermServerClient *c = &s->clients[i];
+  close(c->fd);
+  free(c->out);
+  free(c->in);
+  free(c->data);
+  free(c->colors);
+  s->clients[i] = s->clients[--s->count];
+}
+
+static void VTermServerAccept(VTermServer *s)
+{
+  int fd = accept(s->listen_fd, NULL, NULL);
+  if (fd == -1)
+    return;
+  if (s->count == VTERM_SERVER_MAX_CLIENTS)
+  {
+    VTermError("accept(too many clients)");
+    close(fd);
+    return;
+  }
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+  VTermServerClient *c = &s->clients[s->count++];
+  memset(c, 0, sizeof(*c));
+  c->fd = fd;
+  c->behind = true; // a snapshot, right away
+  if (!VTermServerSend(s, c))
+    VTermServerDrop(s, s->count - 1);
+}
+
+static bool VTermServerHeld(VTermServer *s, double now)
+/* Mid synchronized update no client gets a frame, like VTermHoldFrame */
+{
+  VTermParser *parser = VTermGetCurrentBuffer(&s->vt)->parser;
+
+  if (!(parser->dec_modes & VTERM_DEC_SYNC_OUTPUT))
+  {
+    s->sync_start = 0;
+    return false;
+  }
+  if (s->sync_start == 0)
+    s->sync_start = now;
+  if (now - s->sync_start > VTERM_SYNC_TIMEOUT)
+  {
+    parser->dec_modes &= ~VTERM_DEC_SYNC_OUTPUT;
+    s->sync_start = 0;
+    VTermStats.sync_timeouts++;
+    return false;
+  }
+  VTermStats.frames_held++;
+  return true;
+}
+
+static void VTermServerTick(VTermServer *s)
+/* The screen changed: every client is behind, the idle ones get a frame */
+{
+  VTermDataBuffer *buf = VTermGetCurrentBuffer(&s->vt);
+  VTermDamage d = VTermTakeDamage(buf);
+
+  /* Alt screen switch or resize: scrolls of another screen mean nothing */
+  if (buf != s->last)
+    d.full = true;
+  s->last = buf;
+  s->seq++;
+  for (int i = s->count - 1; i >= 0; i--)
+  {
+    VTermServerClient *c = &s->clients[i];
+    VTermDamageMerge(&c->damage, d);
+    c->behind = true;
+    if (!VTermServerSend(s, c))
+      VTermServerDrop(s, i);
+  }
+}
+
+static int VTermServerListen(const char *path)
+{
+  struct sockaddr_un addr = { .sun_family = AF_UNIX };
+  if (strlen(path) >= sizeof(addr.sun_path))
+  {
+    VTermError("VTermServerListen(path too long)");
+    return -1;
+  }
+  strcpy(addr.sun_path, path);
+
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd == -1)
+  {
+    VTermError("socket(AF_UNIX)");
+    return -1;
+  }
+  /* Only our user may attach: whoever does gets a shell */
+  unlink(path);
+  mode_t mask = umask(077);
+  int bound = bind(fd, (struct sockaddr *)&addr, sizeof(addr));
+  umask(mask);
+  if (bound == -1 || listen(fd, 8) == -1)
+  {
+    VTermError("bind(server socket)");
+    close(fd);
+    return -1;
+  }
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+  return fd;
+}
+
+static void VTermServerExit(VTermServer *s)
+/* Child is gone: everyone gets the last screen and EXIT, with a deadline so
+ * a stuck client can't keep the server around */
+{
+  struct timeval tv = { 1, 0 };
+  VTermWireHeader header = { VTERM_WIRE_EXIT, 0 };
+
+  for (int i = 0; i < s->count; i++)
+  {
+    VTermServerClient *c = &s->clients[i];
+    fcntl(c->fd, F_SETFL, fcntl(c->fd, F_GETFL) & ~O_NONBLOCK);
+    setsockopt(c->fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+    VTermServerWrite(c);
+    c->unacked = c->out_len > 0;
+  }
+  VTermServerTick(s);
+  while (s->count > 0)
+  {
+    VTermServerClient *c = &s->clients[0];
+    if (VTermServerWrite(c) && c->out_len == 0)
+      write(c->fd, &header, sizeof(header));
+    VTermServerDrop(s, 0);
+  }
+}
+
+int VTermServerRun(const char *path, VTermMode mode, uint16_t column_count, uint16_t row_count)
+/* Serves one session on path until its child exits */
+{
+  static VTermServer server;
+  VTermServer *s = &server;
+
+  /* Clients hanging up mid write are handled where write() fails */
+  signal(SIGPIPE, SIG_IGN);
+  memset(s, 0, sizeof(*s));
+  if (!VTermInitHeadless(&s->vt, mode))
+    return 1;
+  if (column_count > 0 && row_count > 0 && !VTermResize(&s->vt, column_count, row_count))
+    return 1;
+  if (!VTermStartChild(s->vt.buffers[0]))
+    return 1;
+  if ((s->listen_fd = VTermServerListen(path)) == -1)
+    return 1;
+
+  struct pollfd fds[3 + VTERM_SERVER_MAX_CLIENTS];
+  bool changed = false; // parsed or resized since the last tick
+  double next = 0;      // earliest next tick
+  for (;;)
+  {
+    VTermDataBuffer *buf = VTermGetCurrentBuffer(&s->vt);
+    int master = buf->pty->master;
+    bool writing = VTermRingUsed(buf->out) > 0 || buf->paste != NULL;
+    int timeout = -1;
+    if (changed)
+    {
+      double wait = next - VTermServerNow();
+      timeout = wait > 0 ? (int)(wait * 1000) + 1 : 0;
+    }
+    if (buf->pty->exited)
+      timeout = 0; // draining what the shell left in the pty
+
+    fds[0] = (struct pollfd){ s->listen_fd, POLLIN, 0 };
+    fds[1] = (struct pollfd){ master, POLLIN | (writing ? POLLOUT : 0), 0 };
+    for (int i = 0; i < s->count; i++)
+      fds[2 + i] = (struct pollfd){ s->clients[i].fd, POLLIN | (s->clients[i].out_len > 0 ? POLLOUT : 0), 0 };
+    /* SIGCHLD: a shell whose background jobs still hold the pty never
+     * gives us EOF, its exit is still the end of the session */
+    fds[2 + s->count] = (struct pollfd){ VTermChildFd(), POLLIN, 0 };
+    int nfds = 3 + s->count;
+    if (poll(fds, nfds, timeout) == -1 && errno != EINTR)
+    {
+      VTermError("poll(server)");
+      break;
+    }
+
+    if (fds[1].revents & (POLLIN | POLLHUP | POLLERR))
+    {
+      ssize_t n = VTermRingFill(buf->in, master);
+      if (n == 0 || (n == -1 && errno != EAGAIN && errno != EINTR))
+        break; // child gone
+      VTermProcessRing(&s->vt, buf->in);
+      changed = true;
+    }
+    VTermReapChildren();
+    if (buf->pty->exited && !(fds[1].revents & POLLIN))
+      break; // and everything it wrote has been read
+
+    /* Back to front, so dropping one keeps fds[] in step with the rest */
+    for (int i = s->count - 1; i >= 0; i--)
+    {
+      VTermServerClient *c = &s->clients[i];
+      short revents = fds[2 + i].revents;
+      if ((revents & (POLLIN | POLLHUP | POLLERR)) && !VTermServerRead(s, c))
+      {
+        VTermServerDrop(s, i);
+        continue;
+      }
+      if ((revents & POLLOUT) && !VTermServerWrite(c))
+        VTermServerDrop(s, i);
+    }
+    if (VTermGetCurrentBuffer(&s->vt) != buf)
+      changed = true; // resized
+    VTermFlushInput(VTermGetCurrentBuffer(&s->vt));
+    if (fds[0].revents & POLLIN)
+      VTermServerAccept(s);
+
+    double now = VTermServerNow();
+    if (changed && now >= next)
+    {
+      if (!VTermServerHeld(s, now))
+      {
+        VTermServerTick(s);
+        changed = false;
+      }
+      next = now + VTERM_SERVER_FRAME;
+    }
+  }
+
+  VTermServerExit(s);
+  close(s->listen_fd);
+  unlink(path);
+  VTermCloseBuffer(s->vt.buffers[0]);
+  return 0;
+}
+
+int VTermServe(int argc, char **argv)
+/* vterm --server <socket> [cols rows] */
+{
+  if (argc < 3)
+  {
+    printf("Usage: vterm --server <socket> [cols rows]\n");
+    return 1;
+  }
+  uint16_t cols = argc > 4 ? atoi(argv[3]) : 0, rows = argc > 4 ? atoi(argv[4]) : 0;
+  return VTermServerRun(argv[2], VTERM_MODE_MONOCHROME_TEXT_40_25, cols, rows);
+}
+
+/***** CLIENT *****/
+
+bool VTermAttach(VTerm *vt, VTermClient *c, const char *path)
+/* vterm --attach <socket>: like VTermInit, but the screen comes from the
+ * server (InitWindow first) */
+{
+  if (!VTermClientConnect(c, path))
+    return false;
+  VTermInitFonts(true);
+  if (!VTermInitHeadless(vt, VTERM_MODE_MONOCHROME_TEXT_40_25))
+    return false;
+  vt->server_fd = c->fd;
+
+  const char *renderer = getenv("VTERM_RENDERER");
+  vt->soft_render = renderer != NULL && strcmp(renderer, "soft") == 0;
+  if (vt->soft_render)
+    VTermSoftPoolInit(sysconf(_SC_NPROCESSORS_ONLN));
+  if (!VTermIdleInit(vt))
+  {
+    VTermError("VTermIdleInit(vt)");
+    return false;
+  }
+
+  /* The snapshot says how big the session is, the window starts that size */
+  struct pollfd pfd = { c->fd, POLLIN, 0 };
+  while (c->frames == 0 && poll(&pfd, 1, 1000) > 0)
+    if (!VTermClientRead(c, vt))
+      return false;
+  VTermDataBuffer *buf = VTermGetCurrentBuffer(vt);
+  vt->pixel_width = buf->column_count * VTermCellWidth(buf);
+  vt->pixel_height = buf->row_count * buf->font_size;
+  SetWindowSize(vt->pixel_width, vt->pixel_height);
+  return true;
+}
+
+bool VTermClientConnect(VTermClient *c, const char *path)
+{
+  struct sockaddr_un addr = { .sun_family = AF_UNIX };
+
+  memset(c, 0, sizeof(*c));
+  c->fd = -1;
+  if (strlen(path) >= sizeof(addr.sun_path))
+  {
+    VTermError("VTermClientConnect(path too long)");
+    return false;
+  }
+  strcpy(addr.sun_path, path);
+  if ((c->fd = socket(AF_UNIX, SOCK_STREAM, 0)) == -1)
+  {
+    VTermError("socket(AF_UNIX)");
+    return false;
+  }
+  if (connect(c->fd, (struct sockaddr *)&addr, sizeof(addr)) == -1)
+  {
+    VTermError("connect(server socket)");
+    close(c->fd);
+    c->fd = -1;
+    return false;
+  }
+  fcntl(c->fd, F_SETFL, fcntl(c->fd, F_GETFL) | O_NONBLOCK);
+  return true;
+}
+
+void VTermClientClose(VTermClient *c)
+{
+  if (c->fd != -1)
+    close(c->fd);
+  free(c->in);
+  memset(c, 0, sizeof(*c));
+  c->fd = -1;
+}
+
+bool VTermWireSend(int fd, VTermWireType type, const void *payload, size_t len)
+/* Small messages (keys, resizes), waits out a full socket */
+{
+  VTermWireHeader header = { type, len };
+  struct iovec iov[2] = { { &header, sizeof(header) }, { (void *)payload, len } };
+  size_t left = sizeof(header) + len;
+
+  while (left > 0)
+  {
+    ssize_t n = writev(fd, iov, 2);
+    if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+    {
+      struct pollfd pfd = { fd, POLLOUT, 0 };
+      poll(&pfd, 1, -1);
+      continue;
+    }
+    if (n == -1 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      return false;
+    left -= n;
+    for (int i = 0; i < 2; i++)
+    {
+      size_t k = (size_t)n < iov[i].iov_len ? (size_t)n : iov[i].iov_len;
+      iov[i].iov_base = (uint8_t *)iov[i].iov_base + k;
+      iov[i].iov_len -= k;
+      n -= k;
+    }
+  }
+  return true;
+}
+
+bool VTermClientFlushInput(VTermClient *c, VTermDataBuffer *buf)
+/* What VTermSendInput queued goes to the server instead of a pty */
+{
+  VTermRing *out = buf->out;
+  while (VTermRingUsed(out) > 0)
+  {
+    size_t at = out->head & (out->size - 1);
+    size_t n = VTermRingUsed(out);
+    if (n > out->size - at)
+      n = out->size - at;
+    if (!VTermWireSend(c->fd, VTERM_WIRE_INPUT, out->data + at, n))
+    {
+      c->exited = true;
+      return false;
+    }
+    out->head += n;
+  }
+  buf->out_stamp = 0;
+  return true;
+}
+
+static bool VTermClientApply(VTermClient *c, VTerm *vt, uint32_t type, const uint8_t *p, size_t len)
+{
+  VTermWireFrame frame;
+
+  if (type == VTERM_WIRE_EXIT)
+  {
+    c->exited = true;
+    return false;
+  }
+  if (type != VTERM_WIRE_SNAPSHOT && type != VTERM_WIRE_DAMAGE)
+    return true;
+  if (len < sizeof(frame))
+    return false;
+  memcpy(&frame, p, sizeof(frame));
+  p += sizeof(frame);
+  len -= sizeof(frame);
+  if (frame.column_count == 0 || frame.row_count == 0)
+    return false;
+
+  /* The server's grid wins, whatever the window asked for */
+  VTermDataBuffer *buf = VTermGetCurrentBuffer(vt);
+  if (frame.column_count != buf->column_count || frame.row_count != buf->row_count)
+  {
+    if (!VTermResize(vt, frame.column_count, frame.row_count))
+      return false;
+    buf = VTermGetCurrentBuffer(vt);
+  }
+  if (frame.scroll != 0 && frame.scroll_top < frame.scroll_bottom && frame.scroll_bottom <= buf->row_count)
+    VTermScrollRegion(buf, frame.scroll_top, frame.scroll_bottom, frame.scroll);
+
+  for (uint16_t i = 0; i < frame.spans; i++)
+  {
+    VTermWireSpan span;
+    if (len < sizeof(span))
+      return false;
+    memcpy(&span, p, sizeof(span));
+    size_t size = sizeof(span) + span.count * sizeof(uint64_t) + VTermWireAlign(span.count);
+    if (len < size || span.row >= buf->row_count || span.col + span.count > buf->column_count)
+      return false;
+    memcpy(VTermRowColors(buf, span.row) + span.col, p + sizeof(span), span.count * sizeof(uint64_t));
+    memcpy(VTermRowData(buf, span.row) + span.col, p + sizeof(span) + span.count * sizeof(uint64_t), span.count);
+    buf->row_flags[span.row] |= VTERM_ROW_DIRTY;
+    p += size;
+    len -= size;
+  }
+
+  buf->col = frame.col < buf->column_count ? frame.col : buf->column_count - 1;
+  buf->row = frame.row < buf->row_count ? frame.row : buf->row_count - 1;
+  buf->parser->dec_modes = frame.dec_modes;
+  c->seq = frame.seq;
+  c->frames++;
+  vt->busy = true;
+  return true;
+}
+
+bool VTermClientRead(VTermClient *c, VTerm *vt)
+/* Applies every complete message on the socket, false once the server is
+ * gone (or talks nonsense) */
+{
+  for (;;)
+  {
+    if (!VTermWireReserve(&c->in, &c->in_cap, c->in_len + 65536))
+      return false;
+    ssize_t n = read(c->fd, c->in + c->in_len, c->in_cap - c->in_len);
+    if (n > 0)
+    {
+      c->in_len += n;
+      c->bytes += n;
+      if (c->in_len < c->in_cap)
+        break;
+      continue;
+    }
+    if (n == -1 && errno == EINTR)
+      continue;
+    if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+      break;
+    c->exited = true;
+    break;
+  }
+
+  size_t at = 0;
+  uint32_t frames = c->frames;
+  VTermWireHeader header;
+  while (c->in_len - at >= sizeof(header))
+  {
+    memcpy(&header, c->in + at, sizeof(header));
+    if (header.length > VTERM_WIRE_MAX)
+    {
+      c->exited = true;
+      break;
+    }
+    if (c->in_len - at - sizeof(header) < header.length)
+      break;
+    if (!VTermClientApply(c, vt, header.type, c->in + at + sizeof(header), header.length))
+    {
+      c->exited = true;
+      break;
+    }
+    at += sizeof(header) + header.length;
+  }
+  memmove(c->in, c->in + at, c->in_len - at);
+  c->in_len -= at;
+  /* Ready for the next one, whatever happened since comes in one frame */
+  if (c->frames != frames && !c->exited && !VTermWireSend(c->fd, VTERM_WIRE_ACK, &c->seq, sizeof(c->seq)))
+    c->exited = true;
+  return !c->exited;
+}
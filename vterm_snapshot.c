@@ -0,0 +1,297 @@
+#include "vterm.h"
+#include <limits.h>
+#include <libgen.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define VTermSnapshotAlign(n) (((n) + 7) & ~(uint64_t)7)
+
+static void VTermSnapshotLayout(VTermSnapshotScreen *s, VTermDataBuffer *buf, uint64_t *at)
+/* Describes buf and gives its arrays their place in the file */
+{
+  memset(s, 0, sizeof(*s));
+  s->mode = buf->mode;
+  s->column_count = buf->column_count;
+  s->row_count = buf->row_count;
+  s->col = buf->col;
+  s->row = buf->row;
+  s->saved_col = buf->saved_col;
+  s->saved_row = buf->saved_row;
+  s->scroll_top = buf->scroll_top;
+  s->scroll_bottom = buf->scroll_bottom;
+  s->font_size = buf->font_size;
+  s->fg_index = buf->pen.fg_index;
+  s->bg_index = buf->pen.bg_index;
+  s->style = buf->pen.style;
+  memcpy(&s->fg, &buf->pen.fg, sizeof(s->fg));
+  memcpy(&s->bg, &buf->pen.bg, sizeof(s->bg));
+  s->fgbg_color = buf->fgbg_color;
+  s->default_fgbg = buf->default_fgbg;
+
+  s->data = *at;
+  *at += VTermSnapshotAlign(buf->buffer_size);
+  s->colors = *at;
+  *at += buf->buffer_size * sizeof(uint64_t);
+  s->row_flags = *at;
+  *at += VTermSnapshotAlign(buf->row_count);
+  s->row_index = *at;
+  *at += VTermSnapshotAlign(buf->row_count * sizeof(uint16_t));
+}
+
+static bool VTermSnapshotPut(FILE *f, const void *src, size_t len)
+/* len bytes, then zeros up to the next 8 byte boundary */
+{
+  static const uint8_t zeros[8];
+  size_t pad = VTermSnapshotAlign(len) - len;
+  return fwrite(src, 1, len, f) == len && fwrite(zeros, 1, pad, f) == pad;
+}
+
+static bool VTermSnapshotPutScreen(FILE *f, VTermDataBuffer *buf)
+{
+  return VTermSnapshotPut(f, buf->data, buf->buffer_size)
+    && VTermSnapshotPut(f, buf->fgbg_colors, buf->buffer_size * sizeof(uint64_t))
+    && VTermSnapshotPut(f, buf->row_flags, buf->row_count)
+    && VTermSnapshotPut(f, buf->row_index, buf->row_count * sizeof(uint16_t));
+}
+
+bool VTermSnapshotSave(VTerm *vt, const char *path)
+/* Written next to path and renamed over it, a crash mid-save leaves the
+ * previous snapshot */
+{
+  VTermSnapshotHeader header = { 0 };
+  VTermSnapshotSession sessions[MAX_BUFFER_COUNT];
+  uint64_t at = VTermSnapshotAlign(sizeof(header));
+  char tmp[PATH_MAX + 8], link_path[PATH_MAX];
+
+  memcpy(header.magic, VTERM_SNAPSHOT_MAGIC, sizeof(header.magic));
+  header.version = VTERM_SNAPSHOT_VERSION;
+  header.buffer_ix = vt->buffer_ix;
+  for (int i = 0; i < MAX_BUFFER_COUNT; i++)
+  {
+    VTermDataBuffer *buf = vt->buffers[i];
+    VTermSnapshotSession *s = &sessions[i];
+
+    snprintf(link_path, sizeof(link_path), "%s.%d", path, i);
+    if (buf == NULL)
+    {
+      /* Left over from a snapshot that had more buffers */
+      unlink(link_path);
+      snprintf(tmp, sizeof(tmp), "%s.idx", link_path);
+      unlink(tmp);
+      snprintf(tmp, sizeof(tmp), "%s.tri", link_path);
+      unlink(tmp);
+      continue;
+    }
+    header.sessions[i] = at;
+    at += VTermSnapshotAlign(sizeof(*s));
+    memset(s, 0, sizeof(*s));
+    VTermSnapshotLayout(&s->screens[0], buf, &at);
+    VTermSnapshotLayout(&s->screens[1], (VTermDataBuffer *)buf->alt_screen, &at);
+    /* Saved between chunks, no escape sequence is half parsed */
+    s->dec_modes = buf->parser->dec_modes & ~VTERM_DEC_SYNC_OUTPUT;
+    s->wrap = buf->parser->previousWasWrap;
+    s->cr_after_wrap = buf->parser->previousWasCRAfterWrap;
+    s->in_alt = buf->alt_buffer != NULL;
+
+    VTermScrollback *sb = buf->scrollback;
+    if (sb->fd != -1 && VTermScrollbackLink(sb, link_path, &s->saved))
+    {
+      snprintf(tmp, sizeof(tmp), "%s", link_path);
+      snprintf(s->scrollback, sizeof(s->scrollback), "%s", basename(tmp));
+    }
+  }
+  header.size = at;
+
+  snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+  FILE *f = fopen(tmp, "wb");
+  if (f == NULL)
+  {
+    VTermError("fopen(snapshot)");
+    return false;
+  }
+  bool ok = VTermSnapshotPut(f, &header, sizeof(header));
+  for (int i = 0; ok && i < MAX_BUFFER_COUNT; i++)
+  {
+    if (vt->buffers[i] == NULL)
+      continue;
+    ok = VTermSnapshotPut(f, &sessions[i], sizeof(sessions[i]))
+      && VTermSnapshotPutScreen(f, vt->buffers[i])
+      && VTermSnapshotPutScreen(f, (VTermDataBuffer *)vt->buffers[i]->alt_screen);
+  }
+  if (fclose(f) != 0 || !ok || rename(tmp, path) == -1)
+  {
+    VTermError("write(snapshot)");
+    unlink(tmp);
+    return false;
+  }
+  return true;
+}
+
+static bool VTermSnapshotFits(uint64_t offset, uint64_t len, uint64_t size)
+{
+  return offset % 8 == 0 && offset <= size && len <= size - offset;
+}
+
+static bool VTermSnapshotPermutation(const uint16_t *row_index, uint16_t row_count)
+/* Each row its own cells: the index holds every row exactly once */
+{
+  uint8_t seen[(UINT16_MAX + 1) / 8] = { 0 };
+  for (uint16_t r = 0; r < row_count; r++)
+  {
+    uint16_t ix = row_index[r];
+    if (ix >= row_count || (seen[ix / 8] & (1 << ix % 8)))
+      return false;
+    seen[ix / 8] |= 1 << ix % 8;
+  }
+  return true;
+}
+
+static bool VTermSnapshotValid(const VTermSnapshotScreen *s, const VTermSnapshotScreen *main, const uint8_t *map,
+                               uint64_t size)
+/* Everything a restore copies has to be inside the file */
+{
+  uint64_t cells = (uint64_t)s->column_count * s->row_count;
+  return s->mode < 21 && s->column_count > 0 && s->row_count > 0
+    && s->column_count == main->column_count && s->row_count == main->row_count
+    && s->col < s->column_count && s->row < s->row_count
+    && s->scroll_top < s->scroll_bottom && s->scroll_bottom <= s->row_count
+    && VTermSnapshotFits(s->data, cells, size)
+    && VTermSnapshotFits(s->colors, cells * sizeof(uint64_t), size)
+    && VTermSnapshotFits(s->row_flags, s->row_count, size)
+    && VTermSnapshotFits(s->row_index, s->row_count * sizeof(uint16_t), size)
+    && VTermSnapshotPermutation((const uint16_t *)(map + s->row_index), s->row_count);
+}
+
+static void VTermSnapshotLoadScreen(VTermDataBuffer *buf, const VTermSnapshotScreen *s, const uint8_t *map)
+/* s passed VTermSnapshotValid */
+{
+  memcpy(buf->data, map + s->data, buf->buffer_size);
+  memcpy(buf->fgbg_colors, map + s->colors, buf->buffer_size * sizeof(uint64_t));
+  memcpy(buf->row_flags, map + s->row_flags, buf->row_count);
+  memcpy(buf->row_index, map + s->row_index, buf->row_count * sizeof(uint16_t));
+  for (uint16_t r = 0; r < buf->row_count; r++)
+    buf->row_flags[r] |= VTERM_ROW_DIRTY;
+  buf->col = s->col;
+  buf->row = s->row;
+  buf->saved_col = s->saved_col < s->column_count ? s->saved_col : 0;
+  buf->saved_row = s->saved_row < s->row_count ? s->saved_row : 0;
+  buf->scroll_top = s->scroll_top;
+  buf->scroll_bottom = s->scroll_bottom;
+  if (s->font_size >= 2)
+    buf->font_size = s->font_size;
+  buf->pen.fg_index = s->fg_index;
+  buf->pen.bg_index = s->bg_index;
+  buf->pen.style = s->style;
+  memcpy(&buf->pen.fg, &s->fg, sizeof(s->fg));
+  memcpy(&buf->pen.bg, &s->bg, sizeof(s->bg));
+  buf->fgbg_color = s->fgbg_color;
+  buf->default_fgbg = s->default_fgbg;
+  buf->damage = (VTermDamage){ .full = true };
+}
+
+bool VTermSnapshotRestore(VTerm *vt, const char *path)
+/* Replaces vt's buffers with the snapshot's, none of them gets a child
+ * (VTermStartChild). vt's fonts and palette must be set up already. */
+{
+  struct stat st;
+  int fd = open(path, O_RDONLY);
+  if (fd == -1)
+  {
+    VTermError("open(snapshot)");
+    return false;
+  }
+  if (fstat(fd, &st) == -1 || (size_t)st.st_size < sizeof(VTermSnapshotHeader))
+  {
+    VTermError("fstat(snapshot)");
+    close(fd);
+    return false;
+  }
+  const uint8_t *map = (const uint8_t *)mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED)
+  {
+    VTermError("mmap(snapshot)");
+    return false;
+  }
+
+  /* Check the whole file before touching vt */
+  const VTermSnapshotHeader *header = (const VTermSnapshotHeader *)map;
+  uint64_t size = st.st_size;
+  bool ok = memcmp(header->magic, VTERM_SNAPSHOT_MAGIC, sizeof(header->magic)) == 0
+    && header->version == VTERM_SNAPSHOT_VERSION && header->size == size
+    && header->buffer_ix < MAX_BUFFER_COUNT && header->sessions[header->buffer_ix] != 0;
+  for (int i = 0; ok && i < MAX_BUFFER_COUNT; i++)
+  {
+    uint64_t offset = header->sessions[i];
+    if (offset == 0)
+      continue;
+    const VTermSnapshotSession *s = (const VTermSnapshotSession *)(map + offset);
+    ok = VTermSnapshotFits(offset, sizeof(*s), size)
+      && VTermSnapshotValid(&s->screens[0], &s->screens[0], map, size)
+      && VTermSnapshotValid(&s->screens[1], &s->screens[0], map, size)
+      && memchr(s->scrollback, '\0', sizeof(s->scrollback)) != NULL;
+  }
+  if (!ok)
+  {
+    VTermError("VTermSnapshotRestore(bad snapshot)");
+    munmap((void *)map, size);
+    return false;
+  }
+
+  uint16_t buffer_ix = header->buffer_ix;
+
+  /* Scrollbacks go where new ones would, else beside the snapshot */
+  char dir[PATH_MAX], from[PATH_MAX];
+  snprintf(dir, sizeof(dir), "%s", path);
+  const char *history = getenv("VTERM_SCROLLBACK") ? getenv("VTERM_SCROLLBACK") : dirname(dir);
+  snprintf(dir, sizeof(dir), "%s", path);
+  const char *snapshot_dir = dirname(dir);
+
+  for (int i = 0; ok && i < MAX_BUFFER_COUNT; i++)
+  {
+    const VTermSnapshotSession *s = (const VTermSnapshotSession *)(map + header->sessions[i]);
+    if (header->sessions[i] == 0)
+    {
+      if (vt->buffers[i] != NULL)
+        VTermCloseBuffer(vt->buffers[i]);
+      vt->buffers[i] = NULL;
+      continue;
+    }
+    if (!VTermInitBufferSized(&vt->buffers[i], s->screens[0].mode, s->screens[0].column_count, s->screens[0].row_count))
+    {
+      ok = false;
+      break;
+    }
+    VTermDataBuffer *buf = vt->buffers[i];
+    VTermDataBuffer *alt = (VTermDataBuffer *)buf->alt_screen;
+    VTermSnapshotLoadScreen(buf, &s->screens[0], map);
+    VTermSnapshotLoadScreen(alt, &s->screens[1], map);
+    buf->parser->dec_modes = s->dec_modes;
+    buf->parser->previousWasWrap = s->wrap;
+    buf->parser->previousWasCRAfterWrap = s->cr_after_wrap;
+    if (s->in_alt)
+      buf->alt_buffer = alt;
+
+    /* Without its history the session is still worth having */
+    snprintf(from, sizeof(from), "%s/%s", snapshot_dir, s->scrollback);
+    if (s->scrollback[0] != '\0'
+        && !VTermScrollbackAdopt(buf->scrollback, history, from, &s->saved))
+      VTermError("VTermScrollbackAdopt(snapshot)");
+  }
+  munmap((void *)map, size);
+
+  if (!ok)
+  {
+    VTermError("VTermSnapshotRestore(load)");
+    for (int i = 0; i < MAX_BUFFER_COUNT; i++)
+    {
+      if (vt->buffers[i] != NULL)
+        VTermCloseBuffer(vt->buffers[i]);
+      vt->buffers[i] = NULL;
+    }
+    return false;
+  }
+  vt->buffer_ix = buffer_ix;
+  vt->busy = true;
+  return true;
+}
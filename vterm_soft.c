@@ -0,0 +1,309 @@
+#include "vterm.h"
+#include <pthread.h>
+
+/* Software renderer: composites the cell grid into an RGBA framebuffer from
+ * 1-bpp glyph rows, no GPU needed. Each glyph row is expanded to pixels as
+ * bg ^ ((fg ^ bg) & mask) eight lanes at a time, and bands of rows are
+ * split across a small thread pool. */
+
+// GCC/Clang vector extension, lowers to SSE/AVX/NEON as available
+typedef uint32_t VTermPixel8 __attribute__((vector_size(32)));
+
+// Glyph row byte -> 8 lane masks, bit 7 is the leftmost pixel
+static VTermPixel8 VTermExpand[256];
+static bool VTermSoftReady = false;
+
+static void VTermSoftInit(void)
+{
+  if (VTermSoftReady)
+    return;
+  for (int b = 0; b < 256; b++)
+    for (int x = 0; x < 8; x++)
+      VTermExpand[b][x] = (b & (0x80 >> x)) ? 0xffffffff : 0;
+  VTermSoftReady = true;
+}
+
+bool VTermFramebufferInit(VTermFramebuffer *fb, VTermDataBuffer *buf)
+/* One pixel per glyph pixel: the grid at the font's native size */
+{
+  VTermSoftInit();
+  fb->width = buf->column_count * buf->glyphs->width;
+  fb->height = buf->row_count * buf->glyphs->height;
+  fb->pixels = (Color *)malloc((size_t)fb->width * fb->height * sizeof(Color));
+  if (fb->pixels == NULL)
+  {
+    VTermError("malloc(framebuffer)");
+    return false;
+  }
+  return true;
+}
+
+void VTermFramebufferClose(VTermFramebuffer *fb)
+{
+  free(fb->pixels);
+  fb->pixels = NULL;
+  fb->width = fb->height = 0;
+}
+
+void VTermSoftRenderRows(VTermDataBuffer *buf, VTermFramebuffer *fb, uint16_t row0, uint16_t row1, bool dirty_only)
+/* Cell rows [row0, row1) into fb, which must match buf's grid. Rendered
+ * rows are clean afterwards. */
+{
+  const VTermPackedFont *g = buf->glyphs;
+  int cw = g->width, ch = g->height;
+  int underline = ch - 1, strike = ch / 2;
+
+  for (int row = row0; row < row1; row++)
+  {
+    if (dirty_only && !(buf->row_flags[row] & VTERM_ROW_DIRTY))
+      continue;
+    buf->row_flags[row] &= ~VTERM_ROW_DIRTY;
+    uint8_t *data = VTermRowData(buf, row);
+    uint64_t *colors = VTermRowColors(buf, row);
+
+    for (int col = 0; col < buf->column_count; col++)
+    {
+      uint32_t fg = UNPACK_fg(colors[col]), bg = UNPACK_bg(colors[col]);
+      uint8_t style = ((Color *)&fg)->a;
+      ((Color *)&fg)->a = 255;
+
+      VTermPixel8 bgv = (VTermPixel8){ 0 } + bg;
+      VTermPixel8 diff = ((VTermPixel8){ 0 } + fg) ^ bgv;
+      const uint16_t *bits = g->bits + data[col] * ch;
+      Color *dst = fb->pixels + (size_t)row * ch * fb->width + col * cw;
+
+      for (int y = 0; y < ch; y++, dst += fb->width)
+      {
+        uint16_t b = bits[y];
+        if (((style & VTERM_STYLE_UNDERLINE) && y == underline) || ((style & VTERM_STYLE_STRIKE) && y == strike))
+          b = 0xffff;
+
+        VTermPixel8 px = bgv ^ (diff & VTermExpand[b >> 8]);
+        if (cw <= 8)
+          memcpy(dst, &px, cw * sizeof(Color)); // narrow fonts use the left cw
+        else
+        {
+          /* 9-16 wide cells: second half from the low byte */
+          VTermPixel8 px2 = bgv ^ (diff & VTermExpand[b & 0xff]);
+          memcpy(dst, &px, sizeof(px));
+          memcpy(dst + 8, &px2, (cw - 8) * sizeof(Color));
+        }
+      }
+    }
+    if (buf->placement_count > 0)
+      VTermImageCompositeRow(buf, fb, row);
+  }
+}
+
+/***** Row-parallel thread pool *****/
+
+static struct {
+  pthread_t threads[VTERM_SOFT_MAX_THREADS];
+  int count;
+  pthread_mutex_t lock;
+  pthread_cond_t start, done;
+  uint64_t generation;
+  int pending;
+  bool running;
+  VTermDataBuffer *buf;
+  VTermFramebuffer *fb;
+  bool dirty_only;
+} VTermSoftPool;
+
+static void VTermSoftBand(int band, int bands)
+{
+  uint16_t rows = VTermSoftPool.buf->row_count;
+  uint16_t row0 = rows * band / bands, row1 = rows * (band + 1) / bands;
+  VTermSoftRenderRows(VTermSoftPool.buf, VTermSoftPool.fb, row0, row1, VTermSoftPool.dirty_only);
+}
+
+static void *VTermSoftWorker(void *arg)
+{
+  int band = (int)(intptr_t)arg;
+  uint64_t seen = 0;
+
+  pthread_mutex_lock(&VTermSoftPool.lock);
+  while (true)
+  {
+    while (VTermSoftPool.running && VTermSoftPool.generation == seen)
+      pthread_cond_wait(&VTermSoftPool.start, &VTermSoftPool.lock);
+    if (!VTermSoftPool.running)
+      break;
+    seen = VTermSoftPool.generation;
+    pthread_mutex_unlock(&VTermSoftPool.lock);
+
+    VTermSoftBand(band, VTermSoftPool.count + 1);
+
+    pthread_mutex_lock(&VTermSoftPool.lock);
+    if (--VTermSoftPool.pending == 0)
+      pthread_cond_signal(&VTermSoftPool.done);
+  }
+  pthread_mutex_unlock(&VTermSoftPool.lock);
+  return NULL;
+}
+
+bool VTermSoftPoolInit(int threads)
+/* threads counts the caller too, 1 means no workers */
+{
+  VTermSoftPoolClose();
+  if (threads > VTERM_SOFT_MAX_THREADS + 1)
+    threads = VTERM_SOFT_MAX_THREADS + 1;
+
+  pthread_mutex_init(&VTermSoftPool.lock, NULL);
+  pthread_cond_init(&VTermSoftPool.start, NULL);
+  pthread_cond_init(&VTermSoftPool.done, NULL);
+  VTermSoftPool.running = true;
+  VTermSoftPool.generation = 0;
+  VTermSoftPool.count = 0;
+  for (int i = 0; i < threads - 1; i++)
+  {
+    if (pthread_create(&VTermSoftPool.threads[i], NULL, VTermSoftWorker, (void *)(intptr_t)i) != 0)
+    {
+      VTermError("pthread_create(soft render)");
+      break;
+    }
+    VTermSoftPool.count++;
+  }
+  return true;
+}
+
+void VTermSoftPoolClose(void)
+{
+  if (!VTermSoftPool.running)
+    return;
+  pthread_mutex_lock(&VTermSoftPool.lock);
+  VTermSoftPool.running = false;
+  pthread_cond_broadcast(&VTermSoftPool.start);
+  pthread_mutex_unlock(&VTermSoftPool.lock);
+  for (int i = 0; i < VTermSoftPool.count; i++)
+    pthread_join(VTermSoftPool.threads[i], NULL);
+  VTermSoftPool.count = 0;
+}
+
+static bool VTermSoftDispatch(VTermDataBuffer *buf, VTermFramebuffer *fb, bool dirty_only)
+{
+  if (fb->width != buf->column_count * buf->glyphs->width || fb->height != buf->row_count * buf->glyphs->height)
+  {
+    VTermError("VTermSoftRender(framebuffer does not match grid)");
+    return false;
+  }
+
+  if (!VTermSoftPool.running || VTermSoftPool.count == 0)
+  {
+    VTermSoftRenderRows(buf, fb, 0, buf->row_count, dirty_only);
+    return true;
+  }
+
+  pthread_mutex_lock(&VTermSoftPool.lock);
+  VTermSoftPool.buf = buf;
+  VTermSoftPool.fb = fb;
+  VTermSoftPool.dirty_only = dirty_only;
+  VTermSoftPool.pending = VTermSoftPool.count;
+  VTermSoftPool.generation++;
+  pthread_cond_broadcast(&VTermSoftPool.start);
+  pthread_mutex_unlock(&VTermSoftPool.lock);
+
+  /* The caller takes the last band */
+  VTermSoftBand(VTermSoftPool.count, VTermSoftPool.count + 1);
+
+  pthread_mutex_lock(&VTermSoftPool.lock);
+  while (VTermSoftPool.pending > 0)
+    pthread_cond_wait(&VTermSoftPool.done, &VTermSoftPool.lock);
+  pthread_mutex_unlock(&VTermSoftPool.lock);
+  return true;
+}
+
+bool VTermSoftRender(VTermDataBuffer *buf, VTermFramebuffer *fb)
+{
+  return VTermSoftDispatch(buf, fb, false);
+}
+
+bool VTermSoftRenderDamage(VTermDataBuffer *buf, VTermFramebuffer *fb)
+/* fb holds the last frame of buf: shift a scrolled region's pixels, then
+ * render just the dirty rows */
+{
+  VTermDamage damage = VTermTakeDamage(buf);
+  if (damage.full)
+    return VTermSoftDispatch(buf, fb, false);
+
+  if (damage.scroll != 0)
+  {
+    size_t row_px = (size_t)fb->width * buf->glyphs->height;
+    int k = abs(damage.scroll), height = damage.scroll_bottom - damage.scroll_top;
+    Color *region = fb->pixels + damage.scroll_top * row_px;
+    if (damage.scroll > 0)
+      memmove(region, region + k * row_px, (height - k) * row_px * sizeof(Color));
+    else
+      memmove(region + k * row_px, region, (height - k) * row_px * sizeof(Color));
+  }
+  return VTermSoftDispatch(buf, fb, true);
+}
+
+bool VTermFramebufferExport(VTermFramebuffer *fb, const char *path)
+/* .ppm is written here, anything else goes through raylib (png, bmp...) */
+{
+  const char *ext = strrchr(path, '.');
+  if (ext == NULL || strcmp(ext, ".ppm") != 0)
+  {
+    Image image = { fb->pixels, fb->width, fb->height, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 };
+    return ExportImage(image, path);
+  }
+
+  FILE *f = fopen(path, "wb");
+  if (f == NULL)
+  {
+    VTermError("fopen(ppm)");
+    return false;
+  }
+  fprintf(f, "P6\n%d %d\n255\n", fb->width, fb->height);
+  uint8_t *line = (uint8_t *)malloc((size_t)fb->width * 3);
+  for (int y = 0; y < fb->height; y++)
+  {
+    Color *src = fb->pixels + (size_t)y * fb->width;
+    for (int x = 0; x < fb->width; x++)
+    {
+      line[3 * x] = src[x].r;
+      line[3 * x + 1] = src[x].g;
+      line[3 * x + 2] = src[x].b;
+    }
+    fwrite(line, 3, fb->width, f);
+  }
+  free(line);
+  fclose(f);
+  return true;
+}
+
+void VTermSoftDraw(VTermDataBuffer *buf)
+/* Windowed fallback: render on the CPU, upload, draw as one quad scaled to
+ * the current cell size */
+{
+  static VTermFramebuffer fb = { 0 };
+  static Texture2D texture = { 0 };
+  static VTermDataBuffer *last = NULL;
+
+  if (fb.pixels == NULL || fb.width != buf->column_count * buf->glyphs->width
+      || fb.height != buf->row_count * buf->glyphs->height)
+  {
+    VTermFramebufferClose(&fb);
+    if (texture.id != 0)
+      UnloadTexture(texture);
+    texture.id = 0;
+    if (!VTermFramebufferInit(&fb, buf))
+      return;
+    Image image = { fb.pixels, fb.width, fb.height, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 };
+    texture = LoadTextureFromImage(image);
+    last = NULL;
+  }
+
+  /* fb holds whatever screen was drawn last, only then is damage enough */
+  if (buf != last)
+    buf->damage.full = true;
+  last = buf;
+  VTermSoftRenderDamage(buf, &fb);
+  UpdateTexture(texture, fb.pixels);
+  DrawTexturePro(texture,
+                 (Rectangle){ 0, 0, fb.width, fb.height },
+                 (Rectangle){ 0, 0, buf->column_count * VTermCellWidth(buf), buf->row_count * buf->font_size },
+                 (Vector2){ 0, 0 }, 0, WHITE);
+  VTermStats.frame_rects++;
+}